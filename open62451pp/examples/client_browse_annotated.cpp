@@ -52,7 +52,7 @@ void browseNodeRecursively(
             opcua::ReferenceTypeId::References,        // 引用类型：所有引用
             false,                                     // includeSubtypes：不包含子类型
             opcua::NodeId::null(),                     // nodeClassMask：所有节点类
-            opcua::NodeId::null()                      // resultMask：所有结果掩码
+            opcua::BrowseResultMask::BrowseName        // resultMask：只返回浏览名称（NodeId 总会返回）
         };
         
         // 执行浏览操作
@@ -122,7 +122,7 @@ void browseSpecificNodeClass(
             opcua::ReferenceTypeId::References,        // 引用类型：所有引用
             false,                                     // 不包含子类型
             static_cast<opcua::NodeClassMask>(nodeClass),  // 只浏览指定节点类
-            opcua::NodeId::null()                      // 所有结果掩码
+            opcua::BrowseResultMask::BrowseName        // 只返回浏览名称
         };
         
         // 执行浏览操作
@@ -253,6 +253,8 @@ int main() {
  * - 采样间隔影响数据精度和资源消耗
  * - 监控项数量影响内存和 CPU 使用
  * - 回调函数应该快速执行，避免阻塞
+ * - 每个监控项一个回调（并在回调中构造 MonitoredItem）适合少量监控项；
+ *   上万个监控项时改用 collector/dispatch_subscription.hpp，每个订阅一个处理函数
  * 
  * 安全考虑：
  * 
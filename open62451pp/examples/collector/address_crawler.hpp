@@ -0,0 +1,276 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <open62541/client.h>
+
+#include <open62541pp/client.hpp>
+
+#include "address_space.hpp"
+#include "request_profiles.hpp"
+
+struct CrawlOptions {
+    size_t nodesPerRequest = 500;          // 每个 Browse 请求包含的节点数
+    uint32_t maxReferencesPerNode = 1000;  // 超出部分通过 BrowseNext 续读
+    size_t maxDepth = 16;
+    bool browseVariables = false;    // 是否继续浏览变量的子节点（结构化变量）
+    bool includeProperties = false;  // 是否收录 HasProperty 引用的属性节点（EURange 等）
+    bool readDataTypes = true;       // 浏览完成后批量读取变量的 DataType
+    size_t readsPerRequest = 1000;
+};
+
+struct CrawlStats {
+    size_t browseRequests = 0;
+    size_t browseNextRequests = 0;
+    size_t readRequests = 0;
+    size_t references = 0;
+    double seconds = 0.0;
+    // 第一个失败的服务结果或节点浏览结果；不是 Good 时快照缺少部分子树，不能据此判断节点已删除
+    UA_StatusCode status = UA_STATUSCODE_GOOD;
+
+    bool complete() const noexcept {
+        return status == UA_STATUSCODE_GOOD;
+    }
+};
+
+/**
+ * @brief 地址空间爬取
+ *
+ * 按层广度优先浏览：每层的节点按 nodesPerRequest 打包成一个 Browse 请求，
+ * 续读点打包成 BrowseNext 请求，而不是逐个节点调用 browse()。
+ */
+class AddressSpaceCrawler {
+public:
+    explicit AddressSpaceCrawler(opcua::Client& client, CrawlOptions options = {})
+        : client_{client},
+          options_{options} {}
+
+    /// 从 root 开始爬取，结果追加到 snapshot；结果是否完整见 CrawlStats::status
+    CrawlStats crawl(const opcua::NodeId& root, AddressSpaceSnapshot& snapshot) {
+        stats_ = {};
+        const auto start = std::chrono::steady_clock::now();
+        const NodeIndex rootIndex = addRoot(root, snapshot);
+        crawlFrom({rootIndex}, snapshot);
+        stats_.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return stats_;
+    }
+
+protected:
+    /// 从一组已在快照中的节点开始向下浏览，返回新增的节点
+    std::vector<NodeIndex> crawlFrom(std::vector<NodeIndex> frontier, AddressSpaceSnapshot& snapshot) {
+        added_.clear();
+        for (size_t depth = 0; !frontier.empty() && depth < options_.maxDepth; ++depth) {
+            std::vector<NodeIndex> next;
+            for (size_t offset = 0; offset < frontier.size(); offset += options_.nodesPerRequest) {
+                const size_t count = std::min(options_.nodesPerRequest, frontier.size() - offset);
+                browseBatch(&frontier[offset], count, snapshot, next);
+            }
+            frontier = std::move(next);
+        }
+        if (options_.readDataTypes) {
+            readDataTypes(added_, snapshot);
+        }
+        return std::move(added_);
+    }
+
+    opcua::Client& client_;
+    CrawlOptions options_;
+    CrawlStats stats_;
+
+private:
+    // 记录第一个失败；服务结果为 Good 但结果数不符时记为 BadUnexpectedError
+    void fail(UA_StatusCode code) noexcept {
+        if (stats_.status == UA_STATUSCODE_GOOD) {
+            stats_.status = code == UA_STATUSCODE_GOOD ? UA_STATUSCODE_BADUNEXPECTEDERROR : code;
+        }
+    }
+
+    static std::string toStdString(const UA_String& s) {
+        return std::string{reinterpret_cast<const char*>(s.data), s.length};
+    }
+
+    NodeIndex addRoot(const opcua::NodeId& root, AddressSpaceSnapshot& snapshot) {
+        UA_ReadValueId items[2];
+        for (auto& item : items) {
+            UA_ReadValueId_init(&item);
+            item.nodeId = *root.handle();
+        }
+        items[0].attributeId = UA_ATTRIBUTEID_BROWSENAME;
+        items[1].attributeId = UA_ATTRIBUTEID_DISPLAYNAME;
+        UA_ReadRequest request;
+        UA_ReadRequest_init(&request);
+        apply(request_profiles::metadata, request);
+        request.nodesToRead = items;
+        request.nodesToReadSize = 2;
+        UA_ReadResponse response = UA_Client_Service_read(client_.handle(), request);
+        ++stats_.readRequests;
+        std::string browseName = "Root";
+        std::string displayName = browseName;
+        if (response.responseHeader.serviceResult != UA_STATUSCODE_GOOD || response.resultsSize != 2) {
+            fail(response.responseHeader.serviceResult);
+        } else {
+            const UA_DataValue& bn = response.results[0];
+            const UA_DataValue& dn = response.results[1];
+            if (bn.hasValue && UA_Variant_hasScalarType(&bn.value, &UA_TYPES[UA_TYPES_QUALIFIEDNAME])) {
+                browseName = toStdString(static_cast<const UA_QualifiedName*>(bn.value.data)->name);
+            }
+            if (dn.hasValue && UA_Variant_hasScalarType(&dn.value, &UA_TYPES[UA_TYPES_LOCALIZEDTEXT])) {
+                displayName = toStdString(static_cast<const UA_LocalizedText*>(dn.value.data)->text);
+            }
+        }
+        UA_ReadResponse_clear(&response);
+        return snapshot.add(root, invalidNodeIndex, browseName, displayName, opcua::NodeClass::Object);
+    }
+
+    void browseBatch(
+        const NodeIndex* nodes, size_t count, AddressSpaceSnapshot& snapshot, std::vector<NodeIndex>& next
+    ) {
+        std::vector<UA_BrowseDescription> descriptions(count);
+        for (size_t i = 0; i < count; ++i) {
+            auto& d = descriptions[i];
+            UA_BrowseDescription_init(&d);
+            d.nodeId = *snapshot.nodeId(nodes[i]).handle();  // 浅拷贝，请求不负责释放
+            d.browseDirection = UA_BROWSEDIRECTION_FORWARD;
+            d.referenceTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_HIERARCHICALREFERENCES);
+            d.includeSubtypes = true;
+            apply(request_profiles::crawl, d);
+        }
+        UA_BrowseRequest request;
+        UA_BrowseRequest_init(&request);
+        request.requestedMaxReferencesPerNode = options_.maxReferencesPerNode;
+        request.nodesToBrowse = descriptions.data();
+        request.nodesToBrowseSize = count;
+        UA_BrowseResponse response = UA_Client_Service_browse(client_.handle(), request);
+        ++stats_.browseRequests;
+
+        // 续读点：(父节点, 续读点)
+        std::vector<std::pair<NodeIndex, UA_ByteString>> pending;
+        if (response.responseHeader.serviceResult == UA_STATUSCODE_GOOD && response.resultsSize == count) {
+            for (size_t i = 0; i < count; ++i) {
+                collect(nodes[i], response.results[i], snapshot, next, pending);
+            }
+        } else {
+            fail(response.responseHeader.serviceResult);
+        }
+        UA_BrowseResponse_clear(&response);
+
+        while (!pending.empty()) {
+            std::vector<UA_ByteString> points(pending.size());
+            std::vector<NodeIndex> parents(pending.size());
+            for (size_t i = 0; i < pending.size(); ++i) {
+                parents[i] = pending[i].first;
+                points[i] = pending[i].second;  // 所有权转移到 points
+            }
+            pending.clear();
+            UA_BrowseNextRequest nextRequest;
+            UA_BrowseNextRequest_init(&nextRequest);
+            nextRequest.continuationPoints = points.data();
+            nextRequest.continuationPointsSize = points.size();
+            UA_BrowseNextResponse nextResponse = UA_Client_Service_browseNext(client_.handle(), nextRequest);
+            ++stats_.browseNextRequests;
+            if (nextResponse.responseHeader.serviceResult == UA_STATUSCODE_GOOD &&
+                nextResponse.resultsSize == points.size()) {
+                for (size_t i = 0; i < points.size(); ++i) {
+                    collect(parents[i], nextResponse.results[i], snapshot, next, pending);
+                }
+            } else {
+                fail(nextResponse.responseHeader.serviceResult);
+            }
+            UA_BrowseNextResponse_clear(&nextResponse);
+            for (auto& point : points) {
+                UA_ByteString_clear(&point);
+            }
+        }
+    }
+
+    void collect(
+        NodeIndex parent,
+        UA_BrowseResult& result,
+        AddressSpaceSnapshot& snapshot,
+        std::vector<NodeIndex>& next,
+        std::vector<std::pair<NodeIndex, UA_ByteString>>& pending
+    ) {
+        if (UA_StatusCode_isBad(result.statusCode)) {
+            // 节点在两层浏览之间被删除是正常的变化，其他错误（续读点失效、资源不足等）使结果不完整
+            if (result.statusCode != UA_STATUSCODE_BADNODEIDUNKNOWN) {
+                fail(result.statusCode);
+            }
+            return;
+        }
+        for (size_t j = 0; j < result.referencesSize; ++j) {
+            const UA_ReferenceDescription& ref = result.references[j];
+            if (ref.nodeId.serverIndex != 0) {
+                continue;  // 其他服务器上的节点
+            }
+            const bool property = ref.referenceTypeId.namespaceIndex == 0 &&
+                ref.referenceTypeId.identifierType == UA_NODEIDTYPE_NUMERIC &&
+                ref.referenceTypeId.identifier.numeric == UA_NS0ID_HASPROPERTY;
+            if (property && !options_.includeProperties) {
+                continue;
+            }
+            ++stats_.references;
+            const size_t before = snapshot.size();
+            const NodeIndex child = snapshot.add(
+                opcua::NodeId{ref.nodeId.nodeId},
+                parent,
+                toStdString(ref.browseName.name),
+                toStdString(ref.displayName.text),
+                static_cast<opcua::NodeClass>(ref.nodeClass)
+            );
+            if (snapshot.size() == before) {
+                continue;  // 已经通过其他路径收录
+            }
+            added_.push_back(child);
+            if (ref.nodeClass == UA_NODECLASS_OBJECT || (options_.browseVariables && !property)) {
+                next.push_back(child);
+            }
+        }
+        if (result.continuationPoint.length > 0) {
+            pending.emplace_back(parent, result.continuationPoint);
+            UA_ByteString_init(&result.continuationPoint);  // 所有权转移到 pending
+        }
+    }
+
+    void readDataTypes(const std::vector<NodeIndex>& added, AddressSpaceSnapshot& snapshot) {
+        std::vector<NodeIndex> variables;
+        for (const NodeIndex node : added) {
+            if (snapshot.nodeClass(node) == opcua::NodeClass::Variable) {
+                variables.push_back(node);
+            }
+        }
+        for (size_t offset = 0; offset < variables.size(); offset += options_.readsPerRequest) {
+            const size_t count = std::min(options_.readsPerRequest, variables.size() - offset);
+            std::vector<UA_ReadValueId> items(count);
+            for (size_t i = 0; i < count; ++i) {
+                UA_ReadValueId_init(&items[i]);
+                items[i].nodeId = *snapshot.nodeId(variables[offset + i]).handle();
+                items[i].attributeId = UA_ATTRIBUTEID_DATATYPE;
+            }
+            UA_ReadRequest request;
+            UA_ReadRequest_init(&request);
+            apply(request_profiles::metadata, request);  // DataType 不需要时间戳
+            request.nodesToRead = items.data();
+            request.nodesToReadSize = count;
+            UA_ReadResponse response = UA_Client_Service_read(client_.handle(), request);
+            ++stats_.readRequests;
+            if (response.responseHeader.serviceResult == UA_STATUSCODE_GOOD && response.resultsSize == count) {
+                for (size_t i = 0; i < count; ++i) {
+                    const UA_DataValue& dv = response.results[i];
+                    if (dv.hasValue && UA_Variant_hasScalarType(&dv.value, &UA_TYPES[UA_TYPES_NODEID])) {
+                        snapshot.setDataType(
+                            variables[offset + i], opcua::NodeId{*static_cast<const UA_NodeId*>(dv.value.data)}
+                        );
+                    }
+                }
+            } else {
+                fail(response.responseHeader.serviceResult);
+            }
+            UA_ReadResponse_clear(&response);
+        }
+    }
+
+    std::vector<NodeIndex> added_;  // 本次浏览新增的节点
+};
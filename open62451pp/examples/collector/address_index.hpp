@@ -0,0 +1,476 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "address_space.hpp"
+#include "checkpoint.hpp"
+#include "variable_metadata.hpp"
+
+enum class SearchMode {
+    Substring,  // 在 BrowseName、DisplayName 和浏览路径中查找子串（不区分大小写）
+    Prefix,     // BrowseName 前缀
+};
+
+struct SearchQuery {
+    std::string text;
+    uint32_t nodeClassMask = 0;             // UA_NodeClass 位的组合，0 表示不限
+    std::optional<opcua::NodeId> dataType;  // 只返回该 DataType 的变量
+    size_t limit = 100;
+    SearchMode mode = SearchMode::Substring;
+};
+
+struct SearchResult {
+    std::vector<NodeIndex> nodes;  // 按 NodeIndex 递增
+    size_t candidates = 0;         // 经过索引筛选后需要逐个核对的节点数
+};
+
+/**
+ * @brief 地址空间快照上的搜索索引
+ *
+ * - 每个节点的检索文本为小写的 "browseName\ndisplayName\nbrowsePath"
+ * - 三字节（trigram）倒排索引：按键排序的键表 + 偏移表 + 递增的节点列表（CSR 布局），
+ *   查询取最短的几个列表求交集，再对候选节点核对子串和过滤条件
+ * - 前缀索引：按小写 BrowseName 排序的节点表，用于前缀查询和少于 3 个字符的查询
+ *
+ * 快照增量变化后调用 update()：变化的节点在主索引中标记为过期，新文本放入一个小的
+ * 追加区逐个核对；追加区超过节点数的 1/16 时自动重建。
+ */
+class AddressSpaceIndex {
+public:
+    AddressSpaceIndex() = default;
+
+    explicit AddressSpaceIndex(const AddressSpaceSnapshot& snapshot) {
+        build(snapshot);
+    }
+
+    void build(const AddressSpaceSnapshot& snapshot) {
+        const size_t n = snapshot.size();
+        text_.clear();
+        textOffsets_.assign(1, 0);
+        textOffsets_.reserve(n + 1);
+        for (NodeIndex node = 0; node < n; ++node) {
+            if (!snapshot.removed(node)) {
+                appendText(snapshot, node, text_);
+            }
+            textOffsets_.push_back(static_cast<uint32_t>(text_.size()));
+        }
+        text_.shrink_to_fit();
+        stale_.assign(n, 0);
+        for (NodeIndex node = 0; node < n; ++node) {
+            stale_[node] = snapshot.removed(node) ? 1 : 0;
+        }
+        overlay_.clear();
+        overlayText_.clear();
+        overlayOffsets_.assign(1, 0);
+
+        // 第一遍统计每个 trigram 出现在多少个节点中，第二遍填充节点列表
+        std::unordered_map<uint32_t, uint32_t> counts;
+        std::vector<uint32_t> grams;
+        for (NodeIndex node = 0; node < n; ++node) {
+            trigrams(text(node), grams);
+            for (const uint32_t gram : grams) {
+                ++counts[gram];
+            }
+        }
+        keys_.clear();
+        keys_.reserve(counts.size());
+        for (const auto& [gram, count] : counts) {
+            keys_.push_back(gram);
+        }
+        std::sort(keys_.begin(), keys_.end());
+        offsets_.assign(keys_.size() + 1, 0);
+        std::unordered_map<uint32_t, uint32_t> slots;
+        slots.reserve(keys_.size());
+        for (uint32_t i = 0; i < keys_.size(); ++i) {
+            offsets_[i + 1] = offsets_[i] + counts[keys_[i]];
+            slots.emplace(keys_[i], offsets_[i]);
+        }
+        postings_.resize(offsets_.back());
+        for (NodeIndex node = 0; node < n; ++node) {
+            trigrams(text(node), grams);
+            for (const uint32_t gram : grams) {
+                postings_[slots[gram]++] = node;  // 节点按编号顺序处理，列表自然递增
+            }
+        }
+
+        byName_.resize(n);
+        for (NodeIndex node = 0; node < n; ++node) {
+            byName_[node] = node;
+        }
+        std::sort(byName_.begin(), byName_.end(), [this](NodeIndex a, NodeIndex b) {
+            return nameOf(a) < nameOf(b);
+        });
+    }
+
+    /**
+     * @brief 快照中的 nodes 已新增、修改或删除
+     *
+     * 节点的浏览路径包含祖先的名称，祖先改名时需要把整个子树传入。
+     */
+    void update(const AddressSpaceSnapshot& snapshot, opcua::Span<const NodeIndex> nodes) {
+        stale_.resize(snapshot.size(), 1);  // build() 之后新增的节点不在主索引中
+        for (const NodeIndex node : nodes) {
+            stale_[node] = 1;
+            const auto it = std::lower_bound(overlay_.begin(), overlay_.end(), node);
+            if (it == overlay_.end() || *it != node) {
+                overlay_.insert(it, node);
+            }
+        }
+        if (overlay_.size() > snapshot.size() / 16) {
+            build(snapshot);
+            return;
+        }
+        // 追加区按 NodeIndex 排序，文本整体重写（追加区很小）
+        overlayText_.clear();
+        overlayOffsets_.assign(1, 0);
+        std::vector<NodeIndex> live;
+        for (const NodeIndex node : overlay_) {
+            if (!snapshot.removed(node)) {
+                live.push_back(node);
+                appendText(snapshot, node, overlayText_);
+                overlayOffsets_.push_back(static_cast<uint32_t>(overlayText_.size()));
+            }
+        }
+        overlay_ = std::move(live);
+    }
+
+    SearchResult search(const AddressSpaceSnapshot& snapshot, const SearchQuery& query) const {
+        SearchResult result;
+        uint32_t dataType = AddressSpaceSnapshot::noDataType;
+        if (query.dataType) {
+            dataType = snapshot.findDataType(*query.dataType);
+            if (dataType == AddressSpaceSnapshot::noDataType) {
+                return result;
+            }
+        }
+        const auto accept = [&](NodeIndex node) {
+            if (query.nodeClassMask != 0 && (snapshot.nodeClasses()[node] & query.nodeClassMask) == 0) {
+                return false;
+            }
+            return !query.dataType || snapshot.dataTypeOf(node) == dataType;
+        };
+
+        std::string needle;
+        for (const char c : query.text) {
+            needle += lower(c);
+        }
+        const bool prefix = query.mode == SearchMode::Prefix || needle.size() < 3;
+        if (prefix) {
+            searchPrefix(needle, query.limit, accept, result);
+        } else {
+            searchSubstring(needle, query.limit, accept, result);
+        }
+        if (!overlay_.empty()) {
+            searchOverlay(needle, prefix, query.limit, accept, result);
+        }
+        return result;
+    }
+
+    size_t memoryBytes() const noexcept {
+        return text_.capacity() + textOffsets_.capacity() * sizeof(uint32_t) +
+            keys_.capacity() * sizeof(uint32_t) + offsets_.capacity() * sizeof(uint32_t) +
+            postings_.capacity() * sizeof(NodeIndex) + byName_.capacity() * sizeof(NodeIndex) +
+            stale_.capacity() + overlayText_.capacity() + overlay_.capacity() * sizeof(NodeIndex) +
+            overlayOffsets_.capacity() * sizeof(uint32_t);
+    }
+
+    /// 追加区中的节点数
+    size_t overlaySize() const noexcept {
+        return overlay_.size();
+    }
+
+    size_t trigramCount() const noexcept {
+        return keys_.size();
+    }
+
+    void save(checkpoint_detail::Writer& writer) const {
+        writer.string(text_);
+        writer.pods(textOffsets_);
+        writer.pods(keys_);
+        writer.pods(offsets_);
+        writer.pods(postings_);
+        writer.pods(byName_);
+        writer.pods(stale_);
+        writer.pods(overlay_);
+        writer.string(overlayText_);
+        writer.pods(overlayOffsets_);
+    }
+
+    void load(checkpoint_detail::Reader& reader) {
+        text_ = reader.string();
+        textOffsets_ = reader.pods<uint32_t>();
+        keys_ = reader.pods<uint32_t>();
+        offsets_ = reader.pods<uint32_t>();
+        postings_ = reader.pods<NodeIndex>();
+        byName_ = reader.pods<NodeIndex>();
+        stale_ = reader.pods<uint8_t>();
+        overlay_ = reader.pods<NodeIndex>();
+        overlayText_ = reader.string();
+        overlayOffsets_ = reader.pods<uint32_t>();
+    }
+
+private:
+    static char lower(char c) noexcept {
+        return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+
+    static void appendLower(const std::string& s, std::string& out) {
+        for (const char c : s) {
+            out += lower(c);
+        }
+    }
+
+    static void appendText(const AddressSpaceSnapshot& snapshot, NodeIndex node, std::string& out) {
+        appendLower(snapshot.browseName(node), out);
+        out += '\n';
+        appendLower(snapshot.displayName(node), out);
+        out += '\n';
+        appendLower(snapshot.browsePath(node), out);
+    }
+
+    std::string_view text(NodeIndex node) const noexcept {
+        return std::string_view{text_}.substr(textOffsets_[node], textOffsets_[node + 1] - textOffsets_[node]);
+    }
+
+    // 检索文本的第一段：小写的 BrowseName
+    std::string_view nameOf(NodeIndex node) const noexcept {
+        const auto t = text(node);
+        return t.substr(0, t.find('\n'));
+    }
+
+    // s 中不重复的 trigram，按值排序
+    static void trigrams(std::string_view s, std::vector<uint32_t>& grams) {
+        grams.clear();
+        for (size_t i = 0; i + 3 <= s.size(); ++i) {
+            grams.push_back(
+                static_cast<uint32_t>(static_cast<uint8_t>(s[i])) << 16 |
+                static_cast<uint32_t>(static_cast<uint8_t>(s[i + 1])) << 8 | static_cast<uint8_t>(s[i + 2])
+            );
+        }
+        std::sort(grams.begin(), grams.end());
+        grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+    }
+
+    template <typename Accept>
+    void searchPrefix(std::string_view prefix, size_t limit, const Accept& accept, SearchResult& result) const {
+        auto it = std::lower_bound(byName_.begin(), byName_.end(), prefix, [this](NodeIndex node, std::string_view p) {
+            return nameOf(node) < p;
+        });
+        for (; it != byName_.end() && result.nodes.size() < limit; ++it) {
+            if (nameOf(*it).substr(0, prefix.size()) != prefix) {
+                break;
+            }
+            if (stale_[*it] != 0) {
+                continue;
+            }
+            ++result.candidates;
+            if (accept(*it)) {
+                result.nodes.push_back(*it);
+            }
+        }
+        std::sort(result.nodes.begin(), result.nodes.end());
+    }
+
+    template <typename Accept>
+    void searchSubstring(std::string_view needle, size_t limit, const Accept& accept, SearchResult& result) const {
+        struct List {
+            const NodeIndex* begin;
+            const NodeIndex* end;
+        };
+        std::vector<uint32_t> grams;
+        trigrams(needle, grams);
+        std::vector<List> lists;
+        for (const uint32_t gram : grams) {
+            const auto it = std::lower_bound(keys_.begin(), keys_.end(), gram);
+            if (it == keys_.end() || *it != gram) {
+                return;  // 有 trigram 不在任何节点中
+            }
+            const size_t slot = static_cast<size_t>(it - keys_.begin());
+            lists.push_back({postings_.data() + offsets_[slot], postings_.data() + offsets_[slot + 1]});
+        }
+        std::sort(lists.begin(), lists.end(), [](const List& a, const List& b) {
+            return a.end - a.begin < b.end - b.begin;
+        });
+
+        // 遍历最短的列表，在其余列表中向前查找（列表都是递增的，查找位置只前进不后退）
+        for (const NodeIndex* p = lists[0].begin; p != lists[0].end && result.nodes.size() < limit; ++p) {
+            const NodeIndex node = *p;
+            bool all = true;
+            for (size_t k = 1; k < lists.size() && all; ++k) {
+                lists[k].begin = std::lower_bound(lists[k].begin, lists[k].end, node);
+                all = lists[k].begin != lists[k].end && *lists[k].begin == node;
+            }
+            if (!all || stale_[node] != 0) {
+                continue;
+            }
+            ++result.candidates;
+            if (text(node).find(needle) != std::string_view::npos && accept(node)) {
+                result.nodes.push_back(node);
+            }
+        }
+    }
+
+    // 追加区：逐个核对，结果与主索引的结果合并后按 NodeIndex 排序
+    template <typename Accept>
+    void searchOverlay(
+        std::string_view needle, bool prefix, size_t limit, const Accept& accept, SearchResult& result
+    ) const {
+        for (size_t i = 0; i < overlay_.size(); ++i) {
+            const std::string_view t = std::string_view{overlayText_}.substr(
+                overlayOffsets_[i], overlayOffsets_[i + 1] - overlayOffsets_[i]
+            );
+            const bool match = prefix ? t.substr(0, t.find('\n')).substr(0, needle.size()) == needle
+                                      : t.find(needle) != std::string_view::npos;
+            ++result.candidates;
+            if (match && accept(overlay_[i])) {
+                result.nodes.push_back(overlay_[i]);
+            }
+        }
+        std::sort(result.nodes.begin(), result.nodes.end());
+        if (result.nodes.size() > limit) {
+            result.nodes.resize(limit);
+        }
+    }
+
+    std::string text_;                  // 所有节点的检索文本首尾相连
+    std::vector<uint32_t> textOffsets_;  // 节点 i 的文本为 [textOffsets_[i], textOffsets_[i + 1])
+    std::vector<uint32_t> keys_;         // trigram，递增
+    std::vector<uint32_t> offsets_;      // keys_[i] 的节点列表为 postings_[offsets_[i], offsets_[i + 1])
+    std::vector<NodeIndex> postings_;
+    std::vector<NodeIndex> byName_;  // 按小写 BrowseName 排序的节点
+    std::vector<uint8_t> stale_;     // 1 表示主索引中的文本已过期
+    std::vector<NodeIndex> overlay_;  // 追加区的节点，递增
+    std::string overlayText_;
+    std::vector<uint32_t> overlayOffsets_;
+};
+
+namespace address_space_detail {
+
+inline constexpr uint32_t magic = 0x50534441;  // "ADSP"
+inline constexpr uint32_t version = 3;
+
+}  // namespace address_space_detail
+
+/**
+ * @brief 保存快照、索引和变量元数据（可选）
+ *
+ * NodeId 以字符串形式保存；索引和元数据按列直接写出，加载时不需要重建。
+ */
+inline bool saveAddressSpace(
+    const std::string& path,
+    const AddressSpaceSnapshot& snapshot,
+    const AddressSpaceIndex& index,
+    const VariableMetadataCache* metadata = nullptr
+) {
+    const std::string tmpPath = path + ".tmp";
+    std::FILE* file = std::fopen(tmpPath.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    checkpoint_detail::Writer writer{file};
+    writer.pod(address_space_detail::magic);
+    writer.pod(address_space_detail::version);
+    writer.pod(static_cast<uint32_t>(snapshot.size()));
+    for (const auto& id : snapshot.nodeIds()) {
+        writer.string(opcua::toString(id));
+    }
+    writer.pods(snapshot.parents());
+    for (const auto& name : snapshot.browseNames()) {
+        writer.string(name);
+    }
+    for (const auto& name : snapshot.displayNames()) {
+        writer.string(name);
+    }
+    writer.pods(snapshot.nodeClasses());
+    writer.pods(snapshot.dataTypes());
+    writer.pod(static_cast<uint32_t>(snapshot.dataTypeIds().size()));
+    for (const auto& id : snapshot.dataTypeIds()) {
+        writer.string(opcua::toString(id));
+    }
+    index.save(writer);
+    writer.pod(static_cast<uint8_t>(metadata != nullptr ? 1 : 0));
+    if (metadata != nullptr) {
+        metadata->save(writer);
+    }
+    const bool ok = writer.ok() && std::fflush(file) == 0;
+    std::fclose(file);
+    if (!ok) {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    return std::rename(tmpPath.c_str(), path.c_str()) == 0;
+}
+
+/// 读取快照和索引；文件不存在或格式不符时返回 false。文件中没有元数据时 metadata 被清空
+inline bool loadAddressSpace(
+    const std::string& path,
+    AddressSpaceSnapshot& snapshot,
+    AddressSpaceIndex& index,
+    VariableMetadataCache* metadata = nullptr
+) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    checkpoint_detail::Reader reader{file};
+    if (reader.pod<uint32_t>() != address_space_detail::magic ||
+        reader.pod<uint32_t>() != address_space_detail::version) {
+        std::fclose(file);
+        return false;
+    }
+    const uint32_t n = reader.pod<uint32_t>();
+    std::vector<opcua::NodeId> nodeIds;
+    nodeIds.reserve(n);
+    for (uint32_t i = 0; i < n && reader.ok(); ++i) {
+        nodeIds.push_back(parseNodeId(reader.string()));
+    }
+    auto parents = reader.pods<NodeIndex>();
+    std::vector<std::string> browseNames(n);
+    for (auto& name : browseNames) {
+        name = reader.string();
+    }
+    std::vector<std::string> displayNames(n);
+    for (auto& name : displayNames) {
+        name = reader.string();
+    }
+    auto nodeClasses = reader.pods<uint32_t>();
+    auto dataTypes = reader.pods<uint32_t>();
+    std::vector<opcua::NodeId> dataTypeIds(reader.pod<uint32_t>());
+    for (auto& id : dataTypeIds) {
+        id = parseNodeId(reader.string());
+    }
+    AddressSpaceIndex loaded;
+    loaded.load(reader);
+    VariableMetadataCache loadedMetadata;
+    const bool hasMetadata = reader.pod<uint8_t>() != 0;
+    if (hasMetadata && metadata != nullptr && !loadedMetadata.load(reader)) {
+        std::fclose(file);
+        return false;
+    }
+    std::fclose(file);
+    if (!reader.ok() || nodeIds.size() != n || parents.size() != n || nodeClasses.size() != n ||
+        dataTypes.size() != n || (hasMetadata && metadata != nullptr && loadedMetadata.size() > n)) {
+        return false;
+    }
+    snapshot.assign(
+        std::move(nodeIds),
+        std::move(parents),
+        std::move(browseNames),
+        std::move(displayNames),
+        std::move(nodeClasses),
+        std::move(dataTypes),
+        std::move(dataTypeIds)
+    );
+    index = std::move(loaded);
+    if (metadata != nullptr) {
+        *metadata = std::move(loadedMetadata);
+    }
+    return true;
+}
@@ -0,0 +1,269 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <open62541pp/types.hpp>
+
+#include "collector_types.hpp"
+
+// 地址空间快照
+// - 浏览得到的节点按 NodeIndex 编号，各属性按列保存（结构数组），便于批量扫描和持久化
+// - 每个节点只记录一个父节点（广度优先浏览时第一次遇到它的路径），浏览路径由父节点链拼出
+// - DataType 使用去重后的小表，节点只保存表中的下标
+// - 删除的节点保留编号，NodeClass 置为 Unspecified，NodeId 不再能查到
+
+using NodeIndex = uint32_t;
+
+inline constexpr NodeIndex invalidNodeIndex = UINT32_MAX;
+
+class AddressSpaceSnapshot {
+public:
+    /// 添加节点；NodeId 已存在时返回已有的编号
+    NodeIndex add(
+        const opcua::NodeId& id,
+        NodeIndex parent,
+        std::string browseName,
+        std::string displayName,
+        opcua::NodeClass nodeClass
+    ) {
+        const auto [it, inserted] = index_.emplace(id, static_cast<NodeIndex>(nodeIds_.size()));
+        if (!inserted) {
+            return it->second;
+        }
+        nodeIds_.push_back(id);
+        parents_.push_back(parent);
+        browseNames_.push_back(std::move(browseName));
+        displayNames_.push_back(std::move(displayName));
+        nodeClasses_.push_back(static_cast<uint32_t>(nodeClass));
+        dataTypes_.push_back(noDataType);
+        return it->second;
+    }
+
+    void setDataType(NodeIndex node, const opcua::NodeId& dataType) {
+        dataTypes_.at(node) = dataTypeIndex(dataType);
+    }
+
+    /**
+     * @brief 更新已有节点的父节点、名称和 NodeClass；有变化时返回 true
+     *
+     * 新的父节点是 node 本身或其后代时（服务器上的引用成环）保留原来的父节点，
+     * 否则父节点链成环，contains() 和浏览路径拼接不会结束。
+     */
+    bool update(
+        NodeIndex node,
+        NodeIndex parent,
+        const std::string& browseName,
+        const std::string& displayName,
+        opcua::NodeClass nodeClass
+    ) {
+        const auto cls = static_cast<uint32_t>(nodeClass);
+        if (parent != invalidNodeIndex && contains(node, parent)) {
+            parent = parents_[node];
+        }
+        if (parents_[node] == parent && browseNames_[node] == browseName &&
+            displayNames_[node] == displayName && nodeClasses_[node] == cls) {
+            return false;
+        }
+        parents_[node] = parent;
+        browseNames_[node] = browseName;
+        displayNames_[node] = displayName;
+        nodeClasses_[node] = cls;
+        return true;
+    }
+
+    /// 删除节点（不处理子节点）
+    void remove(NodeIndex node) {
+        index_.erase(nodeIds_[node]);
+        nodeClasses_[node] = static_cast<uint32_t>(opcua::NodeClass::Unspecified);
+        dataTypes_[node] = noDataType;
+    }
+
+    bool removed(NodeIndex node) const {
+        return nodeClasses_[node] == static_cast<uint32_t>(opcua::NodeClass::Unspecified);
+    }
+
+    /// node 的所有后代（不含 node 本身），父节点排在子节点之前
+    std::vector<NodeIndex> subtree(NodeIndex node) const {
+        // 按父节点分组的子节点表（CSR 布局）
+        std::vector<uint32_t> offsets(nodeIds_.size() + 1, 0);
+        for (NodeIndex i = 0; i < nodeIds_.size(); ++i) {
+            if (parents_[i] != invalidNodeIndex && !removed(i)) {
+                ++offsets[parents_[i] + 1];
+            }
+        }
+        for (size_t i = 0; i < nodeIds_.size(); ++i) {
+            offsets[i + 1] += offsets[i];
+        }
+        std::vector<NodeIndex> children(offsets.back());
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (NodeIndex i = 0; i < nodeIds_.size(); ++i) {
+            if (parents_[i] != invalidNodeIndex && !removed(i)) {
+                children[fill[parents_[i]]++] = i;
+            }
+        }
+        std::vector<NodeIndex> result;
+        std::vector<NodeIndex> stack{node};
+        while (!stack.empty()) {
+            const NodeIndex current = stack.back();
+            stack.pop_back();
+            for (uint32_t k = offsets[current]; k < offsets[current + 1]; ++k) {
+                result.push_back(children[k]);
+                stack.push_back(children[k]);
+            }
+        }
+        return result;
+    }
+
+    /// ancestor 是否为 node 本身或其祖先
+    bool contains(NodeIndex ancestor, NodeIndex node) const {
+        for (NodeIndex i = node; i != invalidNodeIndex; i = parents_[i]) {
+            if (i == ancestor) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    size_t size() const noexcept {
+        return nodeIds_.size();
+    }
+
+    NodeIndex find(const opcua::NodeId& id) const {
+        const auto it = index_.find(id);
+        return it == index_.end() ? invalidNodeIndex : it->second;
+    }
+
+    const opcua::NodeId& nodeId(NodeIndex node) const {
+        return nodeIds_[node];
+    }
+
+    NodeIndex parent(NodeIndex node) const {
+        return parents_[node];
+    }
+
+    const std::string& browseName(NodeIndex node) const {
+        return browseNames_[node];
+    }
+
+    const std::string& displayName(NodeIndex node) const {
+        return displayNames_[node];
+    }
+
+    opcua::NodeClass nodeClass(NodeIndex node) const {
+        return static_cast<opcua::NodeClass>(nodeClasses_[node]);
+    }
+
+    /// DataType 在小表中的下标；没有 DataType 的节点返回 noDataType
+    uint32_t dataTypeOf(NodeIndex node) const {
+        return dataTypes_[node];
+    }
+
+    const opcua::NodeId& dataType(uint32_t index) const {
+        return dataTypeIds_.at(index);
+    }
+
+    /// 查找 DataType 在小表中的下标，不存在时返回 noDataType
+    uint32_t findDataType(const opcua::NodeId& dataType) const {
+        for (uint32_t i = 0; i < dataTypeIds_.size(); ++i) {
+            if (dataTypeIds_[i] == dataType) {
+                return i;
+            }
+        }
+        return noDataType;
+    }
+
+    /// 从根节点开始的浏览路径，例如 "Objects/Channel1/Device1/Temperature1"
+    std::string browsePath(NodeIndex node) const {
+        std::vector<NodeIndex> chain;
+        for (NodeIndex i = node; i != invalidNodeIndex; i = parents_[i]) {
+            chain.push_back(i);
+        }
+        std::string path;
+        for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+            if (!path.empty()) {
+                path += '/';
+            }
+            path += browseNames_[*it];
+        }
+        return path;
+    }
+
+    static constexpr uint32_t noDataType = UINT32_MAX;
+
+    // 持久化使用的列访问
+    const std::vector<opcua::NodeId>& nodeIds() const noexcept {
+        return nodeIds_;
+    }
+
+    const std::vector<NodeIndex>& parents() const noexcept {
+        return parents_;
+    }
+
+    const std::vector<std::string>& browseNames() const noexcept {
+        return browseNames_;
+    }
+
+    const std::vector<std::string>& displayNames() const noexcept {
+        return displayNames_;
+    }
+
+    const std::vector<uint32_t>& nodeClasses() const noexcept {
+        return nodeClasses_;
+    }
+
+    const std::vector<uint32_t>& dataTypes() const noexcept {
+        return dataTypes_;
+    }
+
+    const std::vector<opcua::NodeId>& dataTypeIds() const noexcept {
+        return dataTypeIds_;
+    }
+
+    /// 从持久化的列恢复
+    void assign(
+        std::vector<opcua::NodeId> nodeIds,
+        std::vector<NodeIndex> parents,
+        std::vector<std::string> browseNames,
+        std::vector<std::string> displayNames,
+        std::vector<uint32_t> nodeClasses,
+        std::vector<uint32_t> dataTypes,
+        std::vector<opcua::NodeId> dataTypeIds
+    ) {
+        nodeIds_ = std::move(nodeIds);
+        parents_ = std::move(parents);
+        browseNames_ = std::move(browseNames);
+        displayNames_ = std::move(displayNames);
+        nodeClasses_ = std::move(nodeClasses);
+        dataTypes_ = std::move(dataTypes);
+        dataTypeIds_ = std::move(dataTypeIds);
+        index_.clear();
+        index_.reserve(nodeIds_.size());
+        for (NodeIndex i = 0; i < nodeIds_.size(); ++i) {
+            if (!removed(i)) {
+                index_.emplace(nodeIds_[i], i);
+            }
+        }
+    }
+
+private:
+    uint32_t dataTypeIndex(const opcua::NodeId& dataType) {
+        const uint32_t index = findDataType(dataType);
+        if (index != noDataType) {
+            return index;
+        }
+        dataTypeIds_.push_back(dataType);
+        return static_cast<uint32_t>(dataTypeIds_.size() - 1);
+    }
+
+    std::vector<opcua::NodeId> nodeIds_;
+    std::vector<NodeIndex> parents_;
+    std::vector<std::string> browseNames_;
+    std::vector<std::string> displayNames_;
+    std::vector<uint32_t> nodeClasses_;  // UA_NodeClass，各值是互不重叠的位，可直接与掩码比较
+    std::vector<uint32_t> dataTypes_;    // dataTypeIds_ 的下标
+    std::vector<opcua::NodeId> dataTypeIds_;
+    std::unordered_map<opcua::NodeId, NodeIndex> index_;
+};
@@ -0,0 +1,394 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <open62541/client.h>
+
+#include <open62541pp/client.hpp>
+#include <open62541pp/subscription.hpp>
+
+#include "address_crawler.hpp"
+#include "address_index.hpp"
+#include "collector_types.hpp"
+#include "subscription_engine.hpp"
+
+// ModelChangeStructureDataType.verb 的各位
+namespace model_change {
+
+inline constexpr uint8_t nodeAdded = 1;
+inline constexpr uint8_t nodeDeleted = 2;
+inline constexpr uint8_t referenceAdded = 4;
+inline constexpr uint8_t referenceDeleted = 8;
+inline constexpr uint8_t dataTypeChanged = 16;
+
+}  // namespace model_change
+
+struct AddressSpaceSyncOptions {
+    std::chrono::milliseconds debounce{1000};  // 最后一个事件之后等待的时间，合并一次配置修改产生的多个事件
+    CrawlOptions crawl;
+};
+
+struct AddressSpaceSyncStats {
+    size_t events = 0;
+    size_t changes = 0;        // 事件中的变化条目数
+    size_t resyncs = 0;        // 重新浏览的子树数
+    size_t fullResyncs = 0;    // 无法确定范围、从根节点重新浏览的次数
+    size_t failedResyncs = 0;  // 浏览不完整而放弃、下次重试的子树数
+    size_t nodesAdded = 0;
+    size_t nodesRemoved = 0;
+    size_t nodesUpdated = 0;
+    size_t tagsAdded = 0;
+    size_t tagsRemoved = 0;
+};
+
+/**
+ * @brief 根据模型变化事件增量同步地址空间
+ *
+ * - 在 Server 对象上订阅 GeneralModelChangeEvent 和 SemanticChangeEvent
+ * - 变化条目按 debounce 合并后换算成需要重新浏览的子树：已知节点重新浏览其父节点
+ *   （变量）或自身（对象），未知的新节点通过反向浏览找到已知的父节点
+ * - 子树重新浏览的结果与快照比较：新增、修改、删除的节点修补到快照、索引、TagTable，
+ *   新增和删除的 tag 通过 SubscriptionEngine 创建或删除监控项
+ *
+ * 事件订阅由 opcua::Subscription 管理，它的 Publish 请求会取走同一会话中所有订阅的通知，
+ * 因此 client 应当是与 SubscriptionEngine 不同的会话。所有方法和 client.runIterate()
+ * 在同一线程中调用。
+ */
+class AddressSpaceSync {
+public:
+    /// 决定节点是否作为 tag 采集，默认所有变量
+    using TagFilter = std::function<bool(const AddressSpaceSnapshot&, NodeIndex)>;
+
+    AddressSpaceSync(
+        opcua::Client& client,
+        AddressSpaceSnapshot& snapshot,
+        AddressSpaceIndex& index,
+        TagTable& tags,
+        SubscriptionEngine& engine,
+        AddressSpaceSyncOptions options = {},
+        TagFilter isTag = nullptr
+    )
+        : client_{client},
+          snapshot_{snapshot},
+          index_{index},
+          tags_{tags},
+          engine_{engine},
+          options_{options},
+          crawler_{client, options.crawl},
+          isTag_{std::move(isTag)} {
+        if (!isTag_) {
+            isTag_ = [](const AddressSpaceSnapshot& s, NodeIndex node) {
+                return s.nodeClass(node) == opcua::NodeClass::Variable;
+            };
+        }
+    }
+
+    /// 在 Server 对象上订阅模型变化事件
+    void subscribe() {
+        const opcua::ContentFilterElement ofModelChange{
+            opcua::FilterOperator::OfType,
+            {opcua::LiteralOperand{opcua::NodeId{opcua::ObjectTypeId::BaseModelChangeEventType}}}
+        };
+        const opcua::ContentFilterElement ofSemanticChange{
+            opcua::FilterOperator::OfType,
+            {opcua::LiteralOperand{opcua::NodeId{opcua::ObjectTypeId::SemanticChangeEventType}}}
+        };
+        const opcua::EventFilter filter{
+            {
+                {opcua::ObjectTypeId::BaseEventType, {{0, "SourceNode"}}, opcua::AttributeId::Value},
+                {opcua::ObjectTypeId::GeneralModelChangeEventType, {{0, "Changes"}}, opcua::AttributeId::Value},
+                {opcua::ObjectTypeId::SemanticChangeEventType, {{0, "Changes"}}, opcua::AttributeId::Value},
+            },
+            ofModelChange || ofSemanticChange
+        };
+        subscription_.emplace(client_);
+        subscription_->subscribeEvent(
+            opcua::ObjectId::Server,
+            filter,
+            [this](opcua::IntegerId, opcua::IntegerId, opcua::Span<const opcua::Variant> fields) {
+                onEvent(fields);
+            }
+        );
+    }
+
+    /// 登记一个变化条目（也可以由事件以外的来源调用）
+    void notify(const opcua::NodeId& affected, uint8_t verb) {
+        pending_[affected] |= verb;
+        ++stats_.changes;
+        lastEvent_ = std::chrono::steady_clock::now();
+    }
+
+    /// 无法确定变化范围，下次处理时从根节点重新浏览
+    void notifyAll() {
+        fullResync_ = true;
+        lastEvent_ = std::chrono::steady_clock::now();
+    }
+
+    /**
+     * @brief 在主循环中调用
+     *
+     * 最后一个事件之后 debounce 时间内没有新事件时处理积压的变化。
+     * @return 是否修补了快照
+     */
+    bool poll() {
+        if ((pending_.empty() && !fullResync_) ||
+            std::chrono::steady_clock::now() - lastEvent_ < options_.debounce) {
+            return false;
+        }
+        std::vector<NodeIndex> roots;
+        if (fullResync_) {
+            roots.push_back(0);  // 快照的第 0 个节点是爬取的起点
+            ++stats_.fullResyncs;
+        } else {
+            roots = resolve();
+        }
+        pending_.clear();
+        fullResync_ = false;
+
+        Patch patch;
+        for (const NodeIndex root : roots) {
+            if (resync(root, patch)) {
+                ++stats_.resyncs;
+            } else {
+                ++stats_.failedResyncs;
+                retry(root);
+            }
+        }
+        apply(patch);
+        return !patch.touched.empty();
+    }
+
+    const AddressSpaceSyncStats& stats() const noexcept {
+        return stats_;
+    }
+
+private:
+    struct Patch {
+        std::vector<NodeIndex> touched;  // 新增、修改、删除的节点（索引需要更新的节点）
+        std::vector<NodeIndex> added;    // 新增或恢复的节点
+        std::vector<NodeIndex> removed;
+    };
+
+    void onEvent(opcua::Span<const opcua::Variant> fields) {
+        ++stats_.events;
+        bool hasChanges = false;
+        for (size_t i = 1; i < fields.size(); ++i) {
+            const UA_Variant* v = fields[i].handle();
+            if (v->type == &UA_TYPES[UA_TYPES_MODELCHANGESTRUCTUREDATATYPE]) {
+                const auto* changes = static_cast<const UA_ModelChangeStructureDataType*>(v->data);
+                for (size_t k = 0; k < v->arrayLength; ++k) {
+                    notify(opcua::NodeId{changes[k].affected}, changes[k].verb);
+                    hasChanges = true;
+                }
+            } else if (v->type == &UA_TYPES[UA_TYPES_SEMANTICCHANGESTRUCTUREDATATYPE]) {
+                const auto* changes = static_cast<const UA_SemanticChangeStructureDataType*>(v->data);
+                for (size_t k = 0; k < v->arrayLength; ++k) {
+                    notify(opcua::NodeId{changes[k].affected}, 0);  // 属性（如 EURange）变化
+                    hasChanges = true;
+                }
+            }
+        }
+        if (hasChanges) {
+            return;
+        }
+        // BaseModelChangeEvent 不带变化条目，只能根据 SourceNode 确定范围
+        const UA_Variant* source = fields.empty() ? nullptr : fields[0].handle();
+        if (source != nullptr && UA_Variant_hasScalarType(source, &UA_TYPES[UA_TYPES_NODEID])) {
+            const opcua::NodeId node{*static_cast<const UA_NodeId*>(source->data)};
+            if (node != opcua::NodeId{opcua::ObjectId::Server} && snapshot_.find(node) != invalidNodeIndex) {
+                notify(node, model_change::referenceAdded | model_change::referenceDeleted);
+                return;
+            }
+        }
+        notifyAll();
+    }
+
+    // 把变化条目换算成需要重新浏览的子树，去掉被其他子树包含的
+    std::vector<NodeIndex> resolve() {
+        std::vector<NodeIndex> candidates;
+        for (const auto& [id, verb] : pending_) {
+            NodeIndex node = snapshot_.find(id);
+            if (node == invalidNodeIndex) {
+                node = findKnownParent(id);
+                if (node == invalidNodeIndex) {
+                    continue;  // 不在爬取范围内，或者已经删除
+                }
+            } else if ((verb & model_change::nodeDeleted) != 0 ||
+                       snapshot_.nodeClass(node) != opcua::NodeClass::Object) {
+                // 删除的节点和变量从父节点重新浏览（变量的 DataType 由父节点浏览时读取）
+                if (snapshot_.parent(node) != invalidNodeIndex) {
+                    node = snapshot_.parent(node);
+                }
+            }
+            candidates.push_back(node);
+        }
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+        std::vector<NodeIndex> roots;
+        for (const NodeIndex node : candidates) {
+            const bool covered = std::any_of(candidates.begin(), candidates.end(), [&](NodeIndex other) {
+                return other != node && snapshot_.contains(other, node);
+            });
+            if (!covered) {
+                roots.push_back(node);
+            }
+        }
+        return roots;
+    }
+
+    // 反向浏览层级引用，返回快照中已有的父节点
+    NodeIndex findKnownParent(const opcua::NodeId& id) {
+        UA_BrowseDescription description;
+        UA_BrowseDescription_init(&description);
+        description.nodeId = *id.handle();
+        description.browseDirection = UA_BROWSEDIRECTION_INVERSE;
+        description.referenceTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_HIERARCHICALREFERENCES);
+        description.includeSubtypes = true;
+        UA_BrowseRequest request;
+        UA_BrowseRequest_init(&request);
+        request.nodesToBrowse = &description;
+        request.nodesToBrowseSize = 1;
+        UA_BrowseResponse response = UA_Client_Service_browse(client_.handle(), request);
+        NodeIndex parent = invalidNodeIndex;
+        if (response.resultsSize == 1) {
+            const auto& result = response.results[0];
+            for (size_t j = 0; j < result.referencesSize && parent == invalidNodeIndex; ++j) {
+                parent = snapshot_.find(opcua::NodeId{result.references[j].nodeId.nodeId});
+            }
+        }
+        UA_BrowseResponse_clear(&response);
+        return parent;
+    }
+
+    // 浏览失败的子树在下一个 debounce 周期重新浏览
+    void retry(NodeIndex root) {
+        if (root == 0) {
+            fullResync_ = true;
+        } else {
+            pending_[snapshot_.nodeId(root)] |= model_change::referenceAdded | model_change::referenceDeleted;
+        }
+        lastEvent_ = std::chrono::steady_clock::now();
+    }
+
+    /**
+     * @brief 重新浏览 root 的子树，与快照比较
+     *
+     * 浏览不完整（服务失败、续读点失效等）时不修改快照并返回 false：缺少的子树会被当成已删除。
+     */
+    bool resync(NodeIndex root, Patch& patch) {
+        AddressSpaceSnapshot fresh;
+        if (!crawler_.crawl(snapshot_.nodeId(root), fresh).complete()) {
+            return false;
+        }
+
+        const std::vector<NodeIndex> previous = snapshot_.subtree(root);
+        std::unordered_set<NodeIndex> seen;
+        std::vector<NodeIndex> mapped(fresh.size(), invalidNodeIndex);  // fresh 编号 -> 快照编号
+        mapped[0] = root;
+        bool renamed = false;
+        for (NodeIndex i = 1; i < fresh.size(); ++i) {
+            const NodeIndex parent = mapped[fresh.parent(i)];  // 广度优先，父节点先于子节点
+            NodeIndex node = snapshot_.find(fresh.nodeId(i));
+            const bool isNew = node == invalidNodeIndex;
+            bool updated = false;
+            if (isNew) {
+                node = snapshot_.add(
+                    fresh.nodeId(i), parent, fresh.browseName(i), fresh.displayName(i), fresh.nodeClass(i)
+                );
+                patch.added.push_back(node);
+                ++stats_.nodesAdded;
+            } else {
+                updated = snapshot_.update(
+                    node, parent, fresh.browseName(i), fresh.displayName(i), fresh.nodeClass(i)
+                );
+                renamed = renamed || updated;
+            }
+            const uint32_t dataType = fresh.dataTypeOf(i);
+            if (dataType != AddressSpaceSnapshot::noDataType) {
+                const uint32_t before = snapshot_.dataTypeOf(node);
+                snapshot_.setDataType(node, fresh.dataType(dataType));
+                updated = updated || (!isNew && before != snapshot_.dataTypeOf(node));
+            }
+            if (updated) {
+                ++stats_.nodesUpdated;
+            }
+            if (isNew || updated) {
+                patch.touched.push_back(node);
+            }
+            mapped[i] = node;
+            seen.insert(node);
+        }
+        for (const NodeIndex node : previous) {
+            if (seen.count(node) == 0) {
+                snapshot_.remove(node);
+                patch.removed.push_back(node);
+                patch.touched.push_back(node);
+                ++stats_.nodesRemoved;
+            }
+        }
+        if (renamed) {
+            // 改名或移动的节点的后代浏览路径也变了
+            for (const NodeIndex node : previous) {
+                if (seen.count(node) > 0) {
+                    patch.touched.push_back(node);
+                }
+            }
+        }
+        return true;
+    }
+
+    void apply(Patch& patch) {
+        std::sort(patch.touched.begin(), patch.touched.end());
+        patch.touched.erase(std::unique(patch.touched.begin(), patch.touched.end()), patch.touched.end());
+        if (patch.touched.empty()) {
+            return;
+        }
+        index_.update(snapshot_, patch.touched);
+
+        std::vector<TagHandle> removedTags;
+        for (const NodeIndex node : patch.removed) {
+            if (const auto tag = tags_.remove(snapshot_.nodeId(node))) {
+                removedTags.push_back(*tag);
+            }
+        }
+        std::vector<TagHandle> addedTags;
+        for (const NodeIndex node : patch.added) {
+            if (isTag_(snapshot_, node)) {
+                const size_t before = tags_.size();
+                const TagHandle tag = tags_.add(snapshot_.nodeId(node));
+                if (tags_.size() > before) {
+                    addedTags.push_back(tag);
+                }
+            }
+        }
+        if (!removedTags.empty()) {
+            engine_.removeTags(removedTags);
+            stats_.tagsRemoved += removedTags.size();
+        }
+        if (!addedTags.empty()) {
+            engine_.addTags(addedTags);
+            stats_.tagsAdded += addedTags.size();
+        }
+    }
+
+    opcua::Client& client_;
+    AddressSpaceSnapshot& snapshot_;
+    AddressSpaceIndex& index_;
+    TagTable& tags_;
+    SubscriptionEngine& engine_;
+    AddressSpaceSyncOptions options_;
+    AddressSpaceCrawler crawler_;
+    TagFilter isTag_;
+
+    std::optional<opcua::Subscription<opcua::Client>> subscription_;
+    std::unordered_map<opcua::NodeId, uint8_t> pending_;  // 受影响的节点 -> verb 的并集
+    bool fullResync_ = false;
+    std::chrono::steady_clock::time_point lastEvent_;
+    AddressSpaceSyncStats stats_;
+};
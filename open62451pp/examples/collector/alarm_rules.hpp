@@ -0,0 +1,251 @@
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include <open62541/types.h>
+
+#include "collector_types.hpp"
+#include "simd_kernels.hpp"
+
+enum class AlarmLevel : int8_t {
+    LoLo = -2,
+    Lo = -1,
+    Normal = 0,
+    Hi = 1,
+    HiHi = 2,
+};
+
+// 一个 tag 的报警规则；限值为 NaN 时不检查
+struct AlarmRule {
+    double hihi = std::numeric_limits<double>::quiet_NaN();
+    double hi = std::numeric_limits<double>::quiet_NaN();
+    double lo = std::numeric_limits<double>::quiet_NaN();
+    double lolo = std::numeric_limits<double>::quiet_NaN();
+    double deadband = 0.0;  // 回差：上限报警在值低于 限值 - deadband 时才恢复，下限报警相反
+    double rateLimit = std::numeric_limits<double>::quiet_NaN();  // 变化率限值（每秒，绝对值）
+    double rateDeadband = 0.0;
+};
+
+// 报警状态的变化；level 或 rate 至少有一个与之前不同
+struct AlarmTransition {
+    TagHandle tag;
+    int64_t time;
+    double value;
+    AlarmLevel previous;
+    AlarmLevel level;
+    bool previousRate;
+    bool rate;  // 变化率报警
+};
+
+// 报警事件写入目标
+class AlarmSink {
+public:
+    virtual ~AlarmSink() = default;
+
+    /// 一批采样产生的全部状态变化，同一 tag 的变化按时间顺序排列
+    virtual void writeAlarms(opcua::Span<const AlarmTransition> transitions) = 0;
+};
+
+struct AlarmEngineStats {
+    uint64_t samples = 0;
+    uint64_t evaluated = 0;  // 有规则的采样
+    uint64_t skipped = 0;    // Bad 状态或非有限值的采样
+    uint64_t transitions = 0;
+    double seconds = 0.0;
+};
+
+/**
+ * @brief 客户端报警规则：HIHI/HI/LO/LOLO 限值和变化率报警
+ *
+ * 规则和状态按 TagHandle 平铺存放。每个 tag 的四个限值的进入值和恢复值（已计入回差）占一个 64 字节的缓存行，
+ * 状态（报警位掩码、上一个值和时间、变化率限值）放在另一个数组。作为 HistorySink 接在采集链路上，每个采样：
+ * 1. simd::limitMask() 同时比较四个限值（AVX2 下进入值、恢复值各做 >= 和 <= 两次 256 位比较，共四次），
+ *    movemask 后合成新的位掩码
+ * 2. 标量计算变化率并比较
+ * 3. 位掩码变化时记录一条 AlarmTransition；一批结束后写入所有 AlarmSink
+ *
+ * 开销与一批中的采样数成正比，与规则总数无关：一个采样只访问自己 tag 的规则和状态，
+ * 并提前预取批内后面采样的 tag。同一批中同一 tag 的采样按顺序计算，每个采样看到前一个之后的状态。
+ * 所有方法在同一线程中调用。
+ */
+class AlarmEngine : public HistorySink {
+public:
+    void addSink(AlarmSink& sink) {
+        sinks_.push_back(&sink);
+    }
+
+    /// 设置 tag 的规则；限值需满足 lolo <= lo <= hi <= hihi（未设置的除外），且上限与下限之差大于 deadband，
+    /// 否则抛出 std::invalid_argument
+    void setRule(TagHandle tag, const AlarmRule& rule) {
+        const double ordered[] = {rule.lolo, rule.lo, rule.hi, rule.hihi};
+        double last = -std::numeric_limits<double>::infinity();
+        for (const double limit : ordered) {
+            if (!std::isnan(limit)) {
+                if (limit < last) {
+                    throw std::invalid_argument{"AlarmEngine: limits must satisfy lolo <= lo <= hi <= hihi"};
+                }
+                last = limit;
+            }
+        }
+        if (rule.deadband < 0.0 || rule.rateDeadband < 0.0) {
+            throw std::invalid_argument{"AlarmEngine: deadband must not be negative"};
+        }
+        // 上限报警在 限值 - deadband 以上保持，下限报警在 限值 + deadband 以下保持；
+        // 差不大于 deadband 时同一个值可以同时处于上限和下限报警，levelOf() 会在下限以下报告 Hi
+        const double high = std::isnan(rule.hi) ? rule.hihi : rule.hi;
+        const double low = std::isnan(rule.lo) ? rule.lolo : rule.lo;
+        if (!std::isnan(high) && !std::isnan(low) && high - low <= rule.deadband) {
+            throw std::invalid_argument{"AlarmEngine: deadband must be less than the gap between high and low limits"};
+        }
+        if (tag >= states_.size()) {
+            limits_.resize(static_cast<size_t>(tag) + 1);
+            states_.resize(static_cast<size_t>(tag) + 1);
+        }
+        Limits& limits = limits_[tag];
+        limits.enter[HiHi] = rule.hihi;
+        limits.leave[HiHi] = rule.hihi - rule.deadband;
+        limits.enter[Hi] = rule.hi;
+        limits.leave[Hi] = rule.hi - rule.deadband;
+        limits.enter[Lo] = rule.lo;
+        limits.leave[Lo] = rule.lo + rule.deadband;
+        limits.enter[LoLo] = rule.lolo;
+        limits.leave[LoLo] = rule.lolo + rule.deadband;
+        State& state = states_[tag];
+        state.rateEnter = rule.rateLimit;
+        state.rateLeave = rule.rateLimit - rule.rateDeadband;
+        state.hasRule = true;
+    }
+
+    /// 删除规则；当前处于报警状态时不产生恢复事件
+    void clearRule(TagHandle tag) {
+        if (tag < states_.size()) {
+            states_[tag] = State{};
+        }
+    }
+
+    void write(opcua::Span<const Sample> samples) override {
+        const auto t0 = std::chrono::steady_clock::now();
+        const Sample* data = samples.data();
+        const size_t n = samples.size();
+        for (size_t i = 0; i < n; ++i) {
+            if (i + prefetchDistance < n) {
+                // 访问是随机的，提前取入后面的 tag 的两个缓存行
+                const TagHandle next = data[i + prefetchDistance].tag;
+                if (next < states_.size()) {
+                    __builtin_prefetch(&states_[next]);
+                    __builtin_prefetch(&limits_[next]);
+                }
+            }
+            evaluate(data[i]);
+        }
+        stats_.samples += n;
+        if (!transitions_.empty()) {
+            stats_.transitions += transitions_.size();
+            for (auto* sink : sinks_) {
+                sink->writeAlarms(transitions_);
+            }
+            transitions_.clear();
+        }
+        stats_.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    }
+
+    AlarmLevel level(TagHandle tag) const noexcept {
+        return tag < states_.size() ? levelOf(states_[tag].active) : AlarmLevel::Normal;
+    }
+
+    bool rateActive(TagHandle tag) const noexcept {
+        return tag < states_.size() && (states_[tag].active & rateBit) != 0;
+    }
+
+    const AlarmEngineStats& stats() const noexcept {
+        return stats_;
+    }
+
+private:
+    // 位掩码中的位置，与 simd::limitMask() 的约定一致：前两个为上限，后两个为下限
+    enum Check : unsigned { HiHi, Hi, Lo, LoLo };
+    static constexpr unsigned rateBit = 1U << 4;
+    static constexpr size_t prefetchDistance = 16;
+    static constexpr double disabled = std::numeric_limits<double>::quiet_NaN();
+
+    struct alignas(64) Limits {
+        double enter[4] = {disabled, disabled, disabled, disabled};  // 进入报警的限值
+        double leave[4] = {disabled, disabled, disabled, disabled};  // 保持报警的限值（计入回差）
+    };
+
+    struct State {
+        double lastValue = 0.0;
+        int64_t lastTime = 0;
+        double rateEnter = disabled;
+        double rateLeave = disabled;
+        uint8_t active = 0;  // Check 各位和 rateBit
+        bool hasRule = false;
+    };
+
+    void evaluate(const Sample& sample) {
+        if (sample.tag >= states_.size() || !states_[sample.tag].hasRule) {
+            return;
+        }
+        if (UA_StatusCode_isBad(sample.status) || !std::isfinite(sample.value)) {
+            ++stats_.skipped;
+            return;
+        }
+        ++stats_.evaluated;
+        State& state = states_[sample.tag];
+        const Limits& limits = limits_[sample.tag];
+        unsigned active = simd::limitMask(sample.value, limits.enter, limits.leave, state.active);
+
+        const int64_t time = sampleTime(sample);
+        if (state.lastTime != 0 && time > state.lastTime) {
+            // 第一个采样或时间未前进时保持原来的变化率状态
+            const double seconds = static_cast<double>(time - state.lastTime) / UA_DATETIME_SEC;
+            const double rate = std::fabs(sample.value - state.lastValue) / seconds;
+            const bool wasRate = (state.active & rateBit) != 0;
+            active |= rate >= state.rateEnter || (wasRate && rate >= state.rateLeave) ? rateBit : 0U;
+        } else {
+            active |= state.active & rateBit;
+        }
+
+        if (active != state.active) {
+            const AlarmLevel previous = levelOf(state.active);
+            const AlarmLevel level = levelOf(active);
+            const bool previousRate = (state.active & rateBit) != 0;
+            const bool rate = (active & rateBit) != 0;
+            if (level != previous || rate != previousRate) {
+                transitions_.push_back({sample.tag, time, sample.value, previous, level, previousRate, rate});
+            }
+            state.active = static_cast<uint8_t>(active);
+        }
+        state.lastValue = sample.value;
+        state.lastTime = time;
+    }
+
+    static AlarmLevel levelOf(unsigned active) noexcept {
+        if ((active & 1U << HiHi) != 0) {
+            return AlarmLevel::HiHi;
+        }
+        if ((active & 1U << Hi) != 0) {
+            return AlarmLevel::Hi;
+        }
+        if ((active & 1U << LoLo) != 0) {
+            return AlarmLevel::LoLo;
+        }
+        if ((active & 1U << Lo) != 0) {
+            return AlarmLevel::Lo;
+        }
+        return AlarmLevel::Normal;
+    }
+
+    // 按 TagHandle 下标
+    std::vector<Limits> limits_;
+    std::vector<State> states_;
+
+    std::vector<AlarmTransition> transitions_;
+    std::vector<AlarmSink*> sinks_;
+    AlarmEngineStats stats_;
+};
@@ -0,0 +1,243 @@
+/**
+ * @file alarm_rules_benchmark.cpp
+ * @brief 客户端报警规则测试 - 比较平铺数组 + 向量比较与逐条规则判断的速度
+ *
+ * 本程序测试 alarm_rules.hpp 中的 AlarmEngine：
+ * 1. 为 N 个 tag 设置 HIHI/HI/LO/LOLO 和变化率规则（限值按 tag 略有不同）
+ * 2. 生成随机游走的采样，每批随机选择若干 tag（与一次 Publish 响应中的通知相同）
+ * 3. 同一组批次分别交给 AlarmEngine 和逐条判断的参照实现
+ * 4. 输出每批的耗时、每个采样的耗时，并校验两者产生的报警事件完全一致
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../helper.hpp"   // CliParser - 命令行参数解析器
+#include "alarm_rules.hpp"  // AlarmEngine
+
+// 收集报警事件
+class TransitionLog : public AlarmSink {
+public:
+    void writeAlarms(opcua::Span<const AlarmTransition> transitions) override {
+        events.insert(events.end(), transitions.begin(), transitions.end());
+    }
+
+    std::vector<AlarmTransition> events;
+};
+
+// 逐条判断：每个 tag 一个 AlarmRule 和一组布尔状态，语义与 AlarmEngine 相同
+class ReferenceAlarms {
+public:
+    explicit ReferenceAlarms(size_t size)
+        : rules_(size),
+          states_(size) {}
+
+    void setRule(TagHandle tag, const AlarmRule& rule) {
+        rules_[tag] = rule;
+    }
+
+    void write(const std::vector<Sample>& samples, std::vector<AlarmTransition>& events) {
+        for (const auto& sample : samples) {
+            const AlarmRule& rule = rules_[sample.tag];
+            State& state = states_[sample.tag];
+            const double value = sample.value;
+            const AlarmLevel previous = levelOf(state);
+            const bool previousRate = state.rate;
+            state.hihi = value >= rule.hihi || (state.hihi && value >= rule.hihi - rule.deadband);
+            state.hi = value >= rule.hi || (state.hi && value >= rule.hi - rule.deadband);
+            state.lo = value <= rule.lo || (state.lo && value <= rule.lo + rule.deadband);
+            state.lolo = value <= rule.lolo || (state.lolo && value <= rule.lolo + rule.deadband);
+            const int64_t time = sampleTime(sample);
+            if (state.lastTime != 0 && time > state.lastTime) {
+                const double seconds = static_cast<double>(time - state.lastTime) / UA_DATETIME_SEC;
+                const double rate = std::fabs(value - state.lastValue) / seconds;
+                state.rate = rate >= rule.rateLimit || (state.rate && rate >= rule.rateLimit - rule.rateDeadband);
+            }
+            const AlarmLevel level = levelOf(state);
+            if (level != previous || state.rate != previousRate) {
+                events.push_back({sample.tag, time, value, previous, level, previousRate, state.rate});
+            }
+            state.lastValue = value;
+            state.lastTime = time;
+        }
+    }
+
+private:
+    struct State {
+        bool hihi = false;
+        bool hi = false;
+        bool lo = false;
+        bool lolo = false;
+        bool rate = false;
+        double lastValue = 0.0;
+        int64_t lastTime = 0;
+    };
+
+    static AlarmLevel levelOf(const State& state) {
+        if (state.hihi) {
+            return AlarmLevel::HiHi;
+        }
+        if (state.hi) {
+            return AlarmLevel::Hi;
+        }
+        if (state.lolo) {
+            return AlarmLevel::LoLo;
+        }
+        if (state.lo) {
+            return AlarmLevel::Lo;
+        }
+        return AlarmLevel::Normal;
+    }
+
+    std::vector<AlarmRule> rules_;
+    std::vector<State> states_;
+};
+
+static bool same(const AlarmTransition& a, const AlarmTransition& b) {
+    return a.tag == b.tag && a.time == b.time && a.value == b.value && a.previous == b.previous &&
+        a.level == b.level && a.previousRate == b.previousRate && a.rate == b.rate;
+}
+
+static const char* levelName(AlarmLevel level) {
+    switch (level) {
+    case AlarmLevel::LoLo:
+        return "LOLO";
+    case AlarmLevel::Lo:
+        return "LO";
+    case AlarmLevel::Hi:
+        return "HI";
+    case AlarmLevel::HiHi:
+        return "HIHI";
+    default:
+        return "NORMAL";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "=== 客户端报警规则测试 ===" << std::endl;
+
+    const CliParser parser{argc, argv};
+    const size_t tagCount = std::stoul(std::string{parser.value("--tags").value_or("100000")});
+    const size_t batchSize = std::stoul(std::string{parser.value("--batch").value_or("10000")});
+    const size_t batchCount = std::stoul(std::string{parser.value("--batches").value_or("200")});
+    std::cout << "指令集: " << simd::instructionSet() << std::endl;
+
+    // 1. 规则：Hi/HiHi 在 70~90 附近，Lo/LoLo 在 10~30 附近，回差 1；变化率 20/秒，回差 2
+    std::cout << "1. 设置 " << tagCount << " 条规则..." << std::endl;
+    AlarmEngine engine;
+    ReferenceAlarms reference{tagCount};
+    TransitionLog log;
+    engine.addSink(log);
+    for (size_t tag = 0; tag < tagCount; ++tag) {
+        const double offset = static_cast<double>(tag % 5);
+        AlarmRule rule;
+        rule.hihi = 85.0 + offset;
+        rule.hi = 75.0 + offset;
+        rule.lo = 25.0 - offset;
+        rule.lolo = 15.0 - offset;
+        rule.deadband = 1.0;
+        if (tag % 10 != 0) {
+            rule.rateLimit = 20.0;  // 每 10 个 tag 有一个只检查限值
+            rule.rateDeadband = 2.0;
+        }
+        engine.setRule(static_cast<TagHandle>(tag), rule);
+        reference.setRule(static_cast<TagHandle>(tag), rule);
+    }
+
+    // 2. 生成全部批次：每批 100 毫秒，随机选择 tag，值在 0~100 之间随机游走
+    std::cout << "2. 生成 " << batchCount << " 批 × " << batchSize << " 个采样..." << std::endl;
+    std::mt19937_64 random{42};
+    std::uniform_int_distribution<size_t> pick{0, tagCount - 1};
+    std::normal_distribution<double> step{0.0, 1.5};
+    std::vector<double> level(tagCount, 50.0);
+    std::vector<std::vector<Sample>> batches(batchCount);
+    int64_t time = UA_DateTime_now();
+    for (auto& batch : batches) {
+        time += UA_DATETIME_SEC / 10;
+        batch.reserve(batchSize);
+        for (size_t i = 0; i < batchSize; ++i) {
+            const size_t tag = pick(random);
+            level[tag] = std::clamp(level[tag] + step(random), 0.0, 100.0);
+            batch.push_back({static_cast<TagHandle>(tag), time, time, level[tag], 0});
+        }
+    }
+
+    // 3. 对比
+    std::vector<AlarmTransition> expected;
+    const auto t0 = std::chrono::steady_clock::now();
+    for (const auto& batch : batches) {
+        engine.write(batch);
+    }
+    const auto t1 = std::chrono::steady_clock::now();
+    for (const auto& batch : batches) {
+        reference.write(batch, expected);
+    }
+    const auto t2 = std::chrono::steady_clock::now();
+
+    size_t mismatches = log.events.size() == expected.size() ? 0 : 1;
+    for (size_t i = 0; mismatches == 0 && i < expected.size(); ++i) {
+        mismatches += same(log.events[i], expected[i]) ? 0 : 1;
+    }
+    const auto perBatch = [&](auto duration) {
+        return std::chrono::duration<double, std::micro>(duration).count() / static_cast<double>(batchCount);
+    };
+    const auto perSample = [&](auto duration) {
+        return std::chrono::duration<double, std::nano>(duration).count() /
+            static_cast<double>(batchCount * batchSize);
+    };
+
+    std::cout << "\n3. 结果：" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "   AlarmEngine:  每批 " << perBatch(t1 - t0) << " 微秒，每个采样 " << perSample(t1 - t0)
+              << " 纳秒" << std::endl;
+    std::cout << "   逐条判断:     每批 " << perBatch(t2 - t1) << " 微秒，每个采样 " << perSample(t2 - t1)
+              << " 纳秒" << std::endl;
+    std::cout << "   报警事件:     " << log.events.size() << "（平均每批 "
+              << static_cast<double>(log.events.size()) / static_cast<double>(batchCount) << "）" << std::endl;
+    std::cout << "   结果校验:     " << (mismatches == 0 ? "✓ 一致" : "✗ 不一致") << std::endl;
+    for (size_t i = 0; i < std::min<size_t>(log.events.size(), 5); ++i) {
+        const auto& event = log.events[i];
+        std::cout << "   tag " << event.tag << " = " << event.value << ": " << levelName(event.previous) << " -> "
+                  << levelName(event.level) << (event.rate ? "（变化率报警）" : "") << std::endl;
+    }
+
+    return 0;
+}
+
+/**
+ * 使用说明：
+ *
+ * 1. 编译（启用 AVX2）：
+ *    g++ -std=c++17 -O2 -march=native alarm_rules_benchmark.cpp ...
+ * 2. 运行：./alarm_rules_benchmark --tags 100000 --batch 10000 --batches 200
+ * 3. 修改 --batch 观察每批耗时与批大小成正比，与 --tags 基本无关
+ *
+ * 报警原理：
+ *
+ * 1. 平铺存放：
+ *    - 四个限值的进入值和恢复值（计入回差）按 TagHandle 存放，每个 tag 正好一个 64 字节的缓存行
+ *    - 状态是一个位掩码（HIHI/HI/LO/LOLO/变化率各一位），与上一个值和时间放在另一个数组
+ *
+ * 2. 向量比较：
+ *    - 四个限值同时比较：值广播到 4 个通道，与进入值、恢复值各做 >= 和 <= 比较（AVX2 共四次），
+ *      movemask 后按上限/下限取对应的位，合成位掩码
+ *    - 新状态 = 越过进入值 |（原状态 & 仍越过恢复值），没有分支
+ *    - 位掩码不变时不计算报警级别，大部分采样到此为止
+ *
+ * 3. 随机访问：
+ *    - 一批中的 tag 是随机的，每个采样的开销主要是两次缓存缺失
+ *    - 写入时预取后面第 16 个采样的规则和状态，缺失的等待可以重叠
+ *
+ * 注意事项：
+ *
+ * - 限值为 NaN 表示不检查该项；所有比较对 NaN 都为 false
+ * - 报警级别按 HIHI > HI > LOLO > LO 取最高的一个；变化率报警单独报告
+ * - 第一个采样和时间未前进的采样不计算变化率，变化率报警保持原状态
+ * - 参照实现逐条读取 AlarmRule 并判断，采样少、规则多时两者都只访问有采样的 tag
+ */
@@ -0,0 +1,865 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <open62541/types.h>
+
+#include "collector_types.hpp"
+
+struct CalcEngineOptions {
+    size_t batchLanes = 256;  // 同一程序一次计算的实例数
+};
+
+struct CalcEngineStats {
+    uint64_t samples = 0;      // 作为输入的采样
+    uint64_t evaluations = 0;  // 计算的实例数
+    uint64_t waiting = 0;      // 输入尚未全部到达而跳过的实例
+    uint64_t batches = 0;      // 按程序分批计算的次数
+    uint64_t outputs = 0;
+    double seconds = 0.0;
+};
+
+/**
+ * @brief 计算 tag：用公式从其他 tag 派生的 tag
+ *
+ * 公式语法：
+ * - tag 引用：[ns=2;s=Channel1.Device1.Flow1]，可以引用其他计算 tag（需先定义）
+ * - 数值常量，+ - * /，比较 < <= > >= == !=（结果为 1 或 0），&& || !，括号
+ * - 函数：min(a, b)、max(a, b)、abs(x)、sqrt(x)、if(c, a, b)
+ * - 有状态函数（状态属于每个计算 tag）：
+ *   prev(x) 上次计算时 x 的值，delta(x) 与上次的差，
+ *   rsum(x, n) / ravg(x, n) 最近 n 次计算的和 / 平均值（n 为整数常量），
+ *   latch(set, reset) set 非 0 时置 1、reset 非 0 时清 0
+ *
+ * 公式编译为栈式字节码，tag 引用编译为输入槽位，因此 "[a] * [b]" 形式相同的公式（例如每个设备的
+ * 流量 × 密度）共用一个程序，只是输入的 tag 不同。
+ *
+ * 作为 HistorySink 接在采集链路上：
+ * - 输入采样只标记依赖它的计算 tag（依赖关系是按 TagHandle 下标的平铺数组）
+ * - 每批采样之后按层计算被标记的 tag：第 0 层只依赖原始 tag，第 k 层依赖第 k - 1 层以下的计算 tag
+ * - 同一层中使用同一程序的 tag 一起计算，字节码的每条指令对 batchLanes 个实例做一次循环，
+ *   解释开销按批摊薄，循环可以被编译器向量化
+ * - 结果作为普通 Sample（TagHandle 在同一个 TagTable 中）写入本对象的写入目标
+ *
+ * 结果的源时间戳取输入中最新的一个，状态取输入中最差的一个；任一输入尚未到达时不输出。
+ * 所有方法在同一线程中调用。
+ */
+class CalcEngine : public HistorySink {
+public:
+    explicit CalcEngine(TagTable& tags, CalcEngineOptions options = {})
+        : tags_{tags},
+          options_{options} {
+        if (options_.batchLanes == 0) {
+            throw std::invalid_argument{"CalcEngine: batchLanes must be positive"};
+        }
+    }
+
+    /**
+     * @brief 定义计算 tag
+     *
+     * 公式中引用的 tag 加入 TagTable；output 同样加入 TagTable，之后的公式可以引用它。
+     * 公式有语法错误（包括无法解析的 NodeId）、output 已定义或公式引用 output 自身时抛出 std::invalid_argument，
+     * 此时 TagTable 不变。
+     * @return output 的 TagHandle
+     */
+    TagHandle define(const opcua::NodeId& output, std::string_view formula) {
+        if (const auto existing = tags_.find(output)) {
+            if (isCalc(*existing)) {
+                throw std::invalid_argument{"CalcEngine: " + opcua::toString(output) + " already defined"};
+            }
+            if (*existing < isInput_.size() && isInput_[*existing] != 0) {
+                // 已被其他公式作为原始 tag 引用；计算 tag 必须先定义后引用，依赖关系因此不会成环
+                throw std::invalid_argument{
+                    "CalcEngine: " + opcua::toString(output) + " is referenced before definition"
+                };
+            }
+        }
+        Parser parser{formula};
+        Program program = parser.compile();
+        if (std::find(parser.inputs.begin(), parser.inputs.end(), output) != parser.inputs.end()) {
+            throw std::invalid_argument{"CalcEngine: " + opcua::toString(output) + " references itself"};
+        }
+
+        // 全部检查通过后才修改 TagTable
+        std::vector<TagHandle> inputs;
+        inputs.reserve(parser.inputs.size());
+        for (const auto& input : parser.inputs) {
+            inputs.push_back(tags_.add(input));
+        }
+        const TagHandle handle = tags_.add(output);
+
+        Calc calc{};
+        calc.output = handle;
+        calc.inputs = static_cast<uint32_t>(inputs_.size());
+        calc.inputCount = static_cast<uint32_t>(inputs.size());
+        calc.state = static_cast<uint32_t>(state_.size());
+        for (const TagHandle input : inputs) {
+            inputs_.push_back(input);
+            if (input >= isInput_.size()) {
+                isInput_.resize(static_cast<size_t>(input) + 1, 0);
+            }
+            isInput_[input] = 1;
+            if (input < calcOf_.size() && calcOf_[input] != noCalc) {
+                calc.level = std::max(calc.level, calcs_[calcOf_[input]].level + 1);
+            }
+        }
+        state_.resize(state_.size() + program.stateSize, std::numeric_limits<double>::quiet_NaN());
+        for (const auto& instruction : program.code) {
+            if (instruction.op == Op::RollingSum || instruction.op == Op::RollingAvg) {
+                // 位置、个数、和为 0，窗口为 NaN
+                std::fill_n(state_.begin() + calc.state + instruction.state, 3, 0.0);
+            }
+        }
+
+        // 形式相同的公式共用程序
+        const std::string key = program.key();
+        const auto [it, inserted] = programIndex_.emplace(key, static_cast<uint32_t>(programs_.size()));
+        if (inserted) {
+            programs_.push_back(std::move(program));
+        }
+        calc.program = it->second;
+
+        if (handle >= calcOf_.size()) {
+            calcOf_.resize(static_cast<size_t>(handle) + 1, noCalc);
+        }
+        calcOf_[handle] = static_cast<uint32_t>(calcs_.size());
+        calcs_.push_back(calc);
+        dirty_.push_back(0);
+        if (calc.level >= dirtyByLevel_.size()) {
+            dirtyByLevel_.resize(calc.level + 1);
+        }
+        graphBuilt_ = false;
+        return handle;
+    }
+
+    void addSink(HistorySink& sink) {
+        sinks_.push_back(&sink);
+    }
+
+    void write(opcua::Span<const Sample> samples) override {
+        if (!graphBuilt_) {
+            buildGraph();
+        }
+        for (const auto& sample : samples) {
+            if (sample.tag + 1 >= dependentStart_.size()) {
+                continue;
+            }
+            const uint32_t begin = dependentStart_[sample.tag];
+            const uint32_t end = dependentStart_[sample.tag + 1];
+            if (begin == end || isCalc(sample.tag)) {
+                continue;  // 不是任何公式的输入；计算 tag 的值只由本对象产生
+            }
+            ++stats_.samples;
+            values_[sample.tag] = sample.value;
+            times_[sample.tag] = sampleTime(sample);
+            status_[sample.tag] = sample.status;
+            for (uint32_t k = begin; k < end; ++k) {
+                markDirty(dependents_[k]);
+            }
+        }
+        evaluate();
+    }
+
+    size_t calcCount() const noexcept {
+        return calcs_.size();
+    }
+
+    /// 不同程序的个数；远小于 calcCount() 时批量计算的效果最好
+    size_t programCount() const noexcept {
+        return programs_.size();
+    }
+
+    /// 所有公式引用的原始 tag（不含计算 tag），用于创建订阅
+    std::vector<TagHandle> inputTags() const {
+        std::vector<TagHandle> result;
+        for (const TagHandle tag : inputs_) {
+            if (!isCalc(tag)) {
+                result.push_back(tag);
+            }
+        }
+        std::sort(result.begin(), result.end());
+        result.erase(std::unique(result.begin(), result.end()), result.end());
+        return result;
+    }
+
+    const CalcEngineStats& stats() const noexcept {
+        return stats_;
+    }
+
+private:
+    static constexpr uint32_t noCalc = UINT32_MAX;
+
+    enum class Op : uint8_t {
+        Input,  // arg：输入槽位
+        Const,  // arg：常量下标
+        Add,
+        Sub,
+        Mul,
+        Div,
+        Neg,
+        Not,
+        Lt,
+        Le,
+        Gt,
+        Ge,
+        Eq,
+        Ne,
+        And,
+        Or,
+        Min,
+        Max,
+        Abs,
+        Sqrt,
+        If,
+        Prev,        // state：上次的值
+        Delta,       // state：上次的值
+        RollingSum,  // arg：窗口；state：位置、个数、和、窗口
+        RollingAvg,
+        Latch,  // state：当前状态
+    };
+
+    struct Instruction {
+        Op op;
+        uint32_t arg;
+        uint32_t state;  // 在计算 tag 状态中的偏移
+    };
+
+    struct Program {
+        std::vector<Instruction> code;
+        std::vector<double> constants;
+        uint32_t inputCount = 0;
+        uint32_t stateSize = 0;
+        uint32_t depth = 0;  // 最大栈深度
+
+        std::string key() const {
+            std::string result;
+            const auto append = [&](const void* data, size_t size) {
+                result.append(static_cast<const char*>(data), size);
+            };
+            for (const auto& in : code) {
+                append(&in.op, sizeof(in.op));
+                append(&in.arg, sizeof(in.arg));
+                append(&in.state, sizeof(in.state));
+            }
+            append(constants.data(), constants.size() * sizeof(double));
+            return result;
+        }
+    };
+
+    struct Calc {
+        TagHandle output;
+        uint32_t program;
+        uint32_t level;
+        uint32_t inputs;  // 在 inputs_ 中的偏移
+        uint32_t inputCount;
+        uint32_t state;  // 在 state_ 中的偏移
+    };
+
+    // 递归下降解析，直接生成后缀字节码
+    class Parser {
+    public:
+        explicit Parser(std::string_view formula)
+            : text_{formula} {}
+
+        Program compile() {
+            parseOr();
+            skipSpace();
+            if (pos_ != text_.size()) {
+                fail("unexpected character");
+            }
+            program_.inputCount = static_cast<uint32_t>(inputs.size());
+            return std::move(program_);
+        }
+
+        std::vector<opcua::NodeId> inputs;  // 按槽位；编译成功后才加入 TagTable
+
+    private:
+        void parseOr() {
+            parseAnd();
+            while (accept("||")) {
+                parseAnd();
+                emit(Op::Or, 0, -1);
+            }
+        }
+
+        void parseAnd() {
+            parseComparison();
+            while (accept("&&")) {
+                parseComparison();
+                emit(Op::And, 0, -1);
+            }
+        }
+
+        void parseComparison() {
+            parseAdditive();
+            static constexpr std::pair<std::string_view, Op> operators[] = {
+                {"<=", Op::Le}, {">=", Op::Ge}, {"==", Op::Eq}, {"!=", Op::Ne}, {"<", Op::Lt}, {">", Op::Gt}
+            };
+            for (const auto& [token, op] : operators) {
+                if (accept(token)) {
+                    parseAdditive();
+                    emit(op, 0, -1);
+                    return;
+                }
+            }
+        }
+
+        void parseAdditive() {
+            parseMultiplicative();
+            for (;;) {
+                if (accept("+")) {
+                    parseMultiplicative();
+                    emit(Op::Add, 0, -1);
+                } else if (accept("-")) {
+                    parseMultiplicative();
+                    emit(Op::Sub, 0, -1);
+                } else {
+                    return;
+                }
+            }
+        }
+
+        void parseMultiplicative() {
+            parseUnary();
+            for (;;) {
+                if (accept("*")) {
+                    parseUnary();
+                    emit(Op::Mul, 0, -1);
+                } else if (accept("/")) {
+                    parseUnary();
+                    emit(Op::Div, 0, -1);
+                } else {
+                    return;
+                }
+            }
+        }
+
+        void parseUnary() {
+            if (accept("-")) {
+                parseUnary();
+                emit(Op::Neg, 0, 0);
+            } else if (accept("!")) {
+                parseUnary();
+                emit(Op::Not, 0, 0);
+            } else {
+                parsePrimary();
+            }
+        }
+
+        void parsePrimary() {
+            skipSpace();
+            if (accept("(")) {
+                parseOr();
+                expect(")");
+            } else if (accept("[")) {
+                const size_t end = text_.find(']', pos_);
+                if (end == std::string_view::npos) {
+                    fail("missing ]");
+                }
+                opcua::NodeId tag;
+                try {
+                    tag = parseNodeId(text_.substr(pos_, end - pos_));
+                } catch (const opcua::BadStatus&) {
+                    fail("invalid NodeId");  // 与其他语法错误一样报告 std::invalid_argument 和位置
+                }
+                pos_ = end + 1;
+                // 同一 tag 多次引用时共用槽位
+                const auto it = std::find(inputs.begin(), inputs.end(), tag);
+                const auto slot = static_cast<uint32_t>(it - inputs.begin());
+                if (it == inputs.end()) {
+                    inputs.push_back(std::move(tag));
+                }
+                emit(Op::Input, slot, 1);
+            } else if (pos_ < text_.size() && (isDigit(text_[pos_]) || text_[pos_] == '.')) {
+                emitConstant(parseNumber());
+            } else if (pos_ < text_.size() && isIdentifierStart(text_[pos_])) {
+                parseCall();
+            } else {
+                fail("expected operand");
+            }
+        }
+
+        void parseCall() {
+            const size_t start = pos_;
+            while (pos_ < text_.size() && (isIdentifierStart(text_[pos_]) || isDigit(text_[pos_]))) {
+                ++pos_;
+            }
+            const std::string_view name = text_.substr(start, pos_ - start);
+            expect("(");
+            if (name == "rsum" || name == "ravg") {
+                parseOr();
+                expect(",");
+                skipSpace();
+                const double window = parseNumber();
+                if (window < 1.0 || window != std::floor(window) || window > 1e6) {
+                    fail("window must be a positive integer");
+                }
+                expect(")");
+                const auto n = static_cast<uint32_t>(window);
+                emitStateful(name == "rsum" ? Op::RollingSum : Op::RollingAvg, n, 3 + n, 0);
+                return;
+            }
+            struct Function {
+                std::string_view name;
+                Op op;
+                int arity;
+            };
+            static constexpr Function functions[] = {
+                {"min", Op::Min, 2},
+                {"max", Op::Max, 2},
+                {"abs", Op::Abs, 1},
+                {"sqrt", Op::Sqrt, 1},
+                {"if", Op::If, 3},
+                {"prev", Op::Prev, 1},
+                {"delta", Op::Delta, 1},
+                {"latch", Op::Latch, 2},
+            };
+            const auto* function = std::find_if(std::begin(functions), std::end(functions), [&](const Function& f) {
+                return f.name == name;
+            });
+            if (function == std::end(functions)) {
+                fail("unknown function " + std::string{name});
+            }
+            for (int i = 0; i < function->arity; ++i) {
+                if (i > 0) {
+                    expect(",");
+                }
+                parseOr();
+            }
+            expect(")");
+            const int change = 1 - function->arity;
+            switch (function->op) {
+            case Op::Prev:
+            case Op::Delta:
+            case Op::Latch:
+                emitStateful(function->op, 0, 1, change);
+                break;
+            default:
+                emit(function->op, 0, change);
+                break;
+            }
+        }
+
+        double parseNumber() {
+            const std::string digits{text_.substr(pos_, std::min<size_t>(64, text_.size() - pos_))};
+            char* end = nullptr;
+            const double value = std::strtod(digits.c_str(), &end);
+            if (end == digits.c_str()) {
+                fail("expected number");
+            }
+            pos_ += static_cast<size_t>(end - digits.c_str());
+            return value;
+        }
+
+        void emitConstant(double value) {
+            auto& constants = program_.constants;
+            const auto it = std::find(constants.begin(), constants.end(), value);
+            const auto index = static_cast<uint32_t>(it - constants.begin());
+            if (it == constants.end()) {
+                constants.push_back(value);
+            }
+            emit(Op::Const, index, 1);
+        }
+
+        void emitStateful(Op op, uint32_t arg, uint32_t stateSize, int change) {
+            program_.code.push_back({op, arg, program_.stateSize});
+            program_.stateSize += stateSize;
+            adjust(change);
+        }
+
+        void emit(Op op, uint32_t arg, int change) {
+            program_.code.push_back({op, arg, 0});
+            adjust(change);
+        }
+
+        void adjust(int change) {
+            depth_ += change;
+            program_.depth = std::max(program_.depth, static_cast<uint32_t>(depth_));
+        }
+
+        void skipSpace() {
+            while (pos_ < text_.size() && (text_[pos_] == ' ' || text_[pos_] == '\t')) {
+                ++pos_;
+            }
+        }
+
+        bool accept(std::string_view token) {
+            skipSpace();
+            if (text_.substr(pos_, token.size()) == token) {
+                pos_ += token.size();
+                return true;
+            }
+            return false;
+        }
+
+        void expect(std::string_view token) {
+            if (!accept(token)) {
+                fail("expected " + std::string{token});
+            }
+        }
+
+        [[noreturn]] void fail(const std::string& message) const {
+            throw std::invalid_argument{
+                "CalcEngine: " + message + " at " + std::to_string(pos_) + " in \"" + std::string{text_} + "\""
+            };
+        }
+
+        static bool isDigit(char c) noexcept {
+            return c >= '0' && c <= '9';
+        }
+
+        static bool isIdentifierStart(char c) noexcept {
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+        }
+
+        std::string_view text_;
+        size_t pos_ = 0;
+        int depth_ = 0;
+        Program program_;
+    };
+
+    bool isCalc(TagHandle tag) const noexcept {
+        return tag < calcOf_.size() && calcOf_[tag] != noCalc;
+    }
+
+    // 输入 tag -> 依赖它的计算 tag，平铺为 dependentStart_ / dependents_
+    void buildGraph() {
+        const size_t size = tags_.size();
+        dependentStart_.assign(size + 1, 0);
+        for (const auto& calc : calcs_) {
+            for (uint32_t i = 0; i < calc.inputCount; ++i) {
+                ++dependentStart_[inputs_[calc.inputs + i] + 1];
+            }
+        }
+        for (size_t t = 0; t < size; ++t) {
+            dependentStart_[t + 1] += dependentStart_[t];
+        }
+        dependents_.resize(dependentStart_[size]);
+        std::vector<uint32_t> next(dependentStart_.begin(), dependentStart_.end() - 1);
+        for (uint32_t id = 0; id < calcs_.size(); ++id) {
+            const auto& calc = calcs_[id];
+            for (uint32_t i = 0; i < calc.inputCount; ++i) {
+                dependents_[next[inputs_[calc.inputs + i]]++] = id;
+            }
+        }
+        values_.resize(size, std::numeric_limits<double>::quiet_NaN());
+        times_.resize(size, 0);
+        status_.resize(size, UA_STATUSCODE_GOOD);
+        graphBuilt_ = true;
+    }
+
+    void markDirty(uint32_t id) {
+        if (dirty_[id] == 0) {
+            dirty_[id] = 1;
+            dirtyByLevel_[calcs_[id].level].push_back(id);
+        }
+    }
+
+    void evaluate() {
+        const auto t0 = std::chrono::steady_clock::now();
+        for (auto& ids : dirtyByLevel_) {
+            if (ids.empty()) {
+                continue;
+            }
+            // 按程序分组，同一程序的实例一起计算
+            std::sort(ids.begin(), ids.end(), [this](uint32_t a, uint32_t b) {
+                return calcs_[a].program < calcs_[b].program;
+            });
+            size_t begin = 0;
+            while (begin < ids.size()) {
+                const uint32_t program = calcs_[ids[begin]].program;
+                size_t end = begin;
+                while (end < ids.size() && calcs_[ids[end]].program == program) {
+                    ++end;
+                }
+                for (size_t chunk = begin; chunk < end; chunk += options_.batchLanes) {
+                    runBatch(programs_[program], ids.data() + chunk, std::min(options_.batchLanes, end - chunk));
+                }
+                begin = end;
+            }
+            for (const uint32_t id : ids) {
+                dirty_[id] = 0;
+            }
+            ids.clear();
+        }
+        if (!output_.empty()) {
+            stats_.outputs += output_.size();
+            for (auto* sink : sinks_) {
+                sink->write(output_);
+            }
+            output_.clear();
+        }
+        stats_.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    }
+
+    void runBatch(const Program& program, const uint32_t* ids, size_t count) {
+        // 跳过输入尚未全部到达的实例，同时计算时间戳和状态
+        lanes_.clear();
+        laneTimes_.clear();
+        laneStatus_.clear();
+        for (size_t i = 0; i < count; ++i) {
+            const auto& calc = calcs_[ids[i]];
+            int64_t time = 0;
+            uint32_t status = UA_STATUSCODE_GOOD;
+            bool ready = true;
+            for (uint32_t k = 0; k < calc.inputCount; ++k) {
+                const TagHandle input = inputs_[calc.inputs + k];
+                if (times_[input] == 0) {
+                    ready = false;
+                    break;
+                }
+                time = std::max(time, times_[input]);
+                if ((status_[input] >> 30) > (status >> 30)) {
+                    status = status_[input];  // 严重程度：Good < Uncertain < Bad
+                }
+            }
+            if (!ready) {
+                ++stats_.waiting;
+                continue;
+            }
+            lanes_.push_back(ids[i]);
+            laneTimes_.push_back(time);
+            laneStatus_.push_back(status);
+        }
+        const size_t n = lanes_.size();
+        if (n == 0) {
+            return;
+        }
+        ++stats_.batches;
+        stats_.evaluations += n;
+
+        const size_t stride = options_.batchLanes;
+        stack_.resize(std::max<size_t>(program.depth, 1) * stride);
+        double* const stack = stack_.data();
+        size_t sp = 0;  // 栈顶的下一层
+        const auto top = [&](size_t below) { return stack + (sp - 1 - below) * stride; };
+        for (const auto& in : program.code) {
+            switch (in.op) {
+            case Op::Input: {
+                double* out = stack + sp++ * stride;
+                for (size_t i = 0; i < n; ++i) {
+                    out[i] = values_[inputs_[calcs_[lanes_[i]].inputs + in.arg]];
+                }
+                break;
+            }
+            case Op::Const:
+                std::fill_n(stack + sp++ * stride, n, program.constants[in.arg]);
+                break;
+            case Op::Neg:
+                unary(top(0), n, [](double x) { return -x; });
+                break;
+            case Op::Not:
+                unary(top(0), n, [](double x) { return x == 0.0 ? 1.0 : 0.0; });
+                break;
+            case Op::Abs:
+                unary(top(0), n, [](double x) { return std::fabs(x); });
+                break;
+            case Op::Sqrt:
+                unary(top(0), n, [](double x) { return std::sqrt(x); });
+                break;
+            case Op::Add:
+                binary(top(1), top(0), n, [](double a, double b) { return a + b; });
+                --sp;
+                break;
+            case Op::Sub:
+                binary(top(1), top(0), n, [](double a, double b) { return a - b; });
+                --sp;
+                break;
+            case Op::Mul:
+                binary(top(1), top(0), n, [](double a, double b) { return a * b; });
+                --sp;
+                break;
+            case Op::Div:
+                binary(top(1), top(0), n, [](double a, double b) { return a / b; });
+                --sp;
+                break;
+            case Op::Lt:
+                binary(top(1), top(0), n, [](double a, double b) { return a < b ? 1.0 : 0.0; });
+                --sp;
+                break;
+            case Op::Le:
+                binary(top(1), top(0), n, [](double a, double b) { return a <= b ? 1.0 : 0.0; });
+                --sp;
+                break;
+            case Op::Gt:
+                binary(top(1), top(0), n, [](double a, double b) { return a > b ? 1.0 : 0.0; });
+                --sp;
+                break;
+            case Op::Ge:
+                binary(top(1), top(0), n, [](double a, double b) { return a >= b ? 1.0 : 0.0; });
+                --sp;
+                break;
+            case Op::Eq:
+                binary(top(1), top(0), n, [](double a, double b) { return a == b ? 1.0 : 0.0; });
+                --sp;
+                break;
+            case Op::Ne:
+                binary(top(1), top(0), n, [](double a, double b) { return a != b ? 1.0 : 0.0; });
+                --sp;
+                break;
+            case Op::And:
+                binary(top(1), top(0), n, [](double a, double b) { return a != 0.0 && b != 0.0 ? 1.0 : 0.0; });
+                --sp;
+                break;
+            case Op::Or:
+                binary(top(1), top(0), n, [](double a, double b) { return a != 0.0 || b != 0.0 ? 1.0 : 0.0; });
+                --sp;
+                break;
+            case Op::Min:
+                binary(top(1), top(0), n, [](double a, double b) { return std::min(a, b); });
+                --sp;
+                break;
+            case Op::Max:
+                binary(top(1), top(0), n, [](double a, double b) { return std::max(a, b); });
+                --sp;
+                break;
+            case Op::If: {
+                double* c = top(2);
+                const double* a = top(1);
+                const double* b = top(0);
+                for (size_t i = 0; i < n; ++i) {
+                    c[i] = c[i] != 0.0 ? a[i] : b[i];
+                }
+                sp -= 2;
+                break;
+            }
+            case Op::Prev:
+            case Op::Delta: {
+                double* x = top(0);
+                for (size_t i = 0; i < n; ++i) {
+                    double& last = state_[calcs_[lanes_[i]].state + in.state];
+                    const double current = x[i];
+                    x[i] = in.op == Op::Prev ? last : current - last;
+                    last = current;
+                }
+                break;
+            }
+            case Op::RollingSum:
+            case Op::RollingAvg: {
+                double* x = top(0);
+                for (size_t i = 0; i < n; ++i) {
+                    x[i] = roll(&state_[calcs_[lanes_[i]].state + in.state], in.arg, x[i], in.op == Op::RollingAvg);
+                }
+                break;
+            }
+            case Op::Latch: {
+                double* set = top(1);
+                const double* reset = top(0);
+                for (size_t i = 0; i < n; ++i) {
+                    double& latched = state_[calcs_[lanes_[i]].state + in.state];
+                    if (reset[i] != 0.0) {
+                        latched = 0.0;
+                    } else if (set[i] != 0.0) {
+                        latched = 1.0;
+                    } else if (std::isnan(latched)) {
+                        latched = 0.0;
+                    }
+                    set[i] = latched;
+                }
+                --sp;
+                break;
+            }
+            }
+        }
+
+        const double* result = stack;
+        for (size_t i = 0; i < n; ++i) {
+            const TagHandle output = calcs_[lanes_[i]].output;
+            values_[output] = result[i];
+            times_[output] = laneTimes_[i];
+            status_[output] = laneStatus_[i];
+            output_.push_back({output, laneTimes_[i], laneTimes_[i], result[i], laneStatus_[i]});
+            if (output + 1 < dependentStart_.size()) {
+                for (uint32_t k = dependentStart_[output]; k < dependentStart_[output + 1]; ++k) {
+                    markDirty(dependents_[k]);  // 更高层的计算 tag，在本次 evaluate() 中计算
+                }
+            }
+        }
+    }
+
+    template <typename F>
+    static void unary(double* x, size_t n, F f) noexcept {
+        for (size_t i = 0; i < n; ++i) {
+            x[i] = f(x[i]);
+        }
+    }
+
+    template <typename F>
+    static void binary(double* a, const double* b, size_t n, F f) noexcept {
+        for (size_t i = 0; i < n; ++i) {
+            a[i] = f(a[i], b[i]);
+        }
+    }
+
+    // 滚动窗口：state = [位置, 个数, 和, 窗口...]；NaN 不进入窗口
+    static double roll(double* state, uint32_t window, double x, bool average) noexcept {
+        auto pos = static_cast<uint32_t>(state[0]);
+        auto count = static_cast<uint32_t>(state[1]);
+        double* ring = state + 3;
+        if (!std::isnan(x)) {
+            if (count == window) {
+                state[2] -= ring[pos];
+            } else {
+                ++count;
+            }
+            ring[pos] = x;
+            state[2] += x;
+            pos = pos + 1 == window ? 0 : pos + 1;
+            if (pos == 0 && count == window) {
+                // 每轮重新求和，避免增减累积的舍入误差
+                double sum = 0.0;
+                for (uint32_t k = 0; k < window; ++k) {
+                    sum += ring[k];
+                }
+                state[2] = sum;
+            }
+            state[0] = pos;
+            state[1] = count;
+        }
+        if (count == 0) {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        return average ? state[2] / count : state[2];
+    }
+
+    TagTable& tags_;
+    CalcEngineOptions options_;
+
+    std::vector<Program> programs_;
+    std::unordered_map<std::string, uint32_t> programIndex_;
+    std::vector<Calc> calcs_;
+    std::vector<TagHandle> inputs_;  // 每个计算 tag 的输入，按槽位
+    std::vector<double> state_;      // 有状态函数的状态
+    std::vector<uint32_t> calcOf_;   // TagHandle -> 计算 tag
+    std::vector<uint8_t> isInput_;   // TagHandle 是否被公式引用
+
+    bool graphBuilt_ = false;
+    std::vector<uint32_t> dependentStart_;
+    std::vector<uint32_t> dependents_;
+
+    // 按 TagHandle 下标：输入和计算 tag 的最新值
+    std::vector<double> values_;
+    std::vector<int64_t> times_;
+    std::vector<uint32_t> status_;
+
+    std::vector<uint8_t> dirty_;
+    std::vector<std::vector<uint32_t>> dirtyByLevel_;
+    std::vector<uint32_t> lanes_;
+    std::vector<int64_t> laneTimes_;
+    std::vector<uint32_t> laneStatus_;
+    std::vector<double> stack_;
+    std::vector<Sample> output_;
+
+    std::vector<HistorySink*> sinks_;
+    CalcEngineStats stats_;
+};
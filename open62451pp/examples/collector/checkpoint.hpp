@@ -0,0 +1,219 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "collector_types.hpp"
+
+// 采集器检查点：与会话无关、重启后仍然有效的状态
+// - tag 列表（按 TagHandle 顺序，重启后编号不变）
+// - 订阅布局：服务器分配的订阅 ID、修订后的参数、最后处理的序号、监控项 ID
+// - 各写入目标的偏移量
+// - 每个 tag 的最新值
+//
+// 文件格式为本机字节序的二进制格式，只用于同一台机器上的重启。
+
+struct MonitoredItemCheckpoint {
+    TagHandle tag;  // 同时是监控项的 clientHandle
+    uint32_t monitoredItemId;
+    double revisedSamplingInterval;
+    uint32_t revisedQueueSize;
+};
+
+struct SubscriptionCheckpoint {
+    uint32_t subscriptionId;
+    double revisedPublishingInterval;
+    uint32_t revisedLifetimeCount;
+    uint32_t revisedMaxKeepAliveCount;
+    uint32_t lastSequenceNumber;  // 最后一个已处理的通知消息序号
+    std::vector<MonitoredItemCheckpoint> items;
+};
+
+struct CollectorCheckpoint {
+    int64_t savedAt = 0;  // DateTime
+    std::string endpointUrl;
+    std::vector<std::string> tags;  // NodeId 字符串，下标即 TagHandle
+    std::vector<SubscriptionCheckpoint> subscriptions;
+    std::vector<std::pair<std::string, uint64_t>> sinkOffsets;
+    std::vector<Sample> lastValues;
+};
+
+namespace checkpoint_detail {
+
+inline constexpr uint32_t magic = 0x4B434C43;  // "CLCK"
+inline constexpr uint32_t version = 1;
+
+class Writer {
+public:
+    explicit Writer(std::FILE* file)
+        : file_{file} {}
+
+    template <typename T>
+    void pod(const T& value) {
+        ok_ = ok_ && std::fwrite(&value, sizeof(T), 1, file_) == 1;
+    }
+
+    void string(const std::string& value) {
+        pod(static_cast<uint32_t>(value.size()));
+        ok_ = ok_ && std::fwrite(value.data(), 1, value.size(), file_) == value.size();
+    }
+
+    template <typename T>
+    void pods(const std::vector<T>& values) {
+        pod(static_cast<uint32_t>(values.size()));
+        ok_ = ok_ && std::fwrite(values.data(), sizeof(T), values.size(), file_) == values.size();
+    }
+
+    bool ok() const noexcept {
+        return ok_;
+    }
+
+private:
+    std::FILE* file_;
+    bool ok_ = true;
+};
+
+class Reader {
+public:
+    explicit Reader(std::FILE* file)
+        : file_{file} {}
+
+    template <typename T>
+    T pod() {
+        T value{};
+        ok_ = ok_ && std::fread(&value, sizeof(T), 1, file_) == 1;
+        return value;
+    }
+
+    std::string string() {
+        std::string value(pod<uint32_t>(), '\0');
+        ok_ = ok_ && std::fread(value.data(), 1, value.size(), file_) == value.size();
+        return value;
+    }
+
+    template <typename T>
+    std::vector<T> pods() {
+        std::vector<T> values(pod<uint32_t>());
+        ok_ = ok_ && std::fread(values.data(), sizeof(T), values.size(), file_) == values.size();
+        return values;
+    }
+
+    bool ok() const noexcept {
+        return ok_;
+    }
+
+private:
+    std::FILE* file_;
+    bool ok_ = true;
+};
+
+/// fsync path 所在的目录，使其中的重命名持久化
+inline bool syncDirectory(const std::string& path) {
+    const size_t slash = path.find_last_of('/');
+    const std::string directory = slash == std::string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+    const int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    const bool ok = ::fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+}
+
+}  // namespace checkpoint_detail
+
+/**
+ * @brief 保存检查点
+ *
+ * 先写入临时文件再重命名，进程在写入过程中崩溃时旧的检查点保持完整。
+ * 重命名前 fsync 临时文件，重命名后 fsync 所在目录，断电后不会留下空的或不完整的检查点。
+ */
+inline bool saveCheckpoint(const std::string& path, const CollectorCheckpoint& checkpoint) {
+    const std::string tmpPath = path + ".tmp";
+    std::FILE* file = std::fopen(tmpPath.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    checkpoint_detail::Writer writer{file};
+    writer.pod(checkpoint_detail::magic);
+    writer.pod(checkpoint_detail::version);
+    writer.pod(checkpoint.savedAt);
+    writer.string(checkpoint.endpointUrl);
+    writer.pod(static_cast<uint32_t>(checkpoint.tags.size()));
+    for (const auto& tag : checkpoint.tags) {
+        writer.string(tag);
+    }
+    writer.pod(static_cast<uint32_t>(checkpoint.subscriptions.size()));
+    for (const auto& sub : checkpoint.subscriptions) {
+        writer.pod(sub.subscriptionId);
+        writer.pod(sub.revisedPublishingInterval);
+        writer.pod(sub.revisedLifetimeCount);
+        writer.pod(sub.revisedMaxKeepAliveCount);
+        writer.pod(sub.lastSequenceNumber);
+        writer.pods(sub.items);
+    }
+    writer.pod(static_cast<uint32_t>(checkpoint.sinkOffsets.size()));
+    for (const auto& [name, offset] : checkpoint.sinkOffsets) {
+        writer.string(name);
+        writer.pod(offset);
+    }
+    writer.pods(checkpoint.lastValues);
+    const bool ok = writer.ok() && std::fflush(file) == 0 && ::fsync(::fileno(file)) == 0;
+    std::fclose(file);
+    if (!ok) {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        return false;
+    }
+    return checkpoint_detail::syncDirectory(path);
+}
+
+/// 读取检查点；文件不存在或格式不符时返回 std::nullopt
+inline std::optional<CollectorCheckpoint> loadCheckpoint(const std::string& path) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return std::nullopt;
+    }
+    checkpoint_detail::Reader reader{file};
+    CollectorCheckpoint checkpoint;
+    if (reader.pod<uint32_t>() != checkpoint_detail::magic ||
+        reader.pod<uint32_t>() != checkpoint_detail::version) {
+        std::fclose(file);
+        return std::nullopt;
+    }
+    checkpoint.savedAt = reader.pod<int64_t>();
+    checkpoint.endpointUrl = reader.string();
+    checkpoint.tags.resize(reader.pod<uint32_t>());
+    for (auto& tag : checkpoint.tags) {
+        tag = reader.string();
+    }
+    checkpoint.subscriptions.resize(reader.pod<uint32_t>());
+    for (auto& sub : checkpoint.subscriptions) {
+        sub.subscriptionId = reader.pod<uint32_t>();
+        sub.revisedPublishingInterval = reader.pod<double>();
+        sub.revisedLifetimeCount = reader.pod<uint32_t>();
+        sub.revisedMaxKeepAliveCount = reader.pod<uint32_t>();
+        sub.lastSequenceNumber = reader.pod<uint32_t>();
+        sub.items = reader.pods<MonitoredItemCheckpoint>();
+    }
+    checkpoint.sinkOffsets.resize(reader.pod<uint32_t>());
+    for (auto& [name, offset] : checkpoint.sinkOffsets) {
+        name = reader.string();
+        offset = reader.pod<uint64_t>();
+    }
+    checkpoint.lastValues = reader.pods<Sample>();
+    std::fclose(file);
+    if (!reader.ok()) {
+        return std::nullopt;
+    }
+    return checkpoint;
+}
@@ -0,0 +1,234 @@
+/**
+ * @file client_address_search_annotated.cpp
+ * @brief OPC UA 地址空间搜索示例 - 演示批量浏览、快照持久化和 trigram 索引查询
+ *
+ * 本示例展示了 address_crawler.hpp、address_space.hpp 和 address_index.hpp 的使用方法，包括：
+ * 1. 启动内置的模拟工厂服务器（通道 × 设备 × tag），或连接外部服务器
+ * 2. 用批量 Browse/BrowseNext 请求爬取 Objects 下的地址空间，并批量读取变量的 DataType
+ * 3. 建立搜索索引，与快照一起保存到文件，再重新加载
+ * 4. 执行子串、前缀和带 NodeClass/DataType 过滤的查询，与逐个节点扫描比较耗时
+ *
+ * 功能说明：
+ * - 原来查找 tag 只能在 UaExpert 中逐层展开，或在程序中逐个比较节点名称
+ * - 索引把 BrowseName、DisplayName 和浏览路径中的每三个字节映射到节点列表，
+ *   查询只需核对少量候选节点，几十万个节点时单次查询在 1 毫秒以内
+ * - 快照和索引保存在同一个文件中，重启后直接加载，不需要重新浏览服务器
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 包含必要的头文件
+#include <open62541pp/client.hpp>  // 客户端核心功能
+#include <open62541pp/server.hpp>  // 服务器核心功能
+
+#include "../helper.hpp"           // CliParser - 命令行参数解析器
+#include "address_crawler.hpp"     // AddressSpaceCrawler
+#include "address_index.hpp"       // AddressSpaceIndex、saveAddressSpace、loadAddressSpace
+#include "simulated_plant.hpp"     // SimulatedPlant
+
+static std::string toLower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return s;
+}
+
+// 不使用索引：逐个节点拼出浏览路径并比较，作为对照
+static size_t linearScan(const AddressSpaceSnapshot& snapshot, const SearchQuery& query) {
+    const std::string needle = toLower(query.text);
+    const uint32_t dataType =
+        query.dataType ? snapshot.findDataType(*query.dataType) : AddressSpaceSnapshot::noDataType;
+    size_t found = 0;
+    for (NodeIndex node = 0; node < snapshot.size() && found < query.limit; ++node) {
+        const std::string text = toLower(
+            snapshot.browseName(node) + '\n' + snapshot.displayName(node) + '\n' + snapshot.browsePath(node)
+        );
+        if (text.find(needle) == std::string::npos) {
+            continue;
+        }
+        if (query.nodeClassMask != 0 && (snapshot.nodeClasses()[node] & query.nodeClassMask) == 0) {
+            continue;
+        }
+        if (query.dataType && snapshot.dataTypeOf(node) != dataType) {
+            continue;
+        }
+        ++found;
+    }
+    return found;
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "=== OPC UA 地址空间搜索示例 ===" << std::endl;
+
+    // 解析命令行参数
+    // --url <地址>：外部服务器地址；不指定时启动内置的模拟工厂
+    // --channels / --devices / --tags：模拟工厂的规模，默认 4 × 25 × 50
+    // --snapshot <文件>：快照文件，默认 address_space.bin
+    // --query <文本>：额外执行的查询
+    const CliParser parser{argc, argv};
+    const auto externalUrl = parser.value("--url");
+    const std::string snapshotPath{parser.value("--snapshot").value_or("address_space.bin")};
+
+    PlantOptions plantOptions;
+    plantOptions.channels = std::stoul(std::string{parser.value("--channels").value_or("4")});
+    plantOptions.devicesPerChannel = std::stoul(std::string{parser.value("--devices").value_or("25")});
+    plantOptions.tagsPerDevice = std::stoul(std::string{parser.value("--tags").value_or("50")});
+
+    std::cout << "1. 准备服务器..." << std::endl;
+
+    opcua::ServerConfig config{4840};
+    opcua::Server server{std::move(config)};
+    std::thread serverThread;
+    std::string url;
+    if (externalUrl) {
+        url = std::string{*externalUrl};
+        std::cout << "✓ 使用外部服务器 " << url << std::endl;
+    } else {
+        const SimulatedPlant plant{server, plantOptions};
+        serverThread = std::thread{[&] { server.run(); }};
+        url = "opc.tcp://localhost:4840";
+        std::cout << "✓ 模拟工厂已启动：" << plantOptions.channels << " 个通道 × "
+                  << plantOptions.devicesPerChannel << " 个设备 × " << plantOptions.tagsPerDevice << " 个 tag，共 "
+                  << plant.nodeCount() << " 个节点" << std::endl;
+    }
+
+    std::cout << "2. 爬取地址空间..." << std::endl;
+
+    opcua::Client client;
+    client.connect(url);
+    AddressSpaceSnapshot snapshot;
+    AddressSpaceCrawler crawler{client};
+    const auto crawlStats = crawler.crawl(opcua::NodeId{opcua::ObjectId::ObjectsFolder}, snapshot);
+    std::cout << "✓ " << snapshot.size() << " 个节点，" << crawlStats.references << " 个引用，用时 " << std::fixed
+              << std::setprecision(2) << crawlStats.seconds << " 秒" << std::endl;
+    std::cout << "  Browse 请求 " << crawlStats.browseRequests << "，BrowseNext 请求 "
+              << crawlStats.browseNextRequests << "，Read 请求 " << crawlStats.readRequests << std::endl;
+    client.disconnect();
+
+    std::cout << "3. 建立索引并保存快照..." << std::endl;
+
+    auto t0 = std::chrono::steady_clock::now();
+    const AddressSpaceIndex built{snapshot};
+    auto t1 = std::chrono::steady_clock::now();
+    std::cout << "✓ 索引: " << built.trigramCount() << " 个 trigram，" << std::setprecision(1)
+              << static_cast<double>(built.memoryBytes()) / (1 << 20) << " MiB，用时 "
+              << std::chrono::duration<double, std::milli>(t1 - t0).count() << " 毫秒" << std::endl;
+    if (!saveAddressSpace(snapshotPath, snapshot, built)) {
+        std::cerr << "✗ 无法写入 " << snapshotPath << std::endl;
+        return 1;
+    }
+
+    // 重新加载：之后的查询都使用从文件恢复的快照和索引
+    AddressSpaceSnapshot loaded;
+    AddressSpaceIndex index;
+    t0 = std::chrono::steady_clock::now();
+    if (!loadAddressSpace(snapshotPath, loaded, index) || loaded.size() != snapshot.size()) {
+        std::cerr << "✗ 无法加载 " << snapshotPath << std::endl;
+        return 1;
+    }
+    t1 = std::chrono::steady_clock::now();
+    std::cout << "✓ 已保存到 " << snapshotPath << "，重新加载用时 "
+              << std::chrono::duration<double, std::milli>(t1 - t0).count() << " 毫秒" << std::endl;
+
+    std::cout << "\n4. 查询对比：" << std::endl;
+
+    std::vector<std::pair<std::string, SearchQuery>> queries;
+    queries.push_back({"子串", SearchQuery{"device12"}});
+    queries.push_back({"子串", SearchQuery{"Temperature"}});
+    queries.push_back({"浏览路径", SearchQuery{"Channel2/Device7/Flow"}});
+    queries.push_back({"短前缀", SearchQuery{"Al"}});
+    {
+        SearchQuery query{"pressure"};
+        query.nodeClassMask = UA_NODECLASS_VARIABLE;
+        query.dataType = opcua::NodeId{opcua::DataTypeId::Double};
+        queries.push_back({"变量 + Double", query});
+    }
+    {
+        SearchQuery query{"running"};
+        query.dataType = opcua::NodeId{opcua::DataTypeId::Boolean};
+        query.limit = 1000000;
+        queries.push_back({"全部 Boolean", query});
+    }
+    if (const auto text = parser.value("--query")) {
+        queries.push_back({"命令行", SearchQuery{std::string{*text}}});
+    }
+
+    constexpr int repeat = 100;
+    for (const auto& [kind, query] : queries) {
+        SearchResult result;
+        t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < repeat; ++i) {
+            result = index.search(loaded, query);
+        }
+        t1 = std::chrono::steady_clock::now();
+        const size_t scanned = linearScan(loaded, query);
+        const auto t2 = std::chrono::steady_clock::now();
+
+        std::cout << "   [" << kind << "] \"" << query.text << "\"" << std::endl;
+        std::cout << "     索引:      " << std::setprecision(1)
+                  << std::chrono::duration<double, std::micro>(t1 - t0).count() / repeat << " 微秒，"
+                  << result.nodes.size() << " 个结果（候选 " << result.candidates << "）" << std::endl;
+        std::cout << "     逐个扫描:  " << std::chrono::duration<double, std::micro>(t2 - t1).count()
+                  << " 微秒，" << scanned << " 个结果" << std::endl;
+        for (size_t i = 0; i < std::min<size_t>(result.nodes.size(), 3); ++i) {
+            std::cout << "       " << loaded.browsePath(result.nodes[i]) << "  ("
+                      << opcua::toString(loaded.nodeId(result.nodes[i])) << ")" << std::endl;
+        }
+    }
+
+    if (serverThread.joinable()) {
+        server.stop();
+        serverThread.join();
+    }
+
+    std::cout << "\n=== 程序已退出 ===" << std::endl;
+    return 0;
+}
+
+/**
+ * 使用说明：
+ *
+ * 1. 内置模拟工厂：./client_address_search_annotated --channels 20 --devices 50 --tags 500（约 50 万个节点）
+ * 2. 外部服务器：./client_address_search_annotated --url opc.tcp://host:49320 --query "Boiler"
+ * 3. 快照文件默认写入 address_space.bin，可以用 --snapshot 指定
+ *
+ * 爬取原理：
+ *
+ * 1. 批量浏览：
+ *    - 按层广度优先，每层的节点每 500 个打包成一个 Browse 请求
+ *    - 引用类型为 HierarchicalReferences（含子类型），只返回 Object 和 Variable
+ *    - 每个节点最多返回 1000 个引用，剩余部分的续读点合并成一个 BrowseNext 请求
+ *    - 默认跳过 HasProperty 引用的属性节点（EURange、EngineeringUnits 等）
+ *
+ * 2. DataType：
+ *    - 浏览完成后，所有变量的 DataType 属性每 1000 个打包成一个 Read 请求
+ *    - 快照中 DataType 使用去重后的小表，节点只保存下标
+ *
+ * 索引原理：
+ *
+ * 1. 检索文本：
+ *    - 每个节点为小写的 "browseName\ndisplayName\nbrowsePath"，例如
+ *      "flow3\nflow3\nobjects/channel2/device7/flow3"
+ *
+ * 2. trigram 倒排索引：
+ *    - 每个连续三字节对应一个递增的节点列表，所有列表连续存放（CSR 布局）
+ *    - 查询取其全部 trigram 的列表，从最短的列表开始，在其余列表中二分查找求交集
+ *    - 交集中的节点再核对子串（trigram 都出现不代表它们相邻）和过滤条件
+ *    - 得到 limit 个结果后停止，常见查询只需核对几十到几百个节点
+ *
+ * 3. 前缀索引：
+ *    - 按小写 BrowseName 排序的节点表，二分查找前缀的起点
+ *    - 少于 3 个字符的查询没有 trigram，按 BrowseName 前缀处理
+ *
+ * 注意事项：
+ *
+ * - 快照中每个节点只记录第一次浏览到它的父节点，多个父节点时浏览路径只有一条
+ * - 索引只读，地址空间变化后需要重新 build()；50 万个节点约需 2 秒
+ * - 50 万个节点时索引约 100 MiB，主要是 trigram 节点列表
+ * - 查询按字节比较，只对 ASCII 字母做大小写转换
+ */
@@ -0,0 +1,209 @@
+/**
+ * @file client_calculated_tags_annotated.cpp
+ * @brief OPC UA 计算 tag 示例 - 把公式编译为字节码，只重新计算受输入变化影响的 tag
+ *
+ * 本示例展示了 CalcEngine 的使用方法，包括：
+ * 1. 启动内置的模拟工厂服务器
+ * 2. 为每个设备定义三个计算 tag：质量流量（Flow1 × 密度）、最近 60 次流量之和、超温锁存
+ * 3. 为每个通道定义总质量流量，引用该通道所有设备的质量流量（第二层计算 tag）
+ * 4. 订阅公式引用的原始 tag，周期性地写入部分设备的流量和温度
+ * 5. 计算结果写入 LastValueCache，与原始 tag 一样按 TagHandle 读取
+ * 6. 输出程序数、计算次数、与每批全部重算相比节省的计算量和每次计算的耗时
+ *
+ * 功能说明：
+ * - 每个设备的同类公式形式相同，只是引用的 tag 不同，编译后共用一个程序
+ * - 一批通知只标记依赖这些 tag 的计算 tag，未受影响的不计算
+ * - 同一程序的计算 tag 一起计算，字节码每条指令对一批实例做一次循环
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 包含必要的头文件
+#include <open62541pp/client.hpp>  // 客户端核心功能
+#include <open62541pp/server.hpp>  // 服务器核心功能
+
+#include "../helper.hpp"            // CliParser - 命令行参数解析器
+#include "calculated_tags.hpp"      // CalcEngine
+#include "collector_types.hpp"      // TagTable
+#include "last_value_cache.hpp"     // LastValueCache
+#include "poll_engine.hpp"          // PollEngine::write
+#include "simulated_plant.hpp"      // SimulatedPlant
+#include "subscription_engine.hpp"  // SubscriptionEngine
+
+// 统计写入批数，用于估算每批全部重算的计算量
+class BatchCounter : public HistorySink {
+public:
+    void write(opcua::Span<const Sample>) override {
+        ++batches;
+    }
+
+    size_t batches = 0;
+};
+
+int main(int argc, char* argv[]) {
+    std::cout << "=== OPC UA 计算 tag 示例 ===" << std::endl;
+
+    // 解析命令行参数
+    // --channels / --devices：模拟工厂的规模，默认 4 × 25（每个设备 18 个 tag）
+    // --seconds <秒>：运行时间，默认 20
+    // --changed <百分比>：每次写入改变的设备比例，默认 10
+    const CliParser parser{argc, argv};
+    const std::chrono::seconds duration{std::stoul(std::string{parser.value("--seconds").value_or("20")})};
+    const double changed = std::stod(std::string{parser.value("--changed").value_or("10")}) / 100.0;
+
+    PlantOptions plantOptions;
+    plantOptions.channels = std::stoul(std::string{parser.value("--channels").value_or("4")});
+    plantOptions.devicesPerChannel = std::stoul(std::string{parser.value("--devices").value_or("25")});
+    plantOptions.tagsPerDevice = 18;
+
+    std::cout << "1. 启动模拟工厂..." << std::endl;
+
+    opcua::ServerConfig config{4840};
+    opcua::Server server{std::move(config)};
+    {
+        const SimulatedPlant plant{server, plantOptions};  // 节点留在服务器中，tag 由公式引用
+    }
+    std::thread serverThread{[&] { server.run(); }};
+    std::cout << "✓ 模拟工厂已启动" << std::endl;
+
+    std::cout << "2. 定义计算 tag..." << std::endl;
+
+    TagTable tags;
+    CalcEngine calc{tags};
+    const auto ref = [](const std::string& path) { return "[ns=1;s=" + path + "]"; };
+    std::vector<TagHandle> channelTotals;
+    for (size_t c = 1; c <= plantOptions.channels; ++c) {
+        const std::string channel = "Channel" + std::to_string(c);
+        std::string total;
+        for (size_t d = 1; d <= plantOptions.devicesPerChannel; ++d) {
+            const std::string device = channel + ".Device" + std::to_string(d);
+            const std::string flow = ref(device + ".Flow1");
+            const std::string temperature = ref(device + ".Temperature1");
+            // 密度随温度线性变化
+            calc.define(opcua::NodeId{1, device + ".MassFlow"}, flow + " * (1000 - 0.5 * " + temperature + ")");
+            calc.define(opcua::NodeId{1, device + ".FlowTotal60"}, "rsum(" + flow + ", 60)");
+            calc.define(
+                opcua::NodeId{1, device + ".Overheat"}, "latch(" + temperature + " > 80, " + temperature + " < 60)"
+            );
+            total += (total.empty() ? "" : " + ") + ref(device + ".MassFlow");
+        }
+        channelTotals.push_back(calc.define(opcua::NodeId{1, channel + ".MassFlowTotal"}, total));
+    }
+    const std::vector<TagHandle> inputs = calc.inputTags();
+    std::cout << "✓ " << calc.calcCount() << " 个计算 tag，" << calc.programCount() << " 个程序，引用 "
+              << inputs.size() << " 个原始 tag" << std::endl;
+
+    std::cout << "3. 订阅原始 tag 并运行 " << duration.count() << " 秒..." << std::endl;
+
+    opcua::Client client;
+    client.connect("opc.tcp://localhost:4840");
+    SubscriptionEngineOptions engineOptions;
+    engineOptions.publishingInterval = 250.0;
+    engineOptions.samplingInterval = 100.0;
+    SubscriptionEngine engine{client, tags, engineOptions};
+    LastValueCache cache;
+    BatchCounter counter;
+    calc.addSink(cache);  // 计算 tag 与原始 tag 使用同一个 TagTable，可以写入任何写入目标
+    engine.addSink("calc", calc);
+    engine.addSink("raw", cache);
+    engine.addSink("counter", counter);
+    engine.addTags(inputs);  // 只订阅原始 tag；计算 tag 在服务器上不存在
+    std::cout << "✓ " << engine.subscriptionCount() << " 个订阅" << std::endl;
+
+    PollEngine writer{client, tags};
+    std::mt19937 random{42};
+    std::uniform_real_distribution<double> flowValue{10.0, 50.0};
+    std::uniform_real_distribution<double> temperatureValue{40.0, 100.0};
+    std::bernoulli_distribution pick{changed};
+    auto nextWrite = std::chrono::steady_clock::now();
+    const auto deadline = nextWrite + duration;
+    while (std::chrono::steady_clock::now() < deadline) {
+        if (std::chrono::steady_clock::now() >= nextWrite) {
+            std::vector<TagWrite> writes;
+            for (size_t c = 1; c <= plantOptions.channels; ++c) {
+                for (size_t d = 1; d <= plantOptions.devicesPerChannel; ++d) {
+                    if (!pick(random)) {
+                        continue;
+                    }
+                    const std::string device = "Channel" + std::to_string(c) + ".Device" + std::to_string(d);
+                    const TagHandle flow = *tags.find(opcua::NodeId{1, device + ".Flow1"});
+                    const TagHandle temperature = *tags.find(opcua::NodeId{1, device + ".Temperature1"});
+                    writes.push_back({flow, opcua::Variant{flowValue(random)}});
+                    writes.push_back({temperature, opcua::Variant{temperatureValue(random)}});
+                }
+            }
+            if (!writes.empty()) {
+                writer.write(writes);
+            }
+            nextWrite += std::chrono::milliseconds{500};
+        }
+        engine.publish();
+        client.runIterate(10);
+    }
+
+    const auto& stats = calc.stats();
+    const double fullEvaluations = static_cast<double>(counter.batches) * static_cast<double>(calc.calcCount());
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "\n4. 结果：" << std::endl;
+    std::cout << "   输入采样 " << stats.samples << "，通知批次 " << counter.batches << std::endl;
+    std::cout << "   计算 " << stats.evaluations << " 次（分 " << stats.batches << " 批），每批全部重算需要 "
+              << fullEvaluations << " 次，节省 "
+              << (fullEvaluations > 0 ? 100.0 * (1.0 - static_cast<double>(stats.evaluations) / fullEvaluations) : 0.0)
+              << "%" << std::endl;
+    std::cout << "   输出 " << stats.outputs << " 个采样，等待输入 " << stats.waiting << " 次，平均 "
+              << (stats.evaluations > 0 ? stats.seconds * 1e9 / static_cast<double>(stats.evaluations) : 0.0)
+              << " 纳秒/次" << std::endl;
+    for (size_t c = 0; c < channelTotals.size(); ++c) {
+        const auto entry = cache.get(channelTotals[c]);
+        std::cout << "   Channel" << c + 1 << ".MassFlowTotal = ";
+        if (entry) {
+            std::cout << entry->sample.value << std::endl;
+        } else {
+            std::cout << "（无数据）" << std::endl;
+        }
+    }
+
+    client.disconnect();
+    server.stop();
+    serverThread.join();
+
+    std::cout << "\n=== 程序已退出 ===" << std::endl;
+    return 0;
+}
+
+/**
+ * 使用说明：
+ *
+ * 1. 运行：./client_calculated_tags_annotated --channels 4 --devices 25 --seconds 20
+ * 2. 修改 --changed 观察受影响的设备比例与计算次数的关系
+ *
+ * 计算 tag 原理：
+ *
+ * 1. 编译：
+ *    - 公式按运算符优先级解析为后缀字节码，tag 引用编译为输入槽位，常量放入常量表
+ *    - 字节码和常量相同的公式共用一个程序，本示例 304 个计算 tag 只有 4 个程序
+ *    - 有状态函数（rsum、latch 等）的状态按计算 tag 分配
+ *
+ * 2. 依赖：
+ *    - 每个原始 tag 对应依赖它的计算 tag 列表，按 TagHandle 平铺存放
+ *    - 计算 tag 按引用深度分层，必须先定义后引用，因此不会成环
+ *
+ * 3. 计算：
+ *    - 一批采样更新输入值并标记依赖的计算 tag，然后逐层计算
+ *    - 同一层中同一程序的计算 tag 每 batchLanes 个一批，每条指令对整批做一次循环
+ *    - 计算结果写回值表，标记更高层的计算 tag，在同一批中继续计算
+ *
+ * 注意事项：
+ *
+ * - 计算 tag 在服务器上不存在，订阅时只使用 inputTags()
+ * - 任一输入尚未收到采样时不输出；状态取输入中最差的一个
+ * - rsum / ravg 的窗口按计算次数而不是时间计，需要按时间统计时先用 Resampler 对齐到网格
+ * - if() 两个分支都会计算；除以 0 得到 inf 或 NaN
+ */
@@ -0,0 +1,266 @@
+/**
+ * @file client_history_backfill_annotated.cpp
+ * @brief OPC UA 历史数据补采示例 - 演示采集器断线或停机后从上游服务器补齐历史数据
+ *
+ * 本示例在 client_subscription_annotated.cpp 的重连循环基础上，展示了：
+ * 1. 订阅多个 tag，把实时采样写入本地历史存储
+ * 2. 本地存储按 tag 检测数据缺口（包括采集器停机期间）
+ * 3. 会话激活后，对缺口批量、并行地发送 HistoryReadRawModified 请求
+ * 4. 跟随续读点（ContinuationPoint）读取完整的历史数据
+ * 5. 限制请求速率和合并速度，补采过程不影响实时采集
+ *
+ * 功能说明：
+ * - 原来的重连循环在断线恢复后只是继续订阅，断线期间的数据永久缺失
+ * - 上游服务器（如 KEPServerEX 的 Local Historian）通常保存了这段时间的历史数据
+ * - 补采引擎只读取支持历史读取（AccessLevel 含 HistoryRead）的节点
+ * - 本地存储带有追加日志文件，采集器重启后同样能检测到停机期间的缺口
+ */
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// 包含必要的头文件
+#include <open62541pp/client.hpp>        // 客户端核心功能
+#include <open62541pp/subscription.hpp>  // 订阅功能
+
+#include "../helper.hpp"         // CliParser - 命令行参数解析器
+#include "collector_types.hpp"   // TagTable、Sample
+#include "history_backfill.hpp"  // HistoryBackfill
+#include "local_store.hpp"       // LocalHistoryStore
+
+// 全局运行状态标志，用于控制程序的运行和停止
+inline static std::atomic<bool> isRunning = true;  // NOLINT(*global-variables)
+
+static void signalHandler(int sig) noexcept {
+    if (sig == SIGINT || sig == SIGTERM) {
+        std::cout << "\n接收到信号 " << sig << "，正在优雅关闭..." << std::endl;
+        isRunning = false;
+    }
+}
+
+// 按逗号拆分 tag 列表
+static std::vector<std::string_view> splitTags(std::string_view list) {
+    std::vector<std::string_view> result;
+    while (!list.empty()) {
+        const auto pos = list.find(',');
+        result.push_back(list.substr(0, pos));
+        if (pos == std::string_view::npos) {
+            break;
+        }
+        list.remove_prefix(pos + 1);
+    }
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "=== OPC UA 历史数据补采示例 ===" << std::endl;
+
+    const CliParser parser{argc, argv};
+    const std::string url{parser.value("--url").value_or("opc.tcp://localhost:49320")};
+    const std::string journal{parser.value("--journal").value_or("collector.journal")};
+    const int lookbackMinutes = std::stoi(std::string{parser.value("--lookback-min").value_or("60")});
+    const double samplingInterval = 1000.0;  // 采样间隔：1 秒
+
+    // 默认使用 KEPServerEX 的 Simulation Examples 通道
+    std::vector<std::string_view> tagNames{
+        "ns=2;s=Simulation Examples.Functions.Ramp1",
+        "ns=2;s=Simulation Examples.Functions.Ramp2",
+        "ns=2;s=Simulation Examples.Functions.Sine1",
+        "ns=2;s=Simulation Examples.Functions.Random1",
+    };
+    if (const auto tags = parser.value("--tags")) {
+        tagNames = splitTags(*tags);
+    }
+
+    std::cout << "1. 创建本地历史存储..." << std::endl;
+
+    // 相邻采样间隔超过 5 个采样周期视为缺口
+    const auto maxGap = static_cast<int64_t>(5 * samplingInterval) * UA_DATETIME_MSEC;
+    LocalHistoryStore store{maxGap, journal};
+    TagTable tags;
+    for (const auto name : tagNames) {
+        store.registerTag(tags.add(parseNodeId(name)));
+    }
+    std::cout << "✓ 已登记 " << tags.size() << " 个 tag，日志中已有 " << store.sampleCount()
+              << " 个采样" << std::endl;
+    if (store.droppedJournalBytes() > 0) {
+        std::cout << "  日志末尾有不完整的记录，已截掉 " << store.droppedJournalBytes() << " 字节" << std::endl;
+    }
+
+    opcua::Client client;
+
+    std::cout << "2. 创建补采引擎..." << std::endl;
+
+    BackfillOptions options{};
+    options.nodesPerRequest = 50;       // 每个请求 50 个节点
+    options.valuesPerNode = 1000;       // 每个节点每次最多 1000 个值
+    options.maxInFlight = 4;            // 最多 4 个并行请求
+    options.maxRequestsPerSecond = 10;  // 每秒最多 10 个请求
+    options.maxSamplesPerStep = 5000;   // 每次循环最多合并 5000 个采样
+    HistoryBackfill backfill{client, tags, store, options};
+
+    // 会话激活回调中只做标记，补采任务在主循环中安排
+    bool sessionActivated = false;
+
+    client.onSessionActivated([&] {
+        std::cout << "会话已激活，开始创建订阅和监控项..." << std::endl;
+
+        opcua::Subscription sub{client};
+        opcua::SubscriptionParameters subscriptionParameters{};
+        subscriptionParameters.publishingInterval = samplingInterval;
+        sub.setSubscriptionParameters(subscriptionParameters);
+        sub.setPublishingMode(true);
+
+        for (TagHandle tag = 0; tag < tags.size(); ++tag) {
+            auto mon = sub.subscribeDataChange(
+                tags.nodeId(tag),
+                opcua::AttributeId::Value,
+                [&store, tag](opcua::IntegerId, opcua::IntegerId, const opcua::DataValue& dv) {
+                    // 实时采样直接写入本地存储
+                    Sample sample{};
+                    if (toSample(*dv.handle(), tag, sample)) {
+                        store.write({&sample, 1});
+                    }
+                }
+            );
+            opcua::MonitoringParametersEx monitoringParameters{};
+            monitoringParameters.samplingInterval = samplingInterval;
+            mon.setMonitoringParameters(monitoringParameters);
+        }
+        std::cout << "✓ 已订阅 " << tags.size() << " 个 tag" << std::endl;
+
+        sessionActivated = true;
+    });
+
+    std::signal(SIGINT, signalHandler);  // NOLINT
+    std::signal(SIGTERM, signalHandler);  // NOLINT
+
+    std::cout << "正在启动客户端主循环..." << std::endl;
+    std::cout << "按 Ctrl+C 停止程序" << std::endl;
+
+    auto lastReport = std::chrono::steady_clock::now();
+
+    while (isRunning) {
+        try {
+            std::cout << "正在连接到服务器 " << url << "..." << std::endl;
+            client.connect(url);
+            std::cout << "✓ 连接成功！" << std::endl;
+
+            while (isRunning) {
+                // 每次迭代最多等待 50 毫秒，补采的发送和合并穿插在实时通知之间
+                client.runIterate(50);
+
+                if (sessionActivated) {
+                    sessionActivated = false;
+                    backfill.resetSession();
+                    if (!backfill.serverSupportsHistory()) {
+                        std::cout << "服务器不支持历史数据访问，跳过补采" << std::endl;
+                        continue;
+                    }
+                    // 检测回溯窗口内的缺口
+                    const int64_t now = UA_DateTime_now();
+                    const int64_t from = now - int64_t{lookbackMinutes} * 60 * UA_DATETIME_SEC;
+                    const auto gaps = store.findGaps(from, now);
+                    const size_t queued = backfill.schedule(gaps);
+                    std::cout << "检测到 " << gaps.size() << " 个缺口，已安排 " << queued
+                              << " 个补采任务" << std::endl;
+                }
+
+                backfill.step();
+
+                const auto t = std::chrono::steady_clock::now();
+                if (!backfill.idle() && t - lastReport > std::chrono::seconds{2}) {
+                    lastReport = t;
+                    const auto& stats = backfill.stats();
+                    std::cout << "补采进度: 请求 " << stats.requestsSent
+                              << "，续读 " << stats.continuations
+                              << "，已合并采样 " << stats.samplesMerged
+                              << "，排队节点 " << backfill.queuedNodes() << std::endl;
+                }
+            }
+
+        } catch (const opcua::BadStatus& e) {
+            std::cout << "连接错误: " << e.what() << std::endl;
+            client.disconnect();
+            std::cout << "3 秒后重试连接..." << std::endl;
+            std::this_thread::sleep_for(std::chrono::seconds{3});
+        }
+    }
+
+    std::cout << "程序正在关闭..." << std::endl;
+
+    backfill.cancel();
+    try {
+        client.disconnect();
+        std::cout << "✓ 已断开连接" << std::endl;
+    } catch (const std::exception& e) {
+        std::cout << "断开连接时发生错误: " << e.what() << std::endl;
+    }
+
+    const auto& stats = backfill.stats();
+    std::cout << "\n=== 补采统计 ===" << std::endl;
+    std::cout << "HistoryRead 请求:  " << stats.requestsSent << std::endl;
+    std::cout << "续读次数:          " << stats.continuations << std::endl;
+    std::cout << "合并采样:          " << stats.samplesMerged << std::endl;
+    std::cout << "失败节点:          " << stats.nodesFailed << std::endl;
+    std::cout << "不支持历史的节点:  " << stats.nodesSkipped << std::endl;
+    std::cout << "本地存储采样总数:  " << store.sampleCount() << std::endl;
+
+    std::cout << "=== 程序已退出 ===" << std::endl;
+    return 0;
+}
+
+/**
+ * 使用说明：
+ *
+ * 1. 确保上游服务器开启了历史数据功能（例如 KEPServerEX 的 Local Historian）
+ * 2. 运行程序：./client_history_backfill_annotated --url opc.tcp://host:49320 --tags "ns=2;s=A,ns=2;s=B"
+ * 3. 停止程序或断开网络若干分钟后恢复，观察补采进度
+ * 4. 可选参数：--journal 本地日志文件，--lookback-min 缺口检测的回溯时间（分钟）
+ *
+ * 补采流程：
+ *
+ * 1. 缺口检测：
+ *    - 本地存储为每个 tag 保存按时间排序的采样
+ *    - 相邻采样间隔超过最大间隔（采样周期的 5 倍）视为缺口
+ *    - 最后一个采样到当前时间的间隔同样视为缺口（断线或停机期间）
+ *
+ * 2. 任务安排：
+ *    - 一个 Read 请求批量读取所有相关节点的 AccessLevel
+ *    - 没有 HistoryRead 权限的节点直接跳过
+ *    - 缺口范围按 1 分钟对齐，对齐后范围相同的节点共享同一个 ReadRawModifiedDetails
+ *
+ * 3. 请求发送：
+ *    - 每个 HistoryRead 请求包含最多 50 个节点
+ *    - 最多 4 个请求同时进行，令牌桶限制每秒请求数
+ *    - 返回续读点的节点重新排队，带着续读点读取下一段数据
+ *
+ * 4. 数据合并：
+ *    - 响应在回调中转换为 Sample 并暂存
+ *    - 每次 step() 最多写入 maxSamplesPerStep 个采样
+ *    - 暂存数据积压时暂停发送新请求
+ *    - 本地存储按时间插入，和实时数据重复的时间戳会被忽略
+ *
+ * 5. 断线处理：
+ *    - 断线时未完成请求的回调带错误状态码返回，节点从已合并的位置重新排队
+ *    - 重连后 resetSession() 丢弃失效的续读点
+ *
+ * 注意事项：
+ *
+ * - 补采引擎的回调在 runIterate() 中执行，step() 必须在同一线程调用
+ * - 时间范围对齐会多读少量数据，重复的采样在合并时被丢弃
+ * - 本地存储只保存数值型数据，字符串等类型的采样会被忽略
+ * - 日志文件只追加不压缩，长期运行需要定期归档
+ *
+ * 性能考虑：
+ *
+ * - nodesPerRequest 越大，请求数越少，但单个响应越大
+ * - valuesPerNode 限制单个响应的大小，服务器可能使用更小的值
+ * - maxRequestsPerSecond 和 maxSamplesPerStep 决定补采对实时采集的影响
+ */
@@ -0,0 +1,267 @@
+/**
+ * @file client_model_change_sync_annotated.cpp
+ * @brief OPC UA 地址空间增量同步示例 - 演示根据模型变化事件只重新浏览受影响的子树
+ *
+ * 本示例展示了 address_sync.hpp 的使用方法，包括：
+ * 1. 启动内置的模拟工厂服务器，爬取地址空间并为所有变量创建监控项
+ * 2. 在 Server 对象上订阅 GeneralModelChangeEvent / SemanticChangeEvent
+ * 3. 服务器运行中增加、删除设备并发出模型变化事件（模拟修改 KEPServerEX 的配置）
+ * 4. 采集器只重新浏览受影响的子树，修补快照、搜索索引、TagTable 和监控项
+ *
+ * 功能说明：
+ * - 原来服务器配置变化后只能重新爬取整个地址空间并重建所有订阅，期间采集中断
+ * - 模型变化事件给出受影响的节点，采集器把它们换算成需要重新浏览的最小子树，
+ *   与快照比较后只处理新增、删除和修改的节点
+ * - 未受影响的 tag 的监控项和 TagHandle 保持不变，写入目标看不到任何中断
+ */
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 包含必要的头文件
+#include <open62541pp/client.hpp>  // 客户端核心功能
+#include <open62541pp/server.hpp>  // 服务器核心功能
+
+#include "../helper.hpp"             // CliParser - 命令行参数解析器
+#include "address_crawler.hpp"       // AddressSpaceCrawler
+#include "address_index.hpp"         // AddressSpaceIndex
+#include "address_sync.hpp"          // AddressSpaceSync
+#include "simulated_plant.hpp"       // SimulatedPlant
+#include "subscription_engine.hpp"   // SubscriptionEngine
+
+// 全局运行状态标志，用于控制程序的运行和停止
+inline static std::atomic<bool> isRunning = true;  // NOLINT(*global-variables)
+
+static void signalHandler(int sig) noexcept {
+    if (sig == SIGINT || sig == SIGTERM) {
+        std::cout << "\n接收到信号 " << sig << "，正在退出..." << std::endl;
+        isRunning = false;
+    }
+}
+
+// 统计收到采样的 tag 数
+class CountingSink : public HistorySink {
+public:
+    void write(opcua::Span<const Sample> samples) override {
+        for (const auto& sample : samples) {
+            if (sample.tag >= seen_.size()) {
+                seen_.resize(static_cast<size_t>(sample.tag) + 1, false);
+            }
+            seen_[sample.tag] = true;
+        }
+        samples_ += samples.size();
+    }
+
+    size_t samples() const noexcept {
+        return samples_;
+    }
+
+    bool seen(TagHandle tag) const noexcept {
+        return tag < seen_.size() && seen_[tag];
+    }
+
+private:
+    std::vector<bool> seen_;
+    size_t samples_ = 0;
+};
+
+static void printState(
+    const AddressSpaceSnapshot& snapshot, const TagTable& tags, const SubscriptionEngine& engine
+) {
+    size_t nodes = 0;
+    for (NodeIndex node = 0; node < snapshot.size(); ++node) {
+        nodes += snapshot.removed(node) ? 0 : 1;
+    }
+    size_t activeTags = 0;
+    for (TagHandle tag = 0; tag < tags.size(); ++tag) {
+        activeTags += tags.active(tag) ? 1 : 0;
+    }
+    std::cout << "   快照 " << nodes << " 个节点，tag " << activeTags << " 个（已分配 handle " << tags.size()
+              << "），监控项 " << engine.itemCount() << " 个，订阅 " << engine.subscriptionCount() << " 个"
+              << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "=== OPC UA 地址空间增量同步示例 ===" << std::endl;
+
+    // 解析命令行参数
+    // --channels / --devices / --tags：模拟工厂的规模，默认 2 × 5 × 20
+    const CliParser parser{argc, argv};
+    PlantOptions plantOptions;
+    plantOptions.channels = std::stoul(std::string{parser.value("--channels").value_or("2")});
+    plantOptions.devicesPerChannel = std::stoul(std::string{parser.value("--devices").value_or("5")});
+    plantOptions.tagsPerDevice = std::stoul(std::string{parser.value("--tags").value_or("20")});
+
+    std::signal(SIGINT, signalHandler);   // NOLINT
+    std::signal(SIGTERM, signalHandler);  // NOLINT
+
+    std::cout << "1. 启动模拟工厂..." << std::endl;
+
+    opcua::ServerConfig config{4840};
+    opcua::Server server{std::move(config)};
+    SimulatedPlant plant{server, plantOptions};
+
+    // 服务器线程中按计划修改配置：3 秒后增加设备，6 秒后删除设备，9 秒后删除并重建一个设备
+    int step = 0;
+    opcua::addRepeatedCallback(
+        server,
+        [&] {
+            ++step;
+            if (step == 3) {
+                const auto id = plant.addDevice(1, plantOptions.devicesPerChannel + 1, plantOptions.tagsPerDevice);
+                plant.emitModelChange({{id, model_change::nodeAdded | model_change::referenceAdded}});
+                std::cout << "\n[服务器] 增加设备 " << opcua::toString(id) << std::endl;
+            } else if (step == 6 && plantOptions.channels >= 2) {
+                const auto id = plant.removeDevice(2, 1);
+                plant.emitModelChange({{id, model_change::nodeDeleted | model_change::referenceDeleted}});
+                std::cout << "\n[服务器] 删除设备 " << opcua::toString(id) << std::endl;
+            } else if (step == 9) {
+                // 重建设备：tag 数减半，相当于修改了设备的 tag 配置
+                plant.removeDevice(1, 1);
+                const auto id = plant.addDevice(1, 1, plantOptions.tagsPerDevice / 2);
+                plant.emitModelChange({{id, model_change::nodeDeleted | model_change::nodeAdded}});
+                std::cout << "\n[服务器] 重建设备 " << opcua::toString(id) << "（" << plantOptions.tagsPerDevice / 2
+                          << " 个 tag）" << std::endl;
+            }
+        },
+        1000
+    );
+    std::thread serverThread{[&] { server.run(); }};
+    std::cout << "✓ " << plant.nodeCount() << " 个节点" << std::endl;
+
+    std::cout << "2. 爬取地址空间并创建监控项..." << std::endl;
+
+    opcua::Client client;
+    client.connect("opc.tcp://localhost:4840");
+    AddressSpaceSnapshot snapshot;
+    AddressSpaceCrawler crawler{client};
+    crawler.crawl(opcua::NodeId{opcua::ObjectId::ObjectsFolder}, snapshot);
+    AddressSpaceIndex index{snapshot};
+
+    TagTable tags;
+    for (NodeIndex node = 0; node < snapshot.size(); ++node) {
+        if (snapshot.nodeClass(node) == opcua::NodeClass::Variable) {
+            tags.add(snapshot.nodeId(node));
+        }
+    }
+    SubscriptionEngineOptions engineOptions;
+    engineOptions.publishingInterval = 200.0;
+    engineOptions.samplingInterval = 100.0;
+    engineOptions.itemsPerSubscription = 100;
+    SubscriptionEngine engine{client, tags, engineOptions};
+    CountingSink sink;
+    engine.addSink("count", sink);
+    engine.create();
+    printState(snapshot, tags, engine);
+
+    std::cout << "3. 订阅模型变化事件..." << std::endl;
+
+    // 事件订阅使用单独的会话：opcua::Subscription 的 Publish 请求会取走同一会话中
+    // SubscriptionEngine 订阅的通知
+    opcua::Client watchClient;
+    watchClient.connect("opc.tcp://localhost:4840");
+    AddressSpaceSyncOptions syncOptions;
+    syncOptions.debounce = std::chrono::milliseconds{300};
+    AddressSpaceSync sync{watchClient, snapshot, index, tags, engine, syncOptions};
+    sync.subscribe();
+    std::cout << "✓ 已在 Server 对象上订阅 GeneralModelChangeEvent / SemanticChangeEvent" << std::endl;
+
+    std::cout << "4. 运行中（约 12 秒，Ctrl+C 提前退出）..." << std::endl;
+
+    const auto startedAt = std::chrono::steady_clock::now();
+    while (isRunning && std::chrono::steady_clock::now() - startedAt < std::chrono::seconds{12}) {
+        client.runIterate(20);
+        watchClient.runIterate(20);
+        engine.publish();
+        const auto t0 = std::chrono::steady_clock::now();
+        if (sync.poll()) {
+            const auto t1 = std::chrono::steady_clock::now();
+            const auto& stats = sync.stats();
+            std::cout << "[采集器] 已同步，用时 " << std::chrono::duration<double, std::milli>(t1 - t0).count()
+                      << " 毫秒：累计新增节点 " << stats.nodesAdded << "，删除 " << stats.nodesRemoved << "，tag +"
+                      << stats.tagsAdded << " / -" << stats.tagsRemoved << "，重新浏览子树 " << stats.resyncs
+                      << std::endl;
+            printState(snapshot, tags, engine);
+
+            // 索引已经包含新节点
+            SearchQuery query{"Device" + std::to_string(plantOptions.devicesPerChannel + 1)};
+            query.limit = 3;
+            for (const NodeIndex node : index.search(snapshot, query).nodes) {
+                std::cout << "   搜索到 " << snapshot.browsePath(node) << std::endl;
+            }
+        }
+    }
+
+    // 新增的 tag 应当已经收到采样
+    size_t newTags = 0;
+    size_t newTagsWithData = 0;
+    for (TagHandle tag = 0; tag < tags.size(); ++tag) {
+        const auto name = opcua::toString(tags.nodeId(tag));
+        if (tags.active(tag) &&
+            name.find(".Device" + std::to_string(plantOptions.devicesPerChannel + 1) + ".") != std::string::npos) {
+            ++newTags;
+            newTagsWithData += sink.seen(tag) ? 1 : 0;
+        }
+    }
+
+    watchClient.disconnect();
+    client.disconnect();
+    server.stop();
+    serverThread.join();
+
+    const auto& stats = sync.stats();
+    std::cout << "\n=== 运行统计 ===" << std::endl;
+    std::cout << "模型变化事件:     " << stats.events << std::endl;
+    std::cout << "变化条目:         " << stats.changes << std::endl;
+    std::cout << "重新浏览子树:     " << stats.resyncs << "（全量 " << stats.fullResyncs << "，失败重试 "
+              << stats.failedResyncs << "）" << std::endl;
+    std::cout << "节点 新增/删除/修改: " << stats.nodesAdded << " / " << stats.nodesRemoved << " / "
+              << stats.nodesUpdated << std::endl;
+    std::cout << "tag 新增/删除:    " << stats.tagsAdded << " / " << stats.tagsRemoved << std::endl;
+    std::cout << "采样:             " << sink.samples() << std::endl;
+    std::cout << "新设备的 tag:     " << newTagsWithData << " / " << newTags << " 已收到采样" << std::endl;
+
+    std::cout << "=== 程序已退出 ===" << std::endl;
+    return 0;
+}
+
+/**
+ * 使用说明：
+ *
+ * 1. 运行：./client_model_change_sync_annotated --channels 2 --devices 5 --tags 20
+ * 2. 观察服务器每次修改配置后采集器的同步输出：只重新浏览一个设备或通道
+ * 3. 对接外部服务器时，先用 UaExpert 确认服务器在 Server 对象上发出模型变化事件
+ *
+ * 同步原理：
+ *
+ * 1. 事件：
+ *    - 在 Server 对象上订阅，选择字段为 SourceNode 和两种事件的 Changes
+ *    - Where 子句：OfType(BaseModelChangeEventType) 或 OfType(SemanticChangeEventType)
+ *    - Changes 中每个条目给出受影响的节点和 verb（NodeAdded、NodeDeleted、ReferenceAdded……）
+ *    - 没有 Changes 的 BaseModelChangeEvent 按 SourceNode 处理，仍无法确定时从根节点重新浏览
+ *
+ * 2. 合并：
+ *    - 一次配置修改通常产生一串事件，最后一个事件之后 debounce 时间内没有新事件才处理
+ *    - 已知的对象重新浏览自身；变量和被删除的节点重新浏览父节点
+ *    - 快照中没有的新节点通过反向浏览（Inverse HierarchicalReferences）找到已知的父节点
+ *    - 被其他子树包含的子树不再单独浏览
+ *
+ * 3. 修补：
+ *    - 子树重新浏览到临时快照中，与原快照比较
+ *    - 新节点追加到快照，删除的节点保留编号、标记为已删除，改名的节点更新名称
+ *    - 搜索索引把变化的节点放入追加区，主索引不重建
+ *    - 删除的 tag 从 TagTable 移除（handle 不再复用），按订阅分组删除监控项
+ *    - 新 tag 分配新的 handle，优先填入已有订阅的空位，剩余的创建新订阅
+ *
+ * 注意事项：
+ *
+ * - 事件订阅使用单独的会话，避免 opcua::Subscription 和 SubscriptionEngine 争抢 Publish 响应
+ * - open62541 服务器需要完整的命名空间 0（UA_NAMESPACE_ZERO=FULL）才有 GeneralModelChangeEventType
+ * - 服务器不发出模型变化事件时，可以定期调用 notifyAll() 做全量比较，代价与重新爬取相同
+ * - 重新浏览在主循环中同步进行，大的子树会短暂推迟 Publish 请求
+ */
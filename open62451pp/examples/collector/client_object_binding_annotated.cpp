@@ -0,0 +1,227 @@
+/**
+ * @file client_object_binding_annotated.cpp
+ * @brief OPC UA 对象绑定示例 - 把 DogType 的多个实例批量读取、订阅为 C++ 结构体
+ *
+ * 本示例展示了 ObjectBinding 和 ObjectBinder 的使用方法，包括：
+ * 1. 启动内置服务器，按 server_instantiation_annotated.cpp 创建 MammalType、DogType 和 N 个狗对象
+ * 2. 逐个字段读取：每个实例的每个字段一次 browseChild() 和一次 readValue()
+ * 3. 绑定读取：一次定义 Dog 结构体与 DogType 子节点的映射，批量解析路径、批量读取
+ * 4. 订阅：所有字段通过 SubscriptionEngine 订阅，一个 Write 请求修改所有狗的年龄，按实例输出结构体更新
+ *
+ * 功能说明：
+ * - 逐个字段访问时请求数是实例数 × 字段数 × 2，且每次都要等待往返
+ * - 绑定后路径解析是 TranslateBrowsePathsToNodeIds 的批量请求，读取是 Read 的批量请求
+ * - 通知按 TagHandle 直接定位实例和字段，同一帧中一个实例的多个字段只触发一次更新
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 包含必要的头文件
+#include <open62541/client_highlevel.h>  // UA_Client_Service_write
+
+#include <open62541pp/client.hpp>  // 客户端核心功能
+#include <open62541pp/node.hpp>    // 节点操作
+#include <open62541pp/server.hpp>  // 服务器核心功能
+
+#include "../helper.hpp"            // CliParser - 命令行参数解析器
+#include "collector_types.hpp"      // TagTable
+#include "object_binding.hpp"       // ObjectBinding、ObjectBinder
+#include "subscription_engine.hpp"  // SubscriptionEngine
+
+using Clock = std::chrono::steady_clock;
+
+// 与 DogType 对应的结构体；Age 继承自 MammalType
+struct Dog {
+    uint32_t age = 0;
+    std::string name;
+};
+
+// 创建 MammalType、DogType 和 count 个实例，返回实例的 NodeId
+static std::vector<opcua::NodeId> createDogs(opcua::Server& server, size_t count) {
+    opcua::Node nodeBaseObjectType{server, opcua::ObjectTypeId::BaseObjectType};
+    auto nodeMammalType = nodeBaseObjectType.addObjectType(
+        {1, 10000}, "MammalType", opcua::ObjectTypeAttributes{}.setDisplayName({"en-US", "MammalType"})
+    );
+    nodeMammalType
+        .addVariable(
+            {1, 10001},
+            "Age",
+            opcua::VariableAttributes{}.setDisplayName({"en-US", "Age"}).setValue(opcua::Variant{0U})
+        )
+        .addModellingRule(opcua::ModellingRule::Mandatory);
+    auto nodeDogType = nodeMammalType.addObjectType(
+        {1, 10002}, "DogType", opcua::ObjectTypeAttributes{}.setDisplayName({"en-US", "DogType"})
+    );
+    nodeDogType
+        .addVariable(
+            {1, 10003},
+            "Name",
+            opcua::VariableAttributes{}.setDisplayName({"en-US", "Name"}).setValue(opcua::Variant{"unnamed dog"})
+        )
+        .addModellingRule(opcua::ModellingRule::Mandatory);
+
+    opcua::Node nodeObjects{server, opcua::ObjectId::ObjectsFolder};
+    std::vector<opcua::NodeId> dogs;
+    for (size_t i = 0; i < count; ++i) {
+        const std::string name = "Dog" + std::to_string(i);
+        auto nodeDog = nodeObjects.addObject(
+            {1, static_cast<uint32_t>(20000 + i)},
+            name,
+            opcua::ObjectAttributes{}.setDisplayName({"en-US", name}),
+            nodeDogType.id()
+        );
+        // 子节点由服务器实例化，NodeId 由服务器分配
+        nodeDog.browseChild({{1, "Age"}}).writeValue(opcua::Variant{static_cast<uint32_t>(i % 180)});
+        nodeDog.browseChild({{1, "Name"}}).writeValue(opcua::Variant{name});
+        dogs.push_back(nodeDog.id());
+    }
+    return dogs;
+}
+
+// 用一个 Write 请求设置所有狗的年龄
+static void writeAges(opcua::Client& client, const ObjectBinder<Dog>& binder, uint32_t age) {
+    std::vector<UA_WriteValue> items(binder.instanceCount());
+    for (size_t i = 0; i < items.size(); ++i) {
+        UA_WriteValue_init(&items[i]);
+        items[i].nodeId = *binder.fieldNodeId(i, 0).handle();  // 浅拷贝
+        items[i].attributeId = UA_ATTRIBUTEID_VALUE;
+        items[i].value.hasValue = true;
+        UA_Variant_setScalar(&items[i].value.value, &age, &UA_TYPES[UA_TYPES_UINT32]);
+    }
+    UA_WriteRequest request;
+    UA_WriteRequest_init(&request);
+    request.nodesToWrite = items.data();
+    request.nodesToWriteSize = items.size();
+    UA_WriteResponse response = UA_Client_Service_write(client.handle(), request);
+    UA_WriteResponse_clear(&response);
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "=== OPC UA 对象绑定示例 ===" << std::endl;
+
+    // 解析命令行参数
+    // --dogs <数量>：DogType 实例数，默认 1000
+    // --seconds <秒>：订阅运行时间，默认 5
+    const CliParser parser{argc, argv};
+    const size_t dogCount = std::stoul(std::string{parser.value("--dogs").value_or("1000")});
+    const std::chrono::seconds duration{std::stoul(std::string{parser.value("--seconds").value_or("5")})};
+
+    std::cout << "1. 启动服务器并创建 " << dogCount << " 个 DogType 实例..." << std::endl;
+
+    opcua::ServerConfig config{4840};
+    opcua::Server server{std::move(config)};
+    const std::vector<opcua::NodeId> dogs = createDogs(server, dogCount);
+    std::thread serverThread{[&] { server.run(); }};
+    std::cout << "✓ 服务器已启动" << std::endl;
+
+    opcua::Client client;
+    client.connect("opc.tcp://localhost:4840");
+    std::cout << std::fixed << std::setprecision(3);
+
+    std::cout << "\n2. 逐个字段读取..." << std::endl;
+    {
+        const auto t0 = Clock::now();
+        std::vector<Dog> values(dogs.size());
+        for (size_t i = 0; i < dogs.size(); ++i) {
+            opcua::Node nodeDog{client, dogs[i]};
+            values[i].age = nodeDog.browseChild({{1, "Age"}}).readValue().to<uint32_t>();
+            values[i].name = nodeDog.browseChild({{1, "Name"}}).readValue().to<std::string>();
+        }
+        const double seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+        std::cout << "✓ " << dogs.size() * 4 << " 个请求，" << seconds << " 秒；" << values.back().name << " 的年龄 "
+                  << values.back().age << std::endl;
+    }
+
+    std::cout << "\n3. 绑定读取..." << std::endl;
+
+    // 映射只定义一次，与实例数无关
+    ObjectBinding<Dog> binding;
+    binding.field("1:Age", &Dog::age).field("1:Name", &Dog::name);
+    ObjectBinder<Dog> binder{client, binding};
+    {
+        const auto t0 = Clock::now();
+        const size_t bound = binder.bind(dogs);
+        const double bindSeconds = std::chrono::duration<double>(Clock::now() - t0).count();
+        const auto t1 = Clock::now();
+        const size_t updated = binder.read();
+        const double readSeconds = std::chrono::duration<double>(Clock::now() - t1).count();
+        const auto& stats = binder.stats();
+        std::cout << "✓ 解析 " << bound << " 个字段（缺失 " << stats.fieldsMissing << "），" << stats.translateRequests
+                  << " 个请求，" << bindSeconds << " 秒" << std::endl;
+        std::cout << "✓ 读取 " << updated << " 个实例，" << stats.readRequests << " 个请求，" << readSeconds
+                  << " 秒；" << binder.values().back().name << " 的年龄 " << binder.values().back().age << std::endl;
+    }
+
+    std::cout << "\n4. 订阅所有字段，运行 " << duration.count() << " 秒，每秒修改一次所有狗的年龄..." << std::endl;
+
+    TagTable tags;
+    SubscriptionEngineOptions engineOptions;
+    engineOptions.publishingInterval = 250.0;
+    engineOptions.samplingInterval = 100.0;
+    SubscriptionEngine engine{client, tags, engineOptions};
+    size_t updates = 0;
+    uint32_t lastAge = 0;
+    binder.onUpdate([&](size_t, const Dog& dog) {
+        ++updates;
+        lastAge = dog.age;
+    });
+    const size_t items = binder.subscribe(engine, tags);
+    std::cout << "✓ " << engine.subscriptionCount() << " 个订阅，" << items << " 个监控项" << std::endl;
+
+    uint32_t age = 1000;
+    auto nextWrite = Clock::now() + std::chrono::seconds{1};
+    const auto deadline = Clock::now() + duration;
+    while (Clock::now() < deadline) {
+        if (Clock::now() >= nextWrite) {
+            writeAges(client, binder, ++age);
+            nextWrite += std::chrono::seconds{1};
+        }
+        engine.publish();
+        client.runIterate(10);
+    }
+    const auto& stats = binder.stats();
+    std::cout << "✓ 帧 " << stats.frames << " 个，实例更新 " << updates << " 次，最后的年龄 " << lastAge << "（写入 "
+              << age << "）" << std::endl;
+
+    client.disconnect();
+    server.stop();
+    serverThread.join();
+
+    std::cout << "\n=== 程序已退出 ===" << std::endl;
+    return 0;
+}
+
+/**
+ * 使用说明：
+ *
+ * 1. 运行：./client_object_binding_annotated --dogs 1000 --seconds 5
+ * 2. 实例数越多，逐个字段读取与绑定读取的差距越大
+ *
+ * 对象绑定原理：
+ *
+ * 1. 映射：
+ *    - ObjectBinding<T>::field() 把成员指针和相对浏览路径（"1:Age"、"1:Motor/1:Speed"）登记为一个字段
+ *    - 字段的赋值函数按成员类型生成，只有一份，与实例数无关
+ *
+ * 2. 绑定：
+ *    - bind() 为每个实例的每个字段生成一条 BrowsePath（起点是实例，沿层次引用查找），
+ *      每个 TranslateBrowsePathsToNodeIds 请求最多 pathsPerRequest 条
+ *    - 结果保存在实例 × 字段的平坦数组中，同时预先构建 Read 请求的 ReadValueId 数组
+ *
+ * 3. 读取和订阅：
+ *    - read() 直接发送预先构建的 Read 请求，第 i 个结果对应的实例和字段在构建时已经记录
+ *    - subscribe() 把字段加入 TagTable，按 TagHandle 记录实例和字段，再由 SubscriptionEngine 批量创建监控项
+ *    - 每个 Publish 响应作为一帧交付，帧内更新过的实例在帧结束时各回调一次
+ *
+ * 注意事项：
+ *
+ * - 实例中不存在的字段（例如可选子节点）不读取、不订阅，结构体成员保持默认值
+ * - 值的类型与成员不匹配时（例如 Name 绑定到整数成员）忽略该值
+ * - 实例删除或类型改变后需要重新 bind()
+ */
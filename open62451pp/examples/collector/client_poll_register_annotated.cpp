@@ -0,0 +1,235 @@
+/**
+ * @file client_poll_register_annotated.cpp
+ * @brief OPC UA 轮询采集示例 - 比较使用原始 NodeId 和 RegisterNodes 别名时的请求大小与延迟
+ *
+ * 本示例展示了 poll_engine.hpp 的使用方法，包括：
+ * 1. 启动内置的模拟工厂服务器，或连接外部服务器（例如 KEPServerEX）
+ * 2. 每个设备的 tag 组成一个轮询组，按固定周期批量读取
+ * 3. 分别在每个周期重新构建请求、复用 ReadValueId 数组、注册节点（RegisterNodes）后使用别名三种方式下运行，
+ *    统计每个 Read 请求的字节数、往返时间，以及构建请求和发送请求各自的耗时
+ * 4. 批量写入一轮设定值，写入请求同样使用别名
+ *
+ * 功能说明：
+ * - KEPServerEX 的 tag 使用字符串 NodeId，例如 ns=2;s=Channel1.Device1.Tag5，
+ *   每个 ReadValueId 都带着完整的字符串，服务器每次都要按字符串查找节点
+ * - RegisterNodes 让服务器为这些节点返回经过优化的别名（通常是数值 NodeId），
+ *   之后的读写请求使用别名，请求更小，服务器查找更快
+ * - 别名只在当前会话有效，重新连接后由 resetSession() 触发重新注册
+ * - 固定轮询组每个周期读取相同的节点，ReadValueId 数组按组构建一次后每个周期复用
+ */
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 包含必要的头文件
+#include <open62541pp/client.hpp>  // 客户端核心功能
+#include <open62541pp/server.hpp>  // 服务器核心功能
+
+#include "../helper.hpp"        // CliParser - 命令行参数解析器
+#include "collector_types.hpp"  // TagTable、HistorySink、parseNodeId
+#include "poll_engine.hpp"      // PollEngine
+#include "simulated_plant.hpp"  // SimulatedPlant
+
+// 只计数，不保存
+class CountingSink : public HistorySink {
+public:
+    void write(opcua::Span<const Sample> samples) override {
+        count += samples.size();
+    }
+
+    size_t count = 0;
+};
+
+static void runPolling(
+    const std::string& url,
+    const std::vector<std::vector<opcua::NodeId>>& devices,
+    const PollEngineOptions& options,
+    std::chrono::milliseconds interval,
+    std::chrono::seconds duration
+) {
+    opcua::Client client;
+    client.connect(url);
+
+    TagTable tags;
+    PollEngine engine{client, tags, options};
+    CountingSink sink;
+    engine.addSink(sink);
+    client.onSessionActivated([&] { engine.resetSession(); });
+
+    std::vector<TagWrite> writes;
+    for (const auto& device : devices) {
+        std::vector<TagHandle> group;
+        for (const auto& id : device) {
+            group.push_back(tags.add(id));
+        }
+        // 每个设备的第一个 tag（Temperature1）写入设定值
+        writes.push_back({group.front(), opcua::Variant{20.0}});
+        engine.addGroup(std::move(group), interval);
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + duration;
+    while (std::chrono::steady_clock::now() < deadline) {
+        engine.poll();
+        client.runIterate(5);
+    }
+    const auto readStats = engine.stats();
+    const size_t readBytes = readStats.requestBytes;
+
+    const auto t0 = std::chrono::steady_clock::now();
+    const size_t written = engine.write(writes);
+    const double writeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    const auto& stats = engine.stats();
+
+    std::cout << "     轮询 " << stats.cycles << " 次，超时跳过 " << stats.overruns << " 次，采样 " << sink.count
+              << std::endl;
+    std::cout << "     构建 Read 请求 " << readStats.requestBuilds << " 个，耗时 " << std::setprecision(2)
+              << readStats.prepareSeconds * 1000.0 << " 毫秒；发送耗时 " << readStats.sendSeconds * 1000.0
+              << " 毫秒" << std::endl;
+    if (options.registerNodes) {
+        std::cout << "     RegisterNodes 请求 " << stats.registerRequests << "，注册 " << stats.registeredNodes
+                  << " 个节点" << std::endl;
+    }
+    if (readStats.readRequests > 0 && readStats.responses > 0) {
+        std::cout << "     Read 请求 " << readStats.readRequests << "，平均 "
+                  << readBytes / readStats.readRequests << " 字节，平均往返 " << std::setprecision(2)
+                  << readStats.latencySeconds * 1000.0 / static_cast<double>(readStats.responses) << " 毫秒"
+                  << std::endl;
+    }
+    if (stats.writeRequests > 0) {
+        std::cout << "     Write 请求 " << stats.writeRequests << "，平均 "
+                  << (stats.requestBytes - readBytes) / stats.writeRequests << " 字节，写入成功 " << written
+                  << " / " << writes.size() << "，用时 " << writeSeconds * 1000.0 << " 毫秒" << std::endl;
+    }
+    client.disconnect();
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "=== OPC UA 轮询采集示例 ===" << std::endl;
+
+    // 解析命令行参数
+    // --url <地址>：外部服务器地址；不指定时启动内置的模拟工厂
+    // --nodes <文件>：外部服务器的 NodeId 列表（每行一个，例如 ns=2;s=Channel1.Device1.Tag5），
+    //                  每 --group 个组成一个轮询组
+    // --channels / --devices / --tags：模拟工厂的规模，默认 4 × 25 × 50
+    // --interval <毫秒>：轮询周期，默认 1000
+    // --seconds <秒>：每种方式运行的时间，默认 10
+    const CliParser parser{argc, argv};
+    const auto externalUrl = parser.value("--url");
+    const std::chrono::milliseconds interval{std::stoul(std::string{parser.value("--interval").value_or("1000")})};
+    const std::chrono::seconds duration{std::stoul(std::string{parser.value("--seconds").value_or("10")})};
+
+    PlantOptions plantOptions;
+    plantOptions.channels = std::stoul(std::string{parser.value("--channels").value_or("4")});
+    plantOptions.devicesPerChannel = std::stoul(std::string{parser.value("--devices").value_or("25")});
+    plantOptions.tagsPerDevice = std::stoul(std::string{parser.value("--tags").value_or("50")});
+
+    std::cout << "1. 准备服务器和轮询组..." << std::endl;
+
+    opcua::ServerConfig config{4840};
+    opcua::Server server{std::move(config)};
+    std::thread serverThread;
+    std::string url;
+    std::vector<std::vector<opcua::NodeId>> devices;
+    if (externalUrl) {
+        url = std::string{*externalUrl};
+        const size_t groupSize = std::stoul(std::string{parser.value("--group").value_or("50")});
+        std::ifstream file{std::string{parser.value("--nodes").value_or("nodes.txt")}};
+        for (std::string line; std::getline(file, line);) {
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            if (line.empty()) {
+                continue;
+            }
+            if (devices.empty() || devices.back().size() == groupSize) {
+                devices.emplace_back();
+            }
+            devices.back().push_back(parseNodeId(line));
+        }
+        std::cout << "✓ 使用外部服务器 " << url << "，" << devices.size() << " 个轮询组" << std::endl;
+    } else {
+        const SimulatedPlant plant{server, plantOptions};
+        const size_t perDevice = plantOptions.tagsPerDevice;
+        for (size_t i = 0; i < plant.tags().size(); ++i) {
+            if (i % perDevice == 0) {
+                devices.emplace_back();
+            }
+            devices.back().push_back(plant.tags()[i].id);
+        }
+        serverThread = std::thread{[&] { server.run(); }};
+        url = "opc.tcp://localhost:4840";
+        std::cout << "✓ 模拟工厂已启动：" << plant.tags().size() << " 个 tag，" << devices.size()
+                  << " 个轮询组" << std::endl;
+    }
+    if (devices.empty()) {
+        std::cerr << "✗ 没有 tag" << std::endl;
+        return 1;
+    }
+
+    std::cout << std::fixed << std::setprecision(0);
+
+    PollEngineOptions options;
+    options.reuseReadValueIds = false;
+    std::cout << "\n2. 使用原始 NodeId，每个周期重新构建请求，轮询 " << duration.count() << " 秒（周期 "
+              << interval.count() << " 毫秒）：" << std::endl;
+    runPolling(url, devices, options, interval, duration);
+
+    options.reuseReadValueIds = true;
+    std::cout << std::setprecision(0);
+    std::cout << "\n3. 使用原始 NodeId，复用 ReadValueId 数组，轮询 " << duration.count() << " 秒：" << std::endl;
+    runPolling(url, devices, options, interval, duration);
+
+    options.registerNodes = true;
+    std::cout << std::setprecision(0);
+    std::cout << "\n4. 注册节点后使用别名，复用 ReadValueId 数组，轮询 " << duration.count() << " 秒：" << std::endl;
+    runPolling(url, devices, options, interval, duration);
+
+    if (serverThread.joinable()) {
+        server.stop();
+        serverThread.join();
+    }
+
+    std::cout << "\n=== 程序已退出 ===" << std::endl;
+    return 0;
+}
+
+/**
+ * 使用说明：
+ *
+ * 1. 内置模拟工厂：./client_poll_register_annotated --channels 20 --devices 50 --tags 100 --interval 500
+ * 2. 外部服务器：./client_poll_register_annotated --url opc.tcp://host:49320 --nodes nodes.txt --group 100
+ *
+ * 轮询原理：
+ *
+ * 1. 轮询组：
+ *    - 每个组有自己的周期，到期时按 1000 个 tag 拆成异步 Read 请求
+ *    - 上一轮的请求还没有全部返回时跳过本轮并计入超时跳过，避免请求在服务器上堆积
+ *    - 读到的值与订阅引擎一样转换为 Sample，交给写入目标
+ *
+ * 2. 注册节点：
+ *    - 每个组第一次到期时同步发送 RegisterNodes，之后的 Read 和 Write 请求都使用返回的别名
+ *    - 注册失败的组继续使用原始 NodeId
+ *    - removeGroup() 发送 UnregisterNodes，释放服务器为别名保留的资源
+ *
+ * 3. 复用 ReadValueId 数组：
+ *    - 每个组的 ReadValueId 数组在第一次轮询时构建，之后每个周期用同一个 ReadRequest 发送
+ *    - 客户端发送时改写请求头中的 requestHandle、timestamp 和 authenticationToken
+ *    - 注册或注销别名、会话重建后数组失效，下次轮询时重新构建
+ *
+ * 4. 重新连接：
+ *    - 别名随会话失效，onSessionActivated 回调中调用 resetSession()
+ *    - 未返回的请求被丢弃，下次轮询时重新注册
+ *
+ * 注意事项：
+ *
+ * - open62541 服务器的 RegisterNodes 原样返回请求中的 NodeId，连接内置模拟工厂时两种方式的请求大小相同；
+ *   KEPServerEX 等返回数值别名的服务器上，每个 ReadValueId 可以减少几十字节
+ * - 请求字节数是 Read/Write 请求体的二进制编码长度，不含安全通道的头部和签名
+ * - 复用只省去每个周期分配和填充 ReadValueId 数组的开销，发送耗时三种方式都有
+ * - 往返时间在 runIterate() 处理响应时计算，包含本地事件循环的等待时间
+ */
@@ -0,0 +1,247 @@
+/**
+ * @file client_publish_frames_annotated.cpp
+ * @brief OPC UA 发布帧示例 - 按 Publish 响应整体接收通知，计算一致的多 tag 物料平衡
+ *
+ * 本示例展示了 FrameSink 和 SubscriptionEngine::addFrameSink() 的使用方法，包括：
+ * 1. 启动内置的模拟工厂服务器，每个设备的 Flow1 作为进料、Flow2 作为出料
+ * 2. 周期性地用一个 Write 请求同时改变所有设备的进料和出料（保持平衡）
+ * 3. 逐个采样计算物料平衡（相当于每个通知一个回调）与按帧计算物料平衡对比
+ * 4. 输出帧数、每帧通知数、两种方式的计算次数和不平衡次数
+ *
+ * 功能说明：
+ * - 逐个通知处理时，处理函数看不到哪些通知属于同一个 Publish 响应，
+ *   进料更新后、出料更新前计算的平衡总是错的
+ * - 按帧处理时，一个响应中的全部通知先应用到状态再计算，只有同时写入的值被拆到两个响应中时才会不平衡
+ * - 帧带有订阅 ID、序号和发布时间，写入目标可以把一帧作为一个事务提交
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 包含必要的头文件
+#include <open62541pp/client.hpp>  // 客户端核心功能
+#include <open62541pp/server.hpp>  // 服务器核心功能
+
+#include "../helper.hpp"            // CliParser - 命令行参数解析器
+#include "collector_types.hpp"      // TagTable、FrameSink、PublishFrame
+#include "poll_engine.hpp"          // PollEngine::write
+#include "simulated_plant.hpp"      // SimulatedPlant
+#include "subscription_engine.hpp"  // SubscriptionEngine
+
+// 设备的进料和出料 tag
+struct Device {
+    TagHandle inflow;
+    TagHandle outflow;
+};
+
+// 物料平衡：每个设备进料 - 出料应为 0
+class MassBalance {
+public:
+    MassBalance(const TagTable& tags, const std::vector<Device>& devices)
+        : values_(tags.size()),
+          devices_{devices} {}
+
+    void apply(TagHandle tag, double value) {
+        values_[tag] = value;
+    }
+
+    /// 检查所有设备，返回不平衡的设备数
+    size_t evaluate() {
+        ++evaluations_;
+        size_t imbalanced = 0;
+        for (const auto& device : devices_) {
+            if (values_[device.inflow] != values_[device.outflow]) {
+                ++imbalanced;
+            }
+        }
+        if (imbalanced > 0) {
+            ++imbalancedEvaluations_;
+        }
+        return imbalanced;
+    }
+
+    size_t evaluations() const noexcept {
+        return evaluations_;
+    }
+
+    size_t imbalancedEvaluations() const noexcept {
+        return imbalancedEvaluations_;
+    }
+
+private:
+    std::vector<double> values_;  // 按 TagHandle 下标
+    const std::vector<Device>& devices_;
+    size_t evaluations_ = 0;
+    size_t imbalancedEvaluations_ = 0;
+};
+
+// 逐个采样计算：每个采样应用后立即检查，相当于每个通知一个回调
+class PerSampleBalance : public HistorySink {
+public:
+    PerSampleBalance(const TagTable& tags, const std::vector<Device>& devices)
+        : balance{tags, devices} {}
+
+    void write(opcua::Span<const Sample> samples) override {
+        for (const auto& sample : samples) {
+            balance.apply(sample.tag, sample.value);
+            balance.evaluate();
+        }
+    }
+
+    MassBalance balance;
+};
+
+// 按帧计算：一帧的全部通知应用后检查一次
+class FrameBalance : public FrameSink {
+public:
+    FrameBalance(const TagTable& tags, const std::vector<Device>& devices)
+        : balance{tags, devices} {}
+
+    void writeFrame(const PublishFrame& frame) override {
+        for (const auto& item : frame.items) {
+            Sample sample{};
+            if (toSample(*item.value, item.tag, sample)) {
+                balance.apply(item.tag, sample.value);
+            }
+        }
+        balance.evaluate();
+        ++frames;
+        items += frame.items.size();
+        lastSequenceNumber = frame.sequenceNumber;
+    }
+
+    MassBalance balance;
+    size_t frames = 0;
+    size_t items = 0;
+    uint32_t lastSequenceNumber = 0;
+};
+
+int main(int argc, char* argv[]) {
+    std::cout << "=== OPC UA 发布帧示例 ===" << std::endl;
+
+    // 解析命令行参数
+    // --channels / --devices：模拟工厂的规模，默认 4 × 25（每个设备 18 个 tag，包括 Flow1 和 Flow2）
+    // --seconds <秒>：运行时间，默认 20
+    // --write <毫秒>：写入进料和出料的周期，默认 200
+    const CliParser parser{argc, argv};
+    const std::chrono::seconds duration{std::stoul(std::string{parser.value("--seconds").value_or("20")})};
+    const std::chrono::milliseconds writeInterval{std::stoul(std::string{parser.value("--write").value_or("200")})};
+
+    PlantOptions plantOptions;
+    plantOptions.channels = std::stoul(std::string{parser.value("--channels").value_or("4")});
+    plantOptions.devicesPerChannel = std::stoul(std::string{parser.value("--devices").value_or("25")});
+    plantOptions.tagsPerDevice = 18;
+
+    std::cout << "1. 启动模拟工厂..." << std::endl;
+
+    opcua::ServerConfig config{4840};
+    opcua::Server server{std::move(config)};
+    TagTable tags;
+    std::vector<Device> devices;
+    {
+        const SimulatedPlant plant{server, plantOptions};
+        const auto& plantTags = plant.tags();
+        for (size_t first = 0; first < plantTags.size(); first += plantOptions.tagsPerDevice) {
+            // 每个设备的第一个和第二个 Flow tag
+            std::vector<TagHandle> flows;
+            for (size_t i = first; i < first + plantOptions.tagsPerDevice; ++i) {
+                const TagHandle tag = tags.add(plantTags[i].id);
+                if (plantTags[i].kind == PlantTagKind::Flow) {
+                    flows.push_back(tag);
+                }
+            }
+            devices.push_back({flows.at(0), flows.at(1)});
+        }
+    }
+    std::thread serverThread{[&] { server.run(); }};
+    std::cout << "✓ " << tags.size() << " 个 tag，" << devices.size() << " 个设备" << std::endl;
+
+    std::cout << "2. 创建订阅..." << std::endl;
+
+    opcua::Client client;
+    client.connect("opc.tcp://localhost:4840");
+    SubscriptionEngineOptions engineOptions;
+    engineOptions.publishingInterval = 250.0;
+    engineOptions.samplingInterval = 50.0;
+    SubscriptionEngine engine{client, tags, engineOptions};
+    PerSampleBalance perSample{tags, devices};
+    FrameBalance perFrame{tags, devices};
+    engine.addSink("per-sample", perSample);
+    engine.addFrameSink(perFrame);
+    engine.create();
+    std::cout << "✓ " << engine.subscriptionCount() << " 个订阅，" << engine.itemCount() << " 个监控项" << std::endl;
+
+    std::cout << "3. 运行 " << duration.count() << " 秒，每 " << writeInterval.count()
+              << " 毫秒同时写入所有设备的进料和出料..." << std::endl;
+
+    PollEngine writer{client, tags};
+    double level = 0.0;
+    auto nextWrite = std::chrono::steady_clock::now();
+    const auto deadline = nextWrite + duration;
+    while (std::chrono::steady_clock::now() < deadline) {
+        if (std::chrono::steady_clock::now() >= nextWrite) {
+            level += 1.0;
+            std::vector<TagWrite> writes;
+            for (const auto& device : devices) {
+                writes.push_back({device.inflow, opcua::Variant{level}});
+                writes.push_back({device.outflow, opcua::Variant{level}});
+            }
+            writer.write(writes);  // 一个 Write 请求
+            nextWrite += writeInterval;
+        }
+        engine.publish();
+        client.runIterate(10);
+    }
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "\n4. 结果：" << std::endl;
+    std::cout << "   帧 " << perFrame.frames << " 个，平均每帧 "
+              << (perFrame.frames > 0 ? static_cast<double>(perFrame.items) / perFrame.frames : 0.0)
+              << " 个通知，最后序号 " << perFrame.lastSequenceNumber << std::endl;
+    std::cout << "   逐个采样：计算 " << perSample.balance.evaluations() << " 次，不平衡 "
+              << perSample.balance.imbalancedEvaluations() << " 次" << std::endl;
+    std::cout << "   按帧：    计算 " << perFrame.balance.evaluations() << " 次，不平衡 "
+              << perFrame.balance.imbalancedEvaluations() << " 次" << std::endl;
+
+    client.disconnect();
+    server.stop();
+    serverThread.join();
+
+    std::cout << "\n=== 程序已退出 ===" << std::endl;
+    return 0;
+}
+
+/**
+ * 使用说明：
+ *
+ * 1. 运行：./client_publish_frames_annotated --channels 4 --devices 25 --seconds 20
+ * 2. 缩短写入周期（--write 50）后，同时写入的值更容易被拆到两个 Publish 响应中
+ *
+ * 发布帧原理：
+ *
+ * 1. 帧的内容：
+ *    - 一个 Publish 响应中所有 DataChangeNotification 的监控项，顺序与响应中相同
+ *    - 每项是 TagHandle（即监控项的 clientHandle）和指向响应中 DataValue 的指针
+ *    - 订阅 ID、通知消息序号和发布时间
+ *
+ * 2. 交付：
+ *    - 引擎处理完一个 Publish 响应时调用所有 FrameSink 的 writeFrame()，再写入普通写入目标
+ *    - 通过 Republish 取回的消息同样作为帧交付
+ *    - 使用 DecodePool 时，响应保留到交付之后，帧与采样一起按顺序交付
+ *
+ * 3. 按帧提交事务：
+ *    - 写入目标在 writeFrame() 中开始事务、写入全部通知、提交，一帧要么全部写入要么全部没有
+ *    - 序号可以写入同一事务，重启后据此判断哪些帧已经写入
+ *
+ * 注意事项：
+ *
+ * - 帧的 items 只在 writeFrame() 调用期间有效，需要保留的数据应复制
+ * - 服务器按采样间隔采样，同一个 Write 请求写入的值在同一个采样周期内被采到时才会出现在同一帧中
+ * - 帧保证的是“服务器一次发送的通知”一致，不是服务器端的事务
+ * - 只注册 FrameSink 时引擎不再把通知转换为 Sample
+ */
@@ -0,0 +1,293 @@
+/**
+ * @file client_redundancy_annotated.cpp
+ * @brief OPC UA 热备冗余采集示例 - 演示备用采集器预建订阅并在主节点失效后亚秒级接管
+ *
+ * 本示例展示了 redundant_collector.hpp 和 leader_lock.hpp 的使用方法，包括：
+ * 1. 启动一个内置服务器，模拟一组按固定周期递增的计数器 tag
+ * 2. 启动主、备两个采集器，各自保持会话并创建完全相同的订阅
+ * 3. 备用采集器的订阅处于禁用发布模式
+ * 4. 通过本地租约、文件锁或 Redis 协调主节点身份
+ * 5. 模拟主节点崩溃，测量切换时间以及重复和丢失的采样数
+ *
+ * 功能说明：
+ * - 单个采集器进程是单点故障，冷启动需要重新浏览、解析并订阅全部 tag
+ * - 热备节点只需启用发布，已有的会话、订阅和监控项保持不变
+ * - 计数器的值就是序号，审计写入目标可以精确统计重复和丢失的采样
+ */
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// 包含必要的头文件
+#include <open62541/client.h>  // UA_Client_disconnectSecureChannel
+
+#include <open62541pp/callback.hpp>      // 定时回调
+#include <open62541pp/client.hpp>        // 客户端核心功能
+#include <open62541pp/node.hpp>          // 节点操作
+#include <open62541pp/server.hpp>        // 服务器核心功能
+#include <open62541pp/subscription.hpp>  // 订阅功能
+
+#include "../helper.hpp"            // CliParser - 命令行参数解析器
+#include "collector_types.hpp"      // TagTable、Sample、HistorySink
+#include "leader_lock.hpp"          // LeaderLock 实现
+#include "redundant_collector.hpp"  // RedundantCollector
+
+// 审计写入目标：计数器的值是连续序号，据此统计重复和丢失的采样
+class SequenceAuditSink : public HistorySink {
+public:
+    explicit SequenceAuditSink(size_t tagCount)
+        : last_(tagCount, -1) {}
+
+    void write(opcua::Span<const Sample> samples) override {
+        std::lock_guard lock{mutex_};
+        for (const auto& sample : samples) {
+            const auto value = static_cast<int64_t>(sample.value);
+            auto& last = last_[sample.tag];
+            ++total_;
+            if (last >= 0 && value <= last) {
+                ++duplicates_;
+                continue;
+            }
+            if (last >= 0 && value > last + 1) {
+                lost_ += static_cast<size_t>(value - last - 1);
+            }
+            last = value;
+        }
+    }
+
+    void report() const {
+        std::lock_guard lock{mutex_};
+        std::cout << "写入采样:  " << total_ << std::endl;
+        std::cout << "重复采样:  " << duplicates_ << std::endl;
+        std::cout << "丢失采样:  " << lost_ << std::endl;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<int64_t> last_;
+    size_t total_ = 0;
+    size_t duplicates_ = 0;
+    size_t lost_ = 0;
+};
+
+// 按命令行参数创建主节点锁
+static std::unique_ptr<LeaderLock> createLock(
+    std::string_view kind, const std::string& id, const std::shared_ptr<LocalLease>& lease
+) {
+    const std::chrono::milliseconds ttl{300};  // 租约 300 毫秒
+    if (kind == "file") {
+        return std::make_unique<FileLeaderLock>("/tmp/opcua_collector.lock");
+    }
+    if (kind == "redis") {
+        return std::make_unique<RedisLeaderLock>("127.0.0.1", 6379, "opcua:collector:leader", id, ttl);
+    }
+    return std::make_unique<LocalLeaderLock>(lease, id, ttl);
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "=== OPC UA 热备冗余采集示例 ===" << std::endl;
+
+    // 解析命令行参数
+    // --tags <数量>：计数器 tag 数量，默认 1000
+    // --lock <local|file|redis>：主节点锁类型，默认 local
+    const CliParser parser{argc, argv};
+    const size_t tagCount = std::stoul(std::string{parser.value("--tags").value_or("1000")});
+    const std::string_view lockKind = parser.value("--lock").value_or("local");
+
+    std::cout << "1. 启动内置服务器，创建 " << tagCount << " 个计数器..." << std::endl;
+
+    opcua::Server server;
+    opcua::Node objectsNode{server, opcua::ObjectId::ObjectsFolder};
+    auto countersNode = objectsNode.addFolder({1, "Counters"}, "Counters");
+    TagTable tags;
+    std::vector<opcua::NodeId> counterNodes;
+    for (size_t i = 0; i < tagCount; ++i) {
+        const std::string name = "Counter" + std::to_string(i);
+        counterNodes.push_back(
+            countersNode
+                .addVariable(
+                    {1, name},
+                    name,
+                    opcua::VariableAttributes{}
+                        .setDataType<int64_t>()
+                        .setValue(opcua::Variant{int64_t{0}})
+                )
+                .id()
+        );
+        tags.add(counterNodes.back());
+    }
+
+    // 每 100 毫秒所有计数器加 1
+    int64_t counter = 0;
+    opcua::addRepeatedCallback(
+        server,
+        [&] {
+            ++counter;
+            for (const auto& id : counterNodes) {
+                opcua::Node{server, id}.writeValue(opcua::Variant{counter});
+            }
+        },
+        100
+    );
+    std::thread serverThread{[&] { server.run(); }};
+
+    std::cout << "2. 启动主、备采集器（锁类型: " << lockKind << "）..." << std::endl;
+
+    SequenceAuditSink sink{tagCount};
+    auto lease = std::make_shared<LocalLease>();
+
+    // 每个采集器一个线程：自己的客户端、锁和主循环
+    struct Instance {
+        std::string name;
+        opcua::Client client;
+        std::unique_ptr<LeaderLock> lock;
+        std::unique_ptr<RedundantCollector> collector;
+        std::atomic<bool> crashed = false;
+        std::atomic<bool> ready = false;
+        std::thread thread;
+    };
+    std::atomic<bool> isRunning = true;
+    Instance instances[2];
+    instances[0].name = "collector-a";
+    instances[1].name = "collector-b";
+
+    RedundancyOptions options{};
+    options.publishingInterval = 100.0;  // 发布间隔 100 毫秒
+    options.samplingInterval = 50.0;     // 采样间隔 50 毫秒
+    options.queueSize = 20;              // 队列覆盖约 2 秒的计数器变化
+
+    for (auto& instance : instances) {
+        instance.lock = createLock(lockKind, instance.name, lease);
+        instance.collector = std::make_unique<RedundantCollector>(
+            instance.name, instance.client, tags, sink, *instance.lock, options
+        );
+        instance.client.onSessionActivated([&instance] {
+            instance.collector->createSubscriptions();
+            instance.ready = true;
+        });
+    }
+
+    for (auto& instance : instances) {
+        instance.thread = std::thread{[&instance, &isRunning] {
+            instance.client.connect("opc.tcp://localhost:4840");
+            auto lastHeartbeat = std::chrono::steady_clock::now();
+            while (isRunning && !instance.crashed) {
+                instance.client.runIterate(10);
+                const auto now = std::chrono::steady_clock::now();
+                if (instance.ready && now - lastHeartbeat >= std::chrono::milliseconds{100}) {
+                    lastHeartbeat = now;
+                    instance.collector->heartbeat();
+                }
+            }
+            if (instance.crashed) {
+                // 模拟进程崩溃：不释放锁、不关闭会话，只断开安全通道
+                // client.disconnect() 会发送 CloseSession 并删除订阅，真正的崩溃不会；
+                // 服务器上的会话和订阅保留到会话超时
+                // 文件锁由操作系统随文件描述符释放；本地租约和 Redis 锁等待过期
+                if (dynamic_cast<FileLeaderLock*>(instance.lock.get()) != nullptr) {
+                    instance.lock->release();
+                }
+                UA_Client_disconnectSecureChannel(instance.client.handle());
+            } else {
+                instance.collector->resign();
+                instance.client.disconnect();
+            }
+        }});
+        // 先启动的采集器成为主节点
+        while (!instances[0].ready || instances[0].collector->role() != RedundantCollector::Role::Leader) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{10});
+        }
+    }
+    while (!instances[1].ready) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    }
+    std::cout << "✓ " << instances[0].name << " 为主节点，" << instances[1].name << " 为备用节点" << std::endl;
+
+    std::cout << "3. 正常采集 3 秒..." << std::endl;
+    std::this_thread::sleep_for(std::chrono::seconds{3});
+
+    std::cout << "4. 模拟主节点崩溃..." << std::endl;
+    const auto crashAt = std::chrono::steady_clock::now();
+    instances[0].crashed = true;
+    instances[0].thread.join();
+
+    // 等待备用节点接管并收到数据
+    while (instances[1].collector->firstSampleAt() == std::chrono::steady_clock::time_point{} ||
+           instances[1].collector->firstSampleAt() < crashAt) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    using Ms = std::chrono::duration<double, std::milli>;
+    const Ms detection = instances[1].collector->promotedAt() - crashAt;
+    const Ms failover = instances[1].collector->firstSampleAt() - crashAt;
+    std::cout << "✓ " << instances[1].name << " 已接管" << std::endl;
+
+    std::cout << "5. 继续采集 3 秒..." << std::endl;
+    std::this_thread::sleep_for(std::chrono::seconds{3});
+    isRunning = false;
+    instances[1].thread.join();
+    server.stop();
+    serverThread.join();
+
+    std::cout << "\n=== 切换统计 ===" << std::endl;
+    std::cout << "锁类型:    " << lockKind << std::endl;
+    std::cout << "检测时间:  " << detection.count() << " ms（崩溃到成为主节点）" << std::endl;
+    std::cout << "切换时间:  " << failover.count() << " ms（崩溃到收到第一个采样）" << std::endl;
+    std::cout << instances[0].name << " 写入: " << instances[0].collector->samplesWritten() << std::endl;
+    std::cout << instances[1].name << " 写入: " << instances[1].collector->samplesWritten() << std::endl;
+    sink.report();
+
+    return 0;
+}
+
+/**
+ * 使用说明：
+ *
+ * 1. 编译并运行此程序：./client_redundancy_annotated --tags 1000 --lock local
+ * 2. --lock file 使用 /tmp/opcua_collector.lock 文件锁
+ * 3. --lock redis 使用 127.0.0.1:6379 上的 Redis（或兼容服务器）
+ * 4. 程序会自动模拟主节点崩溃并输出切换统计
+ *
+ * 热备工作原理：
+ *
+ * 1. 预建订阅：
+ *    - 两个采集器都在会话激活时创建全部订阅和监控项
+ *    - 备用节点调用 setPublishingMode(false)，服务器继续采样但不发送通知
+ *    - 监控项队列（queueSize，discardOldest）缓存最近的数据变化
+ *
+ * 2. 主节点选举：
+ *    - 主节点每 100 毫秒续期一次，续期失败立即禁用自己的发布
+ *    - 备用节点每 100 毫秒尝试获取锁
+ *    - local：进程内租约；file：flock 文件锁；redis：SET NX PX 租约
+ *
+ * 3. 切换：
+ *    - 备用节点获取锁后对所有订阅调用 setPublishingMode(true)
+ *    - 服务器在下一个发布周期发送队列中缓存的通知
+ *    - 没有浏览、解析或 CreateMonitoredItems 调用
+ *
+ * 切换时间的组成：
+ *
+ * - 检测时间：file 锁在崩溃后立即释放，最多等待一个心跳周期；
+ *   local/redis 租约需要等待过期（TTL 300 毫秒）加一个心跳周期
+ * - 发布延迟：启用发布到收到第一个发布响应，约一个发布间隔
+ *
+ * 重复和丢失：
+ *
+ * - 队列覆盖的时间（queueSize × 数据变化周期）大于切换时间时不会丢失采样
+ * - 队列中已由旧主节点写入的数据会重复，LocalHistoryStore 按时间戳自动去重
+ * - 队列过短时最旧的数据被丢弃，表现为丢失采样
+ *
+ * 注意事项：
+ *
+ * - 备用节点同样占用服务器的会话、订阅和采样资源
+ * - 崩溃的主节点的会话和订阅仍留在服务器上，直到会话超时；服务器在此期间继续为它们采样
+ * - 租约 TTL 要大于心跳周期的数倍，避免网络抖动导致主节点频繁切换
+ * - Redis 锁在 Redis 不可用时两个节点都不会成为主节点（宁可停止也不双写）
+ * - 文件锁只适用于同一台机器（不要用于 NFS 等网络文件系统）
+ */
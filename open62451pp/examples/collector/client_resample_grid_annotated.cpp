@@ -0,0 +1,223 @@
+/**
+ * @file client_resample_grid_annotated.cpp
+ * @brief OPC UA 网格重采样示例 - 把不规则到达的通知对齐到公共的 1 秒网格
+ *
+ * 本示例展示了 Resampler、GridSink 和 SharedGridMatrix 的使用方法，包括：
+ * 1. 启动内置的模拟工厂服务器，所有数值型 tag 作为网格的列
+ * 2. 每 300 毫秒用一个 Write 请求把所有 Temperature tag 写为当前秒数（与网格不同步）
+ * 3. 订阅所有 tag，通知同时交给保持采样（Hold）和线性插值（Linear）两个重采样器
+ * 4. 线性插值的行写入共享内存矩阵，分析进程可以直接映射读取
+ * 5. 输出每行第一个 Temperature 列的两种结果、行数和计算一行的耗时
+ *
+ * 功能说明：
+ * - 通知按服务器的采样和发布时刻到达，不同 tag 的时间互不对齐
+ * - 重采样器为每个 tag 保留最近几个采样，每个网格时刻一次顺序扫描生成一整行
+ * - 写入值等于写入时刻的秒数，线性插值的结果应接近网格时刻本身，保持采样的结果落后不到 0.3 秒
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 包含必要的头文件
+#include <open62541pp/client.hpp>  // 客户端核心功能
+#include <open62541pp/server.hpp>  // 服务器核心功能
+
+#include "../helper.hpp"            // CliParser - 命令行参数解析器
+#include "collector_types.hpp"      // TagTable
+#include "poll_engine.hpp"          // PollEngine::write
+#include "resampler.hpp"            // Resampler、GridSink
+#include "shared_grid.hpp"          // SharedGridMatrix
+#include "simulated_plant.hpp"      // SimulatedPlant
+#include "subscription_engine.hpp"  // SubscriptionEngine
+
+// 记录每行指定列的值和无数据的列数
+class ColumnProbe : public GridSink {
+public:
+    explicit ColumnProbe(size_t column)
+        : column_{column} {}
+
+    void writeRow(const GridRow& row) override {
+        times.push_back(row.time);
+        values.push_back(row.values[column_]);
+        size_t missing = 0;
+        for (const double value : row.values) {
+            missing += std::isnan(value) ? 1 : 0;
+        }
+        lastMissing = missing;
+    }
+
+    std::vector<int64_t> times;
+    std::vector<double> values;
+    size_t lastMissing = 0;
+
+private:
+    size_t column_;
+};
+
+int main(int argc, char* argv[]) {
+    std::cout << "=== OPC UA 网格重采样示例 ===" << std::endl;
+
+    // 解析命令行参数
+    // --channels / --devices / --tags：模拟工厂的规模，默认 4 × 25 × 50
+    // --seconds <秒>：运行时间，默认 15
+    // --shm <名称>：共享内存对象名称，默认 /collector_grid
+    const CliParser parser{argc, argv};
+    const std::chrono::seconds duration{std::stoul(std::string{parser.value("--seconds").value_or("15")})};
+    const std::string shmName{parser.value("--shm").value_or("/collector_grid")};
+
+    PlantOptions plantOptions;
+    plantOptions.channels = std::stoul(std::string{parser.value("--channels").value_or("4")});
+    plantOptions.devicesPerChannel = std::stoul(std::string{parser.value("--devices").value_or("25")});
+    plantOptions.tagsPerDevice = std::stoul(std::string{parser.value("--tags").value_or("50")});
+
+    std::cout << "1. 启动模拟工厂..." << std::endl;
+
+    opcua::ServerConfig config{4840};
+    opcua::Server server{std::move(config)};
+    TagTable tags;
+    std::vector<TagHandle> columns;       // 数值型 tag
+    std::vector<TagHandle> temperatures;  // 写入的 tag
+    {
+        const SimulatedPlant plant{server, plantOptions};
+        for (const auto& tag : plant.tags()) {
+            const TagHandle handle = tags.add(tag.id);
+            if (tag.kind == PlantTagKind::Status) {
+                continue;  // 字符串，不能重采样
+            }
+            if (tag.kind == PlantTagKind::Temperature) {
+                temperatures.push_back(handle);
+            }
+            columns.push_back(handle);
+        }
+    }
+    std::thread serverThread{[&] { server.run(); }};
+    std::cout << "✓ " << tags.size() << " 个 tag，网格 " << columns.size() << " 列" << std::endl;
+
+    std::cout << "2. 创建重采样器和共享内存矩阵..." << std::endl;
+
+    ResamplerOptions holdOptions;
+    holdOptions.interval = UA_DATETIME_SEC;
+    holdOptions.delay = UA_DATETIME_SEC;  // 发布间隔 500 毫秒，等待一个网格间隔足够
+    holdOptions.depth = 8;
+    holdOptions.idleTimeout = 5 * UA_DATETIME_SEC;  // 保活间隔：发布间隔 500 毫秒 × maxKeepAliveCount 10
+    ResamplerOptions linearOptions = holdOptions;
+    linearOptions.mode = ResampleMode::Linear;
+    Resampler hold{columns, holdOptions};
+    Resampler linear{columns, linearOptions};
+
+    // 第一个 Temperature 列
+    const size_t probeColumn = 0;
+    ColumnProbe holdProbe{probeColumn};
+    ColumnProbe linearProbe{probeColumn};
+    hold.addSink(holdProbe);
+    linear.addSink(linearProbe);
+    SharedGridMatrix matrix{shmName, columns.size(), 3600, linearOptions.interval};  // 保留最近一小时
+    linear.addSink(matrix);
+    std::cout << "✓ 共享内存 " << shmName << "，" << matrix.bytes() / (1024 * 1024) << " MB" << std::endl;
+
+    std::cout << "3. 订阅并运行 " << duration.count() << " 秒..." << std::endl;
+
+    opcua::Client client;
+    client.connect("opc.tcp://localhost:4840");
+    SubscriptionEngineOptions engineOptions;
+    engineOptions.publishingInterval = 500.0;
+    engineOptions.samplingInterval = 100.0;
+    SubscriptionEngine engine{client, tags, engineOptions};
+    engine.addSink("hold", hold);
+    engine.addSink("linear", linear);
+    engine.create();
+    std::cout << "✓ " << engine.subscriptionCount() << " 个订阅" << std::endl;
+
+    PollEngine writer{client, tags};
+    const auto writeInterval = std::chrono::milliseconds{300};
+    auto nextWrite = std::chrono::steady_clock::now();
+    const auto deadline = nextWrite + duration;
+    while (std::chrono::steady_clock::now() < deadline) {
+        if (std::chrono::steady_clock::now() >= nextWrite) {
+            // 值为写入时刻的秒数（相对于网格），线性插值后应等于网格时刻
+            const double seconds = static_cast<double>(UA_DateTime_now() % (1000 * UA_DATETIME_SEC)) / UA_DATETIME_SEC;
+            std::vector<TagWrite> writes;
+            for (const TagHandle tag : temperatures) {
+                writes.push_back({tag, opcua::Variant{seconds}});
+            }
+            writer.write(writes);
+            nextWrite += writeInterval;
+        }
+        engine.publish();
+        client.runIterate(10);
+        // 没有通知时网格也要前进
+        hold.advance(UA_DateTime_now());
+        linear.advance(UA_DateTime_now());
+    }
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "\n4. 第一个 Temperature 列（网格时刻取秒数的后三位）：" << std::endl;
+    std::cout << "   网格时刻    Hold      Linear" << std::endl;
+    const size_t rows = std::min(holdProbe.times.size(), linearProbe.times.size());
+    for (size_t i = 0; i < rows; ++i) {
+        const double tick = static_cast<double>(holdProbe.times[i] % (1000 * UA_DATETIME_SEC)) / UA_DATETIME_SEC;
+        std::cout << "   " << std::setw(8) << tick << "  " << std::setw(8) << holdProbe.values[i] << "  "
+                  << std::setw(8) << linearProbe.values[i] << std::endl;
+    }
+
+    for (const auto* resampler : {&hold, &linear}) {
+        const auto& stats = resampler->stats();
+        std::cout << "   " << (resampler == &hold ? "Hold:   " : "Linear: ") << stats.rows << " 行，采样 "
+                  << stats.samples << "，迟到 " << stats.late << "，近似 " << stats.approximated << "，每行 "
+                  << (stats.rows > 0 ? stats.rowSeconds * 1000.0 / static_cast<double>(stats.rows) : 0.0)
+                  << " 毫秒" << std::endl;
+    }
+    std::cout << "   最后一行无数据的列：" << linearProbe.lastMissing << "，共享内存已写入 " << matrix.written()
+              << " 行" << std::endl;
+
+    matrix.unlink();
+    client.disconnect();
+    server.stop();
+    serverThread.join();
+
+    std::cout << "\n=== 程序已退出 ===" << std::endl;
+    return 0;
+}
+
+/**
+ * 使用说明：
+ *
+ * 1. 运行：./client_resample_grid_annotated --channels 4 --devices 25 --tags 50 --seconds 15
+ * 2. 10 万个 tag：--channels 20 --devices 50 --tags 100
+ *
+ * 重采样原理：
+ *
+ * 1. 状态：
+ *    - 每列保留最近 depth 个采样的时间和值，全部列的时间放在一个数组中，值放在另一个数组中
+ *    - 采样按 TagHandle 找到列（平铺数组），写入该列的环形缓冲，同一列乱序到达的采样丢弃
+ *
+ * 2. 输出时刻：
+ *    - 网格时刻 T 在水位（最大采样时间与本机时钟中较小的一个）越过 T + delay 时输出
+ *    - delay 应不小于发布间隔，保证 T 之后的第一个通知已经到达，线性插值才有右端点
+ *    - 没有通知时周期性调用 advance()；超过 idleTimeout 没有采样后水位跟随本机时钟，网格继续前进
+ *    - 网格起点取第一次输出时的水位；一次最多补出 maxCatchUp 行，更早的网格时刻计入 skippedTicks
+ *
+ * 3. 每列的值：
+ *    - Hold：T 之前的最后一个采样
+ *    - Linear：T 前后两个采样之间线性插值；T 之后还没有采样时等同于 Hold
+ *    - 还没有采样、最后一个采样为 Bad 状态或早于 T - maxAge 时为 NaN
+ *
+ * 4. 共享内存矩阵：
+ *    - 头部记录列数、行数、网格间隔和已写入的行数，之后是时间数组和行优先的数值矩阵
+ *    - 读取者按 written 定位最新行，复制后再次检查 written 判断是否被覆盖（SharedGridMatrix::readRow()）
+ *
+ * 注意事项：
+ *
+ * - 已输出的网格时刻不再修改；迟到的采样计入 late，只影响之后的网格时刻
+ * - depth 应大于 delay 内每个 tag 可能到达的采样数，否则计入 approximated
+ * - 布尔和整数 tag 同样以 double 输出，线性插值对它们通常没有意义，可以用两个重采样器分别处理
+ * - 服务器时钟与本机时钟偏差较大时，网格时刻以两者中较慢的一个为准
+ * - 时间与本机时钟相差超过 maxSkew 的采样（例如设备时钟未设置）丢弃并计入 skewed
+ */
@@ -0,0 +1,217 @@
+/**
+ * @file client_startup_pipeline_annotated.cpp
+ * @brief OPC UA 采集器冷启动示例 - 比较按阶段依次执行与分批流水线的启动耗时
+ *
+ * 本示例展示了 startup_pipeline.hpp 的使用方法，包括：
+ * 1. 启动内置的模拟工厂服务器，或连接外部服务器（tag 路径从文件读取）
+ * 2. 按原来的方式冷启动：解析全部 tag → 读取全部元数据 → 创建全部监控项
+ * 3. 用流水线冷启动：每批 tag 解析完成后立即读取元数据、创建监控项
+ * 4. 输出每个阶段的请求数、起止时间和请求耗时，以及首个采样和全部覆盖的时间
+ *
+ * 功能说明：
+ * - 按阶段执行时，第一个采样要等所有 tag 都解析完、元数据都读完才会出现
+ * - 流水线中三个阶段同时进行：服务器处理后面批次的解析时，前面批次已经在采集
+ * - 全部覆盖指每个监控项都收到过至少一个采样，此时采集器的数据才完整
+ */
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 包含必要的头文件
+#include <open62541pp/client.hpp>  // 客户端核心功能
+#include <open62541pp/server.hpp>  // 服务器核心功能
+
+#include "../helper.hpp"            // CliParser - 命令行参数解析器
+#include "collector_types.hpp"      // TagTable
+#include "simulated_plant.hpp"      // SimulatedPlant
+#include "startup_pipeline.hpp"     // StartupPipeline
+#include "subscription_engine.hpp"  // SubscriptionEngine
+
+// "ns=1;s=Channel1.Device1.Temperature1" -> "1:Channel1/1:Device1/1:Temperature1"
+static std::string toBrowsePath(const opcua::NodeId& id) {
+    const std::string text = opcua::toString(id);
+    const auto pos = text.find(";s=");
+    const std::string prefix = std::to_string(id.namespaceIndex()) + ":";
+    std::string path = prefix;
+    for (const char c : text.substr(pos + 3)) {
+        if (c == '.') {
+            path += '/';
+            path += prefix;
+        } else {
+            path += c;
+        }
+    }
+    return path;
+}
+
+struct RunResult {
+    double connectSeconds = 0.0;
+    StartupStats stats;
+};
+
+static RunResult runStartup(const std::string& url, const std::vector<std::string>& paths, StartupOptions options) {
+    RunResult result;
+    const auto t0 = std::chrono::steady_clock::now();
+    opcua::Client client;
+    client.connect(url);
+    result.connectSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    TagTable tags;
+    SubscriptionEngineOptions engineOptions;
+    engineOptions.publishingInterval = 250.0;
+    engineOptions.samplingInterval = 100.0;
+    SubscriptionEngine engine{client, tags, engineOptions};
+    StartupPipeline pipeline{client, tags, engine, options};
+    engine.addSink("startup", pipeline);
+
+    pipeline.start(paths);
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::minutes{5};
+    while (!pipeline.covered() && std::chrono::steady_clock::now() < deadline) {
+        client.runIterate(10);
+        pipeline.step();
+        engine.publish();
+    }
+    result.stats = pipeline.stats();
+    client.disconnect();
+    return result;
+}
+
+static void printPhase(const char* name, const StartupPhase& phase) {
+    std::cout << "     " << name << std::setw(6) << phase.requests << " 个请求  " << std::setw(7) << phase.items
+              << " 个 tag  " << std::setw(7) << phase.firstStart << " ~ " << std::setw(7) << phase.lastEnd
+              << " 秒  请求耗时合计 " << phase.busySeconds << " 秒" << std::endl;
+}
+
+static void printResult(const RunResult& result) {
+    const auto& stats = result.stats;
+    std::cout << "     连接   " << result.connectSeconds << " 秒" << std::endl;
+    printPhase("解析  ", stats.resolve);
+    printPhase("元数据", stats.metadata);
+    printPhase("订阅  ", stats.subscribe);
+    std::cout << "     tag: 请求 " << stats.tagsRequested << "，解析 " << stats.tagsResolved << "，失败 "
+              << stats.tagsFailed << "，重复 " << stats.tagsDuplicate << "，跳过 " << stats.tagsSkipped << "，订阅 "
+              << stats.tagsSubscribed << "，已覆盖 " << stats.tagsCovered << std::endl;
+    std::cout << "     首个采样 " << stats.firstSample << " 秒，全部覆盖 ";
+    if (stats.fullCoverage >= 0.0) {
+        std::cout << stats.fullCoverage << " 秒" << std::endl;
+    } else {
+        std::cout << "未完成" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "=== OPC UA 采集器冷启动示例 ===" << std::endl;
+
+    // 解析命令行参数
+    // --url <地址> --paths <文件>：外部服务器和 tag 路径文件（每行一个，例如 2:Channel1/2:Device1/2:Tag1）
+    // --channels / --devices / --tags：模拟工厂的规模，默认 4 × 25 × 50
+    // --batch <数量>：每批 tag 数，默认 1000
+    // --mode <both|sequential|pipeline>：默认 both
+    const CliParser parser{argc, argv};
+    const auto externalUrl = parser.value("--url");
+    const std::string mode{parser.value("--mode").value_or("both")};
+
+    PlantOptions plantOptions;
+    plantOptions.channels = std::stoul(std::string{parser.value("--channels").value_or("4")});
+    plantOptions.devicesPerChannel = std::stoul(std::string{parser.value("--devices").value_or("25")});
+    plantOptions.tagsPerDevice = std::stoul(std::string{parser.value("--tags").value_or("50")});
+
+    StartupOptions options;
+    options.batchSize = std::stoul(std::string{parser.value("--batch").value_or("1000")});
+
+    std::cout << "1. 准备服务器和 tag 列表..." << std::endl;
+
+    opcua::ServerConfig config{4840};
+    opcua::Server server{std::move(config)};
+    std::thread serverThread;
+    std::string url;
+    std::vector<std::string> paths;
+    if (externalUrl) {
+        url = std::string{*externalUrl};
+        std::ifstream file{std::string{parser.value("--paths").value_or("tags.txt")}};
+        for (std::string line; std::getline(file, line);) {
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            if (!line.empty()) {
+                paths.push_back(line);
+            }
+        }
+        std::cout << "✓ 使用外部服务器 " << url << "，" << paths.size() << " 个 tag 路径" << std::endl;
+    } else {
+        const SimulatedPlant plant{server, plantOptions};
+        for (const auto& tag : plant.tags()) {
+            paths.push_back(toBrowsePath(tag.id));
+        }
+        serverThread = std::thread{[&] { server.run(); }};
+        url = "opc.tcp://localhost:4840";
+        std::cout << "✓ 模拟工厂已启动：" << paths.size() << " 个 tag" << std::endl;
+    }
+    if (paths.empty()) {
+        std::cerr << "✗ 没有 tag 路径" << std::endl;
+        return 1;
+    }
+
+    std::cout << std::fixed << std::setprecision(2);
+
+    if (mode == "both" || mode == "sequential") {
+        std::cout << "\n2. 按阶段依次执行：" << std::endl;
+        StartupOptions sequential = options;
+        sequential.overlap = false;
+        printResult(runStartup(url, paths, sequential));
+    }
+
+    if (mode == "both" || mode == "pipeline") {
+        std::cout << "\n3. 分批流水线（每批 " << options.batchSize << " 个 tag，每个阶段最多 "
+                  << options.maxInFlight << " 个未完成请求）：" << std::endl;
+        printResult(runStartup(url, paths, options));
+    }
+
+    if (serverThread.joinable()) {
+        server.stop();
+        serverThread.join();
+    }
+
+    std::cout << "\n=== 程序已退出 ===" << std::endl;
+    return 0;
+}
+
+/**
+ * 使用说明：
+ *
+ * 1. 内置模拟工厂：./client_startup_pipeline_annotated --channels 20 --devices 50 --tags 100（10 万个 tag）
+ * 2. 外部服务器：./client_startup_pipeline_annotated --url opc.tcp://host:49320 --paths tags.txt
+ * 3. 只运行其中一种：--mode sequential 或 --mode pipeline
+ *
+ * 流水线原理：
+ *
+ * 1. 解析：
+ *    - tag 路径每 1000 个打包成一个异步 TranslateBrowsePathsToNodeIds 请求，同时最多 4 个
+ *    - 解析成功的 NodeId 加入 TagTable，整批进入元数据队列；多条路径解析到同一节点时只保留一次
+ *
+ * 2. 元数据：
+ *    - 每批一个异步 Read 请求，读取 DataType、ValueRank、AccessLevel，不返回时间戳
+ *    - 跳过不可读的 tag，以及写入目标无法保存的数组和字符串、时间、结构体等类型（按 DataType 的 typeKind 判断）
+ *
+ * 3. 订阅：
+ *    - 每次 step() 把一批 tag 交给 SubscriptionEngine::addTags()，先填满已有订阅再创建新订阅
+ *    - CreateMonitoredItems 是同步请求，等待期间其他批次的解析和元数据响应照常处理
+ *    - engine.publish() 在主循环中持续补充 Publish 请求，第一个订阅创建后就开始采集
+ *
+ * 计时说明：
+ *
+ * - 时间都相对 start()，不含连接时间
+ * - 每个阶段的起止时间是第一个请求发出和最后一个响应到达的时间；流水线中各阶段的时间段重叠
+ * - 请求耗时合计是各请求往返时间之和，同时未完成的请求越多，合计值越大于阶段的起止时间
+ *
+ * 注意事项：
+ *
+ * - 按阶段执行时所有监控项一次创建，与原来的 engine.create() 相同
+ * - 解析或元数据请求失败的批次计入失败数，不自动重试；重新连接后需要重新启动流程
+ * - 采样间隔 100 毫秒、发布间隔 250 毫秒，服务器修订的间隔更长时全部覆盖时间相应变长
+ */
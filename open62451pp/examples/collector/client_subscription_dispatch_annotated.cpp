@@ -0,0 +1,285 @@
+/**
+ * @file client_subscription_dispatch_annotated.cpp
+ * @brief OPC UA 订阅分发示例 - 比较每个监控项一个回调和每个订阅一个处理函数的内存与分发开销
+ *
+ * 本示例展示了 dispatch_subscription.hpp 的使用方法，包括：
+ * 1. 启动内置的模拟工厂服务器，或连接外部服务器
+ * 2. 按 client_subscription_annotated.cpp 的方式订阅：每个监控项一个 lambda，
+ *    回调中构造 opcua::MonitoredItem 查询 NodeId
+ * 3. 用 DispatchSubscription 订阅：每个订阅一个处理函数，按 TagHandle 访问每个 tag 的状态数组
+ * 4. 输出两种方式的创建耗时、内存增长、收齐首批通知的时间和回调耗时
+ *
+ * 功能说明：
+ * - 10 万个监控项时，每个监控项的 std::function 和捕获的数据是 10 万次堆分配
+ * - 回调中构造 MonitoredItem 并读取 nodeId() 需要在客户端的订阅表中查找
+ * - 分发模式下监控项的上下文就是 TagHandle，处理函数直接用它作数组下标
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+// 包含必要的头文件
+#include <open62541pp/client.hpp>        // 客户端核心功能
+#include <open62541pp/server.hpp>        // 服务器核心功能
+#include <open62541pp/subscription.hpp>  // 订阅功能
+
+#include "../helper.hpp"              // CliParser - 命令行参数解析器
+#include "collector_types.hpp"        // TagTable
+#include "dispatch_subscription.hpp"  // DispatchSubscription
+#include "simulated_plant.hpp"        // SimulatedPlant
+
+using Clock = std::chrono::steady_clock;
+
+// 每个 tag 的状态，按 TagHandle 下标保存
+struct TagState {
+    double lastValue = 0.0;
+    int64_t lastTime = 0;
+    uint32_t updates = 0;
+};
+
+// 进程常驻内存（KB），读取 /proc/self/statm
+static size_t residentKilobytes() {
+    std::ifstream statm{"/proc/self/statm"};
+    size_t total = 0;
+    size_t resident = 0;
+    statm >> total >> resident;
+    return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE)) / 1024;
+}
+
+struct RunResult {
+    double createSeconds = 0.0;
+    size_t memoryKilobytes = 0;
+    double firstCoverageSeconds = -1.0;  // 每个 tag 都收到通知的时间
+    double callbackSeconds = 0.0;
+    size_t notifications = 0;
+};
+
+static RunResult runPerItem(const std::string& url, const TagTable& tags, size_t itemsPerSubscription) {
+    opcua::Client client;
+    client.connect(url);
+    RunResult result;
+    std::vector<uint32_t> updates(tags.size());
+    size_t covered = 0;
+
+    const size_t memoryBefore = residentKilobytes();
+    const auto t0 = Clock::now();
+    std::vector<opcua::Subscription<opcua::Client>> subscriptions;
+    for (TagHandle first = 0; first < tags.size(); first += itemsPerSubscription) {
+        opcua::Subscription sub{client};
+        opcua::SubscriptionParameters subscriptionParameters{};
+        subscriptionParameters.publishingInterval = 250.0;
+        sub.setSubscriptionParameters(subscriptionParameters);
+        const auto last = static_cast<TagHandle>(std::min<size_t>(tags.size(), first + itemsPerSubscription));
+        for (TagHandle tag = first; tag < last; ++tag) {
+            opcua::MonitoringParametersEx monitoringParameters{};
+            monitoringParameters.samplingInterval = 100.0;
+            sub.subscribeDataChange(
+                tags.nodeId(tag),
+                opcua::AttributeId::Value,
+                opcua::MonitoringMode::Reporting,
+                monitoringParameters,
+                [&](opcua::IntegerId subId, opcua::IntegerId monId, const opcua::DataValue& dv) {
+                    const auto c0 = Clock::now();
+                    // 与 client_subscription_annotated.cpp 相同：构造监控项对象查询 NodeId，再映射到 tag
+                    opcua::MonitoredItem item{client, subId, monId};
+                    const auto handle = tags.find(item.nodeId());
+                    if (handle) {
+                        if (updates[*handle]++ == 0) {
+                            ++covered;
+                        }
+                        Sample sample{};
+                        toSample(*dv.handle(), *handle, sample);
+                    }
+                    ++result.notifications;
+                    result.callbackSeconds += std::chrono::duration<double>(Clock::now() - c0).count();
+                }
+            );
+        }
+        subscriptions.push_back(std::move(sub));
+    }
+    result.createSeconds = std::chrono::duration<double>(Clock::now() - t0).count();
+    result.memoryKilobytes = residentKilobytes() - memoryBefore;
+
+    const auto deadline = Clock::now() + std::chrono::seconds{30};
+    while (covered < tags.size() && Clock::now() < deadline) {
+        client.runIterate(10);
+    }
+    if (covered == tags.size()) {
+        result.firstCoverageSeconds = std::chrono::duration<double>(Clock::now() - t0).count();
+    }
+    client.disconnect();
+    return result;
+}
+
+static RunResult runDispatch(const std::string& url, const TagTable& tags, size_t itemsPerSubscription) {
+    opcua::Client client;
+    client.connect(url);
+    RunResult result;
+    std::vector<TagState> states(tags.size());
+    size_t covered = 0;
+
+    // 整个订阅共用的处理函数：tag 直接作为状态数组的下标
+    const auto handler = [&](TagHandle tag, const UA_DataValue& dv) {
+        const auto c0 = Clock::now();
+        auto& state = states[tag];
+        Sample sample{};
+        if (toSample(dv, tag, sample)) {
+            state.lastValue = sample.value;
+            state.lastTime = sampleTime(sample);
+        }
+        if (state.updates++ == 0) {
+            ++covered;
+        }
+        ++result.notifications;
+        result.callbackSeconds += std::chrono::duration<double>(Clock::now() - c0).count();
+    };
+
+    DispatchOptions options;
+    options.publishingInterval = 250.0;
+    options.samplingInterval = 100.0;
+
+    const size_t memoryBefore = residentKilobytes();
+    const auto t0 = Clock::now();
+    std::vector<DispatchSubscription> subscriptions;
+    std::vector<TagHandle> handles;
+    for (TagHandle first = 0; first < tags.size(); first += itemsPerSubscription) {
+        const auto last = static_cast<TagHandle>(std::min<size_t>(tags.size(), first + itemsPerSubscription));
+        handles.clear();
+        for (TagHandle tag = first; tag < last; ++tag) {
+            handles.push_back(tag);
+        }
+        DispatchSubscription sub{client, tags, handler, options};
+        sub.addTags(handles);
+        subscriptions.push_back(std::move(sub));
+    }
+    result.createSeconds = std::chrono::duration<double>(Clock::now() - t0).count();
+    result.memoryKilobytes = residentKilobytes() - memoryBefore;
+
+    const auto deadline = Clock::now() + std::chrono::seconds{30};
+    while (covered < tags.size() && Clock::now() < deadline) {
+        client.runIterate(10);
+    }
+    if (covered == tags.size()) {
+        result.firstCoverageSeconds = std::chrono::duration<double>(Clock::now() - t0).count();
+    }
+    client.disconnect();
+    return result;
+}
+
+static void printResult(const RunResult& result) {
+    std::cout << "     创建 " << result.createSeconds << " 秒，内存增长 " << result.memoryKilobytes / 1024.0
+              << " MB，收齐首批通知 ";
+    if (result.firstCoverageSeconds >= 0.0) {
+        std::cout << result.firstCoverageSeconds << " 秒";
+    } else {
+        std::cout << "未完成";
+    }
+    std::cout << std::endl;
+    if (result.notifications > 0) {
+        std::cout << "     通知 " << result.notifications << " 个，回调合计 " << result.callbackSeconds * 1000.0
+                  << " 毫秒，平均 " << result.callbackSeconds * 1e9 / static_cast<double>(result.notifications)
+                  << " 纳秒/个" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "=== OPC UA 订阅分发示例 ===" << std::endl;
+
+    // 解析命令行参数
+    // --url <地址>：外部服务器地址（需同时用 --nodes 提供 NodeId 列表）；不指定时启动内置的模拟工厂
+    // --nodes <文件>：NodeId 列表，每行一个，例如 ns=2;s=Channel1.Device1.Tag5
+    // --channels / --devices / --tags：模拟工厂的规模，默认 4 × 25 × 50
+    // --per-sub <数量>：每个订阅的监控项数，默认 1000
+    const CliParser parser{argc, argv};
+    const auto externalUrl = parser.value("--url");
+    const size_t itemsPerSubscription = std::stoul(std::string{parser.value("--per-sub").value_or("1000")});
+
+    PlantOptions plantOptions;
+    plantOptions.channels = std::stoul(std::string{parser.value("--channels").value_or("4")});
+    plantOptions.devicesPerChannel = std::stoul(std::string{parser.value("--devices").value_or("25")});
+    plantOptions.tagsPerDevice = std::stoul(std::string{parser.value("--tags").value_or("50")});
+
+    std::cout << "1. 准备服务器和 tag 列表..." << std::endl;
+
+    opcua::ServerConfig config{4840};
+    opcua::Server server{std::move(config)};
+    std::thread serverThread;
+    std::string url;
+    TagTable tags;
+    if (externalUrl) {
+        url = std::string{*externalUrl};
+        std::ifstream file{std::string{parser.value("--nodes").value_or("nodes.txt")}};
+        for (std::string line; std::getline(file, line);) {
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            if (!line.empty()) {
+                tags.add(parseNodeId(line));
+            }
+        }
+        std::cout << "✓ 使用外部服务器 " << url << "，" << tags.size() << " 个 tag" << std::endl;
+    } else {
+        const SimulatedPlant plant{server, plantOptions};
+        for (const auto& tag : plant.tags()) {
+            tags.add(tag.id);
+        }
+        serverThread = std::thread{[&] { server.run(); }};
+        url = "opc.tcp://localhost:4840";
+        std::cout << "✓ 模拟工厂已启动：" << tags.size() << " 个 tag" << std::endl;
+    }
+    if (tags.size() == 0) {
+        std::cerr << "✗ 没有 tag" << std::endl;
+        return 1;
+    }
+
+    std::cout << std::fixed << std::setprecision(2);
+
+    std::cout << "\n2. 每个监控项一个回调：" << std::endl;
+    printResult(runPerItem(url, tags, itemsPerSubscription));
+
+    std::cout << "\n3. 每个订阅一个处理函数：" << std::endl;
+    printResult(runDispatch(url, tags, itemsPerSubscription));
+
+    if (serverThread.joinable()) {
+        server.stop();
+        serverThread.join();
+    }
+
+    std::cout << "\n=== 程序已退出 ===" << std::endl;
+    return 0;
+}
+
+/**
+ * 使用说明：
+ *
+ * 1. 内置模拟工厂：./client_subscription_dispatch_annotated --channels 20 --devices 50 --tags 100（10 万个 tag）
+ * 2. 外部服务器：./client_subscription_dispatch_annotated --url opc.tcp://host:49320 --nodes nodes.txt
+ *
+ * 分发原理：
+ *
+ * 1. 创建订阅：
+ *    - UA_Client_Subscriptions_create() 的订阅上下文保存处理函数，删除订阅时由客户端释放
+ *
+ * 2. 创建监控项：
+ *    - 每个 CreateMonitoredItems 请求 1000 个监控项，全部使用同一个静态回调
+ *    - 监控项上下文是 TagHandle 本身，不分配内存
+ *
+ * 3. 通知：
+ *    - 客户端按 clientHandle 找到监控项后调用静态回调，回调取出 TagHandle 交给订阅的处理函数
+ *    - 处理函数用 TagHandle 访问 std::vector<TagState>，不需要任何查找
+ *
+ * 注意事项：
+ *
+ * - 内存增长按进程常驻内存计算；内置模拟工厂与客户端在同一进程中，服务器端监控项的内存也计入，两种方式相同
+ * - 处理函数在 runIterate() 中调用，应尽快返回
+ * - 会话重建后订阅随旧会话删除，需要在 onSessionActivated 回调中重新创建
+ * - 处理大量 tag 并需要接管订阅时使用 SubscriptionEngine，它完全绕过客户端的订阅表
+ */
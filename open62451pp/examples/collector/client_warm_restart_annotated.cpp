@@ -0,0 +1,306 @@
+/**
+ * @file client_warm_restart_annotated.cpp
+ * @brief OPC UA 采集器热重启示例 - 演示从检查点恢复订阅和最新值缓存
+ *
+ * 本示例展示了 checkpoint.hpp、subscription_engine.hpp 和 last_value_cache.hpp 的使用方法，包括：
+ * 1. 定期及退出时把采集器状态写入检查点
+ * 2. 重启后从检查点恢复 tag 列表和最新值缓存
+ * 3. 在重新连接上游服务器之前，立即通过本地服务器提供缓存的当前值
+ * 4. 通过 TransferSubscriptions 接管上一个进程的订阅，用 Republish 取回重启期间的通知
+ * 5. 无法转移的订阅自动重新创建
+ *
+ * 功能说明：
+ * - 原来每次重启都要重新连接并从头创建所有订阅和监控项
+ * - 检查点保存与会话无关的状态：订阅布局、服务器分配的 ID、修订后的参数、
+ *   最后处理的通知序号、各写入目标的偏移量以及每个 tag 的最新值
+ * - 计划重启时只关闭安全通道，保留会话中的订阅等待新进程接管
+ */
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// 包含必要的头文件
+#include <open62541pp/client.hpp>                   // 客户端核心功能
+#include <open62541pp/server.hpp>                   // 服务器核心功能
+#include <open62541pp/services/nodemanagement.hpp>  // 节点管理服务
+
+#include "../helper.hpp"              // CliParser - 命令行参数解析器
+#include "checkpoint.hpp"             // 检查点读写
+#include "collector_types.hpp"        // TagTable、Sample
+#include "last_value_cache.hpp"       // LastValueCache、CachedValueSource
+#include "local_store.hpp"            // LocalHistoryStore
+#include "subscription_engine.hpp"    // SubscriptionEngine
+
+// 全局运行状态标志，用于控制程序的运行和停止
+inline static std::atomic<bool> isRunning = true;  // NOLINT(*global-variables)
+
+static void signalHandler(int sig) noexcept {
+    if (sig == SIGINT || sig == SIGTERM) {
+        std::cout << "\n接收到信号 " << sig << "，正在保存检查点并退出..." << std::endl;
+        isRunning = false;
+    }
+}
+
+// 按逗号拆分 tag 列表
+static std::vector<std::string_view> splitTags(std::string_view list) {
+    std::vector<std::string_view> result;
+    while (!list.empty()) {
+        const auto pos = list.find(',');
+        result.push_back(list.substr(0, pos));
+        if (pos == std::string_view::npos) {
+            break;
+        }
+        list.remove_prefix(pos + 1);
+    }
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "=== OPC UA 采集器热重启示例 ===" << std::endl;
+
+    const CliParser parser{argc, argv};
+    const std::string url{parser.value("--url").value_or("opc.tcp://localhost:49320")};
+    const std::string checkpointPath{parser.value("--checkpoint").value_or("collector.checkpoint")};
+    const int checkpointSeconds = std::stoi(std::string{parser.value("--interval").value_or("10")});
+    const bool coldStop = parser.hasFlag("--cold-stop");
+
+    std::cout << "1. 读取检查点..." << std::endl;
+
+    const auto startedAt = std::chrono::steady_clock::now();
+    auto checkpoint = loadCheckpoint(checkpointPath);
+    if (checkpoint && checkpoint->endpointUrl != url) {
+        std::cout << "检查点属于其他服务器 " << checkpoint->endpointUrl << "，忽略" << std::endl;
+        checkpoint.reset();
+    }
+
+    TagTable tags;
+    LastValueCache cache;
+    if (checkpoint) {
+        // 按检查点中的顺序登记，TagHandle 与上一个进程一致
+        for (const auto& name : checkpoint->tags) {
+            tags.add(parseNodeId(name));
+        }
+        cache.restore(checkpoint->lastValues);
+        std::cout << "✓ 已恢复 " << checkpoint->tags.size() << " 个 tag、"
+                  << checkpoint->subscriptions.size() << " 个订阅、"
+                  << checkpoint->lastValues.size() << " 个最新值" << std::endl;
+    } else {
+        std::vector<std::string_view> tagNames{
+            "ns=2;s=Simulation Examples.Functions.Ramp1",
+            "ns=2;s=Simulation Examples.Functions.Ramp2",
+            "ns=2;s=Simulation Examples.Functions.Sine1",
+            "ns=2;s=Simulation Examples.Functions.Random1",
+        };
+        if (const auto list = parser.value("--tags")) {
+            tagNames = splitTags(*list);
+        }
+        for (const auto name : tagNames) {
+            tags.add(parseNodeId(name));
+        }
+        std::cout << "没有可用的检查点，冷启动 " << tags.size() << " 个 tag" << std::endl;
+    }
+
+    std::cout << "2. 启动本地服务器，提供缓存的当前值..." << std::endl;
+
+    // 本地服务器在连接上游之前就开始提供数据
+    // 恢复自检查点的值状态为 UncertainLastUsableValue，收到新采样后变为上游的状态码
+    opcua::ServerConfig config{4841};
+    opcua::Server server{std::move(config)};
+    std::deque<CachedValueSource> sources;
+    for (TagHandle tag = 0; tag < tags.size(); ++tag) {
+        const std::string name = opcua::toString(tags.nodeId(tag));
+        const auto id = opcua::services::addVariable(
+            server,
+            opcua::ObjectId::ObjectsFolder,
+            {1, tag + 1},
+            name,
+            opcua::VariableAttributes{}
+                .setAccessLevel(UA_ACCESSLEVELMASK_READ)
+                .setDataType<double>(),
+            opcua::VariableTypeId::BaseDataVariableType,
+            opcua::ReferenceTypeId::HasComponent
+        ).value();
+        opcua::setVariableNodeValueBackend(server, id, sources.emplace_back(cache, tag));
+    }
+    std::thread serverThread{[&] { server.run(); }};
+    const std::chrono::duration<double, std::milli> serveDelay =
+        std::chrono::steady_clock::now() - startedAt;
+    std::cout << "✓ 本地服务器 opc.tcp://localhost:4841 已就绪，启动后 " << serveDelay.count()
+              << " ms 开始提供数据" << std::endl;
+
+    std::cout << "3. 创建订阅引擎..." << std::endl;
+
+    const auto maxGap = static_cast<int64_t>(5 * 1000) * UA_DATETIME_MSEC;
+    LocalHistoryStore store{maxGap, "collector.journal"};
+
+    opcua::Client client;
+    SubscriptionEngineOptions options{};
+    options.publishingInterval = 1000.0;  // 发布间隔 1 秒
+    options.samplingInterval = 500.0;     // 采样间隔 500 毫秒
+    options.lifetimeCount = 600;          // 没有 Publish 请求时订阅保留 10 分钟
+    SubscriptionEngine engine{client, tags, options};
+
+    // 写入目标的偏移量从检查点继续计数
+    auto offsetOf = [&](std::string_view name) -> uint64_t {
+        if (checkpoint) {
+            for (const auto& [sinkName, offset] : checkpoint->sinkOffsets) {
+                if (sinkName == name) {
+                    return offset;
+                }
+            }
+        }
+        return 0;
+    };
+    engine.addSink("history", store, offsetOf("history"));
+    engine.addSink("cache", cache, offsetOf("cache"));
+
+    // 写入检查点
+    auto writeCheckpoint = [&] {
+        CollectorCheckpoint cp;
+        cp.savedAt = UA_DateTime_now();
+        cp.endpointUrl = url;
+        for (TagHandle tag = 0; tag < tags.size(); ++tag) {
+            cp.tags.push_back(opcua::toString(tags.nodeId(tag)));
+        }
+        engine.checkpoint(cp);
+        cp.lastValues = cache.snapshot();
+        if (!saveCheckpoint(checkpointPath, cp)) {
+            std::cout << "检查点写入失败: " << checkpointPath << std::endl;
+        }
+    };
+
+    // 会话激活回调中只做标记，订阅在主循环中恢复或创建
+    bool sessionActivated = false;
+    client.onSessionActivated([&] { sessionActivated = true; });
+
+    std::signal(SIGINT, signalHandler);  // NOLINT
+    std::signal(SIGTERM, signalHandler);  // NOLINT
+
+    auto lastCheckpoint = std::chrono::steady_clock::now();
+
+    while (isRunning) {
+        try {
+            std::cout << "正在连接到服务器 " << url << "..." << std::endl;
+            client.connect(url);
+            std::cout << "✓ 连接成功！" << std::endl;
+
+            while (isRunning) {
+                client.runIterate(50);
+
+                if (sessionActivated) {
+                    sessionActivated = false;
+                    const auto t0 = std::chrono::steady_clock::now();
+                    if (checkpoint && !checkpoint->subscriptions.empty()) {
+                        // 热启动：接管上一个进程的订阅
+                        const size_t transferred = engine.restore(checkpoint->subscriptions);
+                        std::cout << "✓ 已转移 " << transferred << "/" << checkpoint->subscriptions.size()
+                                  << " 个订阅，重新创建 " << engine.stats().subscriptionsCreated
+                                  << " 个，Republish " << engine.stats().republished << " 条通知"
+                                  << std::endl;
+                        checkpoint.reset();
+                    } else if (engine.subscriptionCount() > 0) {
+                        // 断线重连：恢复本进程的订阅
+                        engine.resume();
+                        std::cout << "✓ 已恢复 " << engine.subscriptionCount() << " 个订阅" << std::endl;
+                    } else {
+                        engine.create();
+                        std::cout << "✓ 已创建 " << engine.subscriptionCount() << " 个订阅" << std::endl;
+                    }
+                    const std::chrono::duration<double, std::milli> elapsed =
+                        std::chrono::steady_clock::now() - t0;
+                    std::cout << "订阅就绪耗时 " << elapsed.count() << " ms" << std::endl;
+                }
+
+                engine.publish();
+
+                const auto now = std::chrono::steady_clock::now();
+                if (now - lastCheckpoint >= std::chrono::seconds{checkpointSeconds}) {
+                    lastCheckpoint = now;
+                    writeCheckpoint();
+                }
+            }
+
+        } catch (const opcua::BadStatus& e) {
+            std::cout << "连接错误: " << e.what() << std::endl;
+            client.disconnect();
+            std::cout << "3 秒后重试连接..." << std::endl;
+            std::this_thread::sleep_for(std::chrono::seconds{3});
+        }
+    }
+
+    std::cout << "程序正在关闭..." << std::endl;
+
+    if (coldStop) {
+        // 关闭会话并删除订阅，下一个进程将冷启动
+        client.disconnect();
+        std::remove(checkpointPath.c_str());
+    } else {
+        // 先写检查点，再只关闭安全通道，订阅保留在服务器上等待下一个进程接管
+        writeCheckpoint();
+        std::cout << "✓ 检查点已写入 " << checkpointPath << std::endl;
+        engine.detach();
+    }
+
+    server.stop();
+    serverThread.join();
+
+    const auto& stats = engine.stats();
+    std::cout << "\n=== 运行统计 ===" << std::endl;
+    std::cout << "创建订阅:      " << stats.subscriptionsCreated << std::endl;
+    std::cout << "转移订阅:      " << stats.subscriptionsTransferred << std::endl;
+    std::cout << "Republish:     " << stats.republished << "（失败 " << stats.republishFailed << "）" << std::endl;
+    std::cout << "Publish 错误:  " << stats.publishErrors << std::endl;
+    std::cout << "通知消息:      " << stats.notifications << std::endl;
+    std::cout << "采样:          " << stats.samples << std::endl;
+
+    std::cout << "=== 程序已退出 ===" << std::endl;
+    return 0;
+}
+
+/**
+ * 使用说明：
+ *
+ * 1. 第一次运行：./client_warm_restart_annotated --url opc.tcp://host:49320 --tags "ns=2;s=A,ns=2;s=B"
+ * 2. 按 Ctrl+C 退出，检查点写入 collector.checkpoint，订阅保留在上游服务器
+ * 3. 再次运行（无需 --tags），观察订阅转移和 Republish 的结果
+ * 4. 重启期间用 UaExpert 连接 opc.tcp://localhost:4841，可以立即读到缓存的值
+ * 5. 使用 --cold-stop 退出时删除订阅和检查点
+ *
+ * 热重启工作原理：
+ *
+ * 1. 检查点内容：
+ *    - tag 列表按 TagHandle 顺序保存，重启后编号不变
+ *    - 每个订阅：服务器分配的订阅 ID、修订后的发布间隔/生存周期/保活周期、最后处理的序号
+ *    - 每个监控项：tag、监控项 ID、修订后的采样间隔和队列长度（clientHandle 就是 TagHandle）
+ *    - 写入目标偏移量和最新值缓存
+ *    - 先写入临时文件再重命名，写入过程中崩溃不会损坏旧的检查点
+ *
+ * 2. 退出：
+ *    - client.disconnect() 关闭会话时服务器会删除订阅
+ *    - 计划重启时只关闭安全通道，会话和订阅在服务器上继续存在
+ *    - 服务器继续采样，通知消息在订阅中排队等待 Publish 请求
+ *
+ * 3. 启动：
+ *    - 本地服务器先用缓存提供数据，不必等待上游连接
+ *    - 会话激活后调用 TransferSubscriptions（sendInitialValues = true）
+ *    - 对序号大于检查点的可用通知消息调用 Republish，补上重启期间的数据
+ *    - 已由上一个进程处理但尚未确认的消息只确认，不重复处理
+ *    - Republish 失败的消息不确认，服务器继续保留，计入 republishFailed
+ *    - 转移失败的订阅中的 tag 重新创建
+ *
+ * 注意事项：
+ *
+ * - 订阅在 lifetimeCount × 发布间隔内没有 Publish 请求会被服务器删除，重启必须在此之前完成
+ * - TransferSubscriptions 要求新会话使用与原会话相同的用户身份
+ * - 会话超时（sessionTimeout）后服务器关闭会话，订阅可能随之删除
+ * - 检查点之后、退出之前处理的通知会再次写入，LocalHistoryStore 按时间戳去重
+ */
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+#include <open62541/types.h>
+
+#include <open62541pp/types.hpp>
+
+// 数据采集系统的公共类型
+// - TagHandle：采集点（tag）在采集器内部的紧凑编号，用作各种平铺数组的下标
+// - Sample：一个采样值（数值型），时间戳使用 OPC UA DateTime 的原始值（100ns，自 1601 年起）
+// - HistorySink：历史数据的写入目标（本地存储、MySQL 等）
+// - TagTable：NodeId 与 TagHandle 的双向映射
+
+using TagHandle = uint32_t;
+
+inline constexpr TagHandle invalidTagHandle = UINT32_MAX;
+
+struct Sample {
+    TagHandle tag;
+    int64_t sourceTime;  // 源时间戳
+    int64_t serverTime;  // 服务器时间戳
+    double value;
+    uint32_t status;  // OPC UA 状态码
+};
+
+// 从 DataValue 提取数值型采样值；非数值类型返回 false
+inline bool toSample(const UA_DataValue& dv, TagHandle tag, Sample& sample) noexcept {
+    sample.tag = tag;
+    sample.sourceTime = dv.hasSourceTimestamp ? dv.sourceTimestamp : 0;
+    sample.serverTime = dv.hasServerTimestamp ? dv.serverTimestamp : 0;
+    sample.status = dv.hasStatus ? dv.status : UA_STATUSCODE_GOOD;
+    sample.value = 0.0;
+    if (!dv.hasValue || !UA_Variant_isScalar(&dv.value) || dv.value.data == nullptr) {
+        return sample.status != UA_STATUSCODE_GOOD;  // 无值但带错误状态码的采样仍然有意义
+    }
+    const void* data = dv.value.data;
+    switch (dv.value.type->typeKind) {
+    case UA_DATATYPEKIND_BOOLEAN: sample.value = *static_cast<const UA_Boolean*>(data) ? 1.0 : 0.0; break;
+    case UA_DATATYPEKIND_SBYTE: sample.value = *static_cast<const UA_SByte*>(data); break;
+    case UA_DATATYPEKIND_BYTE: sample.value = *static_cast<const UA_Byte*>(data); break;
+    case UA_DATATYPEKIND_INT16: sample.value = *static_cast<const UA_Int16*>(data); break;
+    case UA_DATATYPEKIND_UINT16: sample.value = *static_cast<const UA_UInt16*>(data); break;
+    case UA_DATATYPEKIND_INT32: sample.value = *static_cast<const UA_Int32*>(data); break;
+    case UA_DATATYPEKIND_UINT32: sample.value = *static_cast<const UA_UInt32*>(data); break;
+    case UA_DATATYPEKIND_INT64:
+        sample.value = static_cast<double>(*static_cast<const UA_Int64*>(data));
+        break;
+    case UA_DATATYPEKIND_UINT64:
+        sample.value = static_cast<double>(*static_cast<const UA_UInt64*>(data));
+        break;
+    case UA_DATATYPEKIND_FLOAT: sample.value = *static_cast<const UA_Float*>(data); break;
+    case UA_DATATYPEKIND_DOUBLE: sample.value = *static_cast<const UA_Double*>(data); break;
+    case UA_DATATYPEKIND_ENUM: sample.value = *static_cast<const UA_Int32*>(data); break;
+    default: return false;
+    }
+    return true;
+}
+
+// 采样时间：优先使用源时间戳
+inline int64_t sampleTime(const Sample& sample) noexcept {
+    return sample.sourceTime != 0 ? sample.sourceTime : sample.serverTime;
+}
+
+// 解析 NodeId 字符串，例如 "ns=2;s=Channel1.Device1.Tag1"
+inline opcua::NodeId parseNodeId(std::string_view text) {
+    opcua::NodeId id;
+    UA_String native{text.size(), reinterpret_cast<UA_Byte*>(const_cast<char*>(text.data()))};
+    const UA_StatusCode status = UA_NodeId_parse(id.handle(), native);
+    if (status != UA_STATUSCODE_GOOD) {
+        throw opcua::BadStatus{status};
+    }
+    return id;
+}
+
+// 历史数据写入目标
+class HistorySink {
+public:
+    virtual ~HistorySink() = default;
+
+    /// 写入一批采样值；同一 tag 的采样按时间顺序排列
+    virtual void write(opcua::Span<const Sample> samples) = 0;
+};
+
+// 一个 Publish 响应中的一个数据变化通知
+struct FrameItem {
+    TagHandle tag;
+    const UA_DataValue* value;
+};
+
+// 一个 Publish 响应的全部数据变化通知；items 只在 writeFrame() 调用期间有效
+struct PublishFrame {
+    uint32_t subscriptionId;
+    uint32_t sequenceNumber;
+    int64_t publishTime;  // 服务器发送通知消息的时间（DateTime）
+    opcua::Span<const FrameItem> items;
+};
+
+// 按 Publish 响应整体接收通知的写入目标，例如需要一致的多 tag 快照的计算、按帧提交事务的存储
+class FrameSink {
+public:
+    virtual ~FrameSink() = default;
+
+    /// 一个 Publish 响应的全部通知在同一次调用中交付，顺序与响应中相同
+    virtual void writeFrame(const PublishFrame& frame) = 0;
+};
+
+// NodeId 与 TagHandle 的双向映射
+class TagTable {
+public:
+    TagHandle add(const opcua::NodeId& nodeId) {
+        std::lock_guard lock{mutex_};
+        const auto [it, inserted] = handles_.emplace(nodeId, static_cast<TagHandle>(nodeIds_.size()));
+        if (inserted) {
+            nodeIds_.push_back(nodeId);
+        }
+        return it->second;
+    }
+
+    std::optional<TagHandle> find(const opcua::NodeId& nodeId) const {
+        std::lock_guard lock{mutex_};
+        const auto it = handles_.find(nodeId);
+        if (it == handles_.end()) {
+            return std::nullopt;
+        }
+        return it->second;
+    }
+
+    const opcua::NodeId& nodeId(TagHandle handle) const {
+        std::lock_guard lock{mutex_};
+        return nodeIds_.at(handle);
+    }
+
+    /// 节点已从服务器删除：NodeId 不再映射到 handle，handle 不会分配给其他节点
+    std::optional<TagHandle> remove(const opcua::NodeId& nodeId) {
+        std::lock_guard lock{mutex_};
+        const auto it = handles_.find(nodeId);
+        if (it == handles_.end()) {
+            return std::nullopt;
+        }
+        const TagHandle handle = it->second;
+        handles_.erase(it);
+        return handle;
+    }
+
+    /// handle 是否仍然有效（未被 remove）
+    bool active(TagHandle handle) const {
+        std::lock_guard lock{mutex_};
+        const auto it = handles_.find(nodeIds_.at(handle));
+        return it != handles_.end() && it->second == handle;
+    }
+
+    size_t size() const {
+        std::lock_guard lock{mutex_};
+        return nodeIds_.size();
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::unordered_map<opcua::NodeId, TagHandle> handles_;
+    std::deque<opcua::NodeId> nodeIds_;  // deque：追加时已有元素的引用保持有效
+};
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "collector_types.hpp"
+
+struct DecodePoolOptions {
+    size_t threads = 4;        // 工作线程数
+    size_t rangeSize = 2000;   // 每个区间的元素数
+    size_t minItems = 5000;    // 少于这个数的响应在调用线程中转换
+};
+
+struct DecodePoolStats {
+    uint64_t jobs = 0;
+    uint64_t parallelJobs = 0;  // 拆分到工作线程的响应
+    uint64_t ranges = 0;
+    uint64_t items = 0;
+    uint64_t samples = 0;
+    size_t maxPending = 0;  // 同时未交付的响应数的最大值
+};
+
+/**
+ * @brief 把大响应的采样转换分给工作线程
+ *
+ * open62541 客户端在 runIterate() 中解码响应后调用回调，两万个通知的 Publish 响应
+ * 在同一个线程中逐个转换为 Sample、写入各写入目标、再释放响应，期间其他响应都要等待。
+ * 引擎在回调中接管响应（之后由工作线程释放），把元素数组按 rangeSize 拆成区间并行转换：
+ *
+ * - convert(begin, end, out) 在工作线程中调用，只能读取响应和调用时复制的数据
+ * - deliver(samples) 在 drain() 中调用，即引擎所在的线程；写入目标仍然只被一个线程调用
+ * - 区间按顺序拼接，响应按提交顺序交付，每个 tag 的采样顺序与不使用线程池时相同
+ *
+ * submit() 和 drain() 在同一线程中调用（与 client.runIterate() 相同）。
+ */
+class DecodePool {
+public:
+    using Convert = std::function<void(size_t begin, size_t end, std::vector<Sample>& out)>;
+    using Deliver = std::function<void(std::vector<Sample>& samples)>;
+
+    explicit DecodePool(DecodePoolOptions options = {})
+        : options_{options} {
+        if (options_.threads == 0 || options_.rangeSize == 0) {
+            throw std::invalid_argument{"DecodePool: threads and rangeSize must be positive"};
+        }
+        for (size_t i = 0; i < options_.threads; ++i) {
+            threads_.emplace_back([this] { run(); });
+        }
+    }
+
+    ~DecodePool() {
+        {
+            std::lock_guard lock{mutex_};
+            stopping_ = true;
+        }
+        wakeup_.notify_all();
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    DecodePool(const DecodePool&) = delete;
+    DecodePool& operator=(const DecodePool&) = delete;
+
+    /**
+     * @brief 提交一个响应的 count 个元素
+     *
+     * convert 持有的数据（例如接管的响应）在最后一个区间转换完成后、交付之前释放。
+     */
+    void submit(size_t count, Convert convert, Deliver deliver) {
+        auto job = std::make_unique<Job>();
+        job->deliver = std::move(deliver);
+        ++stats_.jobs;
+        stats_.items += count;
+        if (count == 0 || count < options_.minItems) {
+            // 小响应不值得切换线程；仍然排队交付，保持与前面响应的顺序
+            // count 为 0 时没有区间可分发，必须在这里完成，否则 done 永远不会置位，之后的交付全部阻塞
+            job->outputs.resize(1);
+            convert(0, count, job->outputs[0]);
+            job->done.store(true, std::memory_order_relaxed);
+            jobs_.push_back(std::move(job));
+        } else {
+            const size_t ranges = (count + options_.rangeSize - 1) / options_.rangeSize;
+            job->count = count;
+            job->convert = std::move(convert);
+            job->outputs.resize(ranges);
+            job->remaining.store(ranges, std::memory_order_relaxed);
+            ++stats_.parallelJobs;
+            stats_.ranges += ranges;
+            Job* raw = job.get();
+            jobs_.push_back(std::move(job));
+            {
+                std::lock_guard lock{mutex_};
+                for (size_t r = 0; r < ranges; ++r) {
+                    tasks_.push_back({raw, r});
+                }
+            }
+            wakeup_.notify_all();
+        }
+        stats_.maxPending = std::max(stats_.maxPending, jobs_.size());
+    }
+
+    /**
+     * @brief 按提交顺序交付已转换完的响应
+     *
+     * 遇到尚未完成的响应即停止，之后提交的响应即使已完成也等待。
+     * @return 交付的响应数
+     */
+    size_t drain() {
+        size_t delivered = 0;
+        while (!jobs_.empty() && jobs_.front()->done.load(std::memory_order_acquire)) {
+            auto job = std::move(jobs_.front());
+            jobs_.pop_front();
+            auto& samples = job->outputs[0];
+            for (size_t r = 1; r < job->outputs.size(); ++r) {
+                samples.insert(samples.end(), job->outputs[r].begin(), job->outputs[r].end());
+            }
+            stats_.samples += samples.size();
+            job->deliver(samples);
+            ++delivered;
+        }
+        return delivered;
+    }
+
+    /// 等待所有已提交的响应转换完成并交付（例如在断开连接或写检查点之前）
+    void flush() {
+        while (!jobs_.empty()) {
+            drain();
+            if (!jobs_.empty()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    size_t pending() const noexcept {
+        return jobs_.size();
+    }
+
+    const DecodePoolOptions& options() const noexcept {
+        return options_;
+    }
+
+    const DecodePoolStats& stats() const noexcept {
+        return stats_;
+    }
+
+private:
+    struct Job {
+        size_t count = 0;
+        Convert convert;
+        Deliver deliver;
+        std::vector<std::vector<Sample>> outputs;  // 每个区间一个
+        std::atomic<size_t> remaining{0};
+        std::atomic<bool> done{false};
+    };
+
+    struct Task {
+        Job* job;
+        size_t range;
+    };
+
+    void run() {
+        for (;;) {
+            Task task{};
+            {
+                std::unique_lock lock{mutex_};
+                wakeup_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+                if (stopping_) {
+                    return;
+                }
+                task = tasks_.front();
+                tasks_.pop_front();
+            }
+            Job& job = *task.job;
+            const size_t begin = task.range * options_.rangeSize;
+            const size_t end = std::min(job.count, begin + options_.rangeSize);
+            auto& out = job.outputs[task.range];
+            out.reserve(end - begin);
+            job.convert(begin, end, out);
+            if (job.remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                job.convert = nullptr;  // 在工作线程中释放接管的响应
+                job.done.store(true, std::memory_order_release);
+            }
+        }
+    }
+
+    DecodePoolOptions options_;
+    std::deque<std::unique_ptr<Job>> jobs_;  // 按提交顺序，只在调用线程中访问
+    DecodePoolStats stats_;
+
+    std::mutex mutex_;
+    std::condition_variable wakeup_;
+    std::deque<Task> tasks_;
+    bool stopping_ = false;
+    std::vector<std::thread> threads_;
+};
@@ -0,0 +1,205 @@
+/**
+ * @file decode_pool_benchmark.cpp
+ * @brief 大响应并行转换对比 - 比较在网络线程中直接转换和交给 DecodePool 时网络线程被占用的时间
+ *
+ * 本程序构造与批量 Read 响应相同的 DataValue 数组（double、状态码、源时间戳和服务器时间戳），
+ * 模拟网络线程连续收到多个大响应：
+ * 1. inline：在回调中逐个转换为 Sample、写入写入目标、释放响应（引擎原来的方式）
+ * 2. pool：回调中接管响应并提交给 DecodePool，主循环中按顺序交付
+ *
+ * 对每种方式输出：网络线程在回调和交付中占用的总时间、单个回调的最长时间、全部采样交付完成的时间，
+ * 并检查两种方式交付的采样顺序一致。
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <open62541/types.h>
+
+#include "../helper.hpp"        // CliParser - 命令行参数解析器
+#include "collector_types.hpp"  // Sample、toSample
+#include "decode_pool.hpp"      // DecodePool
+
+using Clock = std::chrono::steady_clock;
+
+// 构造一个 count 个 DataValue 的 Read 响应，值为 first 开始的连续整数
+static UA_ReadResponse makeResponse(size_t count, size_t first) {
+    UA_ReadResponse response;
+    UA_ReadResponse_init(&response);
+    response.results = static_cast<UA_DataValue*>(UA_Array_new(count, &UA_TYPES[UA_TYPES_DATAVALUE]));
+    response.resultsSize = count;
+    const UA_DateTime now = UA_DateTime_now();
+    for (size_t i = 0; i < count; ++i) {
+        auto& dv = response.results[i];
+        const double value = static_cast<double>(first + i);
+        UA_Variant_setScalarCopy(&dv.value, &value, &UA_TYPES[UA_TYPES_DOUBLE]);
+        dv.hasValue = true;
+        dv.sourceTimestamp = now;
+        dv.hasSourceTimestamp = true;
+        dv.serverTimestamp = now;
+        dv.hasServerTimestamp = true;
+    }
+    return response;
+}
+
+// 模拟写入目标：复制采样并计算校验和
+class ChecksumSink : public HistorySink {
+public:
+    void write(opcua::Span<const Sample> samples) override {
+        for (const auto& s : samples) {
+            checksum = checksum * 31 + static_cast<uint64_t>(s.value) + s.tag;
+        }
+        count += samples.size();
+    }
+
+    uint64_t checksum = 0;
+    size_t count = 0;
+};
+
+struct RunResult {
+    double loopSeconds = 0.0;      // 网络线程在回调和交付中的时间
+    double maxCallbackSeconds = 0.0;
+    double totalSeconds = 0.0;
+    uint64_t checksum = 0;
+    size_t samples = 0;
+};
+
+static RunResult run(size_t responses, size_t items, DecodePool* pool) {
+    // 先构造全部响应，构造时间不计入
+    std::vector<UA_ReadResponse> inbox;
+    for (size_t r = 0; r < responses; ++r) {
+        inbox.push_back(makeResponse(items, r * items));
+    }
+    ChecksumSink sink;
+    RunResult result;
+    std::vector<Sample> batch;
+    const auto start = Clock::now();
+    for (size_t r = 0; r < responses; ++r) {
+        auto& response = inbox[r];
+        const auto t0 = Clock::now();
+        if (pool == nullptr) {
+            batch.clear();
+            for (size_t i = 0; i < response.resultsSize; ++i) {
+                Sample sample{};
+                if (toSample(response.results[i], static_cast<TagHandle>(i), sample)) {
+                    batch.push_back(sample);
+                }
+            }
+            sink.write(batch);
+            UA_ReadResponse_clear(&response);  // 客户端在回调返回后释放响应
+        } else {
+            std::shared_ptr<UA_ReadResponse> owned{
+                new UA_ReadResponse{response},
+                [](UA_ReadResponse* p) {
+                    UA_ReadResponse_clear(p);
+                    delete p;
+                }
+            };
+            UA_ReadResponse_init(&response);
+            pool->submit(
+                owned->resultsSize,
+                [owned](size_t begin, size_t end, std::vector<Sample>& out) {
+                    for (size_t i = begin; i < end; ++i) {
+                        Sample sample{};
+                        if (toSample(owned->results[i], static_cast<TagHandle>(i), sample)) {
+                            out.push_back(sample);
+                        }
+                    }
+                },
+                [&sink](std::vector<Sample>& samples) { sink.write(samples); }
+            );
+            pool->drain();
+        }
+        const double callback = std::chrono::duration<double>(Clock::now() - t0).count();
+        result.loopSeconds += callback;
+        result.maxCallbackSeconds = std::max(result.maxCallbackSeconds, callback);
+    }
+    if (pool != nullptr) {
+        // 主循环中的交付：计入网络线程时间，等待本身不计入
+        while (pool->pending() > 0) {
+            const auto t0 = Clock::now();
+            pool->drain();
+            result.loopSeconds += std::chrono::duration<double>(Clock::now() - t0).count();
+        }
+    }
+    result.totalSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    result.checksum = sink.checksum;
+    result.samples = sink.count;
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "=== 大响应并行转换对比 ===" << std::endl;
+
+    // --responses <数量>：响应数，默认 50
+    // --items <数量>：每个响应的 DataValue 数，默认 20000
+    // --threads <数量>：工作线程数，默认 4
+    // --range <数量>：每个区间的元素数，默认 2000
+    const CliParser parser{argc, argv};
+    const size_t responses = std::stoul(std::string{parser.value("--responses").value_or("50")});
+    const size_t items = std::stoul(std::string{parser.value("--items").value_or("20000")});
+
+    DecodePoolOptions options;
+    options.threads = std::stoul(std::string{parser.value("--threads").value_or("4")});
+    options.rangeSize = std::stoul(std::string{parser.value("--range").value_or("2000")});
+
+    std::cout << responses << " 个响应 × " << items << " 个 DataValue，" << options.threads << " 个工作线程，每个区间 "
+              << options.rangeSize << " 个" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+
+    const auto print = [](const char* name, const RunResult& r) {
+        std::cout << "  " << name << "  网络线程占用 " << std::setw(8) << r.loopSeconds * 1000.0 << " 毫秒  单个回调最长 "
+                  << std::setw(7) << r.maxCallbackSeconds * 1000.0 << " 毫秒  全部交付 " << std::setw(8)
+                  << r.totalSeconds * 1000.0 << " 毫秒  采样 " << r.samples << std::endl;
+    };
+
+    const auto inlineResult = run(responses, items, nullptr);
+    print("inline", inlineResult);
+
+    DecodePool pool{options};
+    const auto poolResult = run(responses, items, &pool);
+    print("pool  ", poolResult);
+
+    if (poolResult.checksum != inlineResult.checksum || poolResult.samples != inlineResult.samples) {
+        std::cerr << "✗ 两种方式交付的采样不一致" << std::endl;
+        return 1;
+    }
+    std::cout << "✓ 两种方式交付的采样和顺序一致" << std::endl;
+    std::cout << "  线程池：并行转换 " << pool.stats().parallelJobs << " 个响应，" << pool.stats().ranges
+              << " 个区间，最多 " << pool.stats().maxPending << " 个响应等待交付" << std::endl;
+    return 0;
+}
+
+/**
+ * 使用说明：
+ *
+ * 1. 运行：./decode_pool_benchmark --responses 50 --items 20000 --threads 4
+ * 2. 在引擎中使用：
+ *    DecodePool pool{options};
+ *    engine.useDecodePool(pool);      // SubscriptionEngine 或 PollEngine
+ *
+ * 并行转换原理：
+ *
+ * 1. 接管响应：回调中把响应结构体复制到堆上并把原结构体置空，客户端随后清理的是空响应
+ * 2. 拆分：元素数不少于 minItems 的响应按 rangeSize 拆成区间，交给工作线程转换为 Sample
+ * 3. 释放：最后一个区间完成时在工作线程中释放响应，几万个 Variant 的释放也不占用网络线程
+ * 4. 交付：引擎的 publish() / poll() 调用 drain()，按提交顺序把完成的响应交给写入目标
+ *
+ * 结果解读：
+ *
+ * - 网络线程占用越少，runIterate() 越早处理下一个响应、发送下一个 Publish 请求
+ * - 单个回调最长时间决定网络线程一次被阻塞多久
+ * - 交付仍在网络线程中进行，写入目标本身较慢时应使用 MySqlWriterPool 等异步写入目标
+ *
+ * 注意事项：
+ *
+ * - open62541 客户端在调用回调之前已完成二进制解码，线程池并行的是采样转换、交付前的拼接和响应的释放
+ * - Publish 响应在交付之后才确认，进程在交付前退出时服务器会重新发送这些通知
+ * - 响应按提交顺序交付，一个很大的响应会让之后的小响应等待它完成
+ */
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <open62541/client_subscriptions.h>
+
+#include <open62541pp/client.hpp>
+
+#include "collector_types.hpp"
+
+// 分发订阅参数
+struct DispatchOptions {
+    double publishingInterval = 1000.0;  // 发布间隔（毫秒）
+    double samplingInterval = 500.0;     // 采样间隔（毫秒）
+    uint32_t queueSize = 1;              // 监控项队列长度
+    size_t itemsPerRequest = 1000;       // 每个 CreateMonitoredItems 请求的监控项数
+    bool publishing = true;              // 创建后是否启用发布
+    UA_TimestampsToReturn timestampsToReturn = UA_TIMESTAMPSTORETURN_BOTH;
+};
+
+/// 一个订阅的所有监控项共用的通知处理函数；tag 可以直接作为每个 tag 状态数组的下标
+using DataChangeHandler = std::function<void(TagHandle tag, const UA_DataValue& value)>;
+
+/**
+ * @brief 整个订阅共用一个处理函数的订阅
+ *
+ * opcua::Subscription::subscribeDataChange() 为每个监控项保存一个 std::function，
+ * 回调中通常还要构造 opcua::MonitoredItem 查询 NodeId 等信息；10 万个监控项就是 10 万次分配，
+ * 每个通知一次间接调用和一次查找。这里改为：
+ * - 订阅的上下文保存唯一的处理函数，所有监控项注册同一个静态回调
+ * - 监控项的上下文就是 TagHandle（不分配内存），回调直接把它交给处理函数
+ * - 处理函数按 TagHandle 访问自己的 std::vector<状态>，不需要按监控项 ID 查找
+ *
+ * 订阅的上下文由客户端在删除订阅时释放（deleteSubscription()、会话关闭、客户端析构），
+ * 会话重建后需要重新创建订阅，与 opcua::Subscription 相同。
+ * 所有方法和 client.runIterate() 在同一线程中调用。
+ */
+class DispatchSubscription {
+public:
+    DispatchSubscription(
+        opcua::Client& client, const TagTable& tags, DataChangeHandler handler, DispatchOptions options = {}
+    )
+        : client_{&client},
+          tags_{&tags},
+          options_{options} {
+        UA_CreateSubscriptionRequest request = UA_CreateSubscriptionRequest_default();
+        request.requestedPublishingInterval = options_.publishingInterval;
+        request.publishingEnabled = options_.publishing;
+        auto context = std::make_unique<Context>(Context{std::move(handler)});
+        UA_CreateSubscriptionResponse response = UA_Client_Subscriptions_create(
+            client_->handle(), request, context.get(), nullptr, onDeleteSubscription
+        );
+        const UA_StatusCode status = response.responseHeader.serviceResult;
+        subscriptionId_ = response.subscriptionId;
+        UA_CreateSubscriptionResponse_clear(&response);
+        if (status != UA_STATUSCODE_GOOD) {
+            throw opcua::BadStatus{status};
+        }
+        context.release();  // 所有权交给客户端，在 onDeleteSubscription 中释放
+    }
+
+    DispatchSubscription(DispatchSubscription&& other) noexcept
+        : client_{other.client_},
+          tags_{other.tags_},
+          options_{other.options_},
+          subscriptionId_{std::exchange(other.subscriptionId_, 0)},
+          itemCount_{other.itemCount_} {}
+
+    DispatchSubscription& operator=(DispatchSubscription&&) = delete;
+    DispatchSubscription(const DispatchSubscription&) = delete;
+    DispatchSubscription& operator=(const DispatchSubscription&) = delete;
+
+    /**
+     * @brief 为 tag 创建监控项
+     * @return 创建成功的监控项数
+     */
+    size_t addTags(opcua::Span<const TagHandle> tags) {
+        size_t created = 0;
+        for (size_t offset = 0; offset < tags.size(); offset += options_.itemsPerRequest) {
+            const size_t count = std::min(options_.itemsPerRequest, tags.size() - offset);
+            std::vector<UA_MonitoredItemCreateRequest> items(count);
+            std::vector<void*> contexts(count);
+            std::vector<UA_Client_DataChangeNotificationCallback> callbacks(count, onDataChange);
+            std::vector<UA_Client_DeleteMonitoredItemCallback> deleteCallbacks(count, nullptr);
+            for (size_t i = 0; i < count; ++i) {
+                const TagHandle tag = tags[offset + i];
+                auto& item = items[i];
+                UA_MonitoredItemCreateRequest_init(&item);
+                item.itemToMonitor.nodeId = *tags_->nodeId(tag).handle();  // 浅拷贝
+                item.itemToMonitor.attributeId = UA_ATTRIBUTEID_VALUE;
+                item.monitoringMode = UA_MONITORINGMODE_REPORTING;
+                item.requestedParameters.samplingInterval = options_.samplingInterval;
+                item.requestedParameters.queueSize = options_.queueSize;
+                item.requestedParameters.discardOldest = true;
+                contexts[i] = reinterpret_cast<void*>(static_cast<uintptr_t>(tag));
+            }
+            UA_CreateMonitoredItemsRequest request;
+            UA_CreateMonitoredItemsRequest_init(&request);
+            request.subscriptionId = subscriptionId_;
+            request.timestampsToReturn = options_.timestampsToReturn;
+            request.itemsToCreate = items.data();
+            request.itemsToCreateSize = count;
+            // clientHandle 由客户端分配，通知通过监控项上下文映射到 tag
+            UA_CreateMonitoredItemsResponse response = UA_Client_MonitoredItems_createDataChanges(
+                client_->handle(), request, contexts.data(), callbacks.data(), deleteCallbacks.data()
+            );
+            const UA_StatusCode status = response.responseHeader.serviceResult;
+            if (status == UA_STATUSCODE_GOOD) {
+                for (size_t i = 0; i < response.resultsSize; ++i) {
+                    created += response.results[i].statusCode == UA_STATUSCODE_GOOD ? 1 : 0;
+                }
+            }
+            UA_CreateMonitoredItemsResponse_clear(&response);
+            if (status != UA_STATUSCODE_GOOD) {
+                throw opcua::BadStatus{status};
+            }
+        }
+        itemCount_ += created;
+        return created;
+    }
+
+    void setPublishingMode(bool publishing) {
+        UA_SetPublishingModeRequest request;
+        UA_SetPublishingModeRequest_init(&request);
+        request.publishingEnabled = publishing;
+        request.subscriptionIds = &subscriptionId_;
+        request.subscriptionIdsSize = 1;
+        UA_SetPublishingModeResponse response = UA_Client_Subscriptions_setPublishingMode(client_->handle(), request);
+        const UA_StatusCode status = response.responseHeader.serviceResult;
+        UA_SetPublishingModeResponse_clear(&response);
+        if (status != UA_STATUSCODE_GOOD) {
+            throw opcua::BadStatus{status};
+        }
+    }
+
+    /// 删除订阅（连同监控项）；会话已失效时客户端已在本地删除
+    void deleteSubscription() {
+        if (subscriptionId_ != 0) {
+            UA_Client_Subscriptions_deleteSingle(client_->handle(), subscriptionId_);
+            subscriptionId_ = 0;
+            itemCount_ = 0;
+        }
+    }
+
+    uint32_t subscriptionId() const noexcept {
+        return subscriptionId_;
+    }
+
+    size_t itemCount() const noexcept {
+        return itemCount_;
+    }
+
+private:
+    struct Context {
+        DataChangeHandler handler;
+    };
+
+    static void onDataChange(
+        UA_Client*, UA_UInt32, void* subContext, UA_UInt32, void* monContext, UA_DataValue* value
+    ) {
+        const auto tag = static_cast<TagHandle>(reinterpret_cast<uintptr_t>(monContext));
+        static_cast<Context*>(subContext)->handler(tag, *value);
+    }
+
+    static void onDeleteSubscription(UA_Client*, UA_UInt32, void* subContext) {
+        delete static_cast<Context*>(subContext);
+    }
+
+    opcua::Client* client_;
+    const TagTable* tags_;
+    DispatchOptions options_;
+    UA_UInt32 subscriptionId_ = 0;
+    size_t itemCount_ = 0;
+};
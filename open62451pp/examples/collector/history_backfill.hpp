@@ -0,0 +1,451 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <open62541/client.h>
+
+#include <open62541pp/client.hpp>
+
+#include "collector_types.hpp"
+#include "local_store.hpp"
+
+// 历史数据补采参数
+struct BackfillOptions {
+    size_t nodesPerRequest = 50;       // 每个 HistoryRead 请求包含的节点数
+    uint32_t valuesPerNode = 1000;     // 每个节点每次最多返回的值（超出部分通过续读点获取）
+    size_t maxInFlight = 4;            // 同时未完成的请求数
+    double maxRequestsPerSecond = 10;  // 请求速率上限（令牌桶）
+    size_t maxSamplesPerStep = 5000;   // 每次 step() 最多写入历史存储的采样数
+    int64_t bucket = 60 * UA_DATETIME_SEC;  // 缺口范围对齐粒度，对齐后范围相同的缺口合并到同一请求
+};
+
+struct BackfillStats {
+    size_t requestsSent = 0;
+    size_t responsesReceived = 0;
+    size_t continuations = 0;  // 续读次数
+    size_t samplesMerged = 0;
+    size_t nodesFailed = 0;
+    size_t nodesSkipped = 0;  // 不支持历史读取的节点
+};
+
+/**
+ * @brief 从上游服务器的历史数据补采本地存储中的缺口
+ *
+ * - schedule()：按 AccessLevel 过滤不支持历史读取的节点，按时间范围把缺口分组
+ * - step()：在客户端主循环中调用，发送异步 HistoryReadRawModified 请求并合并结果
+ * - 每个请求读取多个节点，多个请求并行，返回续读点的节点继续排队读取
+ * - 请求速率、并发数和每次合并的采样数都有上限，避免挤占实时采集
+ *
+ * 请求的回调在 client.runIterate() 中执行，因此 step() 与 runIterate() 应在同一线程调用。
+ */
+class HistoryBackfill {
+public:
+    HistoryBackfill(
+        opcua::Client& client, const TagTable& tags, HistorySink& sink, BackfillOptions options = {}
+    )
+        : client_{client},
+          tags_{tags},
+          sink_{sink},
+          options_{options},
+          tokens_{static_cast<double>(options.maxInFlight)},
+          lastRefill_{std::chrono::steady_clock::now()} {}
+
+    ~HistoryBackfill() {
+        cancel();
+    }
+
+    HistoryBackfill(const HistoryBackfill&) = delete;
+    HistoryBackfill& operator=(const HistoryBackfill&) = delete;
+
+    /**
+     * @brief 查询服务器的 AccessHistoryDataCapability
+     *
+     * 很多服务器不提供 HistoryServerCapabilities 对象，此时返回 true，由各节点的 AccessLevel 决定。
+     */
+    bool serverSupportsHistory() {
+        UA_ReadValueId item;
+        UA_ReadValueId_init(&item);
+        item.nodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_HISTORYSERVERCAPABILITIES_ACCESSHISTORYDATACAPABILITY);
+        item.attributeId = UA_ATTRIBUTEID_VALUE;
+        UA_ReadRequest request;
+        UA_ReadRequest_init(&request);
+        request.nodesToRead = &item;
+        request.nodesToReadSize = 1;
+        UA_ReadResponse response = UA_Client_Service_read(client_.handle(), request);
+        bool supported = true;
+        if (response.responseHeader.serviceResult == UA_STATUSCODE_GOOD && response.resultsSize == 1) {
+            const UA_DataValue& dv = response.results[0];
+            if (dv.hasValue && UA_Variant_hasScalarType(&dv.value, &UA_TYPES[UA_TYPES_BOOLEAN])) {
+                supported = *static_cast<const UA_Boolean*>(dv.value.data);
+            }
+        }
+        UA_ReadResponse_clear(&response);
+        return supported;
+    }
+
+    /**
+     * @brief 安排补采任务
+     *
+     * 用一个 Read 请求批量读取所有相关节点的 AccessLevel，跳过没有 HistoryRead 权限的节点。
+     * 缺口起点向下、终点向上对齐到 bucket，对齐后范围相同的节点合并到同一组请求中。
+     *
+     * @return 排队的节点数
+     */
+    size_t schedule(const std::vector<LocalHistoryStore::Gap>& gaps) {
+        if (gaps.empty()) {
+            return 0;
+        }
+        std::vector<TagHandle> tags;
+        tags.reserve(gaps.size());
+        for (const auto& gap : gaps) {
+            tags.push_back(gap.tag);
+        }
+        std::sort(tags.begin(), tags.end());
+        tags.erase(std::unique(tags.begin(), tags.end()), tags.end());
+        const std::vector<bool> historizing = readHistoryAccess(tags);
+
+        size_t queued = 0;
+        for (const auto& gap : gaps) {
+            const auto index = std::lower_bound(tags.begin(), tags.end(), gap.tag) - tags.begin();
+            if (!historizing[index]) {
+                ++stats_.nodesSkipped;
+                continue;
+            }
+            const int64_t start = floorTo(gap.start);
+            const int64_t end = ceilTo(gap.end);
+            queue_[{start, end}].push_back({gap.tag, gap.start, {}});
+            ++queued;
+        }
+        return queued;
+    }
+
+    /**
+     * @brief 推进补采：合并已收到的数据，并在令牌和并发数允许时发送新请求
+     */
+    void step() {
+        merge();
+        refill();
+        // 待合并数据积压时暂停发送，合并速度决定补采速度
+        const size_t backlogLimit = 4 * options_.maxSamplesPerStep;
+        while (!queue_.empty() && inFlight_ < options_.maxInFlight && tokens_ >= 1.0 &&
+               backlogSamples_ < backlogLimit) {
+            if (!sendNext()) {
+                break;
+            }
+            tokens_ -= 1.0;
+        }
+    }
+
+    /**
+     * @brief 会话重建后调用
+     *
+     * 续读点属于旧会话，已经失效；这些节点从已合并的位置重新读取。
+     */
+    void resetSession() {
+        std::map<Range, std::vector<NodeRead>> rebuilt;
+        for (auto& [range, nodes] : queue_) {
+            for (auto& node : nodes) {
+                if (node.continuationPoint.empty()) {
+                    rebuilt[range].push_back(std::move(node));
+                } else {
+                    node.continuationPoint.clear();
+                    rebuilt[{floorTo(node.resumeFrom), range.second}].push_back(std::move(node));
+                }
+            }
+        }
+        queue_ = std::move(rebuilt);
+    }
+
+    /// 取消所有排队的任务，并通知服务器释放续读点
+    void cancel() {
+        std::vector<UA_HistoryReadValueId> release;
+        for (const auto& [range, nodes] : queue_) {
+            for (const auto& node : nodes) {
+                if (!node.continuationPoint.empty()) {
+                    release.push_back(readValueId(node));
+                }
+            }
+        }
+        if (!release.empty()) {
+            UA_ReadRawModifiedDetails details;
+            UA_ReadRawModifiedDetails_init(&details);
+            UA_HistoryReadRequest request;
+            UA_HistoryReadRequest_init(&request);
+            UA_ExtensionObject_setValue(
+                &request.historyReadDetails, &details, &UA_TYPES[UA_TYPES_READRAWMODIFIEDDETAILS]
+            );
+            request.releaseContinuationPoints = true;
+            request.nodesToRead = release.data();
+            request.nodesToReadSize = release.size();
+            // 结果无需处理
+            __UA_Client_AsyncService(
+                client_.handle(),
+                &request,
+                &UA_TYPES[UA_TYPES_HISTORYREADREQUEST],
+                nullptr,
+                &UA_TYPES[UA_TYPES_HISTORYREADRESPONSE],
+                nullptr,
+                nullptr
+            );
+        }
+        queue_.clear();
+        pending_.clear();
+        pendingOffset_ = 0;
+        backlogSamples_ = 0;
+        alive_ = std::make_shared<HistoryBackfill*>(this);  // 正在进行的请求的回调不再生效
+        inFlight_ = 0;
+    }
+
+    bool idle() const noexcept {
+        return queue_.empty() && inFlight_ == 0 && pending_.empty();
+    }
+
+    size_t queuedNodes() const noexcept {
+        size_t count = 0;
+        for (const auto& [range, nodes] : queue_) {
+            count += nodes.size();
+        }
+        return count;
+    }
+
+    const BackfillStats& stats() const noexcept {
+        return stats_;
+    }
+
+private:
+    using Range = std::pair<int64_t, int64_t>;  // 对齐后的 [start, end]
+
+    struct NodeRead {
+        TagHandle tag;
+        int64_t resumeFrom;  // 已合并数据之后的时间，会话重建后从这里重新读取
+        std::vector<UA_Byte> continuationPoint;
+    };
+
+    // 一个请求的上下文，作为回调的 userdata
+    struct RequestContext {
+        std::weak_ptr<HistoryBackfill*> owner;
+        Range range;
+        std::vector<NodeRead> nodes;
+    };
+
+    int64_t floorTo(int64_t t) const noexcept {
+        return t - ((t % options_.bucket) + options_.bucket) % options_.bucket;
+    }
+
+    int64_t ceilTo(int64_t t) const noexcept {
+        const int64_t floored = floorTo(t);
+        return floored == t ? t : floored + options_.bucket;
+    }
+
+    UA_HistoryReadValueId readValueId(const NodeRead& node) const {
+        UA_HistoryReadValueId item;
+        UA_HistoryReadValueId_init(&item);
+        item.nodeId = *tags_.nodeId(node.tag).handle();  // 浅拷贝，请求在发送时已编码
+        item.continuationPoint.length = node.continuationPoint.size();
+        item.continuationPoint.data = const_cast<UA_Byte*>(node.continuationPoint.data());
+        return item;
+    }
+
+    std::vector<bool> readHistoryAccess(const std::vector<TagHandle>& tags) {
+        std::vector<UA_ReadValueId> items(tags.size());
+        for (size_t i = 0; i < tags.size(); ++i) {
+            UA_ReadValueId_init(&items[i]);
+            items[i].nodeId = *tags_.nodeId(tags[i]).handle();
+            items[i].attributeId = UA_ATTRIBUTEID_ACCESSLEVEL;
+        }
+        UA_ReadRequest request;
+        UA_ReadRequest_init(&request);
+        request.nodesToRead = items.data();
+        request.nodesToReadSize = items.size();
+        UA_ReadResponse response = UA_Client_Service_read(client_.handle(), request);
+        std::vector<bool> result(tags.size(), false);
+        if (response.responseHeader.serviceResult == UA_STATUSCODE_GOOD &&
+            response.resultsSize == tags.size()) {
+            for (size_t i = 0; i < tags.size(); ++i) {
+                const UA_DataValue& dv = response.results[i];
+                if (dv.hasValue && UA_Variant_hasScalarType(&dv.value, &UA_TYPES[UA_TYPES_BYTE])) {
+                    const auto accessLevel = *static_cast<const UA_Byte*>(dv.value.data);
+                    result[i] = (accessLevel & UA_ACCESSLEVELMASK_HISTORYREAD) != 0;
+                }
+            }
+        }
+        UA_ReadResponse_clear(&response);
+        return result;
+    }
+
+    void refill() {
+        const auto now = std::chrono::steady_clock::now();
+        const std::chrono::duration<double> elapsed = now - lastRefill_;
+        lastRefill_ = now;
+        tokens_ = std::min(
+            static_cast<double>(options_.maxInFlight),
+            tokens_ + elapsed.count() * options_.maxRequestsPerSecond
+        );
+    }
+
+    bool sendNext() {
+        auto it = queue_.begin();
+        auto& nodes = it->second;
+        const size_t count = std::min(nodes.size(), options_.nodesPerRequest);
+
+        auto context = std::make_unique<RequestContext>();
+        context->owner = alive_;
+        context->range = it->first;
+        context->nodes.assign(
+            std::make_move_iterator(nodes.end() - count), std::make_move_iterator(nodes.end())
+        );
+        nodes.resize(nodes.size() - count);
+        if (nodes.empty()) {
+            queue_.erase(it);
+        }
+
+        std::vector<UA_HistoryReadValueId> items;
+        items.reserve(count);
+        for (const auto& node : context->nodes) {
+            items.push_back(readValueId(node));
+        }
+
+        UA_ReadRawModifiedDetails details;
+        UA_ReadRawModifiedDetails_init(&details);
+        details.isReadModified = false;
+        details.startTime = context->range.first;
+        details.endTime = context->range.second;
+        details.numValuesPerNode = options_.valuesPerNode;
+        details.returnBounds = false;
+
+        UA_HistoryReadRequest request;
+        UA_HistoryReadRequest_init(&request);
+        UA_ExtensionObject_setValue(
+            &request.historyReadDetails, &details, &UA_TYPES[UA_TYPES_READRAWMODIFIEDDETAILS]
+        );
+        request.timestampsToReturn = UA_TIMESTAMPSTORETURN_BOTH;
+        request.nodesToRead = items.data();
+        request.nodesToReadSize = items.size();
+
+        const UA_StatusCode status = __UA_Client_AsyncService(
+            client_.handle(),
+            &request,
+            &UA_TYPES[UA_TYPES_HISTORYREADREQUEST],
+            onResponse,
+            &UA_TYPES[UA_TYPES_HISTORYREADRESPONSE],
+            context.get(),
+            nullptr
+        );
+        if (status != UA_STATUSCODE_GOOD) {
+            requeue(*context);  // 例如连接已断开，等待下次 step() 重试
+            return false;
+        }
+        context.release();  // 所有权交给回调
+        ++inFlight_;
+        ++stats_.requestsSent;
+        return true;
+    }
+
+    // 客户端保证每个异步请求的回调都会被调用（断开连接时带错误状态码）
+    static void onResponse(UA_Client*, void* userdata, UA_UInt32, void* response) {
+        std::unique_ptr<RequestContext> context{static_cast<RequestContext*>(userdata)};
+        const auto owner = context->owner.lock();
+        if (owner == nullptr) {
+            return;
+        }
+        (*owner)->handleResponse(*context, *static_cast<UA_HistoryReadResponse*>(response));
+    }
+
+    void handleResponse(RequestContext& context, const UA_HistoryReadResponse& response) {
+        --inFlight_;
+        ++stats_.responsesReceived;
+        if (response.responseHeader.serviceResult != UA_STATUSCODE_GOOD ||
+            response.resultsSize != context.nodes.size()) {
+            for (auto& node : context.nodes) {
+                node.continuationPoint.clear();
+            }
+            requeue(context);
+            return;
+        }
+
+        std::vector<Sample> samples;
+        for (size_t i = 0; i < response.resultsSize; ++i) {
+            const UA_HistoryReadResult& result = response.results[i];
+            auto& node = context.nodes[i];
+            if (UA_StatusCode_isBad(result.statusCode)) {
+                ++stats_.nodesFailed;
+                continue;
+            }
+            const UA_ExtensionObject& data = result.historyData;
+            if (data.encoding >= UA_EXTENSIONOBJECT_DECODED &&
+                data.content.decoded.type == &UA_TYPES[UA_TYPES_HISTORYDATA]) {
+                const auto* history = static_cast<const UA_HistoryData*>(data.content.decoded.data);
+                Sample sample{};
+                for (size_t j = 0; j < history->dataValuesSize; ++j) {
+                    if (toSample(history->dataValues[j], node.tag, sample)) {
+                        samples.push_back(sample);
+                        node.resumeFrom = std::max(node.resumeFrom, sampleTime(sample) + 1);
+                    }
+                }
+            }
+            if (result.continuationPoint.length > 0) {
+                node.continuationPoint.assign(
+                    result.continuationPoint.data,
+                    result.continuationPoint.data + result.continuationPoint.length
+                );
+                queue_[context.range].push_back(std::move(node));
+                ++stats_.continuations;
+            }
+        }
+        if (!samples.empty()) {
+            backlogSamples_ += samples.size();
+            pending_.push_back(std::move(samples));
+        }
+    }
+
+    void requeue(RequestContext& context) {
+        for (auto& node : context.nodes) {
+            const Range range = node.continuationPoint.empty()
+                ? Range{floorTo(node.resumeFrom), context.range.second}
+                : context.range;
+            queue_[range].push_back(std::move(node));
+        }
+    }
+
+    // 按预算把收到的历史数据写入历史存储
+    void merge() {
+        size_t budget = options_.maxSamplesPerStep;
+        while (budget > 0 && !pending_.empty()) {
+            auto& front = pending_.front();
+            const size_t count = std::min(budget, front.size() - pendingOffset_);
+            sink_.write({front.data() + pendingOffset_, count});
+            pendingOffset_ += count;
+            budget -= count;
+            backlogSamples_ -= count;
+            stats_.samplesMerged += count;
+            if (pendingOffset_ == front.size()) {
+                pending_.pop_front();
+                pendingOffset_ = 0;
+            }
+        }
+    }
+
+    opcua::Client& client_;
+    const TagTable& tags_;
+    HistorySink& sink_;
+    BackfillOptions options_;
+
+    std::map<Range, std::vector<NodeRead>> queue_;
+    std::deque<std::vector<Sample>> pending_;  // 已收到、尚未写入的采样
+    size_t pendingOffset_ = 0;
+    size_t backlogSamples_ = 0;
+    size_t inFlight_ = 0;
+
+    double tokens_;
+    std::chrono::steady_clock::time_point lastRefill_;
+
+    std::shared_ptr<HistoryBackfill*> alive_ = std::make_shared<HistoryBackfill*>(this);
+    BackfillStats stats_;
+};
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include <open62541pp/server.hpp>
+
+#include "collector_types.hpp"
+
+// 每个 tag 的最新值
+// - 作为 HistorySink 接在采集链路上，只保留时间最新的采样
+// - 从检查点恢复的值标记为非实时，收到新采样后变为实时
+class LastValueCache : public HistorySink {
+public:
+    struct Entry {
+        Sample sample{};
+        bool valid = false;
+        bool live = false;  // false：来自检查点，尚未收到新采样
+    };
+
+    void write(opcua::Span<const Sample> samples) override {
+        std::lock_guard lock{mutex_};
+        for (const auto& sample : samples) {
+            auto& entry = at(sample.tag);
+            if (!entry.valid || sampleTime(entry.sample) <= sampleTime(sample)) {
+                entry = {sample, true, true};
+            }
+        }
+    }
+
+    /// 从检查点恢复
+    void restore(const std::vector<Sample>& samples) {
+        std::lock_guard lock{mutex_};
+        for (const auto& sample : samples) {
+            auto& entry = at(sample.tag);
+            if (!entry.valid) {
+                entry = {sample, true, false};
+            }
+        }
+    }
+
+    std::optional<Entry> get(TagHandle tag) const {
+        std::lock_guard lock{mutex_};
+        if (tag >= entries_.size() || !entries_[tag].valid) {
+            return std::nullopt;
+        }
+        return entries_[tag];
+    }
+
+    /// 所有有效的最新值（用于写入检查点）
+    std::vector<Sample> snapshot() const {
+        std::lock_guard lock{mutex_};
+        std::vector<Sample> result;
+        for (const auto& entry : entries_) {
+            if (entry.valid) {
+                result.push_back(entry.sample);
+            }
+        }
+        return result;
+    }
+
+private:
+    Entry& at(TagHandle tag) {
+        if (tag >= entries_.size()) {
+            entries_.resize(static_cast<size_t>(tag) + 1);
+        }
+        return entries_[tag];
+    }
+
+    mutable std::mutex mutex_;
+    std::vector<Entry> entries_;
+};
+
+// 把缓存中的最新值作为服务器变量的数据源
+// 恢复自检查点、尚未刷新的值以 UncertainLastUsableValue 状态返回
+class CachedValueSource : public opcua::DataSourceBase {
+public:
+    CachedValueSource(const LastValueCache& cache, TagHandle tag)
+        : cache_{cache},
+          tag_{tag} {}
+
+    opcua::StatusCode read(
+        [[maybe_unused]] opcua::Session& session,
+        [[maybe_unused]] const opcua::NodeId& id,
+        [[maybe_unused]] const opcua::NumericRange* range,
+        opcua::DataValue& dv,
+        [[maybe_unused]] bool timestamp
+    ) override {
+        const auto entry = cache_.get(tag_);
+        if (!entry) {
+            dv.setStatus(UA_STATUSCODE_BADWAITINGFORINITIALDATA);
+            return UA_STATUSCODE_GOOD;
+        }
+        dv.setValue(opcua::Variant{entry->sample.value});
+        dv.setSourceTimestamp(opcua::DateTime{entry->sample.sourceTime});
+        dv.setServerTimestamp(opcua::DateTime{entry->sample.serverTime});
+        dv.setStatus(entry->live ? entry->sample.status : UA_STATUSCODE_UNCERTAINLASTUSABLEVALUE);
+        return UA_STATUSCODE_GOOD;
+    }
+
+    opcua::StatusCode write(
+        [[maybe_unused]] opcua::Session& session,
+        [[maybe_unused]] const opcua::NodeId& id,
+        [[maybe_unused]] const opcua::NumericRange* range,
+        [[maybe_unused]] const opcua::DataValue& dv
+    ) override {
+        return UA_STATUSCODE_BADNOTWRITABLE;
+    }
+
+private:
+    const LastValueCache& cache_;
+    TagHandle tag_;
+};
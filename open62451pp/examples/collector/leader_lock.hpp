@@ -0,0 +1,192 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+#include "resp_client.hpp"
+
+// 冗余采集器的主节点选举
+// - 持有锁的采集器为主节点（leader），负责发布数据；其余为备用节点（standby）
+// - 主节点周期性调用 renew() 续期，续期失败立即降级
+// - 备用节点周期性调用 tryAcquire()，主节点失效后接管
+class LeaderLock {
+public:
+    virtual ~LeaderLock() = default;
+
+    /// 尝试成为主节点
+    virtual bool tryAcquire() = 0;
+
+    /// 主节点续期；返回 false 表示已失去主节点身份
+    virtual bool renew() = 0;
+
+    /// 主动释放（正常退出时调用，备用节点可立即接管）
+    virtual void release() = 0;
+};
+
+// 进程内租约，用于在同一进程中运行多个采集器（测试和演示）
+struct LocalLease {
+    std::mutex mutex;
+    std::string owner;
+    std::chrono::steady_clock::time_point expiry;
+};
+
+class LocalLeaderLock : public LeaderLock {
+public:
+    LocalLeaderLock(std::shared_ptr<LocalLease> lease, std::string id, std::chrono::milliseconds ttl)
+        : lease_{std::move(lease)},
+          id_{std::move(id)},
+          ttl_{ttl} {}
+
+    bool tryAcquire() override {
+        std::lock_guard lock{lease_->mutex};
+        const auto now = std::chrono::steady_clock::now();
+        if (!lease_->owner.empty() && lease_->owner != id_ && lease_->expiry > now) {
+            return false;
+        }
+        lease_->owner = id_;
+        lease_->expiry = now + ttl_;
+        return true;
+    }
+
+    bool renew() override {
+        std::lock_guard lock{lease_->mutex};
+        const auto now = std::chrono::steady_clock::now();
+        if (lease_->owner != id_ || lease_->expiry <= now) {
+            return false;
+        }
+        lease_->expiry = now + ttl_;
+        return true;
+    }
+
+    void release() override {
+        std::lock_guard lock{lease_->mutex};
+        if (lease_->owner == id_) {
+            lease_->owner.clear();
+        }
+    }
+
+private:
+    std::shared_ptr<LocalLease> lease_;
+    std::string id_;
+    std::chrono::milliseconds ttl_;
+};
+
+// 文件锁（flock），用于同一台机器上的多个采集器进程
+// 进程崩溃时操作系统关闭文件描述符并释放锁，备用节点在下一次 tryAcquire() 时即可接管
+class FileLeaderLock : public LeaderLock {
+public:
+    explicit FileLeaderLock(std::string path)
+        : path_{std::move(path)} {}
+
+    ~FileLeaderLock() override {
+        release();
+    }
+
+    bool tryAcquire() override {
+        if (fd_ >= 0) {
+            return true;
+        }
+        const int fd = ::open(path_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            return false;
+        }
+        if (::flock(fd, LOCK_EX | LOCK_NB) != 0) {
+            ::close(fd);
+            return false;
+        }
+        fd_ = fd;
+        return true;
+    }
+
+    bool renew() override {
+        return fd_ >= 0;  // 锁随文件描述符存在，无需续期
+    }
+
+    void release() override {
+        if (fd_ >= 0) {
+            ::close(fd_);  // 关闭即释放 flock
+            fd_ = -1;
+        }
+    }
+
+private:
+    std::string path_;
+    int fd_ = -1;
+};
+
+// 基于 Redis 的租约锁，用于不同机器上的采集器
+// - 获取：SET key id NX PX ttl
+// - 续期和释放用脚本检查持有者，避免误删其他节点的锁
+class RedisLeaderLock : public LeaderLock {
+public:
+    RedisLeaderLock(
+        std::string host, uint16_t port, std::string key, std::string id, std::chrono::milliseconds ttl
+    )
+        : host_{std::move(host)},
+          port_{port},
+          key_{std::move(key)},
+          id_{std::move(id)},
+          ttl_{std::to_string(ttl.count())} {}
+
+    bool tryAcquire() override {
+        return run([&] {
+            const auto reply = redis_.command({"SET", key_, id_, "NX", "PX", ttl_});
+            if (reply.type == RespReply::Type::Status) {
+                return true;
+            }
+            // 锁可能已经属于自己（例如上一次续期的应答丢失）
+            return renewLocked();
+        });
+    }
+
+    bool renew() override {
+        return run([&] { return renewLocked(); });
+    }
+
+    void release() override {
+        run([&] {
+            static constexpr std::string_view script =
+                "if redis.call('get', KEYS[1]) == ARGV[1] then return redis.call('del', KEYS[1]) "
+                "else return 0 end";
+            redis_.command({"EVAL", script, "1", key_, id_});
+            return true;
+        });
+    }
+
+private:
+    bool renewLocked() {
+        static constexpr std::string_view script =
+            "if redis.call('get', KEYS[1]) == ARGV[1] then return redis.call('pexpire', KEYS[1], ARGV[2]) "
+            "else return 0 end";
+        const auto reply = redis_.command({"EVAL", script, "1", key_, id_, ttl_});
+        return reply.type == RespReply::Type::Integer && reply.integer == 1;
+    }
+
+    // Redis 不可用时视为未持有锁：主节点降级，备用节点不接管
+    template <typename F>
+    bool run(F&& f) {
+        try {
+            if (!redis_.connected()) {
+                redis_.connect(host_, port_);
+            }
+            return f();
+        } catch (const std::exception&) {
+            redis_.close();
+            return false;
+        }
+    }
+
+    std::string host_;
+    uint16_t port_;
+    std::string key_;
+    std::string id_;
+    std::string ttl_;
+    RespClient redis_;
+};
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "collector_types.hpp"
+
+// 本地历史存储
+// - 每个 tag 一个按时间排序的采样数组，按 TagHandle 下标访问
+// - 实时采样通常按时间顺序到达，走追加的快速路径
+// - 补采的历史数据按时间插入，同一时间戳的采样只保留一份
+// - 按 tag 检测数据缺口：相邻采样间隔超过该 tag 的最大间隔即视为缺口
+// - 可选的追加日志文件：进程重启后从日志恢复，停机期间的缺口因此可以被检测到
+class LocalHistoryStore : public HistorySink {
+public:
+    struct Gap {
+        TagHandle tag;
+        int64_t start;  // 缺口前最后一个采样的时间（不含）
+        int64_t end;    // 缺口后第一个采样的时间（不含）
+    };
+
+    /// @param defaultMaxGap 默认最大采样间隔（DateTime 单位，100ns）
+    /// @param journalPath 追加日志文件路径，为空时只保存在内存中
+    /// 上次退出时写了一半的末尾记录被截掉（计入 droppedJournalBytes()），之后的追加保持按记录对齐
+    explicit LocalHistoryStore(int64_t defaultMaxGap, const std::string& journalPath = {})
+        : defaultMaxGap_{defaultMaxGap} {
+        if (journalPath.empty()) {
+            return;
+        }
+        std::error_code error;
+        const auto size = std::filesystem::file_size(journalPath, error);
+        if (!error && size % sizeof(Sample) != 0) {
+            droppedJournalBytes_ = static_cast<size_t>(size % sizeof(Sample));
+            std::filesystem::resize_file(journalPath, size - droppedJournalBytes_);
+        }
+        if (std::FILE* in = std::fopen(journalPath.c_str(), "rb")) {
+            std::vector<Sample> buffer(4096);
+            size_t n = 0;
+            while ((n = std::fread(buffer.data(), sizeof(Sample), buffer.size(), in)) > 0) {
+                insert({buffer.data(), n});
+            }
+            std::fclose(in);
+        }
+        journal_ = std::fopen(journalPath.c_str(), "ab");
+    }
+
+    ~LocalHistoryStore() override {
+        if (journal_ != nullptr) {
+            std::fclose(journal_);
+        }
+    }
+
+    LocalHistoryStore(const LocalHistoryStore&) = delete;
+    LocalHistoryStore& operator=(const LocalHistoryStore&) = delete;
+
+    /// 设置某个 tag 的最大采样间隔（通常为采样周期的若干倍）
+    void setMaxGap(TagHandle tag, int64_t maxGap) {
+        std::lock_guard lock{mutex_};
+        ensure(tag);
+        tags_[tag].maxGap = maxGap;
+    }
+
+    /// 确保 tag 在存储中登记（即使还没有采样，也参与缺口检测）
+    void registerTag(TagHandle tag) {
+        std::lock_guard lock{mutex_};
+        ensure(tag);
+    }
+
+    void write(opcua::Span<const Sample> samples) override {
+        std::lock_guard lock{mutex_};
+        insert(samples);
+        if (journal_ != nullptr) {
+            std::fwrite(samples.data(), sizeof(Sample), samples.size(), journal_);
+            std::fflush(journal_);
+        }
+    }
+
+    /**
+     * @brief 检测 [from, to] 时间范围内每个 tag 的数据缺口
+     *
+     * - 相邻采样间隔超过最大间隔
+     * - 最后一个采样到 to 之间超过最大间隔（例如采集器停机或断线期间）
+     * - 没有任何采样的 tag 整个范围都是缺口
+     */
+    std::vector<Gap> findGaps(int64_t from, int64_t to) const {
+        std::lock_guard lock{mutex_};
+        std::vector<Gap> gaps;
+        for (TagHandle tag = 0; tag < tags_.size(); ++tag) {
+            const auto& entry = tags_[tag];
+            const int64_t maxGap = entry.maxGap > 0 ? entry.maxGap : defaultMaxGap_;
+            const auto& series = entry.samples;
+            auto it = lowerBound(series, from);
+            int64_t previous = it == series.begin() ? from : sampleTime(*std::prev(it));
+            for (; it != series.end() && sampleTime(*it) <= to; ++it) {
+                const int64_t t = sampleTime(*it);
+                if (t - previous > maxGap) {
+                    gaps.push_back({tag, previous, t});
+                }
+                previous = t;
+            }
+            if (to - previous > maxGap) {
+                gaps.push_back({tag, previous, to});
+            }
+        }
+        return gaps;
+    }
+
+    /// 读取 tag 在 [from, to] 范围内的采样
+    std::vector<Sample> read(TagHandle tag, int64_t from, int64_t to) const {
+        std::lock_guard lock{mutex_};
+        std::vector<Sample> result;
+        if (tag >= tags_.size()) {
+            return result;
+        }
+        const auto& series = tags_[tag].samples;
+        for (auto it = lowerBound(series, from); it != series.end() && sampleTime(*it) <= to; ++it) {
+            result.push_back(*it);
+        }
+        return result;
+    }
+
+    size_t sampleCount() const {
+        std::lock_guard lock{mutex_};
+        size_t count = 0;
+        for (const auto& entry : tags_) {
+            count += entry.samples.size();
+        }
+        return count;
+    }
+
+    /// 打开日志时截掉的不完整末尾记录的字节数
+    size_t droppedJournalBytes() const noexcept {
+        return droppedJournalBytes_;
+    }
+
+private:
+    struct TagEntry {
+        std::vector<Sample> samples;
+        int64_t maxGap = 0;
+    };
+
+    static std::vector<Sample>::const_iterator lowerBound(
+        const std::vector<Sample>& series, int64_t time
+    ) {
+        return std::lower_bound(series.begin(), series.end(), time, [](const Sample& s, int64_t t) {
+            return sampleTime(s) < t;
+        });
+    }
+
+    void ensure(TagHandle tag) {
+        if (tag >= tags_.size()) {
+            tags_.resize(static_cast<size_t>(tag) + 1);
+        }
+    }
+
+    void insert(opcua::Span<const Sample> samples) {
+        for (const auto& sample : samples) {
+            ensure(sample.tag);
+            auto& series = tags_[sample.tag].samples;
+            const int64_t t = sampleTime(sample);
+            if (series.empty() || sampleTime(series.back()) < t) {
+                series.push_back(sample);  // 快速路径：按时间顺序追加
+                continue;
+            }
+            const auto it = lowerBound(series, t);
+            if (it != series.end() && sampleTime(*it) == t) {
+                continue;  // 已存在同一时间戳的采样
+            }
+            series.insert(it, sample);
+        }
+    }
+
+    int64_t defaultMaxGap_;
+    mutable std::mutex mutex_;
+    std::vector<TagEntry> tags_;
+    std::FILE* journal_ = nullptr;
+    size_t droppedJournalBytes_ = 0;
+};
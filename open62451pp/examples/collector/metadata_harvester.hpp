@@ -0,0 +1,398 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <open62541/client.h>
+
+#include <open62541pp/client.hpp>
+
+#include "address_space.hpp"
+#include "request_profiles.hpp"
+#include "variable_metadata.hpp"
+
+struct HarvestOptions {
+    size_t readsPerRequest = 1000;  // 每个 Read 请求包含的 ReadValueId 数
+    size_t nodesPerBrowse = 500;    // 每个 Browse 请求包含的节点数
+    bool properties = true;         // 读取 EngineeringUnits、EURange 和 EnumStrings 属性
+    bool enumerations = true;       // 读取变量 DataType 的 EnumStrings/EnumValues
+};
+
+struct HarvestStats {
+    size_t variables = 0;
+    size_t readRequests = 0;
+    size_t browseRequests = 0;
+    size_t attributes = 0;  // 读取的属性和属性节点的值
+    size_t properties = 0;  // 找到的属性节点
+    size_t enumerations = 0;
+    double seconds = 0.0;
+};
+
+/**
+ * @brief 批量读取变量元数据
+ *
+ * 1. 每个变量的 DataType、ValueRank、ArrayDimensions、AccessLevel 放进同一个 Read 请求，
+ *    一个请求包含约 250 个变量
+ * 2. 对所有变量批量浏览 HasProperty，找到 EngineeringUnits、EURange、EnumStrings、EnumValues
+ *    属性节点，再批量读取它们的值
+ * 3. 对变量用到的每个 DataType（内置类型除外）同样查找 EnumStrings/EnumValues，
+ *    同一个枚举类型的变量共享一份定义
+ *
+ * 结果写入 VariableMetadataCache，DataType 写回快照。
+ */
+class MetadataHarvester {
+public:
+    explicit MetadataHarvester(opcua::Client& client, HarvestOptions options = {})
+        : client_{client},
+          options_{options} {}
+
+    /// 采集快照中所有变量的元数据
+    HarvestStats harvest(AddressSpaceSnapshot& snapshot, VariableMetadataCache& cache) {
+        std::vector<NodeIndex> variables;
+        for (NodeIndex node = 0; node < snapshot.size(); ++node) {
+            if (snapshot.nodeClass(node) == opcua::NodeClass::Variable) {
+                variables.push_back(node);
+            }
+        }
+        return harvest(snapshot, cache, variables);
+    }
+
+    /// 只采集指定的变量，例如地址空间同步后新增的节点
+    HarvestStats harvest(
+        AddressSpaceSnapshot& snapshot, VariableMetadataCache& cache, opcua::Span<const NodeIndex> variables
+    ) {
+        stats_ = {};
+        const auto start = std::chrono::steady_clock::now();
+        cache.resize(snapshot.size());
+        stats_.variables = variables.size();
+
+        readAttributes(snapshot, cache, variables);
+
+        std::vector<char> ownEnumeration(variables.size(), 0);
+        if (options_.properties) {
+            std::vector<opcua::NodeId> owners;
+            owners.reserve(variables.size());
+            for (const NodeIndex node : variables) {
+                owners.push_back(snapshot.nodeId(node));
+            }
+            for (const auto& property : readProperties(owners)) {
+                const NodeIndex node = variables[property.owner];
+                const UA_Variant& value = *property.value.handle();
+                switch (property.kind) {
+                case PropertyKind::EngineeringUnits:
+                    if (UA_Variant_hasScalarType(&value, &UA_TYPES[UA_TYPES_EUINFORMATION])) {
+                        const auto* eu = static_cast<const UA_EUInformation*>(value.data);
+                        cache.setEngineeringUnits(
+                            node,
+                            {toStdString(eu->namespaceUri),
+                             eu->unitId,
+                             toStdString(eu->displayName.text),
+                             toStdString(eu->description.text)}
+                        );
+                    }
+                    break;
+                case PropertyKind::EURange:
+                    if (UA_Variant_hasScalarType(&value, &UA_TYPES[UA_TYPES_RANGE])) {
+                        const auto* range = static_cast<const UA_Range*>(value.data);
+                        cache.setRange(node, range->low, range->high);
+                    }
+                    break;
+                default: {
+                    // MultiStateDiscrete 等变量自身的 EnumStrings/EnumValues
+                    const auto entries = toEnumeration(value);
+                    if (!entries.empty()) {
+                        cache.setEnumeration(node, cache.addEnumeration(entries));
+                        ownEnumeration[property.owner] = 1;
+                    }
+                    break;
+                }
+                }
+            }
+        }
+
+        if (options_.enumerations) {
+            readEnumerations(snapshot, cache, variables, ownEnumeration);
+        }
+
+        stats_.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return stats_;
+    }
+
+private:
+    enum class PropertyKind : uint8_t {
+        EngineeringUnits,
+        EURange,
+        EnumStrings,
+        EnumValues,
+    };
+
+    struct Property {
+        size_t owner;  // owners 中的下标
+        PropertyKind kind;
+        opcua::NodeId id;
+        opcua::Variant value;
+    };
+
+    static std::string toStdString(const UA_String& s) {
+        return {reinterpret_cast<const char*>(s.data), s.length};
+    }
+
+    static bool propertyKind(const UA_QualifiedName& name, PropertyKind& kind) {
+        // 只比较名称：有的服务器把属性的 BrowseName 放在自己的命名空间中
+        const std::string_view text{reinterpret_cast<const char*>(name.name.data), name.name.length};
+        if (text == "EngineeringUnits") {
+            kind = PropertyKind::EngineeringUnits;
+        } else if (text == "EURange") {
+            kind = PropertyKind::EURange;
+        } else if (text == "EnumStrings") {
+            kind = PropertyKind::EnumStrings;
+        } else if (text == "EnumValues") {
+            kind = PropertyKind::EnumValues;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    // EnumStrings（LocalizedText 数组，值为下标）或 EnumValues（EnumValueType 数组）
+    static std::vector<EnumEntry> toEnumeration(const UA_Variant& value) {
+        std::vector<EnumEntry> entries;
+        if (UA_Variant_isScalar(&value) || value.data == nullptr) {
+            return entries;
+        }
+        if (value.type == &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]) {
+            const auto* texts = static_cast<const UA_LocalizedText*>(value.data);
+            for (size_t i = 0; i < value.arrayLength; ++i) {
+                entries.push_back({static_cast<int64_t>(i), toStdString(texts[i].text)});
+            }
+        } else if (value.type == &UA_TYPES[UA_TYPES_ENUMVALUETYPE]) {
+            const auto* values = static_cast<const UA_EnumValueType*>(value.data);
+            for (size_t i = 0; i < value.arrayLength; ++i) {
+                entries.push_back({values[i].value, toStdString(values[i].displayName.text)});
+            }
+        }
+        return entries;
+    }
+
+    void readAttributes(
+        AddressSpaceSnapshot& snapshot, VariableMetadataCache& cache, opcua::Span<const NodeIndex> variables
+    ) {
+        static constexpr UA_UInt32 attributes[] = {
+            UA_ATTRIBUTEID_DATATYPE,
+            UA_ATTRIBUTEID_VALUERANK,
+            UA_ATTRIBUTEID_ARRAYDIMENSIONS,
+            UA_ATTRIBUTEID_ACCESSLEVEL,
+        };
+        constexpr size_t perNode = std::size(attributes);
+        const size_t nodesPerRequest = std::max<size_t>(1, options_.readsPerRequest / perNode);
+        for (size_t offset = 0; offset < variables.size(); offset += nodesPerRequest) {
+            const size_t count = std::min(nodesPerRequest, variables.size() - offset);
+            std::vector<UA_ReadValueId> items(count * perNode);
+            for (size_t i = 0; i < count; ++i) {
+                for (size_t a = 0; a < perNode; ++a) {
+                    auto& item = items[i * perNode + a];
+                    UA_ReadValueId_init(&item);
+                    item.nodeId = *snapshot.nodeId(variables[offset + i]).handle();  // 浅拷贝
+                    item.attributeId = attributes[a];
+                }
+            }
+            UA_ReadRequest request;
+            UA_ReadRequest_init(&request);
+            request.nodesToRead = items.data();
+            request.nodesToReadSize = items.size();
+            apply(request_profiles::metadata, request);
+            UA_ReadResponse response = UA_Client_Service_read(client_.handle(), request);
+            ++stats_.readRequests;
+            stats_.attributes += items.size();
+            if (response.responseHeader.serviceResult == UA_STATUSCODE_GOOD &&
+                response.resultsSize == items.size()) {
+                for (size_t i = 0; i < count; ++i) {
+                    const UA_DataValue* dv = &response.results[i * perNode];
+                    const NodeIndex node = variables[offset + i];
+                    if (dv[0].hasValue && UA_Variant_hasScalarType(&dv[0].value, &UA_TYPES[UA_TYPES_NODEID])) {
+                        snapshot.setDataType(node, opcua::NodeId{*static_cast<const UA_NodeId*>(dv[0].value.data)});
+                    }
+                    int32_t valueRank = -1;
+                    if (dv[1].hasValue && UA_Variant_hasScalarType(&dv[1].value, &UA_TYPES[UA_TYPES_INT32])) {
+                        valueRank = *static_cast<const UA_Int32*>(dv[1].value.data);
+                    }
+                    opcua::Span<const uint32_t> dimensions;
+                    if (dv[2].hasValue && dv[2].value.type == &UA_TYPES[UA_TYPES_UINT32] &&
+                        !UA_Variant_isScalar(&dv[2].value)) {
+                        dimensions = {static_cast<const uint32_t*>(dv[2].value.data), dv[2].value.arrayLength};
+                    }
+                    uint8_t accessLevel = 0;
+                    if (dv[3].hasValue && UA_Variant_hasScalarType(&dv[3].value, &UA_TYPES[UA_TYPES_BYTE])) {
+                        accessLevel = *static_cast<const UA_Byte*>(dv[3].value.data);
+                    }
+                    cache.setAttributes(node, valueRank, dimensions, accessLevel);
+                }
+            }
+            UA_ReadResponse_clear(&response);
+        }
+    }
+
+    /// 浏览 owners 的 HasProperty 引用，读取已知属性节点的值
+    std::vector<Property> readProperties(const std::vector<opcua::NodeId>& owners) {
+        std::vector<Property> found;
+        std::vector<std::pair<size_t, UA_ByteString>> pending;  // (owner, 续读点)
+        auto collect = [&](size_t owner, const UA_BrowseResult& result) {
+            for (size_t r = 0; r < result.referencesSize; ++r) {
+                const auto& ref = result.references[r];
+                PropertyKind kind;
+                if (UA_ExpandedNodeId_isLocal(&ref.nodeId) && propertyKind(ref.browseName, kind)) {
+                    found.push_back({owner, kind, opcua::NodeId{ref.nodeId.nodeId}, {}});
+                }
+            }
+            if (result.continuationPoint.length > 0) {
+                UA_ByteString point;
+                UA_ByteString_copy(&result.continuationPoint, &point);
+                pending.push_back({owner, point});
+            }
+        };
+
+        for (size_t offset = 0; offset < owners.size(); offset += options_.nodesPerBrowse) {
+            const size_t count = std::min(options_.nodesPerBrowse, owners.size() - offset);
+            std::vector<UA_BrowseDescription> descriptions(count);
+            for (size_t i = 0; i < count; ++i) {
+                auto& d = descriptions[i];
+                UA_BrowseDescription_init(&d);
+                d.nodeId = *owners[offset + i].handle();
+                d.browseDirection = UA_BROWSEDIRECTION_FORWARD;
+                d.referenceTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_HASPROPERTY);
+                d.includeSubtypes = false;
+                d.nodeClassMask = UA_NODECLASS_VARIABLE;
+                d.resultMask = UA_BROWSERESULTMASK_BROWSENAME;
+            }
+            UA_BrowseRequest request;
+            UA_BrowseRequest_init(&request);
+            request.nodesToBrowse = descriptions.data();
+            request.nodesToBrowseSize = count;
+            UA_BrowseResponse response = UA_Client_Service_browse(client_.handle(), request);
+            ++stats_.browseRequests;
+            if (response.responseHeader.serviceResult == UA_STATUSCODE_GOOD && response.resultsSize == count) {
+                for (size_t i = 0; i < count; ++i) {
+                    collect(offset + i, response.results[i]);
+                }
+            }
+            UA_BrowseResponse_clear(&response);
+        }
+
+        while (!pending.empty()) {
+            std::vector<UA_ByteString> points(pending.size());
+            std::vector<size_t> pendingOwners(pending.size());
+            for (size_t i = 0; i < pending.size(); ++i) {
+                pendingOwners[i] = pending[i].first;
+                points[i] = pending[i].second;  // 所有权转移到 points
+            }
+            pending.clear();
+            UA_BrowseNextRequest request;
+            UA_BrowseNextRequest_init(&request);
+            request.continuationPoints = points.data();
+            request.continuationPointsSize = points.size();
+            UA_BrowseNextResponse response = UA_Client_Service_browseNext(client_.handle(), request);
+            ++stats_.browseRequests;
+            if (response.responseHeader.serviceResult == UA_STATUSCODE_GOOD &&
+                response.resultsSize == points.size()) {
+                for (size_t i = 0; i < points.size(); ++i) {
+                    collect(pendingOwners[i], response.results[i]);
+                }
+            }
+            UA_BrowseNextResponse_clear(&response);
+            for (auto& point : points) {
+                UA_ByteString_clear(&point);
+            }
+        }
+        stats_.properties += found.size();
+
+        for (size_t offset = 0; offset < found.size(); offset += options_.readsPerRequest) {
+            const size_t count = std::min(options_.readsPerRequest, found.size() - offset);
+            std::vector<UA_ReadValueId> items(count);
+            for (size_t i = 0; i < count; ++i) {
+                UA_ReadValueId_init(&items[i]);
+                items[i].nodeId = *found[offset + i].id.handle();
+                items[i].attributeId = UA_ATTRIBUTEID_VALUE;
+            }
+            UA_ReadRequest request;
+            UA_ReadRequest_init(&request);
+            request.nodesToRead = items.data();
+            request.nodesToReadSize = count;
+            apply(request_profiles::metadata, request);
+            UA_ReadResponse response = UA_Client_Service_read(client_.handle(), request);
+            ++stats_.readRequests;
+            stats_.attributes += count;
+            if (response.responseHeader.serviceResult == UA_STATUSCODE_GOOD && response.resultsSize == count) {
+                for (size_t i = 0; i < count; ++i) {
+                    // 移走值，避免复制数组
+                    found[offset + i].value = opcua::Variant{std::move(response.results[i].value)};
+                }
+            }
+            UA_ReadResponse_clear(&response);
+        }
+        return found;
+    }
+
+    void readEnumerations(
+        const AddressSpaceSnapshot& snapshot,
+        VariableMetadataCache& cache,
+        opcua::Span<const NodeIndex> variables,
+        const std::vector<char>& ownEnumeration
+    ) {
+        // 变量用到的 DataType；内置类型（ns=0;i=1..29）不是枚举，跳过
+        std::vector<uint32_t> dataTypes;
+        for (const NodeIndex node : variables) {
+            const uint32_t dataType = snapshot.dataTypeOf(node);
+            if (dataType == AddressSpaceSnapshot::noDataType) {
+                continue;
+            }
+            const UA_NodeId& id = *snapshot.dataType(dataType).handle();
+            if (id.namespaceIndex == 0 && id.identifierType == UA_NODEIDTYPE_NUMERIC &&
+                id.identifier.numeric <= UA_NS0ID_ENUMERATION) {
+                continue;
+            }
+            dataTypes.push_back(dataType);
+        }
+        std::sort(dataTypes.begin(), dataTypes.end());
+        dataTypes.erase(std::unique(dataTypes.begin(), dataTypes.end()), dataTypes.end());
+        if (dataTypes.empty()) {
+            return;
+        }
+
+        std::vector<opcua::NodeId> owners;
+        for (const uint32_t dataType : dataTypes) {
+            owners.push_back(snapshot.dataType(dataType));
+        }
+        std::unordered_map<uint32_t, uint32_t> enumerationOf;  // DataType 下标 -> 枚举定义
+        for (const auto& property : readProperties(owners)) {
+            if (property.kind != PropertyKind::EnumStrings && property.kind != PropertyKind::EnumValues) {
+                continue;
+            }
+            const auto entries = toEnumeration(*property.value.handle());
+            if (!entries.empty()) {
+                enumerationOf[dataTypes[property.owner]] = cache.addEnumeration(entries);
+            }
+        }
+        stats_.enumerations = enumerationOf.size();
+
+        for (size_t i = 0; i < variables.size(); ++i) {
+            if (ownEnumeration[i] != 0) {
+                continue;
+            }
+            const auto it = enumerationOf.find(snapshot.dataTypeOf(variables[i]));
+            if (it != enumerationOf.end()) {
+                cache.setEnumeration(variables[i], it->second);
+            }
+        }
+    }
+
+    opcua::Client& client_;
+    HarvestOptions options_;
+    HarvestStats stats_;
+};
@@ -0,0 +1,148 @@
+/**
+ * @file mysql_pool_benchmark.cpp
+ * @brief MySQL 并行写入测试 - 比较 1/2/4/8 个写入连接的写入速度
+ *
+ * 本程序测试 mysql_writer_pool.hpp 中的 MySqlWriterPool：
+ * 1. 创建采样表（主键 tag_id + source_time）
+ * 2. 生成 N 个 tag × M 秒的模拟采样，按时间交错写入（与订阅通知的顺序一致）
+ * 3. 分别使用 1、2、4、8 个写入连接写入同样的数据，每轮之前清空表
+ * 4. 输出每轮的耗时、行/秒、批次数和重试次数
+ *
+ * 写入过程中可以重启数据库或用 KILL 断开某个连接，观察分区转交和重连。
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../helper.hpp"         // CliParser - 命令行参数解析器
+#include "mysql_writer_pool.hpp"  // MySqlWriterPool
+
+// 执行一条不返回结果的 SQL
+static void execute(const MySqlConfig& config, const std::string& sql) {
+    MYSQL* conn = mysql_init(nullptr);
+    if (mysql_real_connect(
+            conn,
+            config.host.c_str(),
+            config.user.c_str(),
+            config.password.c_str(),
+            config.database.c_str(),
+            config.port,
+            nullptr,
+            0
+        ) == nullptr ||
+        mysql_real_query(conn, sql.data(), sql.size()) != 0) {
+        const std::string error = mysql_error(conn);
+        mysql_close(conn);
+        throw std::runtime_error{error};
+    }
+    mysql_close(conn);
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "=== MySQL 并行写入测试 ===" << std::endl;
+
+    const CliParser parser{argc, argv};
+    MySqlConfig config;
+    config.host = parser.value("--host").value_or("127.0.0.1");
+    config.port = static_cast<unsigned int>(std::stoul(std::string{parser.value("--port").value_or("3306")}));
+    config.user = parser.value("--user").value_or("root");
+    config.password = parser.value("--password").value_or("");
+    config.database = parser.value("--database").value_or("collector");
+    config.table = "samples_benchmark";
+    const size_t tagCount = std::stoul(std::string{parser.value("--tags").value_or("10000")});
+    const size_t seconds = std::stoul(std::string{parser.value("--seconds").value_or("60")});
+
+    // 1. 准备表和数据
+    std::cout << "1. 创建表 " << config.database << "." << config.table << "..." << std::endl;
+    MySqlWriterPool::createTable(config);
+
+    std::cout << "2. 生成 " << tagCount << " 个 tag × " << seconds << " 秒的模拟数据..." << std::endl;
+    std::vector<Sample> samples;
+    samples.reserve(tagCount * seconds);
+    const int64_t start = opcua::DateTime::now().get();
+    for (size_t t = 0; t < seconds; ++t) {
+        for (size_t tag = 0; tag < tagCount; ++tag) {
+            const int64_t time = start + static_cast<int64_t>(t) * UA_DATETIME_SEC;
+            samples.push_back({static_cast<TagHandle>(tag), time, time, static_cast<double>(t + tag), 0});
+        }
+    }
+
+    // 2. 按写入连接数逐轮测试
+    std::cout << "\n" << std::setw(8) << "连接数" << std::setw(12) << "耗时(s)" << std::setw(14)
+              << "行/秒" << std::setw(10) << "批次" << std::setw(10) << "重试" << std::setw(10)
+              << "转交" << std::endl;
+    double baseline = 0.0;
+    for (const size_t writers : {1, 2, 4, 8}) {
+        execute(config, "TRUNCATE TABLE `" + config.table + "`");
+
+        MySqlWriterOptions options;
+        options.writers = writers;
+        MySqlWriterPool pool{config, options};
+
+        const auto begin = std::chrono::steady_clock::now();
+        // 每次写入 tagCount 个采样，相当于每秒一个发布周期
+        for (size_t offset = 0; offset < samples.size(); offset += tagCount) {
+            pool.write({samples.data() + offset, std::min(tagCount, samples.size() - offset)});
+        }
+        const bool drained = pool.flush(std::chrono::minutes{10});
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+        const auto stats = pool.stats();
+        const double rate = static_cast<double>(stats.rows) / elapsed;
+        if (writers == 1) {
+            baseline = rate;
+        }
+        std::cout << std::setw(8) << writers << std::fixed << std::setprecision(2) << std::setw(12) << elapsed
+                  << std::setprecision(0) << std::setw(14) << rate << std::setw(10) << stats.batches
+                  << std::setw(10) << stats.retries << std::setw(10) << stats.failovers;
+        if (baseline > 0.0) {
+            std::cout << "  ×" << std::setprecision(2) << rate / baseline;
+        }
+        if (!drained || stats.rows != samples.size()) {
+            std::cout << "  ✗ 写入 " << stats.rows << "/" << samples.size() << " 行，丢弃 " << stats.dropped;
+        }
+        std::cout << std::endl;
+    }
+
+    return 0;
+}
+
+/**
+ * 使用说明：
+ *
+ * 1. 启动本地 MySQL 兼容服务器并创建数据库：
+ *    docker run -d -p 3306:3306 -e MYSQL_ALLOW_EMPTY_PASSWORD=yes -e MYSQL_DATABASE=collector mysql:8
+ *    （或 mariadb:11，数据库名相同）
+ * 2. 编译：g++ -std=c++17 -O2 mysql_pool_benchmark.cpp -lmysqlclient ...（MariaDB 客户端库为 -lmariadb）
+ * 3. 运行：./mysql_pool_benchmark --tags 10000 --seconds 60 --user root
+ *
+ * 写入池原理：
+ *
+ * 1. 分区：
+ *    - tag 按连续区间分区（默认每 256 个 tag 一个分区），分区 p 默认由连接 p % writers 写入
+ *    - 同一 tag 只由一个连接写入，保持时间顺序
+ *    - InnoDB 按主键 (tag_id, source_time) 聚簇，各连接写入不同的索引区间，减少页锁争用
+ *
+ * 2. 批量和重试：
+ *    - 每个连接凑满 batchRows 行或等待 flushInterval 后发送一条多行 INSERT
+ *    - 死锁、锁等待超时和连接错误会重试；连接错误先原地重连
+ *    - ON DUPLICATE KEY UPDATE 使重发的批次不会产生重复行
+ *
+ * 3. 故障转交：
+ *    - 重试 maxRetries 次仍失败时，该连接的分区和未写入的采样转交给其他连接
+ *    - 失效连接在后台重连，代管连接在队列清空时把分区交还
+ *
+ * 结果解读：
+ *
+ * - 连接数增加时吞吐量通常近似线性增长，直到服务器的 CPU、redo 日志或磁盘成为瓶颈
+ * - 单机 Docker 测试受客户端和服务器争用 CPU 影响，8 个连接的收益可能不明显
+ * - innodb_flush_log_at_trx_commit=2 等设置对结果影响很大，对比时保持服务器配置不变
+ *
+ * 注意事项：
+ *
+ * - 测试表 samples_benchmark 每轮都会被清空
+ * - 分区大小应与 tag 编号方式匹配：同一设备的 tag 编号连续时，同一设备由同一连接写入
+ */
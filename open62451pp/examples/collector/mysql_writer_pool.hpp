@@ -0,0 +1,418 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <mysql/errmsg.h>
+#include <mysql/mysql.h>
+#include <mysql/mysqld_error.h>
+
+#include "collector_types.hpp"
+
+// MySQL 连接参数（兼容 MariaDB、Percona 等）
+struct MySqlConfig {
+    std::string host = "127.0.0.1";
+    unsigned int port = 3306;
+    std::string user = "root";
+    std::string password;
+    std::string database = "collector";
+    std::string table = "samples";
+    unsigned int connectTimeout = 5;  // 秒；MYSQL_OPT_CONNECT_TIMEOUT
+    unsigned int readTimeout = 30;    // 秒；服务器挂起或网络断开时 mysql_real_query() 最长阻塞时间
+    unsigned int writeTimeout = 30;   // 秒
+};
+
+struct MySqlWriterOptions {
+    size_t writers = 4;                            // 写入连接数
+    TagHandle tagsPerPartition = 256;              // 每个分区包含的连续 tag 数
+    size_t batchRows = 1000;                       // 单条 INSERT 的最大行数
+    std::chrono::milliseconds flushInterval{200};  // 不足一批时的最长等待时间
+    int maxRetries = 3;                            // 单批的重试次数，超过后认为连接失效
+    std::chrono::milliseconds retryDelay{500};     // 重试和重连间隔
+};
+
+struct MySqlWriterStats {
+    uint64_t rows = 0;
+    uint64_t batches = 0;
+    uint64_t retries = 0;    // 重试的批次
+    uint64_t failovers = 0;  // 分区因连接失效转交给其他写入连接的次数
+    uint64_t dropped = 0;    // 因不可重试的错误（如表不存在）丢弃的行数
+    uint64_t nonFinite = 0;  // 值为 NaN/Inf 而跳过的采样（value 列为 DOUBLE NOT NULL，SQL 中无法表示）
+};
+
+/**
+ * @brief 按 tag 分区的并行 MySQL 写入池
+ *
+ * - tag 按连续区间分区（tag / tagsPerPartition），每个分区同一时刻只属于一个写入连接，
+ *   同一 tag 的采样按到达顺序写入，不同连接写入主键 (tag_id, source_time) 中不相邻的区间，
+ *   不会争用同一批索引页
+ * - 每个写入连接有自己的线程、队列、批量 INSERT 和重试
+ * - 连接失效时它的分区和未写入的采样转交给其他连接；连接恢复后，
+ *   代管连接在队列清空时把分区交还，交还前不会有该分区的采样在途
+ */
+class MySqlWriterPool : public HistorySink {
+public:
+    MySqlWriterPool(MySqlConfig config, MySqlWriterOptions options = {})
+        : config_{std::move(config)},
+          options_{options} {
+        if (options_.writers == 0 || options_.tagsPerPartition == 0) {
+            throw std::invalid_argument{"MySqlWriterPool: writers and tagsPerPartition must be positive"};
+        }
+        static const int initialized = mysql_library_init(0, nullptr, nullptr);
+        if (initialized != 0) {
+            throw std::runtime_error{"mysql_library_init failed"};
+        }
+        for (size_t i = 0; i < options_.writers; ++i) {
+            writers_.push_back(std::make_unique<Writer>());
+        }
+        for (size_t i = 0; i < options_.writers; ++i) {
+            writers_[i]->thread = std::thread{[this, i] { run(i); }};
+        }
+    }
+
+    ~MySqlWriterPool() override {
+        flush(std::chrono::seconds{5});
+        {
+            std::lock_guard lock{mutex_};
+            stopping_ = true;
+        }
+        wakeup_.notify_all();
+        for (auto& writer : writers_) {
+            writer->thread.join();
+        }
+    }
+
+    MySqlWriterPool(const MySqlWriterPool&) = delete;
+    MySqlWriterPool& operator=(const MySqlWriterPool&) = delete;
+
+    /// 创建采样表（主键 tag_id + source_time，InnoDB 按主键聚簇）
+    static void createTable(const MySqlConfig& config) {
+        MYSQL* conn = connect(config);
+        if (conn == nullptr) {
+            throw std::runtime_error{"MySQL connect failed"};
+        }
+        const std::string sql = "CREATE TABLE IF NOT EXISTS `" + config.table +
+            "` (tag_id INT UNSIGNED NOT NULL, source_time BIGINT NOT NULL, server_time BIGINT NOT NULL, "
+            "value DOUBLE NOT NULL, status INT UNSIGNED NOT NULL, PRIMARY KEY (tag_id, source_time)) "
+            "ENGINE=InnoDB";
+        const bool ok = mysql_real_query(conn, sql.data(), sql.size()) == 0;
+        const std::string error = ok ? std::string{} : mysql_error(conn);
+        mysql_close(conn);
+        if (!ok) {
+            throw std::runtime_error{"CREATE TABLE failed: " + error};
+        }
+    }
+
+    void write(opcua::Span<const Sample> samples) override {
+        {
+            std::lock_guard lock{mutex_};
+            for (const auto& sample : samples) {
+                writers_[ownerOf(sample.tag)]->queue.push_back(sample);
+            }
+        }
+        wakeup_.notify_all();
+    }
+
+    /// 等待所有队列写完；超时（例如所有连接都不可用）返回 false
+    bool flush(std::chrono::milliseconds timeout) {
+        std::unique_lock lock{mutex_};
+        flushing_ = true;
+        wakeup_.notify_all();
+        const bool drained = drained_.wait_for(lock, timeout, [&] {
+            for (const auto& writer : writers_) {
+                if (writer->busy || !writer->queue.empty()) {
+                    return false;
+                }
+            }
+            return true;
+        });
+        flushing_ = false;
+        return drained;
+    }
+
+    MySqlWriterStats stats() const {
+        std::lock_guard lock{mutex_};
+        MySqlWriterStats total;
+        for (const auto& writer : writers_) {
+            total.rows += writer->stats.rows;
+            total.batches += writer->stats.batches;
+            total.retries += writer->stats.retries;
+            total.failovers += writer->stats.failovers;
+            total.dropped += writer->stats.dropped;
+            total.nonFinite += writer->stats.nonFinite;
+        }
+        return total;
+    }
+
+    /// 各写入连接的统计
+    std::vector<MySqlWriterStats> writerStats() const {
+        std::lock_guard lock{mutex_};
+        std::vector<MySqlWriterStats> result;
+        for (const auto& writer : writers_) {
+            result.push_back(writer->stats);
+        }
+        return result;
+    }
+
+    /// 当前可用的写入连接数
+    size_t aliveWriters() const {
+        std::lock_guard lock{mutex_};
+        size_t count = 0;
+        for (const auto& writer : writers_) {
+            count += writer->alive ? 1 : 0;
+        }
+        return count;
+    }
+
+private:
+    struct Writer {
+        std::thread thread;
+        std::deque<Sample> queue;
+        bool alive = true;
+        bool busy = false;
+        MySqlWriterStats stats;
+    };
+
+    enum class Result { Ok, Dropped, ConnectionLost };
+
+    static MYSQL* connect(const MySqlConfig& config) {
+        MYSQL* conn = mysql_init(nullptr);
+        if (conn == nullptr) {
+            return nullptr;
+        }
+        // 没有超时时，服务器所在主机断电或网络中断会让写入线程永久阻塞在 connect/read 上
+        mysql_options(conn, MYSQL_OPT_CONNECT_TIMEOUT, &config.connectTimeout);
+        mysql_options(conn, MYSQL_OPT_READ_TIMEOUT, &config.readTimeout);
+        mysql_options(conn, MYSQL_OPT_WRITE_TIMEOUT, &config.writeTimeout);
+        if (mysql_real_connect(
+                conn,
+                config.host.c_str(),
+                config.user.c_str(),
+                config.password.c_str(),
+                config.database.c_str(),
+                config.port,
+                nullptr,
+                0
+            ) == nullptr) {
+            mysql_close(conn);
+            return nullptr;
+        }
+        return conn;
+    }
+
+    static bool connectionError(unsigned int error) noexcept {
+        return error == CR_CONNECTION_ERROR || error == CR_CONN_HOST_ERROR || error == CR_SERVER_GONE_ERROR ||
+            error == CR_SERVER_LOST;
+    }
+
+    static bool retryableError(unsigned int error) noexcept {
+        return connectionError(error) || error == ER_LOCK_WAIT_TIMEOUT || error == ER_LOCK_DEADLOCK;
+    }
+
+    // 调用方持有 mutex_
+    size_t ownerOf(TagHandle tag) {
+        const size_t partition = tag / options_.tagsPerPartition;
+        while (owner_.size() <= partition) {
+            // 默认连接不可用时先由下一个可用连接代管
+            size_t owner = owner_.size() % writers_.size();
+            for (size_t i = 0; i < writers_.size() && !writers_[owner]->alive; ++i) {
+                owner = (owner + 1) % writers_.size();
+            }
+            owner_.push_back(owner);
+        }
+        return owner_[partition];
+    }
+
+    // 调用方持有 mutex_；把失效连接的分区和采样转交给其他可用连接
+    void failover(size_t failed, std::vector<Sample>& unsent) {
+        std::vector<size_t> alive;
+        for (size_t i = 0; i < writers_.size(); ++i) {
+            if (i != failed && writers_[i]->alive) {
+                alive.push_back(i);
+            }
+        }
+        auto& writer = *writers_[failed];
+        if (alive.empty()) {
+            // 没有可用连接：采样留在自己的队列中，等待重连
+            writer.queue.insert(writer.queue.begin(), unsent.begin(), unsent.end());
+            return;
+        }
+        size_t next = 0;
+        for (auto& owner : owner_) {
+            if (owner == failed) {
+                owner = alive[next++ % alive.size()];
+            }
+        }
+        ++writer.stats.failovers;
+        // 新的所属连接中还没有这些分区的采样，追加到队尾即可保持每个 tag 的顺序
+        for (const auto& sample : unsent) {
+            writers_[ownerOf(sample.tag)]->queue.push_back(sample);
+        }
+        for (const auto& sample : writer.queue) {
+            writers_[ownerOf(sample.tag)]->queue.push_back(sample);
+        }
+        writer.queue.clear();
+        wakeup_.notify_all();
+    }
+
+    // 调用方持有 mutex_，index 的队列为空且没有在途的批次
+    void handBack(size_t index) {
+        for (size_t partition = 0; partition < owner_.size(); ++partition) {
+            const size_t home = partition % writers_.size();
+            if (owner_[partition] == index && home != index && writers_[home]->alive) {
+                owner_[partition] = home;
+            }
+        }
+    }
+
+    // 连接错误时先原地重连重试；ON DUPLICATE KEY UPDATE 使重发已提交的批次无副作用
+    Result insert(MYSQL*& conn, const std::vector<Sample>& batch, std::string& sql, Writer& writer) {
+        sql = "INSERT INTO `" + config_.table +
+            "` (tag_id, source_time, server_time, value, status) VALUES ";
+        char row[128];
+        for (size_t i = 0; i < batch.size(); ++i) {
+            const auto& s = batch[i];
+            std::snprintf(
+                row,
+                sizeof(row),
+                "%s(%u,%lld,%lld,%.17g,%u)",
+                i == 0 ? "" : ",",
+                static_cast<unsigned>(s.tag),
+                static_cast<long long>(s.sourceTime),
+                static_cast<long long>(s.serverTime),
+                s.value,
+                static_cast<unsigned>(s.status)
+            );
+            sql += row;
+        }
+        // 补采和热备切换可能重复写入同一时间戳，以最新的写入为准
+        sql += " ON DUPLICATE KEY UPDATE server_time=VALUES(server_time), value=VALUES(value), "
+               "status=VALUES(status)";
+
+        for (int attempt = 0;; ++attempt) {
+            if (conn != nullptr && mysql_real_query(conn, sql.data(), sql.size()) == 0) {
+                return Result::Ok;
+            }
+            const unsigned int error = conn != nullptr ? mysql_errno(conn) : CR_CONN_HOST_ERROR;
+            if (!retryableError(error)) {
+                return Result::Dropped;
+            }
+            if (attempt >= options_.maxRetries) {
+                return connectionError(error) ? Result::ConnectionLost : Result::Dropped;
+            }
+            {
+                std::lock_guard lock{mutex_};
+                ++writer.stats.retries;
+            }
+            std::this_thread::sleep_for(options_.retryDelay);
+            if (connectionError(error)) {
+                if (conn != nullptr) {
+                    mysql_close(conn);
+                }
+                conn = connect(config_);
+            }
+        }
+    }
+
+    void run(size_t index) {
+        mysql_thread_init();
+        auto& writer = *writers_[index];
+        MYSQL* conn = connect(config_);
+        std::vector<Sample> batch;
+        std::string sql;
+        std::unique_lock lock{mutex_};
+        if (conn == nullptr) {
+            writer.alive = false;
+            failover(index, batch);
+        }
+        while (!stopping_) {
+            if (conn == nullptr) {
+                // 重连，成功后等待代管连接交还分区
+                lock.unlock();
+                std::this_thread::sleep_for(options_.retryDelay);
+                conn = connect(config_);
+                lock.lock();
+                writer.alive = conn != nullptr;
+                continue;
+            }
+
+            wakeup_.wait_for(lock, options_.flushInterval, [&] {
+                return stopping_ || writer.queue.size() >= options_.batchRows ||
+                    (flushing_ && !writer.queue.empty());
+            });
+            if (writer.queue.empty()) {
+                handBack(index);
+                drained_.notify_all();
+                continue;
+            }
+            const size_t count = std::min(writer.queue.size(), options_.batchRows);
+            batch.assign(writer.queue.begin(), writer.queue.begin() + static_cast<std::ptrdiff_t>(count));
+            writer.queue.erase(writer.queue.begin(), writer.queue.begin() + static_cast<std::ptrdiff_t>(count));
+            writer.busy = true;
+            lock.unlock();
+
+            // %.17g 把 NaN/Inf 格式化为 nan/inf，整条 INSERT 语法错误，一个采样会导致整批被丢弃
+            const auto finiteEnd = std::remove_if(batch.begin(), batch.end(), [](const Sample& s) {
+                return !std::isfinite(s.value);
+            });
+            const auto nonFinite = static_cast<uint64_t>(batch.end() - finiteEnd);
+            batch.erase(finiteEnd, batch.end());
+            const Result result = batch.empty() ? Result::Ok : insert(conn, batch, sql, writer);
+
+            lock.lock();
+            writer.busy = false;
+            writer.stats.nonFinite += nonFinite;
+            switch (result) {
+            case Result::Ok:
+                writer.stats.rows += batch.size();
+                writer.stats.batches += batch.empty() ? 0 : 1;
+                break;
+            case Result::Dropped:
+                writer.stats.dropped += batch.size();
+                break;
+            case Result::ConnectionLost:
+                writer.alive = false;
+                failover(index, batch);
+                if (conn != nullptr) {
+                    lock.unlock();
+                    mysql_close(conn);
+                    conn = nullptr;
+                    lock.lock();
+                }
+                break;
+            }
+            if (writer.queue.empty()) {
+                handBack(index);
+            }
+            drained_.notify_all();
+        }
+        lock.unlock();
+        if (conn != nullptr) {
+            mysql_close(conn);
+        }
+        mysql_thread_end();
+    }
+
+    MySqlConfig config_;
+    MySqlWriterOptions options_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wakeup_;
+    std::condition_variable drained_;
+    std::vector<std::unique_ptr<Writer>> writers_;
+    std::vector<size_t> owner_;  // 分区 -> 当前所属的写入连接；分区 p 的默认连接为 p % writers
+    bool flushing_ = false;
+    bool stopping_ = false;
+};
@@ -0,0 +1,390 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <open62541/client_highlevel.h>
+
+#include <open62541pp/client.hpp>
+
+#include "collector_types.hpp"
+#include "request_profiles.hpp"
+#include "subscription_engine.hpp"
+
+struct BindingOptions {
+    size_t pathsPerRequest = 1000;  // 每个 TranslateBrowsePathsToNodeIds 请求的路径数
+    size_t readsPerRequest = 1000;  // 每个 Read 请求的字段数
+    RequestProfile profile = request_profiles::collect;
+};
+
+struct BindingStats {
+    size_t translateRequests = 0;
+    size_t readRequests = 0;
+    size_t fieldsBound = 0;    // 解析到 NodeId 的字段
+    size_t fieldsMissing = 0;  // 实例中不存在的字段
+    size_t frames = 0;
+    size_t updates = 0;        // 交给更新回调的实例数
+};
+
+namespace binding_detail {
+
+// 数值型 Variant 转换为任意算术类型；整数直接转换，不经过 double
+template <typename F>
+bool assignNumber(const UA_Variant& v, F& out) {
+    const void* data = v.data;
+    switch (v.type->typeKind) {
+    case UA_DATATYPEKIND_BOOLEAN: out = static_cast<F>(*static_cast<const UA_Boolean*>(data) ? 1 : 0); break;
+    case UA_DATATYPEKIND_SBYTE: out = static_cast<F>(*static_cast<const UA_SByte*>(data)); break;
+    case UA_DATATYPEKIND_BYTE: out = static_cast<F>(*static_cast<const UA_Byte*>(data)); break;
+    case UA_DATATYPEKIND_INT16: out = static_cast<F>(*static_cast<const UA_Int16*>(data)); break;
+    case UA_DATATYPEKIND_UINT16: out = static_cast<F>(*static_cast<const UA_UInt16*>(data)); break;
+    case UA_DATATYPEKIND_INT32: out = static_cast<F>(*static_cast<const UA_Int32*>(data)); break;
+    case UA_DATATYPEKIND_UINT32: out = static_cast<F>(*static_cast<const UA_UInt32*>(data)); break;
+    case UA_DATATYPEKIND_INT64: out = static_cast<F>(*static_cast<const UA_Int64*>(data)); break;
+    case UA_DATATYPEKIND_UINT64: out = static_cast<F>(*static_cast<const UA_UInt64*>(data)); break;
+    case UA_DATATYPEKIND_FLOAT: out = static_cast<F>(*static_cast<const UA_Float*>(data)); break;
+    case UA_DATATYPEKIND_DOUBLE: out = static_cast<F>(*static_cast<const UA_Double*>(data)); break;
+    case UA_DATATYPEKIND_ENUM: out = static_cast<F>(*static_cast<const UA_Int32*>(data)); break;
+    default: return false;
+    }
+    return true;
+}
+
+inline bool assignString(const UA_Variant& v, std::string& out) {
+    const UA_String* text = nullptr;
+    switch (v.type->typeKind) {
+    case UA_DATATYPEKIND_STRING: text = static_cast<const UA_String*>(v.data); break;
+    case UA_DATATYPEKIND_LOCALIZEDTEXT: text = &static_cast<const UA_LocalizedText*>(v.data)->text; break;
+    case UA_DATATYPEKIND_QUALIFIEDNAME: text = &static_cast<const UA_QualifiedName*>(v.data)->name; break;
+    default: return false;
+    }
+    out.assign(reinterpret_cast<const char*>(text->data), text->length);
+    return true;
+}
+
+// 标量 Variant 写入字段；类型不匹配时返回 false，字段保持原值
+template <typename F>
+bool assign(const UA_Variant& v, F& out) {
+    if (!UA_Variant_isScalar(&v) || v.data == nullptr) {
+        return false;
+    }
+    if constexpr (std::is_same_v<F, bool>) {
+        int value = 0;
+        if (!assignNumber(v, value)) {
+            return false;
+        }
+        out = value != 0;
+        return true;
+    } else if constexpr (std::is_arithmetic_v<F>) {
+        return assignNumber(v, out);
+    } else {
+        static_assert(std::is_same_v<F, std::string>, "ObjectBinding: unsupported field type");
+        return assignString(v, out);
+    }
+}
+
+}  // namespace binding_detail
+
+/**
+ * @brief C++ 结构体与 ObjectType 子节点的映射
+ *
+ * 每个字段是结构体成员和相对于实例的浏览路径，例如 "1:Age"、"1:Motor/1:Speed"；
+ * 路径中每一级可以带命名空间前缀，沿层次引用（HasComponent、HasProperty 等）查找。
+ * 映射只定义一次，与实例数无关。
+ */
+template <typename T>
+class ObjectBinding {
+public:
+    struct Field {
+        std::vector<std::pair<uint16_t, std::string>> path;
+        std::function<bool(T&, const UA_Variant&)> assign;
+    };
+
+    /// 绑定一个成员；支持算术类型、bool 和 std::string
+    template <typename F>
+    ObjectBinding& field(std::string_view path, F T::*member) {
+        fields_.push_back({splitPath(path), [member](T& object, const UA_Variant& value) {
+                               return binding_detail::assign(value, object.*member);
+                           }});
+        return *this;
+    }
+
+    size_t size() const noexcept {
+        return fields_.size();
+    }
+
+    const Field& operator[](size_t i) const {
+        return fields_[i];
+    }
+
+private:
+    static std::vector<std::pair<uint16_t, std::string>> splitPath(std::string_view path) {
+        std::vector<std::pair<uint16_t, std::string>> elements;
+        while (!path.empty()) {
+            const size_t slash = path.find('/');
+            std::string_view element = path.substr(0, slash);
+            path = slash == std::string_view::npos ? std::string_view{} : path.substr(slash + 1);
+            uint16_t ns = 0;
+            const size_t colon = element.find(':');
+            if (colon != std::string_view::npos && colon > 0 &&
+                std::all_of(element.begin(), element.begin() + colon, [](char c) { return c >= '0' && c <= '9'; })) {
+                ns = static_cast<uint16_t>(std::stoul(std::string{element.substr(0, colon)}));
+                element = element.substr(colon + 1);
+            }
+            if (!element.empty()) {
+                elements.emplace_back(ns, std::string{element});
+            }
+        }
+        return elements;
+    }
+
+    std::vector<Field> fields_;
+};
+
+/**
+ * @brief 把多个对象实例批量读取、订阅为结构体
+ *
+ * - bind() 为所有实例的所有字段批量解析 NodeId（每个请求 pathsPerRequest 条路径）
+ * - read() 用预先构建的 Read 请求读取全部字段，按结果顺序直接写入对应实例的成员
+ * - subscribe() 通过 SubscriptionEngine 为全部字段创建监控项，引擎把每个 Publish 响应作为一帧交给本对象；
+ *   一帧中的通知按 TagHandle 下标找到实例和字段（共用同一节点的字段串成链表），帧结束时对更新过的实例调用更新回调
+ *
+ * 字段 i 在实例 k 中的位置为 k * fields + i，热路径上不做任何按名称或 NodeId 的查找。
+ * 所有方法和 client.runIterate() 在同一线程中调用。
+ */
+template <typename T>
+class ObjectBinder : public FrameSink {
+public:
+    using UpdateHandler = std::function<void(size_t instance, const T& value)>;
+
+    ObjectBinder(opcua::Client& client, ObjectBinding<T> binding, BindingOptions options = {})
+        : client_{client},
+          binding_{std::move(binding)},
+          options_{options} {}
+
+    /// 实例在结构体更新后调用（read() 和每帧结束时）
+    void onUpdate(UpdateHandler handler) {
+        handler_ = std::move(handler);
+    }
+
+    /**
+     * @brief 添加实例并解析其字段
+     * @return 解析成功的字段数
+     */
+    size_t bind(const std::vector<opcua::NodeId>& instances) {
+        const size_t fields = binding_.size();
+        const size_t firstSlot = nodeIds_.size();
+        nodeIds_.resize(firstSlot + instances.size() * fields);
+        values_.resize(values_.size() + instances.size());
+        dirty_.resize(values_.size(), 0);
+
+        // 每个实例 × 每个字段一条路径；字符串指向 binding_，发送时立即编码
+        std::vector<std::vector<UA_RelativePathElement>> elements(fields);
+        for (size_t f = 0; f < fields; ++f) {
+            for (const auto& [ns, name] : binding_[f].path) {
+                UA_RelativePathElement element;
+                UA_RelativePathElement_init(&element);
+                element.referenceTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_HIERARCHICALREFERENCES);
+                element.includeSubtypes = true;
+                element.targetName.namespaceIndex = ns;
+                element.targetName.name = {name.size(), reinterpret_cast<UA_Byte*>(const_cast<char*>(name.data()))};
+                elements[f].push_back(element);
+            }
+        }
+        const size_t total = instances.size() * fields;
+        size_t bound = 0;
+        for (size_t offset = 0; offset < total; offset += options_.pathsPerRequest) {
+            const size_t count = std::min(options_.pathsPerRequest, total - offset);
+            std::vector<UA_BrowsePath> paths(count);
+            for (size_t i = 0; i < count; ++i) {
+                const size_t instance = (offset + i) / fields;
+                const size_t f = (offset + i) % fields;
+                UA_BrowsePath_init(&paths[i]);
+                paths[i].startingNode = *instances[instance].handle();  // 浅拷贝
+                paths[i].relativePath.elements = elements[f].data();
+                paths[i].relativePath.elementsSize = elements[f].size();
+            }
+            UA_TranslateBrowsePathsToNodeIdsRequest request;
+            UA_TranslateBrowsePathsToNodeIdsRequest_init(&request);
+            request.browsePaths = paths.data();
+            request.browsePathsSize = count;
+            UA_TranslateBrowsePathsToNodeIdsResponse response =
+                UA_Client_Service_translateBrowsePathsToNodeIds(client_.handle(), request);
+            ++stats_.translateRequests;
+            if (response.responseHeader.serviceResult == UA_STATUSCODE_GOOD && response.resultsSize == count) {
+                for (size_t i = 0; i < count; ++i) {
+                    const auto& result = response.results[i];
+                    if (result.statusCode == UA_STATUSCODE_GOOD && result.targetsSize > 0 &&
+                        UA_ExpandedNodeId_isLocal(&result.targets[0].targetId)) {
+                        nodeIds_[firstSlot + offset + i] = opcua::NodeId{result.targets[0].targetId.nodeId};
+                        ++bound;
+                    }
+                }
+            }
+            UA_TranslateBrowsePathsToNodeIdsResponse_clear(&response);
+        }
+        stats_.fieldsBound += bound;
+        stats_.fieldsMissing += total - bound;
+        buildReadItems();
+        return bound;
+    }
+
+    /**
+     * @brief 读取所有实例的所有字段
+     * @return 更新的实例数
+     */
+    size_t read() {
+        for (size_t offset = 0; offset < readItems_.size(); offset += options_.readsPerRequest) {
+            const size_t count = std::min(options_.readsPerRequest, readItems_.size() - offset);
+            UA_ReadRequest request;
+            UA_ReadRequest_init(&request);
+            request.nodesToRead = readItems_.data() + offset;
+            request.nodesToReadSize = count;
+            apply(options_.profile, request);
+            UA_ReadResponse response = UA_Client_Service_read(client_.handle(), request);
+            ++stats_.readRequests;
+            if (response.responseHeader.serviceResult == UA_STATUSCODE_GOOD && response.resultsSize == count) {
+                for (size_t i = 0; i < count; ++i) {
+                    const auto& dv = response.results[i];
+                    if (dv.hasValue && (!dv.hasStatus || dv.status == UA_STATUSCODE_GOOD)) {
+                        applyValue(readSlots_[offset + i], dv.value);
+                    }
+                }
+            }
+            UA_ReadResponse_clear(&response);
+        }
+        return flushUpdates();
+    }
+
+    /**
+     * @brief 为所有字段创建监控项，结构体随通知更新
+     *
+     * 字段的 NodeId 加入 tags，engine 按 itemsPerRequest 批量创建监控项。
+     * 多个字段（同一实例或不同实例）解析到同一节点时共用一个监控项，通知写入所有这些字段。
+     * @return 新建的监控项数
+     */
+    size_t subscribe(SubscriptionEngine& engine, TagTable& tags) {
+        const std::vector<uint32_t> previous = std::move(slotOf_);
+        slotOf_.assign(previous.size(), noSlot);
+        nextSlot_.assign(nodeIds_.size(), noSlot);
+        std::vector<TagHandle> handles;
+        // 倒序插入链表头，每个 tag 的链表按 slot 升序
+        for (size_t slot = nodeIds_.size(); slot-- > 0;) {
+            if (UA_NodeId_isNull(nodeIds_[slot].handle())) {
+                continue;
+            }
+            const TagHandle tag = tags.add(nodeIds_[slot]);
+            if (tag >= slotOf_.size()) {
+                slotOf_.resize(tag + 1, noSlot);
+            }
+            if (slotOf_[tag] == noSlot && (tag >= previous.size() || previous[tag] == noSlot)) {
+                handles.push_back(tag);  // 之前的 subscribe() 已创建的监控项不再重复创建
+            }
+            nextSlot_[slot] = slotOf_[tag];
+            slotOf_[tag] = static_cast<uint32_t>(slot);
+        }
+        std::reverse(handles.begin(), handles.end());
+        engine.addFrameSink(*this);  // 再次调用时引擎忽略重复添加
+        engine.addTags(handles);
+        return handles.size();
+    }
+
+    void writeFrame(const PublishFrame& frame) override {
+        ++stats_.frames;
+        for (const auto& item : frame.items) {
+            if (item.tag >= slotOf_.size() || slotOf_[item.tag] == noSlot) {
+                continue;  // 引擎中其他 tag 的通知
+            }
+            const auto& dv = *item.value;
+            if (dv.hasValue && (!dv.hasStatus || dv.status == UA_STATUSCODE_GOOD)) {
+                for (uint32_t slot = slotOf_[item.tag]; slot != noSlot; slot = nextSlot_[slot]) {
+                    applyValue(slot, dv.value);
+                }
+            }
+        }
+        flushUpdates();
+    }
+
+    size_t instanceCount() const noexcept {
+        return values_.size();
+    }
+
+    const T& value(size_t instance) const {
+        return values_.at(instance);
+    }
+
+    const std::vector<T>& values() const noexcept {
+        return values_;
+    }
+
+    /// 字段的 NodeId；实例中不存在该字段时为空 NodeId
+    const opcua::NodeId& fieldNodeId(size_t instance, size_t field) const {
+        return nodeIds_.at(instance * binding_.size() + field);
+    }
+
+    const BindingStats& stats() const noexcept {
+        return stats_;
+    }
+
+private:
+    static constexpr uint32_t noSlot = UINT32_MAX;
+
+    // 读取请求只在 bind() 后重建：ReadValueId 浅拷贝 nodeIds_，readSlots_ 记录每项对应的位置
+    void buildReadItems() {
+        readItems_.clear();
+        readSlots_.clear();
+        for (size_t slot = 0; slot < nodeIds_.size(); ++slot) {
+            if (UA_NodeId_isNull(nodeIds_[slot].handle())) {
+                continue;
+            }
+            UA_ReadValueId item;
+            UA_ReadValueId_init(&item);
+            item.nodeId = *nodeIds_[slot].handle();
+            item.attributeId = UA_ATTRIBUTEID_VALUE;
+            readItems_.push_back(item);
+            readSlots_.push_back(static_cast<uint32_t>(slot));
+        }
+    }
+
+    void applyValue(uint32_t slot, const UA_Variant& value) {
+        const size_t instance = slot / binding_.size();
+        if (binding_[slot % binding_.size()].assign(values_[instance], value) && dirty_[instance] == 0) {
+            dirty_[instance] = 1;
+            dirtyList_.push_back(static_cast<uint32_t>(instance));
+        }
+    }
+
+    size_t flushUpdates() {
+        const size_t updated = dirtyList_.size();
+        for (const uint32_t instance : dirtyList_) {
+            dirty_[instance] = 0;
+            if (handler_) {
+                handler_(instance, values_[instance]);
+            }
+        }
+        dirtyList_.clear();
+        stats_.updates += updated;
+        return updated;
+    }
+
+    opcua::Client& client_;
+    ObjectBinding<T> binding_;
+    BindingOptions options_;
+    UpdateHandler handler_;
+
+    std::vector<opcua::NodeId> nodeIds_;  // 实例 × 字段
+    std::vector<T> values_;               // 每个实例一个结构体
+    std::vector<UA_ReadValueId> readItems_;
+    std::vector<uint32_t> readSlots_;
+    std::vector<uint32_t> slotOf_;    // TagHandle -> 第一个使用该节点的 nodeIds_ 下标
+    std::vector<uint32_t> nextSlot_;  // nodeIds_ 下标 -> 使用同一节点的下一个下标
+    std::vector<uint8_t> dirty_;
+    std::vector<uint32_t> dirtyList_;
+    BindingStats stats_;
+};
@@ -0,0 +1,493 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <open62541/client.h>
+
+#include <open62541pp/client.hpp>
+
+#include "collector_types.hpp"
+#include "decode_pool.hpp"
+#include "request_profiles.hpp"
+
+// 轮询引擎参数
+struct PollEngineOptions {
+    size_t readsPerRequest = 1000;   // 每个 Read 请求包含的 tag 数
+    size_t writesPerRequest = 1000;  // 每个 Write 请求包含的 tag 数
+    // 每个轮询组调用一次 RegisterNodes，之后的请求使用服务器返回的别名（会话重建后重新注册）
+    bool registerNodes = false;
+    // 每个轮询组的 ReadValueId 数组只构建一次，之后每个周期复用
+    bool reuseReadValueIds = true;
+    RequestProfile profile = request_profiles::collect;
+};
+
+struct PollStats {
+    size_t cycles = 0;
+    size_t overruns = 0;  // 上一轮的请求尚未返回，跳过的轮询周期
+    size_t readRequests = 0;
+    size_t writeRequests = 0;
+    size_t registerRequests = 0;
+    size_t registeredNodes = 0;
+    size_t requestBytes = 0;  // Read 和 Write 请求的编码长度
+    size_t requestBuilds = 0;     // 构建的 Read 请求数；reuseReadValueIds 时只在注册状态变化后重新构建
+    double prepareSeconds = 0.0;  // 构建 Read 请求（分配和填充 ReadValueId 数组）的耗时
+    double sendSeconds = 0.0;     // __UA_Client_AsyncService() 发送 Read 请求的耗时
+    size_t responses = 0;
+    double latencySeconds = 0.0;  // Read 请求往返时间之和
+    size_t samples = 0;
+};
+
+struct TagWrite {
+    TagHandle tag;
+    opcua::Variant value;
+};
+
+/**
+ * @brief 批量轮询读取和批量写入
+ *
+ * - 每个轮询组是一组 tag 和一个周期，到期时按 readsPerRequest 拆成异步 Read 请求
+ * - 读到的值转换为 Sample 写入各写入目标，与订阅引擎相同
+ * - write() 把多个 tag 的写入合并成 Write 请求
+ *
+ * registerNodes 为 true 时，每个轮询组第一次轮询前调用 RegisterNodes：
+ * KEPServerEX 的字符串 NodeId（"ns=2;s=Channel1.Device1.Tag5"）通常有几十字节，
+ * 服务器返回的别名一般是几个字节的数值 NodeId，之后的请求更小，服务器也不必再解析字符串。
+ * 注册的别名只在当前会话有效，会话重建后调用 resetSession()，下次轮询时重新注册。
+ *
+ * 固定的轮询组每个周期读取相同的节点，reuseReadValueIds 为 true 时每个组的 ReadValueId 数组按组缓存，
+ * 稳定运行时每个周期不再分配和填充数组。
+ *
+ * 所有方法和 client.runIterate() 在同一线程中调用。
+ */
+class PollEngine {
+public:
+    using GroupId = size_t;
+
+    PollEngine(opcua::Client& client, const TagTable& tags, PollEngineOptions options = {})
+        : client_{client},
+          tags_{tags},
+          options_{options} {}
+
+    ~PollEngine() {
+        alive_.reset();  // 尚未返回的请求的回调不再访问引擎
+    }
+
+    PollEngine(const PollEngine&) = delete;
+    PollEngine& operator=(const PollEngine&) = delete;
+
+    void addSink(HistorySink& sink) {
+        sinks_.push_back(&sink);
+    }
+
+    /// 使用线程池转换 Read 响应，采样在 poll() 中按顺序写入写入目标
+    void useDecodePool(DecodePool& pool) {
+        decodePool_ = &pool;
+    }
+
+    /// 添加轮询组；第一次 poll() 时立即读取
+    GroupId addGroup(std::vector<TagHandle> tags, std::chrono::milliseconds interval) {
+        Group group;
+        group.tags = std::move(tags);
+        group.interval = interval;
+        group.due = std::chrono::steady_clock::now();
+        groups_.push_back(std::move(group));
+        return groups_.size() - 1;
+    }
+
+    /// 删除轮询组，并注销其别名；尚未返回的请求的响应被忽略（组编号不会重复使用）
+    void removeGroup(GroupId id) {
+        auto& group = groups_.at(id);
+        if (!group.aliases.empty() && sessionActivated()) {
+            unregisterGroup(id);
+        }
+        forgetAliases(id);
+        group = {};  // 模板随之释放
+        group.removed = true;
+    }
+
+    /**
+     * @brief 发送到期轮询组的 Read 请求（在主循环中调用）
+     */
+    void poll() {
+        if (decodePool_ != nullptr) {
+            decodePool_->drain();
+        }
+        if (!sessionActivated()) {
+            return;
+        }
+        const auto now = std::chrono::steady_clock::now();
+        for (GroupId id = 0; id < groups_.size(); ++id) {
+            auto& group = groups_[id];
+            if (group.removed || group.tags.empty() || now < group.due) {
+                continue;
+            }
+            // 按周期推进到期时间；落后超过一个周期时从当前时间重新开始
+            group.due += group.interval;
+            if (group.due < now) {
+                group.due = now + group.interval;
+            }
+            if (group.inFlight > 0) {
+                ++stats_.overruns;
+                continue;
+            }
+            if (options_.registerNodes && !group.registered) {
+                registerGroup(id);
+            }
+            if (group.templates.empty()) {
+                buildTemplates(group);
+            }
+            ++stats_.cycles;
+            for (auto& t : group.templates) {
+                sendRead(id, t);
+            }
+            if (!options_.reuseReadValueIds) {
+                group.templates.clear();
+            }
+        }
+    }
+
+    /**
+     * @brief 批量写入（同步）
+     *
+     * 属于已注册轮询组的 tag 使用别名（在多个组中注册时使用任一组的别名）。
+     * @return 写入成功的 tag 数
+     */
+    size_t write(const std::vector<TagWrite>& writes) {
+        size_t good = 0;
+        for (size_t offset = 0; offset < writes.size(); offset += options_.writesPerRequest) {
+            const size_t count = std::min(options_.writesPerRequest, writes.size() - offset);
+            std::vector<UA_WriteValue> items(count);
+            for (size_t i = 0; i < count; ++i) {
+                const auto& w = writes[offset + i];
+                auto& item = items[i];
+                UA_WriteValue_init(&item);
+                item.nodeId = *nodeIdFor(w.tag).handle();  // 浅拷贝
+                item.attributeId = UA_ATTRIBUTEID_VALUE;
+                item.value.value = *w.value.handle();
+                item.value.hasValue = true;
+            }
+            UA_WriteRequest request;
+            UA_WriteRequest_init(&request);
+            apply(options_.profile, request.requestHeader);
+            request.nodesToWrite = items.data();
+            request.nodesToWriteSize = count;
+            stats_.requestBytes += UA_calcSizeBinary(&request, &UA_TYPES[UA_TYPES_WRITEREQUEST]);
+            UA_WriteResponse response = UA_Client_Service_write(client_.handle(), request);
+            ++stats_.writeRequests;
+            if (response.responseHeader.serviceResult == UA_STATUSCODE_GOOD && response.resultsSize == count) {
+                for (size_t i = 0; i < count; ++i) {
+                    good += response.results[i] == UA_STATUSCODE_GOOD ? 1 : 0;
+                }
+            }
+            UA_WriteResponse_clear(&response);
+        }
+        return good;
+    }
+
+    /**
+     * @brief 会话重建后调用（例如在 onSessionActivated 回调中）
+     *
+     * 旧会话的别名和未返回的请求都已失效，下次轮询时重新注册。
+     */
+    void resetSession() {
+        alive_ = std::make_shared<PollEngine*>(this);
+        for (auto& group : groups_) {
+            group.inFlight = 0;
+            group.registered = false;
+            group.aliases.clear();
+            group.templates.clear();
+        }
+        aliasOf_.clear();
+    }
+
+    size_t groupCount() const noexcept {
+        return groups_.size();
+    }
+
+    const PollStats& stats() const noexcept {
+        return stats_;
+    }
+
+private:
+    // 一个 Read 请求的模板：nodesToRead 指向 items，items 浅拷贝组内的 NodeId
+    struct ReadTemplate {
+        size_t offset = 0;
+        std::vector<UA_ReadValueId> items;
+        UA_ReadRequest request{};
+        size_t encodedSize = 0;
+    };
+
+    struct Group {
+        std::vector<TagHandle> tags;
+        std::chrono::milliseconds interval{1000};
+        std::chrono::steady_clock::time_point due;
+        size_t inFlight = 0;
+        bool registered = false;
+        bool removed = false;
+        std::vector<opcua::NodeId> aliases;  // 与 tags 一一对应；为空表示使用原始 NodeId
+        // 模板引用的原始 NodeId 副本（TagTable 增加 tag 时内部数组可能重新分配）
+        std::vector<opcua::NodeId> nodeIds;
+        std::vector<ReadTemplate> templates;  // 为空表示需要重新构建
+    };
+
+    // 别名在 groups_[group].aliases 中的位置
+    struct AliasRef {
+        GroupId group;
+        size_t index;
+    };
+
+    struct ReadContext {
+        std::weak_ptr<PollEngine*> owner;
+        GroupId group;
+        size_t offset;
+        size_t count;
+        std::chrono::steady_clock::time_point sent;
+    };
+
+    bool sessionActivated() {
+        UA_SecureChannelState channelState{};
+        UA_SessionState sessionState{};
+        UA_StatusCode connectStatus{};
+        UA_Client_getState(client_.handle(), &channelState, &sessionState, &connectStatus);
+        return sessionState == UA_SESSIONSTATE_ACTIVATED;
+    }
+
+    const opcua::NodeId& nodeIdFor(TagHandle tag) const {
+        const auto it = aliasOf_.find(tag);
+        return it != aliasOf_.end() ? groups_[it->second.group].aliases[it->second.index] : tags_.nodeId(tag);
+    }
+
+    // RegisterNodes（同步），失败时该组继续使用原始 NodeId
+    void registerGroup(GroupId id) {
+        auto& group = groups_[id];
+        group.registered = true;
+        std::vector<opcua::NodeId> aliases;
+        aliases.reserve(group.tags.size());
+        for (size_t offset = 0; offset < group.tags.size(); offset += options_.readsPerRequest) {
+            const size_t count = std::min(options_.readsPerRequest, group.tags.size() - offset);
+            std::vector<UA_NodeId> ids(count);
+            for (size_t i = 0; i < count; ++i) {
+                ids[i] = *tags_.nodeId(group.tags[offset + i]).handle();  // 浅拷贝
+            }
+            UA_RegisterNodesRequest request;
+            UA_RegisterNodesRequest_init(&request);
+            request.nodesToRegister = ids.data();
+            request.nodesToRegisterSize = count;
+            UA_RegisterNodesResponse response = UA_Client_Service_registerNodes(client_.handle(), request);
+            ++stats_.registerRequests;
+            const bool ok = response.responseHeader.serviceResult == UA_STATUSCODE_GOOD &&
+                response.registeredNodeIdsSize == count;
+            if (ok) {
+                for (size_t i = 0; i < count; ++i) {
+                    aliases.emplace_back(response.registeredNodeIds[i]);
+                }
+            }
+            UA_RegisterNodesResponse_clear(&response);
+            if (!ok) {
+                if (!aliases.empty()) {
+                    group.aliases = std::move(aliases);
+                    unregisterGroup(id);  // 已注册的部分也不再使用
+                }
+                return;
+            }
+        }
+        group.aliases = std::move(aliases);
+        group.templates.clear();  // 改用别名
+        stats_.registeredNodes += group.aliases.size();
+        for (size_t i = 0; i < group.tags.size(); ++i) {
+            aliasOf_.emplace(group.tags[i], AliasRef{id, i});
+        }
+    }
+
+    void unregisterGroup(GroupId id) {
+        auto& group = groups_[id];
+        for (size_t offset = 0; offset < group.aliases.size(); offset += options_.readsPerRequest) {
+            const size_t count = std::min(options_.readsPerRequest, group.aliases.size() - offset);
+            std::vector<UA_NodeId> ids(count);
+            for (size_t i = 0; i < count; ++i) {
+                ids[i] = *group.aliases[offset + i].handle();
+            }
+            UA_UnregisterNodesRequest request;
+            UA_UnregisterNodesRequest_init(&request);
+            request.nodesToUnregister = ids.data();
+            request.nodesToUnregisterSize = count;
+            UA_UnregisterNodesResponse response = UA_Client_Service_unregisterNodes(client_.handle(), request);
+            UA_UnregisterNodesResponse_clear(&response);
+        }
+        forgetAliases(id);
+        group.aliases.clear();
+        group.templates.clear();
+    }
+
+    // 只删除本组的别名；同一个 tag 可能也在其他组中注册
+    void forgetAliases(GroupId id) {
+        for (const TagHandle tag : groups_[id].tags) {
+            auto [it, end] = aliasOf_.equal_range(tag);
+            while (it != end) {
+                it = it->second.group == id ? aliasOf_.erase(it) : std::next(it);
+            }
+        }
+    }
+
+    // 按 readsPerRequest 拆分并构建 Read 请求；别名和原始 NodeId 都由组持有
+    void buildTemplates(Group& group) {
+        const auto t0 = std::chrono::steady_clock::now();
+        if (group.aliases.empty() && group.nodeIds.size() != group.tags.size()) {
+            group.nodeIds.clear();
+            group.nodeIds.reserve(group.tags.size());
+            for (const TagHandle tag : group.tags) {
+                group.nodeIds.push_back(tags_.nodeId(tag));
+            }
+        }
+        const auto& ids = group.aliases.empty() ? group.nodeIds : group.aliases;
+        group.templates.clear();
+        for (size_t offset = 0; offset < group.tags.size(); offset += options_.readsPerRequest) {
+            const size_t count = std::min(options_.readsPerRequest, group.tags.size() - offset);
+            auto& t = group.templates.emplace_back();
+            t.offset = offset;
+            t.items.resize(count);
+            for (size_t i = 0; i < count; ++i) {
+                UA_ReadValueId_init(&t.items[i]);
+                t.items[i].nodeId = *ids[offset + i].handle();  // 浅拷贝
+                t.items[i].attributeId = UA_ATTRIBUTEID_VALUE;
+            }
+            UA_ReadRequest_init(&t.request);
+            t.request.nodesToRead = t.items.data();
+            t.request.nodesToReadSize = count;
+            apply(options_.profile, t.request);
+        }
+        stats_.requestBuilds += group.templates.size();
+        stats_.prepareSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        // 编码长度只用于统计，不计入构建耗时
+        for (auto& t : group.templates) {
+            t.encodedSize = UA_calcSizeBinary(&t.request, &UA_TYPES[UA_TYPES_READREQUEST]);
+        }
+    }
+
+    // 客户端发送时在请求头中填入 requestHandle、timestamp 和 authenticationToken，
+    // 发送后恢复 authenticationToken，其余字段不变，模板可以重复发送
+    void sendRead(GroupId id, ReadTemplate& t) {
+        auto context = std::make_unique<ReadContext>();
+        context->owner = alive_;
+        context->group = id;
+        context->offset = t.offset;
+        context->count = t.items.size();
+        context->sent = std::chrono::steady_clock::now();
+        const UA_StatusCode status = __UA_Client_AsyncService(
+            client_.handle(),
+            &t.request,
+            &UA_TYPES[UA_TYPES_READREQUEST],
+            onReadResponse,
+            &UA_TYPES[UA_TYPES_READRESPONSE],
+            context.get(),
+            nullptr
+        );
+        stats_.sendSeconds +=
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - context->sent).count();
+        if (status != UA_STATUSCODE_GOOD) {
+            return;  // 例如连接已断开，下个周期重试
+        }
+        context.release();  // 所有权交给回调
+        ++groups_[id].inFlight;
+        ++stats_.readRequests;
+        stats_.requestBytes += t.encodedSize;
+    }
+
+    // 客户端保证每个异步请求的回调都会被调用（断开连接时带错误状态码）
+    static void onReadResponse(UA_Client*, void* userdata, UA_UInt32, void* response) {
+        std::unique_ptr<ReadContext> context{static_cast<ReadContext*>(userdata)};
+        const auto owner = context->owner.lock();
+        if (owner == nullptr) {
+            return;
+        }
+        (*owner)->handleRead(*context, *static_cast<UA_ReadResponse*>(response));
+    }
+
+    void handleRead(const ReadContext& context, UA_ReadResponse& response) {
+        auto& group = groups_[context.group];
+        if (group.removed) {
+            return;  // removeGroup() 已清零 inFlight
+        }
+        --group.inFlight;
+        ++stats_.responses;
+        stats_.latencySeconds +=
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - context.sent).count();
+        if (response.responseHeader.serviceResult != UA_STATUSCODE_GOOD ||
+            response.resultsSize != context.count) {
+            return;
+        }
+        if (decodePool_ != nullptr) {
+            dispatchAsync(context, group, response);
+            return;
+        }
+        batch_.clear();
+        for (size_t i = 0; i < context.count; ++i) {
+            Sample sample{};
+            if (toSample(response.results[i], group.tags[context.offset + i], sample)) {
+                batch_.push_back(sample);
+            }
+        }
+        deliver(batch_);
+    }
+
+    // 接管响应，交给线程池转换；tag 列表复制一份，removeGroup() 不影响正在转换的区间
+    void dispatchAsync(const ReadContext& context, const Group& group, UA_ReadResponse& response) {
+        std::shared_ptr<UA_ReadResponse> owned{
+            new UA_ReadResponse{response},
+            [](UA_ReadResponse* r) {
+                UA_ReadResponse_clear(r);
+                delete r;
+            }
+        };
+        UA_ReadResponse_init(&response);
+        const auto first = group.tags.begin() + static_cast<std::ptrdiff_t>(context.offset);
+        std::vector<TagHandle> tags(first, first + static_cast<std::ptrdiff_t>(context.count));
+        decodePool_->submit(
+            context.count,
+            [owned, tags = std::move(tags)](size_t begin, size_t end, std::vector<Sample>& out) {
+                for (size_t i = begin; i < end; ++i) {
+                    Sample sample{};
+                    if (toSample(owned->results[i], tags[i], sample)) {
+                        out.push_back(sample);
+                    }
+                }
+            },
+            [owner = std::weak_ptr<PollEngine*>{alive_}](std::vector<Sample>& samples) {
+                if (const auto engine = owner.lock()) {
+                    (*engine)->deliver(samples);
+                }
+            }
+        );
+        decodePool_->drain();
+    }
+
+    void deliver(const std::vector<Sample>& samples) {
+        if (samples.empty()) {
+            return;
+        }
+        for (auto* sink : sinks_) {
+            sink->write(samples);
+        }
+        stats_.samples += samples.size();
+    }
+
+    opcua::Client& client_;
+    const TagTable& tags_;
+    PollEngineOptions options_;
+
+    std::vector<Group> groups_;
+    std::unordered_multimap<TagHandle, AliasRef> aliasOf_;  // 已注册的 tag -> 各组中的别名，write() 使用
+    std::vector<HistorySink*> sinks_;
+    std::vector<Sample> batch_;
+    DecodePool* decodePool_ = nullptr;
+
+    std::shared_ptr<PollEngine*> alive_ = std::make_shared<PollEngine*>(this);
+    PollStats stats_;
+};
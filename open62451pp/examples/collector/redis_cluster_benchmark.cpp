@@ -0,0 +1,177 @@
+/**
+ * @file redis_cluster_benchmark.cpp
+ * @brief Redis Cluster 分片写入测试 - 把大量 tag 的实时值按哈希槽写入多个 Redis 节点
+ *
+ * 本程序测试 redis_cluster_sink.hpp 中的 RedisClusterSink：
+ * 1. 通过种子节点读取 CLUSTER SLOTS，建立槽到主节点的映射
+ * 2. 按 KEPServerEX 的命名方式注册 "ChannelN.DeviceM.TagK"，同一设备的 tag 共用哈希标签
+ * 3. 按固定周期写入全部 tag 的新值，模拟订阅通知
+ * 4. 输出每个节点的命令数、重定向和重连统计
+ * 5. 按 MOVED 重定向读回部分 tag，校验写入的值
+ *
+ * 运行期间可以在另一个终端中迁移槽或停止主节点，观察 MOVED/ASK 处理和故障转移。
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../helper.hpp"          // CliParser - 命令行参数解析器
+#include "redis_cluster_sink.hpp"  // RedisClusterSink
+
+// 读取一个 tag 的值 v，按 MOVED 重定向查找所属节点
+static std::string readValue(const std::vector<redis_cluster::Endpoint>& seeds, const std::string& key) {
+    redis_cluster::Endpoint endpoint = seeds.front();
+    for (int attempt = 0; attempt < 5; ++attempt) {
+        RespClient client{endpoint.host, endpoint.port};
+        const auto reply = client.command({"HGET", key, "v"});
+        redis_cluster::Redirect redirect;
+        if (reply.isError() && redis_cluster::parseRedirect(reply.str, redirect)) {
+            endpoint = redirect.target;
+            continue;
+        }
+        return reply.isNil() ? "(nil)" : reply.str;
+    }
+    return "(too many redirects)";
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "=== Redis Cluster 分片写入测试 ===" << std::endl;
+
+    const CliParser parser{argc, argv};
+    const std::string nodes{parser.value("--nodes").value_or("127.0.0.1:7000")};
+    const size_t devices = std::stoul(std::string{parser.value("--devices").value_or("100")});
+    const size_t tagsPerDevice = std::stoul(std::string{parser.value("--tags-per-device").value_or("100")});
+    const int seconds = std::stoi(std::string{parser.value("--seconds").value_or("10")});
+    const int intervalMs = std::stoi(std::string{parser.value("--interval").value_or("100")});
+
+    // 1. 种子节点（逗号分隔）
+    std::vector<redis_cluster::Endpoint> seeds;
+    for (size_t begin = 0; begin < nodes.size();) {
+        const size_t end = std::min(nodes.find(',', begin), nodes.size());
+        seeds.push_back(redis_cluster::parseEndpoint(std::string_view{nodes}.substr(begin, end - begin)));
+        begin = end + 1;
+    }
+
+    std::cout << "1. 读取集群槽映射..." << std::endl;
+    RedisClusterSink sink{seeds};
+    std::cout << "   ✓ 覆盖 " << sink.coveredSlots() << "/" << redis_cluster::slotCount << " 个槽，"
+              << sink.nodeCommands().size() << " 个主节点" << std::endl;
+
+    // 2. 注册 tag
+    std::cout << "2. 注册 " << devices << " 个设备 × " << tagsPerDevice << " 个 tag..." << std::endl;
+    std::vector<Sample> samples;
+    for (size_t d = 0; d < devices; ++d) {
+        for (size_t t = 0; t < tagsPerDevice; ++t) {
+            const auto tag = static_cast<TagHandle>(samples.size());
+            sink.addTag(tag, "Channel" + std::to_string(d / 10 + 1) + ".Device" + std::to_string(d + 1) +
+                                 ".Tag" + std::to_string(t + 1));
+            samples.push_back({tag, 0, 0, 0.0, 0});
+        }
+    }
+    std::cout << "   ✓ 例如 " << sink.key(0) << " -> 槽 " << redis_cluster::keySlot(sink.key(0))
+              << std::endl;
+
+    // 3. 周期写入
+    std::cout << "3. 每 " << intervalMs << " 毫秒写入全部 tag，持续 " << seconds << " 秒..." << std::endl;
+    const auto start = std::chrono::steady_clock::now();
+    const auto stopAt = start + std::chrono::seconds{seconds};
+    double writeSeconds = 0.0;
+    size_t cycles = 0;
+    for (auto next = start; next < stopAt; next += std::chrono::milliseconds{intervalMs}) {
+        std::this_thread::sleep_until(next);
+        const int64_t now = opcua::DateTime::now().get();
+        for (auto& sample : samples) {
+            sample.value = static_cast<double>(cycles);
+            sample.sourceTime = now;
+            sample.serverTime = now;
+        }
+        const auto writeStart = std::chrono::steady_clock::now();
+        sink.write(samples);
+        writeSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - writeStart).count();
+        ++cycles;
+    }
+    const bool drained = sink.flush(std::chrono::seconds{10});
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // 4. 统计
+    const auto stats = sink.stats();
+    std::cout << "\n4. 统计：" << std::endl;
+    std::cout << "   写入周期:     " << cycles << "（write() 平均 " << std::fixed << std::setprecision(3)
+              << writeSeconds / static_cast<double>(std::max<size_t>(cycles, 1)) * 1000.0 << " 毫秒）"
+              << std::endl;
+    std::cout << "   HSET 命令:    " << stats.commands << "（"
+              << std::setprecision(0) << static_cast<double>(stats.commands) / elapsed << " 条/秒）" << std::endl;
+    for (const auto& [name, commands] : sink.nodeCommands()) {
+        std::cout << "     " << std::left << std::setw(22) << name << std::right << commands << std::endl;
+    }
+    std::cout << "   MOVED/ASK:    " << stats.moved << " / " << stats.ask << std::endl;
+    std::cout << "   重试/重连:    " << stats.retries << " / " << stats.reconnects << std::endl;
+    std::cout << "   映射刷新:     " << stats.refreshes << std::endl;
+    std::cout << "   无法路由:     " << stats.unroutable << std::endl;
+    std::cout << "   错误应答:     " << stats.errors << std::endl;
+    if (!drained) {
+        std::cout << "   ✗ 10 秒内未能写完全部待写数据" << std::endl;
+    }
+
+    // 5. 读回校验：最后一个周期写入的值
+    std::cout << "\n5. 读回校验（期望值 " << cycles - 1 << "）：" << std::endl;
+    for (size_t d = 0; d < devices; d += std::max<size_t>(devices / 5, 1)) {
+        const auto& key = sink.key(static_cast<TagHandle>(d * tagsPerDevice));
+        std::cout << "   " << key << " = " << readValue(seeds, key) << std::endl;
+    }
+
+    return 0;
+}
+
+/**
+ * 使用说明：
+ *
+ * 1. 启动 3 个集群模式的 Redis 实例（端口 7000-7002）：
+ *    for port in 7000 7001 7002; do
+ *      mkdir -p /tmp/redis-$port
+ *      redis-server --port $port --cluster-enabled yes --cluster-config-file nodes.conf \
+ *                   --dir /tmp/redis-$port --save "" --appendonly no --daemonize yes
+ *    done
+ *    redis-cli --cluster create 127.0.0.1:7000 127.0.0.1:7001 127.0.0.1:7002 --cluster-yes
+ *    （需要故障转移时使用 6 个实例并加上 --cluster-replicas 1）
+ *
+ * 2. 运行：./redis_cluster_benchmark --nodes 127.0.0.1:7000,127.0.0.1:7001 --devices 100 --tags-per-device 100
+ *
+ * 3. 运行期间迁移槽，观察 MOVED/ASK：
+ *    redis-cli --cluster reshard 127.0.0.1:7000 --cluster-from all --cluster-to <节点 ID> \
+ *              --cluster-slots 1000 --cluster-yes
+ *
+ * 4. 运行期间停止一个主节点（有副本时）：redis-cli -p 7001 shutdown nosave
+ *
+ * 分片写入原理：
+ *
+ * 1. 键槽：
+ *    - 槽 = CRC16(键) mod 16384；键中含 {...} 时只对花括号内的内容计算
+ *    - 键名 rt:{Channel1.Device1}:Channel1.Device1.Tag5 使同一设备的 tag 在同一个槽，
+ *      读取整台设备时可以在一个节点上完成
+ *
+ * 2. 按节点流水线：
+ *    - write() 只做分组和入队，不等待网络
+ *    - 每个主节点一个连接和一个线程，一次发送最多 maxBatch 条 HSET 再依次读取应答
+ *    - 待写队列按 tag 合并，节点慢或不可用时只保留最新值
+ *
+ * 3. 重定向：
+ *    - MOVED：槽已迁移到其他节点，更新映射、刷新 CLUSTER SLOTS 后重发
+ *    - ASK：槽正在迁移，该键已在目标节点，先发 ASKING 再发 HSET，映射保持不变
+ *    - TRYAGAIN/CLUSTERDOWN/LOADING：等待 retryDelay 后重发
+ *
+ * 4. 节点故障：
+ *    - 连接或收发失败（ioTimeout）后刷新映射，副本提升为主节点后写入自动转到新主节点
+ *    - 其他节点的写入线程不受影响
+ *
+ * 注意事项：
+ *
+ * - 实时值只需要最新值，合并后丢弃的旧值应由历史写入目标（本地存储、MySQL）保存
+ * - addTag() 必须在第一次 write() 之前完成
+ * - 没有所属节点的槽（集群未完全覆盖）中的采样计入 unroutable 并丢弃
+ */
@@ -0,0 +1,581 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "collector_types.hpp"
+#include "resp_client.hpp"
+
+// Redis Cluster 的键槽计算和重定向解析
+namespace redis_cluster {
+
+inline constexpr size_t slotCount = 16384;
+
+struct Endpoint {
+    std::string host;
+    uint16_t port = 0;
+
+    std::string str() const {
+        return host + ":" + std::to_string(port);
+    }
+};
+
+/// "host:port" 形式的地址
+inline Endpoint parseEndpoint(std::string_view text) {
+    const auto colon = text.rfind(':');
+    if (colon == std::string_view::npos) {
+        throw std::invalid_argument{"expected host:port: " + std::string{text}};
+    }
+    return {
+        std::string{text.substr(0, colon)},
+        static_cast<uint16_t>(std::stoul(std::string{text.substr(colon + 1)})),
+    };
+}
+
+/// CRC16-CCITT（XMODEM），Redis Cluster 规范指定的键槽哈希
+inline uint16_t crc16(std::string_view data) noexcept {
+    uint16_t crc = 0;
+    for (const char c : data) {
+        crc ^= static_cast<uint16_t>(static_cast<uint8_t>(c) << 8);
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x8000) != 0 ? static_cast<uint16_t>((crc << 1) ^ 0x1021)
+                                      : static_cast<uint16_t>(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/// 键所在的槽；键中第一个非空的 {...} 是哈希标签，只对标签内容计算哈希
+inline uint16_t keySlot(std::string_view key) noexcept {
+    const auto open = key.find('{');
+    if (open != std::string_view::npos) {
+        const auto close = key.find('}', open + 1);
+        if (close != std::string_view::npos && close > open + 1) {
+            key = key.substr(open + 1, close - open - 1);
+        }
+    }
+    return static_cast<uint16_t>(crc16(key) % slotCount);
+}
+
+struct Redirect {
+    bool ask = false;  // false：MOVED（槽已迁移），true：ASK（槽正在迁移）
+    uint16_t slot = 0;
+    Endpoint target;
+};
+
+/// 解析 "MOVED 3999 127.0.0.1:6381" / "ASK 3999 127.0.0.1:6381" 错误应答
+inline bool parseRedirect(std::string_view error, Redirect& redirect) {
+    if (error.rfind("MOVED ", 0) == 0) {
+        redirect.ask = false;
+        error.remove_prefix(6);
+    } else if (error.rfind("ASK ", 0) == 0) {
+        redirect.ask = true;
+        error.remove_prefix(4);
+    } else {
+        return false;
+    }
+    const auto space = error.find(' ');
+    if (space == std::string_view::npos) {
+        return false;
+    }
+    redirect.slot = static_cast<uint16_t>(std::stoul(std::string{error.substr(0, space)}));
+    redirect.target = parseEndpoint(error.substr(space + 1));
+    return true;
+}
+
+/// 可以稍后重试的集群错误（槽迁移中的多键操作、集群暂时不可用、节点正在加载数据）
+inline bool retryableError(std::string_view error) noexcept {
+    return error.rfind("TRYAGAIN", 0) == 0 || error.rfind("CLUSTERDOWN", 0) == 0 ||
+        error.rfind("LOADING", 0) == 0;
+}
+
+}  // namespace redis_cluster
+
+struct RedisClusterOptions {
+    std::string keyPrefix = "rt";                    // 键名：<prefix>:{<device>}:<tag>
+    std::chrono::milliseconds ioTimeout{1000};       // 单个节点的收发超时
+    std::chrono::milliseconds retryDelay{200};       // 连接失败或集群暂不可用时的重试间隔
+    size_t maxBatch = 4096;                          // 单次流水线的最大命令数
+};
+
+struct RedisClusterStats {
+    uint64_t commands = 0;     // 成功写入的 HSET 命令数
+    uint64_t moved = 0;        // MOVED 重定向
+    uint64_t ask = 0;          // ASK 重定向
+    uint64_t retries = 0;      // TRYAGAIN/CLUSTERDOWN/LOADING 后重试的命令数
+    uint64_t reconnects = 0;   // 节点连接失败次数
+    uint64_t refreshes = 0;    // CLUSTER SLOTS 刷新次数
+    uint64_t unroutable = 0;   // 槽没有所属节点而丢弃的采样
+    uint64_t errors = 0;       // 其他错误应答
+};
+
+/**
+ * @brief 感知 Redis Cluster 分片的实时值写入目标
+ *
+ * - 每个 tag 对应一个哈希：<prefix>:{<device>}:<tag>，字段 v（值）、st（源时间戳）、
+ *   ts（服务器时间戳）、q（状态码）；哈希标签 {<device>} 使同一设备的 tag 落在同一节点
+ * - 启动时用 CLUSTER SLOTS 建立槽到节点的映射，write() 按所属节点分组
+ * - 每个主节点一个连接和一个写入线程，按流水线批量发送，慢节点或故障节点不影响其他分片
+ * - 每个节点的待写队列只保留每个 tag 的最新值，节点恢复后不会积压过期数据
+ * - MOVED：更新映射并刷新 CLUSTER SLOTS，采样改发到新节点；刷新不阻塞其他写入线程
+ * - ASK：采样以 ASKING + HSET 发到目标节点，不修改映射
+ */
+class RedisClusterSink : public HistorySink {
+public:
+    RedisClusterSink(std::vector<redis_cluster::Endpoint> seeds, RedisClusterOptions options = {})
+        : seeds_{std::move(seeds)},
+          options_{std::move(options)} {
+        slots_.fill(nullptr);
+        if (!refreshSlots()) {
+            stop();
+            throw std::runtime_error{"no reachable Redis Cluster node"};
+        }
+    }
+
+    ~RedisClusterSink() override {
+        stop();
+    }
+
+    RedisClusterSink(const RedisClusterSink&) = delete;
+    RedisClusterSink& operator=(const RedisClusterSink&) = delete;
+
+    /// 键名分组：KEPServerEX 的 "Channel1.Device1.Group.Tag5" 取前两级作为设备
+    static std::string_view deviceOf(std::string_view path) noexcept {
+        const auto first = path.find('.');
+        if (first == std::string_view::npos) {
+            return path;
+        }
+        const auto second = path.find('.', first + 1);
+        return second == std::string_view::npos ? path.substr(0, first) : path.substr(0, second);
+    }
+
+    /**
+     * @brief 注册 tag 的键名
+     *
+     * 必须在第一次 write() 之前完成全部注册。
+     */
+    void addTag(TagHandle tag, std::string_view device, std::string_view name) {
+        if (tag >= keys_.size()) {
+            keys_.resize(static_cast<size_t>(tag) + 1);
+            keySlots_.resize(static_cast<size_t>(tag) + 1, 0);
+        }
+        std::string key = options_.keyPrefix;
+        key += ":{";
+        key += device;
+        key += "}:";
+        key += name;
+        keySlots_[tag] = redis_cluster::keySlot(key);
+        keys_[tag] = std::move(key);
+    }
+
+    void addTag(TagHandle tag, std::string_view path) {
+        addTag(tag, deviceOf(path), path);
+    }
+
+    const std::string& key(TagHandle tag) const {
+        return keys_.at(tag);
+    }
+
+    void write(opcua::Span<const Sample> samples) override {
+        route(samples);
+    }
+
+    /// 等待所有节点的待写队列清空；超时返回 false
+    bool flush(std::chrono::milliseconds timeout) {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        for (;;) {
+            bool idle = true;
+            for (Node* node : nodes()) {
+                std::lock_guard lock{node->mutex};
+                if (node->busy || !node->pending.empty() || !node->asking.empty()) {
+                    idle = false;
+                    break;
+                }
+            }
+            if (idle) {
+                return true;
+            }
+            if (std::chrono::steady_clock::now() >= deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        }
+    }
+
+    RedisClusterStats stats() const {
+        RedisClusterStats result;
+        result.commands = commands_;
+        result.moved = moved_;
+        result.ask = ask_;
+        result.retries = retries_;
+        result.reconnects = reconnects_;
+        result.refreshes = refreshes_;
+        result.unroutable = unroutable_;
+        result.errors = errors_;
+        return result;
+    }
+
+    /// 每个节点（"host:port"）及其写入的命令数
+    std::vector<std::pair<std::string, uint64_t>> nodeCommands() const {
+        std::vector<std::pair<std::string, uint64_t>> result;
+        for (Node* node : nodes()) {
+            result.emplace_back(node->endpoint.str(), node->commands.load());
+        }
+        return result;
+    }
+
+    /// 映射中有所属节点的槽数（16384 表示全部覆盖）
+    size_t coveredSlots() const {
+        std::lock_guard lock{topologyMutex_};
+        size_t count = 0;
+        for (Node* node : slots_) {
+            count += node != nullptr ? 1 : 0;
+        }
+        return count;
+    }
+
+private:
+    struct Node {
+        redis_cluster::Endpoint endpoint;
+        std::mutex mutex;
+        std::condition_variable wakeup;
+        std::vector<Sample> pending;                    // 待写入的最新值
+        std::unordered_map<TagHandle, size_t> position;  // tag 在 pending 中的位置
+        std::vector<Sample> asking;                      // ASK 重定向到本节点的采样
+        bool busy = false;
+        std::atomic<uint64_t> commands{0};
+        std::thread worker;  // 只在 stop() 中 join
+    };
+
+    std::vector<Node*> nodes() const {
+        std::lock_guard lock{topologyMutex_};
+        std::vector<Node*> result;
+        for (const auto& node : nodes_) {
+            result.push_back(node.get());
+        }
+        return result;
+    }
+
+    // 按槽映射把采样分发到各节点的待写队列
+    void route(opcua::Span<const Sample> samples) {
+        std::vector<std::pair<Node*, std::vector<Sample>>> groups;
+        {
+            std::lock_guard lock{topologyMutex_};
+            for (const auto& sample : samples) {
+                Node* node = sample.tag < keySlots_.size() && !keys_[sample.tag].empty()
+                    ? slots_[keySlots_[sample.tag]]
+                    : nullptr;
+                if (node == nullptr) {
+                    ++unroutable_;
+                    continue;
+                }
+                auto it = std::find_if(groups.begin(), groups.end(), [&](const auto& group) {
+                    return group.first == node;
+                });
+                if (it == groups.end()) {
+                    it = groups.insert(groups.end(), {node, {}});
+                }
+                it->second.push_back(sample);
+            }
+        }
+        for (auto& [node, group] : groups) {
+            enqueue(*node, group, false);
+        }
+    }
+
+    static void enqueue(Node& node, const std::vector<Sample>& samples, bool asking) {
+        {
+            std::lock_guard lock{node.mutex};
+            for (const auto& sample : samples) {
+                if (asking) {
+                    node.asking.push_back(sample);
+                    continue;
+                }
+                const auto [it, inserted] = node.position.try_emplace(sample.tag, node.pending.size());
+                if (inserted) {
+                    node.pending.push_back(sample);
+                } else if (sampleTime(node.pending[it->second]) <= sampleTime(sample)) {
+                    node.pending[it->second] = sample;
+                }
+            }
+        }
+        node.wakeup.notify_one();
+    }
+
+    // 调用方持有 topologyMutex_；stop() 开始后不再创建节点（返回 nullptr），保证 stop() 能 join 全部写入线程
+    Node* nodeFor(const redis_cluster::Endpoint& endpoint) {
+        const auto name = endpoint.str();
+        if (const auto it = nodeByName_.find(name); it != nodeByName_.end()) {
+            return it->second;
+        }
+        if (stopping_) {
+            return nullptr;
+        }
+        auto node = std::make_unique<Node>();
+        node->endpoint = endpoint;
+        Node* raw = node.get();
+        nodes_.push_back(std::move(node));
+        nodeByName_.emplace(name, raw);
+        raw->worker = std::thread{[this, raw] { run(*raw); }};
+        return raw;
+    }
+
+    /**
+     * @brief 从任一可达节点读取 CLUSTER SLOTS 并替换槽映射
+     *
+     * 连接和查询不持有任何锁（连接和收发都有 ioTimeout），只在替换映射时持有 topologyMutex_。
+     * 多个写入线程同时要求刷新时只有一个执行，其他的直接返回 false。
+     */
+    bool refreshSlots() {
+        if (refreshing_.exchange(true)) {
+            return false;
+        }
+        std::vector<redis_cluster::Endpoint> candidates;
+        {
+            std::lock_guard lock{topologyMutex_};
+            for (const auto& node : nodes_) {
+                candidates.push_back(node->endpoint);
+            }
+        }
+        candidates.insert(candidates.end(), seeds_.begin(), seeds_.end());
+
+        bool refreshed = false;
+        for (const auto& candidate : candidates) {
+            if (stopping_) {
+                break;
+            }
+            RespReply reply;
+            try {
+                RespClient client;
+                client.setTimeout(options_.ioTimeout);
+                client.connect(candidate.host, candidate.port);
+                reply = client.command({"CLUSTER", "SLOTS"});
+            } catch (const std::exception&) {
+                continue;
+            }
+            if (reply.type != RespReply::Type::Array) {
+                continue;
+            }
+            installSlots(reply, candidate);
+            ++refreshes_;
+            refreshed = true;
+            break;
+        }
+        refreshing_ = false;
+        return refreshed;
+    }
+
+    void installSlots(const RespReply& reply, const redis_cluster::Endpoint& source) {
+        std::lock_guard lock{topologyMutex_};
+        slots_.fill(nullptr);
+        for (const auto& range : reply.elements) {
+            // [起始槽, 结束槽, [主节点 host, port, id], 副本...]
+            if (range.elements.size() < 3 || range.elements[2].elements.size() < 2) {
+                continue;
+            }
+            const auto& master = range.elements[2];
+            redis_cluster::Endpoint endpoint{
+                master.elements[0].str.empty() ? source.host : master.elements[0].str,
+                static_cast<uint16_t>(master.elements[1].integer),
+            };
+            Node* node = nodeFor(endpoint);
+            const auto first = static_cast<size_t>(range.elements[0].integer);
+            const auto last = static_cast<size_t>(range.elements[1].integer);
+            for (size_t slot = first; slot <= last && slot < redis_cluster::slotCount; ++slot) {
+                slots_[slot] = node;
+            }
+        }
+    }
+
+    // 每个节点的写入线程
+    void run(Node& node) {
+        RespClient client;
+        client.setTimeout(options_.ioTimeout);
+        std::vector<Sample> batch;
+        std::vector<Sample> asking;
+        for (;;) {
+            {
+                std::unique_lock lock{node.mutex};
+                node.busy = false;
+                node.wakeup.wait(lock, [&] {
+                    return stopping_ || !node.pending.empty() || !node.asking.empty();
+                });
+                if (stopping_) {
+                    return;
+                }
+                // 超过 maxBatch 的部分留到下一轮，位置表随之重建
+                batch.clear();
+                if (node.pending.size() <= options_.maxBatch) {
+                    batch.swap(node.pending);
+                    node.position.clear();
+                } else {
+                    batch.assign(node.pending.begin(), node.pending.begin() + options_.maxBatch);
+                    node.pending.erase(node.pending.begin(), node.pending.begin() + options_.maxBatch);
+                    node.position.clear();
+                    for (size_t i = 0; i < node.pending.size(); ++i) {
+                        node.position.emplace(node.pending[i].tag, i);
+                    }
+                }
+                asking.clear();
+                asking.swap(node.asking);
+                node.busy = true;
+            }
+
+            try {
+                if (!client.connected()) {
+                    client.connect(node.endpoint.host, node.endpoint.port);
+                }
+                send(node, client, batch, asking);
+            } catch (const std::exception&) {
+                // 节点不可达：等待后刷新映射（可能已发生故障转移），按新映射重新分发
+                client.close();
+                ++reconnects_;
+                {
+                    std::unique_lock lock{node.mutex};
+                    node.wakeup.wait_for(lock, options_.retryDelay, [&] { return stopping_.load(); });
+                }
+                refreshSlots();
+                batch.insert(batch.end(), asking.begin(), asking.end());
+                route(batch);
+            }
+        }
+    }
+
+    void send(Node& node, RespClient& client, const std::vector<Sample>& batch, const std::vector<Sample>& asking) {
+        for (const auto& sample : batch) {
+            appendHset(client, sample);
+        }
+        for (const auto& sample : asking) {
+            client.append({"ASKING"});
+            appendHset(client, sample);
+        }
+        client.flush();
+
+        std::vector<Sample> moved;
+        std::vector<Sample> retry;
+        std::vector<std::pair<redis_cluster::Endpoint, Sample>> ask;
+        const auto handle = [&](const RespReply& reply, const Sample& sample) {
+            if (!reply.isError()) {
+                ++node.commands;
+                ++commands_;
+                return;
+            }
+            redis_cluster::Redirect redirect;
+            if (redis_cluster::parseRedirect(reply.str, redirect)) {
+                if (redirect.ask) {
+                    ++ask_;
+                    ask.emplace_back(redirect.target, sample);
+                } else {
+                    ++moved_;
+                    std::lock_guard lock{topologyMutex_};
+                    slots_[redirect.slot] = nodeFor(redirect.target);
+                    moved.push_back(sample);
+                }
+            } else if (redis_cluster::retryableError(reply.str)) {
+                ++retries_;
+                retry.push_back(sample);
+            } else {
+                ++errors_;
+            }
+        };
+        for (const auto& sample : batch) {
+            handle(client.readReply(), sample);
+        }
+        for (const auto& sample : asking) {
+            client.readReply();  // ASKING 的 +OK
+            handle(client.readReply(), sample);
+        }
+
+        if (!moved.empty()) {
+            // 一个 MOVED 通常意味着一批槽已迁移，刷新整个映射
+            refreshSlots();
+            route(moved);
+        }
+        for (const auto& [endpoint, sample] : ask) {
+            Node* target = nullptr;
+            {
+                std::lock_guard lock{topologyMutex_};
+                target = nodeFor(endpoint);
+            }
+            if (target != nullptr) {
+                enqueue(*target, {sample}, true);
+            }
+        }
+        if (!retry.empty()) {
+            std::this_thread::sleep_for(options_.retryDelay);
+            route(retry);
+        }
+    }
+
+    void appendHset(RespClient& client, const Sample& sample) const {
+        char value[32];
+        char sourceTime[24];
+        char serverTime[24];
+        char status[12];
+        std::snprintf(value, sizeof(value), "%.17g", sample.value);
+        std::snprintf(sourceTime, sizeof(sourceTime), "%lld", static_cast<long long>(sample.sourceTime));
+        std::snprintf(serverTime, sizeof(serverTime), "%lld", static_cast<long long>(sample.serverTime));
+        std::snprintf(status, sizeof(status), "%u", static_cast<unsigned>(sample.status));
+        const std::string_view args[] = {
+            "HSET", keys_[sample.tag], "v", value, "st", sourceTime, "ts", serverTime, "q", status
+        };
+        client.append(args, std::size(args));
+    }
+
+    void stop() {
+        {
+            // 与 nodeFor() 在同一把锁下：此后 nodes_ 不再增加，下面取到的列表包含全部写入线程
+            std::lock_guard lock{topologyMutex_};
+            stopping_ = true;
+        }
+        for (Node* node : nodes()) {
+            {
+                std::lock_guard lock{node->mutex};
+            }
+            node->wakeup.notify_all();
+        }
+        for (Node* node : nodes()) {
+            if (node->worker.joinable()) {
+                node->worker.join();
+            }
+        }
+    }
+
+    std::vector<redis_cluster::Endpoint> seeds_;
+    RedisClusterOptions options_;
+
+    // 键名和槽只在 addTag() 中写入
+    std::vector<std::string> keys_;
+    std::vector<uint16_t> keySlots_;
+
+    mutable std::mutex topologyMutex_;
+    std::array<Node*, redis_cluster::slotCount> slots_{};
+    std::deque<std::unique_ptr<Node>> nodes_;
+    std::unordered_map<std::string, Node*> nodeByName_;
+    std::atomic<bool> refreshing_{false};
+
+    std::atomic<bool> stopping_{false};
+    std::atomic<uint64_t> commands_{0};
+    std::atomic<uint64_t> moved_{0};
+    std::atomic<uint64_t> ask_{0};
+    std::atomic<uint64_t> retries_{0};
+    std::atomic<uint64_t> reconnects_{0};
+    std::atomic<uint64_t> refreshes_{0};
+    std::atomic<uint64_t> unroutable_{0};
+    std::atomic<uint64_t> errors_{0};
+};
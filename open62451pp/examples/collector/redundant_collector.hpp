@@ -0,0 +1,172 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <open62541pp/client.hpp>
+
+#include "collector_types.hpp"
+#include "dispatch_subscription.hpp"
+#include "leader_lock.hpp"
+
+// 热备冗余参数
+struct RedundancyOptions {
+    double publishingInterval = 100.0;  // 发布间隔（毫秒）
+    double samplingInterval = 50.0;     // 采样间隔（毫秒）
+    uint32_t queueSize = 20;            // 监控项队列长度，应覆盖切换期间的采样数
+    size_t itemsPerSubscription = 1000;  // 每个订阅的监控项数
+};
+
+/**
+ * @brief 热备冗余采集器
+ *
+ * - 主节点和备用节点都保持会话，并预先创建完全相同的订阅和监控项
+ * - 备用节点的订阅处于禁用发布模式（setPublishingMode(false)），服务器照常采样并缓存在监控项队列中
+ * - 每个订阅一个处理函数（DispatchSubscription），不为每个监控项保存回调
+ * - 切换时只需启用发布，不需要重新浏览、解析和订阅
+ * - 启用发布后，服务器先发送队列中缓存的通知，覆盖主节点失效到切换完成之间的数据
+ *
+ * heartbeat() 和 client.runIterate() 在同一线程中调用。
+ */
+class RedundantCollector {
+public:
+    enum class Role { Standby, Leader };
+
+    RedundantCollector(
+        std::string name,
+        opcua::Client& client,
+        const TagTable& tags,
+        HistorySink& sink,
+        LeaderLock& lock,
+        RedundancyOptions options = {}
+    )
+        : name_{std::move(name)},
+          client_{client},
+          tags_{tags},
+          sink_{sink},
+          lock_{lock},
+          options_{options} {}
+
+    /**
+     * @brief 创建订阅和监控项（在 onSessionActivated 回调中调用）
+     *
+     * 备用节点创建的订阅处于禁用发布模式。
+     */
+    void createSubscriptions() {
+        subscriptions_.clear();
+        DispatchOptions dispatchOptions;
+        dispatchOptions.publishingInterval = options_.publishingInterval;
+        dispatchOptions.samplingInterval = options_.samplingInterval;
+        dispatchOptions.queueSize = options_.queueSize;
+        dispatchOptions.publishing = role_ == Role::Leader;
+        std::vector<TagHandle> handles;
+        for (TagHandle first = 0; first < tags_.size(); first += options_.itemsPerSubscription) {
+            const auto last = static_cast<TagHandle>(
+                std::min<size_t>(tags_.size(), first + options_.itemsPerSubscription)
+            );
+            handles.clear();
+            for (TagHandle tag = first; tag < last; ++tag) {
+                handles.push_back(tag);
+            }
+            DispatchSubscription sub{
+                client_,
+                tags_,
+                [this](TagHandle tag, const UA_DataValue& dv) { onDataChange(tag, dv); },
+                dispatchOptions
+            };
+            sub.addTags(handles);
+            subscriptions_.push_back(std::move(sub));
+        }
+    }
+
+    /**
+     * @brief 主节点续期 / 备用节点尝试接管（在主循环中定期调用）
+     */
+    void heartbeat() {
+        if (role_ == Role::Leader) {
+            if (!lock_.renew()) {
+                setRole(Role::Standby);
+            }
+        } else if (lock_.tryAcquire()) {
+            setRole(Role::Leader);
+        }
+    }
+
+    /// 正常退出：释放锁，备用节点无需等待租约过期
+    void resign() {
+        if (role_ == Role::Leader) {
+            setRole(Role::Standby);
+        }
+        lock_.release();
+    }
+
+    Role role() const noexcept {
+        return role_;
+    }
+
+    const std::string& name() const noexcept {
+        return name_;
+    }
+
+    /// 最近一次成为主节点的时间
+    std::chrono::steady_clock::time_point promotedAt() const noexcept {
+        return promotedAt_.load();
+    }
+
+    /// 成为主节点后收到的第一个采样的时间
+    std::chrono::steady_clock::time_point firstSampleAt() const noexcept {
+        return firstSampleAt_.load();
+    }
+
+    size_t samplesWritten() const noexcept {
+        return samplesWritten_;
+    }
+
+private:
+    void setRole(Role role) {
+        role_ = role;
+        const bool publishing = role == Role::Leader;
+        if (publishing) {
+            promotedAt_ = std::chrono::steady_clock::now();
+            firstSampleAt_ = {};
+        }
+        for (auto& sub : subscriptions_) {
+            sub.setPublishingMode(publishing);
+        }
+    }
+
+    void onDataChange(TagHandle tag, const UA_DataValue& dv) {
+        // 降级时可能仍有已发出的通知到达，只有主节点写入
+        if (role_ != Role::Leader) {
+            return;
+        }
+        Sample sample{};
+        if (!toSample(dv, tag, sample)) {
+            return;
+        }
+        if (firstSampleAt_.load() == std::chrono::steady_clock::time_point{}) {
+            firstSampleAt_ = std::chrono::steady_clock::now();
+        }
+        sink_.write({&sample, 1});
+        ++samplesWritten_;
+    }
+
+    std::string name_;
+    opcua::Client& client_;
+    const TagTable& tags_;
+    HistorySink& sink_;
+    LeaderLock& lock_;
+    RedundancyOptions options_;
+
+    // 角色和统计数据可能被其他线程读取
+    std::atomic<Role> role_ = Role::Standby;
+    std::vector<DispatchSubscription> subscriptions_;
+    std::atomic<std::chrono::steady_clock::time_point> promotedAt_{};
+    std::atomic<std::chrono::steady_clock::time_point> firstSampleAt_{};
+    std::atomic<size_t> samplesWritten_ = 0;
+};
@@ -0,0 +1,349 @@
+/**
+ * @file request_profile_benchmark.cpp
+ * @brief 请求配置测试 - 比较不同 RequestProfile 下 Browse、Read 和订阅通知的响应大小与解码耗时
+ *
+ * 本程序测试 request_profiles.hpp：
+ * 1. 启动内置的模拟工厂服务器，或连接外部服务器，爬取 Objects 下的对象和变量
+ * 2. Browse：按 full、crawl、browse-names 三种配置批量浏览所有对象
+ * 3. Read：按 full、collect、collect-source 三种配置批量读取所有变量的值
+ * 4. 订阅：按同样三种配置创建监控项，用 Publish 取回每个监控项的首个通知
+ * 5. 输出每种配置的响应字节数、解码耗时，以及相对 full 的比例
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <open62541/client.h>
+
+#include <open62541pp/client.hpp>
+#include <open62541pp/server.hpp>
+
+#include "../helper.hpp"          // CliParser - 命令行参数解析器
+#include "address_crawler.hpp"    // AddressSpaceCrawler
+#include "request_profiles.hpp"   // RequestProfile、measureResponse
+#include "simulated_plant.hpp"    // SimulatedPlant
+
+template <typename Request, typename Response>
+static void service(
+    opcua::Client& client,
+    const Request& request,
+    const UA_DataType& requestType,
+    Response& response,
+    const UA_DataType& responseType
+) {
+    __UA_Client_Service(client.handle(), &request, &requestType, &response, &responseType);
+}
+
+static PayloadStats browseAll(
+    opcua::Client& client,
+    const AddressSpaceSnapshot& snapshot,
+    const std::vector<NodeIndex>& objects,
+    const RequestProfile& profile,
+    int rounds
+) {
+    PayloadStats stats;
+    constexpr size_t batch = 500;
+    for (int round = 0; round < rounds; ++round) {
+        for (size_t offset = 0; offset < objects.size(); offset += batch) {
+            const size_t count = std::min(batch, objects.size() - offset);
+            std::vector<UA_BrowseDescription> descriptions(count);
+            for (size_t i = 0; i < count; ++i) {
+                auto& d = descriptions[i];
+                UA_BrowseDescription_init(&d);
+                d.nodeId = *snapshot.nodeId(objects[offset + i]).handle();  // 浅拷贝
+                d.browseDirection = UA_BROWSEDIRECTION_FORWARD;
+                d.referenceTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_HIERARCHICALREFERENCES);
+                d.includeSubtypes = true;
+            }
+            UA_BrowseRequest request;
+            UA_BrowseRequest_init(&request);
+            request.nodesToBrowse = descriptions.data();
+            request.nodesToBrowseSize = count;
+            apply(profile, request);
+            UA_BrowseResponse response = UA_Client_Service_browse(client.handle(), request);
+            measureResponse(&response, UA_TYPES[UA_TYPES_BROWSERESPONSE], stats);
+            UA_BrowseResponse_clear(&response);
+        }
+    }
+    return stats;
+}
+
+static PayloadStats readAll(
+    opcua::Client& client,
+    const AddressSpaceSnapshot& snapshot,
+    const std::vector<NodeIndex>& variables,
+    const RequestProfile& profile,
+    int rounds
+) {
+    PayloadStats stats;
+    constexpr size_t batch = 1000;
+    for (int round = 0; round < rounds; ++round) {
+        for (size_t offset = 0; offset < variables.size(); offset += batch) {
+            const size_t count = std::min(batch, variables.size() - offset);
+            std::vector<UA_ReadValueId> items(count);
+            for (size_t i = 0; i < count; ++i) {
+                UA_ReadValueId_init(&items[i]);
+                items[i].nodeId = *snapshot.nodeId(variables[offset + i]).handle();
+                items[i].attributeId = UA_ATTRIBUTEID_VALUE;
+            }
+            UA_ReadRequest request;
+            UA_ReadRequest_init(&request);
+            request.nodesToRead = items.data();
+            request.nodesToReadSize = count;
+            apply(profile, request);
+            UA_ReadResponse response = UA_Client_Service_read(client.handle(), request);
+            measureResponse(&response, UA_TYPES[UA_TYPES_READRESPONSE], stats);
+            UA_ReadResponse_clear(&response);
+        }
+    }
+    return stats;
+}
+
+// 创建一个订阅，按 profile 创建所有监控项，取回每个监控项的首个通知后删除订阅
+static PayloadStats subscribeAll(
+    opcua::Client& client,
+    const AddressSpaceSnapshot& snapshot,
+    const std::vector<NodeIndex>& variables,
+    const RequestProfile& profile
+) {
+    PayloadStats stats;
+
+    UA_CreateSubscriptionRequest createRequest;
+    UA_CreateSubscriptionRequest_init(&createRequest);
+    createRequest.requestedPublishingInterval = 100.0;
+    createRequest.requestedLifetimeCount = 600;
+    createRequest.requestedMaxKeepAliveCount = 10;
+    createRequest.publishingEnabled = true;
+    UA_CreateSubscriptionResponse createResponse;
+    service(
+        client,
+        createRequest,
+        UA_TYPES[UA_TYPES_CREATESUBSCRIPTIONREQUEST],
+        createResponse,
+        UA_TYPES[UA_TYPES_CREATESUBSCRIPTIONRESPONSE]
+    );
+    const UA_StatusCode status = createResponse.responseHeader.serviceResult;
+    const UA_UInt32 subscriptionId = createResponse.subscriptionId;
+    UA_CreateSubscriptionResponse_clear(&createResponse);
+    if (status != UA_STATUSCODE_GOOD) {
+        throw opcua::BadStatus{status};
+    }
+
+    size_t created = 0;
+    constexpr size_t batch = 1000;
+    for (size_t offset = 0; offset < variables.size(); offset += batch) {
+        const size_t count = std::min(batch, variables.size() - offset);
+        std::vector<UA_MonitoredItemCreateRequest> items(count);
+        for (size_t i = 0; i < count; ++i) {
+            auto& item = items[i];
+            UA_MonitoredItemCreateRequest_init(&item);
+            item.itemToMonitor.nodeId = *snapshot.nodeId(variables[offset + i]).handle();
+            item.itemToMonitor.attributeId = UA_ATTRIBUTEID_VALUE;
+            item.monitoringMode = UA_MONITORINGMODE_REPORTING;
+            item.requestedParameters.clientHandle = static_cast<UA_UInt32>(offset + i);
+            item.requestedParameters.samplingInterval = 100.0;
+            item.requestedParameters.queueSize = 1;
+            item.requestedParameters.discardOldest = true;
+        }
+        UA_CreateMonitoredItemsRequest request;
+        UA_CreateMonitoredItemsRequest_init(&request);
+        request.subscriptionId = subscriptionId;
+        request.itemsToCreate = items.data();
+        request.itemsToCreateSize = count;
+        apply(profile, request);
+        UA_CreateMonitoredItemsResponse response;
+        service(
+            client,
+            request,
+            UA_TYPES[UA_TYPES_CREATEMONITOREDITEMSREQUEST],
+            response,
+            UA_TYPES[UA_TYPES_CREATEMONITOREDITEMSRESPONSE]
+        );
+        for (size_t i = 0; i < response.resultsSize; ++i) {
+            created += response.results[i].statusCode == UA_STATUSCODE_GOOD ? 1 : 0;
+        }
+        UA_CreateMonitoredItemsResponse_clear(&response);
+    }
+
+    // 同步发送 Publish，确认上一条通知，直到所有监控项都报告过一次
+    size_t notified = 0;
+    UA_SubscriptionAcknowledgement ack{};
+    bool pendingAck = false;
+    for (int attempt = 0; attempt < 50 && notified < created; ++attempt) {
+        UA_PublishRequest request;
+        UA_PublishRequest_init(&request);
+        apply(profile, request.requestHeader);
+        if (pendingAck) {
+            request.subscriptionAcknowledgements = &ack;
+            request.subscriptionAcknowledgementsSize = 1;
+        }
+        UA_PublishResponse response;
+        service(client, request, UA_TYPES[UA_TYPES_PUBLISHREQUEST], response, UA_TYPES[UA_TYPES_PUBLISHRESPONSE]);
+        if (response.responseHeader.serviceResult == UA_STATUSCODE_GOOD) {
+            const auto& message = response.notificationMessage;
+            for (size_t i = 0; i < message.notificationDataSize; ++i) {
+                const auto& data = message.notificationData[i];
+                if (data.content.decoded.type == &UA_TYPES[UA_TYPES_DATACHANGENOTIFICATION]) {
+                    const auto* change = static_cast<const UA_DataChangeNotification*>(data.content.decoded.data);
+                    notified += change->monitoredItemsSize;
+                }
+            }
+            if (message.notificationDataSize > 0) {
+                measureResponse(&response, UA_TYPES[UA_TYPES_PUBLISHRESPONSE], stats);
+                ack.subscriptionId = response.subscriptionId;
+                ack.sequenceNumber = message.sequenceNumber;
+                pendingAck = true;
+            }
+        }
+        UA_PublishResponse_clear(&response);
+    }
+
+    UA_UInt32 ids[1] = {subscriptionId};
+    UA_DeleteSubscriptionsRequest deleteRequest;
+    UA_DeleteSubscriptionsRequest_init(&deleteRequest);
+    deleteRequest.subscriptionIds = ids;
+    deleteRequest.subscriptionIdsSize = 1;
+    UA_DeleteSubscriptionsResponse deleteResponse;
+    service(
+        client,
+        deleteRequest,
+        UA_TYPES[UA_TYPES_DELETESUBSCRIPTIONSREQUEST],
+        deleteResponse,
+        UA_TYPES[UA_TYPES_DELETESUBSCRIPTIONSRESPONSE]
+    );
+    UA_DeleteSubscriptionsResponse_clear(&deleteResponse);
+    return stats;
+}
+
+static void printRow(const RequestProfile& profile, const PayloadStats& stats, const PayloadStats& baseline) {
+    const double ratio =
+        baseline.bytes > 0 ? static_cast<double>(stats.bytes) / static_cast<double>(baseline.bytes) : 1.0;
+    const double decodeRatio = baseline.decodeSeconds > 0.0 ? stats.decodeSeconds / baseline.decodeSeconds : 1.0;
+    std::cout << "   " << std::left << std::setw(16) << profile.name << std::right << std::setw(6) << stats.responses
+              << " 个响应  " << std::setw(10) << stats.bytes << " 字节 (" << std::setw(5) << std::setprecision(1)
+              << ratio * 100.0 << "%)  解码 " << std::setw(8) << std::setprecision(2)
+              << stats.decodeSeconds * 1000.0 << " 毫秒 (" << std::setw(5) << std::setprecision(1)
+              << decodeRatio * 100.0 << "%)" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "=== 请求配置测试 ===" << std::endl;
+
+    // 解析命令行参数
+    // --url <地址>：外部服务器地址；不指定时启动内置的模拟工厂
+    // --channels / --devices / --tags：模拟工厂的规模，默认 4 × 25 × 50
+    // --rounds <次数>：Browse 和 Read 的重复次数，默认 5
+    const CliParser parser{argc, argv};
+    const auto externalUrl = parser.value("--url");
+    const int rounds = std::stoi(std::string{parser.value("--rounds").value_or("5")});
+
+    PlantOptions plantOptions;
+    plantOptions.channels = std::stoul(std::string{parser.value("--channels").value_or("4")});
+    plantOptions.devicesPerChannel = std::stoul(std::string{parser.value("--devices").value_or("25")});
+    plantOptions.tagsPerDevice = std::stoul(std::string{parser.value("--tags").value_or("50")});
+
+    std::cout << "1. 准备服务器..." << std::endl;
+
+    opcua::ServerConfig config{4840};
+    opcua::Server server{std::move(config)};
+    std::thread serverThread;
+    std::string url;
+    if (externalUrl) {
+        url = std::string{*externalUrl};
+        std::cout << "✓ 使用外部服务器 " << url << std::endl;
+    } else {
+        const SimulatedPlant plant{server, plantOptions};
+        serverThread = std::thread{[&] { server.run(); }};
+        url = "opc.tcp://localhost:4840";
+        std::cout << "✓ 模拟工厂已启动：" << plant.nodeCount() << " 个节点" << std::endl;
+    }
+
+    opcua::Client client;
+    client.connect(url);
+    AddressSpaceSnapshot snapshot;
+    AddressSpaceCrawler crawler{client};
+    crawler.crawl(opcua::NodeId{opcua::ObjectId::ObjectsFolder}, snapshot);
+    std::vector<NodeIndex> objects;
+    std::vector<NodeIndex> variables;
+    for (NodeIndex node = 0; node < snapshot.size(); ++node) {
+        if (snapshot.nodeClass(node) == opcua::NodeClass::Object) {
+            objects.push_back(node);
+        } else if (snapshot.nodeClass(node) == opcua::NodeClass::Variable) {
+            variables.push_back(node);
+        }
+    }
+    std::cout << "✓ " << objects.size() << " 个对象，" << variables.size() << " 个变量" << std::endl;
+
+    std::cout << std::fixed;
+
+    std::cout << "\n2. Browse（每个请求 500 个对象，重复 " << rounds << " 次）：" << std::endl;
+    {
+        const auto baseline = browseAll(client, snapshot, objects, request_profiles::full, rounds);
+        printRow(request_profiles::full, baseline, baseline);
+        for (const auto* profile : {&request_profiles::crawl, &request_profiles::browseNames}) {
+            printRow(*profile, browseAll(client, snapshot, objects, *profile, rounds), baseline);
+        }
+    }
+
+    std::cout << "\n3. Read（每个请求 1000 个变量，重复 " << rounds << " 次）：" << std::endl;
+    {
+        const auto baseline = readAll(client, snapshot, variables, request_profiles::full, rounds);
+        printRow(request_profiles::full, baseline, baseline);
+        for (const auto* profile : {&request_profiles::collect, &request_profiles::collectSource}) {
+            printRow(*profile, readAll(client, snapshot, variables, *profile, rounds), baseline);
+        }
+    }
+
+    std::cout << "\n4. 订阅（每个监控项的首个通知）：" << std::endl;
+    {
+        const auto baseline = subscribeAll(client, snapshot, variables, request_profiles::full);
+        printRow(request_profiles::full, baseline, baseline);
+        for (const auto* profile : {&request_profiles::collect, &request_profiles::collectSource}) {
+            printRow(*profile, subscribeAll(client, snapshot, variables, *profile), baseline);
+        }
+    }
+
+    client.disconnect();
+    if (serverThread.joinable()) {
+        server.stop();
+        serverThread.join();
+    }
+
+    std::cout << "\n=== 程序已退出 ===" << std::endl;
+    return 0;
+}
+
+/**
+ * 使用说明：
+ *
+ * 1. 内置模拟工厂：./request_profile_benchmark --channels 10 --devices 50 --tags 100
+ * 2. 外部服务器：./request_profile_benchmark --url opc.tcp://host:49320 --rounds 1
+ *
+ * 配置说明：
+ *
+ * 1. Browse：
+ *    - full 返回 ReferenceDescription 的全部字段，TypeDefinition 和带 locale 的 DisplayName 占了大部分
+ *    - crawl 只浏览对象和变量，不取 TypeDefinition；AddressSpaceCrawler 使用这个配置
+ *    - browse-names 只取 BrowseName，适合按名称查找子节点
+ *
+ * 2. Read 和订阅：
+ *    - full 和 collect 都返回两个时间戳；collect-source 只返回源时间戳，每个值少 8 字节
+ *    - 值本身很小（Double、Boolean）时，时间戳占 DataValue 的一半以上
+ *    - SubscriptionEngineOptions::timestampsToReturn 控制订阅引擎使用哪一种
+ *
+ * 3. maxAge 和诊断信息：
+ *    - maxAge 不改变响应大小，但服务器可以直接返回缓存值（cached-read 配置接受 5 秒内的值），
+ *      KEPServerEX 等网关可以不访问设备
+ *    - full 请求全部诊断信息；没有错误时服务器不返回诊断，出现大量 Bad 结果时差别才明显
+ *
+ * 注意事项：
+ *
+ * - 字节数是响应的二进制编码长度，不含安全通道的消息头、签名和加密填充
+ * - 解码耗时通过重新编码响应再解码一次测得，与客户端收到报文时的解码耗时相当
+ * - 写入目标需要服务器时间戳时（按服务器时间排序、检测时钟偏差），不要使用 collect-source
+ */
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include <open62541/client.h>
+#include <open62541/types.h>
+
+// 请求配置：按用途只请求需要的字段，减小批量请求的响应
+//
+// - Browse：nodeClassMask 过滤节点类，resultMask 决定每个 ReferenceDescription 带哪些字段
+//   （NodeId 总会返回；TypeDefinition 是一个完整的 ExpandedNodeId，DisplayName 带 locale）
+// - Read / CreateMonitoredItems：timestampsToReturn 决定每个 DataValue 带几个时间戳，
+//   每个时间戳 8 字节，一万个 tag 的采样就是 80 KB
+// - Read：maxAge 允许服务器直接返回缓存值，不必访问设备
+// - 请求头：returnDiagnostics 为 0 时服务器不返回诊断信息
+struct RequestProfile {
+    const char* name;
+    uint32_t nodeClassMask;            // Browse：0 表示所有节点类
+    uint32_t browseResultMask;         // Browse：UA_BROWSERESULTMASK_*
+    UA_TimestampsToReturn timestamps;  // Read、CreateMonitoredItems
+    double maxAge;                     // Read：可接受的缓存值时长（毫秒），0 表示读取当前值
+    uint32_t returnDiagnostics;        // 请求头：UA_DIAGNOSTICINFO 掩码，0 表示不返回
+};
+
+namespace request_profiles {
+
+/// 请求全部字段，用于对照
+inline constexpr RequestProfile full{
+    "full", 0, UA_BROWSERESULTMASK_ALL, UA_TIMESTAMPSTORETURN_BOTH, 0.0, 0x3ff
+};
+
+/// 只取子节点名称，例如按名称查找 tag
+inline constexpr RequestProfile browseNames{
+    "browse-names", 0, UA_BROWSERESULTMASK_BROWSENAME, UA_TIMESTAMPSTORETURN_NEITHER, 0.0, 0
+};
+
+/// 地址空间爬取：只浏览对象和变量，只取建立快照需要的字段
+inline constexpr RequestProfile crawl{
+    "crawl",
+    UA_NODECLASS_OBJECT | UA_NODECLASS_VARIABLE,
+    UA_BROWSERESULTMASK_REFERENCETYPEID | UA_BROWSERESULTMASK_BROWSENAME | UA_BROWSERESULTMASK_DISPLAYNAME |
+        UA_BROWSERESULTMASK_NODECLASS,
+    UA_TIMESTAMPSTORETURN_NEITHER,
+    0.0,
+    0
+};
+
+/// 读取 DataType、EngineeringUnits 等元数据：不需要时间戳，允许使用缓存
+inline constexpr RequestProfile metadata{
+    "metadata", 0, UA_BROWSERESULTMASK_NONE, UA_TIMESTAMPSTORETURN_NEITHER, 60000.0, 0
+};
+
+/// 采集：两个时间戳都写入历史库（与订阅引擎的默认行为相同）
+inline constexpr RequestProfile collect{
+    "collect", 0, UA_BROWSERESULTMASK_NONE, UA_TIMESTAMPSTORETURN_BOTH, 0.0, 0
+};
+
+/// 采集：写入目标只使用源时间戳
+inline constexpr RequestProfile collectSource{
+    "collect-source", 0, UA_BROWSERESULTMASK_NONE, UA_TIMESTAMPSTORETURN_SOURCE, 0.0, 0
+};
+
+/// 看板等轮询读取：接受 5 秒内的缓存值
+inline constexpr RequestProfile cachedRead{
+    "cached-read", 0, UA_BROWSERESULTMASK_NONE, UA_TIMESTAMPSTORETURN_SOURCE, 5000.0, 0
+};
+
+}  // namespace request_profiles
+
+inline void apply(const RequestProfile& profile, UA_RequestHeader& header) noexcept {
+    header.returnDiagnostics = profile.returnDiagnostics;
+}
+
+inline void apply(const RequestProfile& profile, UA_BrowseDescription& description) noexcept {
+    description.nodeClassMask = profile.nodeClassMask;
+    description.resultMask = profile.browseResultMask;
+}
+
+inline void apply(const RequestProfile& profile, UA_BrowseRequest& request) noexcept {
+    apply(profile, request.requestHeader);
+    for (size_t i = 0; i < request.nodesToBrowseSize; ++i) {
+        apply(profile, request.nodesToBrowse[i]);
+    }
+}
+
+inline void apply(const RequestProfile& profile, UA_ReadRequest& request) noexcept {
+    apply(profile, request.requestHeader);
+    request.timestampsToReturn = profile.timestamps;
+    request.maxAge = profile.maxAge;
+}
+
+inline void apply(const RequestProfile& profile, UA_CreateMonitoredItemsRequest& request) noexcept {
+    apply(profile, request.requestHeader);
+    request.timestampsToReturn = profile.timestamps;
+}
+
+struct PayloadStats {
+    size_t responses = 0;
+    size_t bytes = 0;             // 响应的二进制编码长度（不含安全通道的消息头）
+    double decodeSeconds = 0.0;
+
+    double bytesPerResponse() const noexcept {
+        return responses > 0 ? static_cast<double>(bytes) / static_cast<double>(responses) : 0.0;
+    }
+};
+
+/**
+ * @brief 统计一个已收到的响应的编码长度和解码耗时
+ *
+ * 客户端收到的原始报文已经解码并释放，这里把响应重新编码，再计时解码一次，
+ * 解码耗时与客户端收到这个响应时的解码耗时相当。
+ */
+inline void measureResponse(const void* response, const UA_DataType& type, PayloadStats& stats) {
+    ++stats.responses;
+    stats.bytes += UA_calcSizeBinary(response, &type);
+
+    UA_ByteString encoded = UA_BYTESTRING_NULL;
+    if (UA_encodeBinary(response, &type, &encoded) != UA_STATUSCODE_GOOD) {
+        return;
+    }
+    void* decoded = UA_new(&type);
+    const auto start = std::chrono::steady_clock::now();
+    const UA_StatusCode status = UA_decodeBinary(&encoded, decoded, &type, nullptr);
+    const auto stop = std::chrono::steady_clock::now();
+    if (status == UA_STATUSCODE_GOOD) {
+        stats.decodeSeconds += std::chrono::duration<double>(stop - start).count();
+    }
+    UA_delete(decoded, &type);
+    UA_ByteString_clear(&encoded);
+}
@@ -0,0 +1,250 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include <open62541/types.h>
+
+#include "collector_types.hpp"
+
+enum class ResampleMode : uint8_t {
+    Hold,    // 取网格时刻之前的最后一个采样
+    Linear,  // 在网格时刻前后两个采样之间线性插值
+};
+
+struct ResamplerOptions {
+    int64_t interval = UA_DATETIME_SEC;          // 网格间隔
+    int64_t delay = 2 * UA_DATETIME_SEC;         // 网格时刻之后等待迟到采样的时间，应不小于发布间隔
+    int64_t maxAge = 0;                          // 最后一个采样早于 tick - maxAge 时输出 NaN；0 不限制
+    size_t depth = 4;                            // 每列保留的最近采样数，应大于 delay 内每个 tag 的采样数
+    ResampleMode mode = ResampleMode::Hold;
+    int64_t maxSkew = 3600 * UA_DATETIME_SEC;    // 采样时间与本机时钟相差超过此值时丢弃；0 不限制
+    size_t maxCatchUp = 3600;                    // 一次 advance() 最多输出的行数，落后更多时跳过较早的网格时刻
+    int64_t idleTimeout = 10 * UA_DATETIME_SEC;  // 超过此时间没有采样时水位跟随本机时钟，应不小于保活间隔；0 不跟随
+};
+
+struct ResamplerStats {
+    uint64_t samples = 0;
+    uint64_t ignored = 0;       // 不属于任何列的采样
+    uint64_t late = 0;          // 时间早于已输出的网格时刻或早于该列最新采样
+    uint64_t rows = 0;
+    uint64_t approximated = 0;  // 网格时刻之前的采样已被覆盖（depth 不足），改用保留的最早采样
+    uint64_t skewed = 0;        // 时间与本机时钟相差超过 maxSkew 而丢弃的采样
+    uint64_t skippedTicks = 0;  // 落后超过 maxCatchUp 行而跳过的网格时刻
+    double rowSeconds = 0.0;    // 计算行的累计耗时
+};
+
+// 网格上的一行；values 按列顺序，无数据为 NaN，只在 writeRow() 调用期间有效
+struct GridRow {
+    int64_t time;
+    opcua::Span<const double> values;
+};
+
+// 网格行写入目标
+class GridSink {
+public:
+    virtual ~GridSink() = default;
+
+    virtual void writeRow(const GridRow& row) = 0;
+};
+
+/**
+ * @brief 把不规则到达的采样对齐到公共时间网格
+ *
+ * 作为 HistorySink 接在 SubscriptionEngine 或 DispatchSubscription 之后，
+ * 每个网格时刻（interval 的整数倍）输出一行，每列一个 tag。
+ *
+ * 每列保存最近 depth 个采样，时间和值分别存放在 times_/values_ 数组中（列 c 占 [c * depth, (c + 1) * depth)），
+ * 计算一行是对这两个数组的一次顺序扫描：每列从最新的采样向前找到 T 之前的一个，通常只看一两个位置，
+ * 10 万列时不涉及任何查找或分配。
+ *
+ * 网格时刻 T 在水位越过 T + delay 时输出，此时 T 之后的第一个采样通常已经到达，可以插值。
+ * 水位是已收到的最大采样时间与本机时钟中较小的一个，服务器时钟超前时不会提前输出。
+ * 值不变时数据变化订阅没有通知，超过 idleTimeout 没有采样到达后水位改为跟随本机时钟，网格继续前进。
+ * 一个 tag 在 T 之后到达 depth 个以上采样时，T 之前的采样已被覆盖，改用保留的最早采样并计入 approximated。
+ *
+ * 网格起点取第一次 advance() 时的水位。设备时钟错误（例如源时间戳停在 1970 年）的采样按 maxSkew 丢弃，
+ * 不会把起点拉到很久以前；长时间没有调用 advance() 后，一次最多补出 maxCatchUp 行，其余的计入 skippedTicks。
+ *
+ * 所有方法在同一线程中调用（与 client.runIterate() 相同）。
+ */
+class Resampler : public HistorySink {
+public:
+    explicit Resampler(const std::vector<TagHandle>& columns, ResamplerOptions options = {})
+        : options_{options},
+          columns_{columns},
+          times_(columns.size() * options.depth, noTime),
+          values_(columns.size() * options.depth, std::numeric_limits<double>::quiet_NaN()),
+          newest_(columns.size(), 0),
+          row_(columns.size()) {
+        if (options_.interval <= 0 || options_.depth == 0 || options_.maxCatchUp == 0) {
+            throw std::invalid_argument{"Resampler: interval, depth and maxCatchUp must be positive"};
+        }
+        if (options_.maxSkew < 0 || options_.idleTimeout < 0) {
+            throw std::invalid_argument{"Resampler: maxSkew and idleTimeout must not be negative"};
+        }
+        for (size_t c = 0; c < columns_.size(); ++c) {
+            if (columns_[c] >= columnOf_.size()) {
+                columnOf_.resize(static_cast<size_t>(columns_[c]) + 1, noColumn);
+            }
+            columnOf_[columns_[c]] = static_cast<uint32_t>(c);
+        }
+    }
+
+    void addSink(GridSink& sink) {
+        sinks_.push_back(&sink);
+    }
+
+    void write(opcua::Span<const Sample> samples) override {
+        const int64_t now = UA_DateTime_now();
+        for (const auto& sample : samples) {
+            ++stats_.samples;
+            if (sample.tag >= columnOf_.size() || columnOf_[sample.tag] == noColumn) {
+                ++stats_.ignored;
+                continue;
+            }
+            const int64_t time = sampleTime(sample);
+            if (options_.maxSkew > 0 && (time < now - options_.maxSkew || time > now + options_.maxSkew)) {
+                ++stats_.skewed;
+                continue;
+            }
+            // 状态为 Bad 的采样作为无数据保存，之后的网格时刻输出 NaN
+            const double value = UA_StatusCode_isBad(sample.status) ? std::numeric_limits<double>::quiet_NaN()
+                                                                     : sample.value;
+            apply(columnOf_[sample.tag], time, value);
+            maxTime_ = std::max(maxTime_, time);
+            lastArrival_ = now;
+        }
+        advance(now);
+    }
+
+    /**
+     * @brief 输出水位已越过的网格时刻
+     *
+     * write() 在每批采样之后调用；没有采样到达时需要周期性调用，否则网格停止前进。
+     * 最后一个采样到达已超过 idleTimeout 时，水位按 now - delay 计算。
+     * 待输出的网格时刻超过 maxCatchUp 个时只输出最近的 maxCatchUp 个。
+     * @return 输出的行数
+     */
+    size_t advance(int64_t now) {
+        if (maxTime_ == noTime) {
+            return 0;  // 还没有任何采样，网格起点未定
+        }
+        // 安静期间 maxTime_ 不再增长，按本机时钟推进；之后到达的采样早于已输出的网格时刻时计入 late
+        const bool idle = options_.idleTimeout > 0 && now - lastArrival_ > options_.idleTimeout;
+        const int64_t watermark = (idle ? now : std::min(maxTime_, now)) - options_.delay;
+        if (nextTick_ == noTime) {
+            nextTick_ = (watermark / options_.interval) * options_.interval;
+        }
+        if (nextTick_ > watermark) {
+            return 0;
+        }
+        const auto pending = static_cast<uint64_t>((watermark - nextTick_) / options_.interval) + 1;
+        if (pending > options_.maxCatchUp) {
+            const uint64_t skipped = pending - options_.maxCatchUp;
+            nextTick_ += static_cast<int64_t>(skipped) * options_.interval;
+            stats_.skippedTicks += skipped;
+        }
+        size_t emitted = 0;
+        while (nextTick_ <= watermark) {
+            emit(nextTick_);
+            nextTick_ += options_.interval;
+            ++emitted;
+        }
+        return emitted;
+    }
+
+    const std::vector<TagHandle>& columns() const noexcept {
+        return columns_;
+    }
+
+    /// 下一个要输出的网格时刻；尚未收到采样时为 INT64_MIN
+    int64_t nextTick() const noexcept {
+        return nextTick_;
+    }
+
+    const ResamplerOptions& options() const noexcept {
+        return options_;
+    }
+
+    const ResamplerStats& stats() const noexcept {
+        return stats_;
+    }
+
+private:
+    static constexpr int64_t noTime = std::numeric_limits<int64_t>::min();
+    static constexpr uint32_t noColumn = UINT32_MAX;
+
+    void apply(uint32_t c, int64_t time, double value) {
+        const size_t base = static_cast<size_t>(c) * options_.depth;
+        uint32_t slot = newest_[c];
+        if (time < times_[base + slot]) {
+            ++stats_.late;  // 同一列乱序到达的采样丢弃
+            return;
+        }
+        if (nextTick_ != noTime && time <= nextTick_ - options_.interval) {
+            ++stats_.late;  // 已输出的网格时刻不再修改，值仍用于之后的网格时刻
+        }
+        if (time > times_[base + slot]) {
+            slot = slot + 1 == options_.depth ? 0 : slot + 1;
+            newest_[c] = slot;
+            times_[base + slot] = time;
+        }
+        values_[base + slot] = value;
+    }
+
+    void emit(int64_t tick) {
+        const auto t0 = std::chrono::steady_clock::now();
+        const bool linear = options_.mode == ResampleMode::Linear;
+        const int64_t oldest = options_.maxAge > 0 ? tick - options_.maxAge : noTime;
+        const size_t depth = options_.depth;
+        const size_t n = columns_.size();
+        for (size_t c = 0; c < n; ++c) {
+            const int64_t* times = times_.data() + c * depth;
+            const double* values = values_.data() + c * depth;
+            // 从最新的采样向前找到 tick 之前的一个；after 是其后的一个
+            size_t slot = newest_[c];
+            size_t after = depth;
+            size_t seen = 0;
+            while (times[slot] > tick && ++seen < depth) {
+                after = slot;
+                slot = slot == 0 ? depth - 1 : slot - 1;
+            }
+            const int64_t at = times[slot];
+            double value = values[slot];
+            if (at > tick) {
+                ++stats_.approximated;
+            } else if (linear && after != depth && at != noTime) {
+                const double w = static_cast<double>(tick - at) / static_cast<double>(times[after] - at);
+                value += (values[after] - value) * w;
+            }
+            row_[c] = at == noTime || at < oldest ? std::numeric_limits<double>::quiet_NaN() : value;
+        }
+        stats_.rowSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        ++stats_.rows;
+        const GridRow row{tick, {row_.data(), row_.size()}};
+        for (auto* sink : sinks_) {
+            sink->writeRow(row);
+        }
+    }
+
+    ResamplerOptions options_;
+    std::vector<TagHandle> columns_;
+    std::vector<uint32_t> columnOf_;  // TagHandle -> 列
+
+    // 每列最近 depth 个采样的环形缓冲，newest_ 是最新采样的位置
+    std::vector<int64_t> times_;
+    std::vector<double> values_;
+    std::vector<uint32_t> newest_;
+    std::vector<double> row_;
+
+    int64_t maxTime_ = noTime;
+    int64_t lastArrival_ = noTime;  // 本机时钟
+    int64_t nextTick_ = noTime;
+    std::vector<GridSink*> sinks_;
+    ResamplerStats stats_;
+};
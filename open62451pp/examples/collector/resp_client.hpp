@@ -0,0 +1,295 @@
+#pragma once
+
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+// Redis 协议（RESP2）的最小客户端，兼容 Redis、KeyDB、Valkey 等服务器
+// - 同步阻塞 I/O，一个连接只在一个线程中使用；setTimeout() 设置连接和收发超时
+// - 支持流水线：append() 多个命令后 flush()，再依次 readReply()
+
+struct RespReply {
+    enum class Type { Status, Error, Integer, Bulk, Nil, Array };
+
+    Type type = Type::Nil;
+    std::string str;  // Status、Error、Bulk
+    int64_t integer = 0;
+    std::vector<RespReply> elements;
+
+    bool isError() const noexcept {
+        return type == Type::Error;
+    }
+
+    bool isNil() const noexcept {
+        return type == Type::Nil;
+    }
+};
+
+class RespClient {
+public:
+    RespClient() = default;
+
+    RespClient(const std::string& host, uint16_t port) {
+        connect(host, port);
+    }
+
+    ~RespClient() {
+        close();
+    }
+
+    RespClient(const RespClient&) = delete;
+    RespClient& operator=(const RespClient&) = delete;
+
+    RespClient(RespClient&& other) noexcept
+        : fd_{other.fd_},
+          timeout_{other.timeout_},
+          out_{std::move(other.out_)},
+          in_{std::move(other.in_)},
+          inPos_{other.inPos_} {
+        other.fd_ = -1;
+    }
+
+    void connect(const std::string& host, uint16_t port) {
+        close();
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* result = nullptr;
+        const std::string service = std::to_string(port);
+        if (const int rc = getaddrinfo(host.c_str(), service.c_str(), &hints, &result); rc != 0) {
+            throw std::runtime_error{std::string{"getaddrinfo: "} + gai_strerror(rc)};
+        }
+        for (addrinfo* ai = result; ai != nullptr; ai = ai->ai_next) {
+            fd_ = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+            if (fd_ < 0) {
+                continue;
+            }
+            if (connectSocket(fd_, ai->ai_addr, ai->ai_addrlen, timeout_)) {
+                break;
+            }
+            ::close(fd_);
+            fd_ = -1;
+        }
+        freeaddrinfo(result);
+        if (fd_ < 0) {
+            throw std::system_error{errno, std::generic_category(), "connect " + host + ":" + service};
+        }
+        const int one = 1;
+        ::setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        applyTimeout();
+    }
+
+    /// 设置连接和收发超时（0 表示不超时），超时后 connect()/flush()/readReply() 抛出 std::system_error
+    void setTimeout(std::chrono::milliseconds timeout) {
+        timeout_ = timeout;
+        applyTimeout();
+    }
+
+    void close() noexcept {
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+        out_.clear();
+        in_.clear();
+        inPos_ = 0;
+    }
+
+    bool connected() const noexcept {
+        return fd_ >= 0;
+    }
+
+    /// 把命令追加到发送缓冲区
+    void append(std::initializer_list<std::string_view> args) {
+        append(args.begin(), args.size());
+    }
+
+    void append(const std::string_view* args, size_t count) {
+        out_ += '*';
+        out_ += std::to_string(count);
+        out_ += "\r\n";
+        for (size_t i = 0; i < count; ++i) {
+            out_ += '$';
+            out_ += std::to_string(args[i].size());
+            out_ += "\r\n";
+            out_ += args[i];
+            out_ += "\r\n";
+        }
+    }
+
+    /// 发送缓冲区中的所有命令
+    void flush() {
+        size_t offset = 0;
+        while (offset < out_.size()) {
+            const ssize_t n = ::send(fd_, out_.data() + offset, out_.size() - offset, MSG_NOSIGNAL);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::system_error{errno, std::generic_category(), "send"};
+            }
+            offset += static_cast<size_t>(n);
+        }
+        out_.clear();
+    }
+
+    /// 读取一个应答
+    RespReply readReply() {
+        RespReply reply;
+        const std::string line = readLine();
+        if (line.empty()) {
+            throw std::runtime_error{"RESP: empty reply line"};
+        }
+        const std::string_view payload{line.data() + 1, line.size() - 1};
+        switch (line[0]) {
+        case '+':
+            reply.type = RespReply::Type::Status;
+            reply.str = payload;
+            break;
+        case '-':
+            reply.type = RespReply::Type::Error;
+            reply.str = payload;
+            break;
+        case ':':
+            reply.type = RespReply::Type::Integer;
+            reply.integer = std::strtoll(line.c_str() + 1, nullptr, 10);
+            break;
+        case '$': {
+            const long long length = std::strtoll(line.c_str() + 1, nullptr, 10);
+            if (length < 0) {
+                reply.type = RespReply::Type::Nil;
+                break;
+            }
+            reply.type = RespReply::Type::Bulk;
+            reply.str = readExact(static_cast<size_t>(length) + 2);
+            reply.str.resize(static_cast<size_t>(length));  // 去掉结尾的 \r\n
+            break;
+        }
+        case '*': {
+            const long long count = std::strtoll(line.c_str() + 1, nullptr, 10);
+            if (count < 0) {
+                reply.type = RespReply::Type::Nil;
+                break;
+            }
+            reply.type = RespReply::Type::Array;
+            reply.elements.reserve(static_cast<size_t>(count));
+            for (long long i = 0; i < count; ++i) {
+                reply.elements.push_back(readReply());
+            }
+            break;
+        }
+        default:
+            throw std::runtime_error{"RESP: unexpected reply type"};
+        }
+        return reply;
+    }
+
+    /// 发送一个命令并等待应答
+    RespReply command(std::initializer_list<std::string_view> args) {
+        append(args);
+        flush();
+        return readReply();
+    }
+
+private:
+    // 有超时时以非阻塞方式连接并用 poll() 等待，避免不可达的地址阻塞到内核的 SYN 重试结束
+    static bool connectSocket(int fd, const sockaddr* address, socklen_t length, std::chrono::milliseconds timeout) {
+        if (timeout.count() <= 0) {
+            return ::connect(fd, address, length) == 0;
+        }
+        const int flags = ::fcntl(fd, F_GETFL, 0);
+        ::fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+        int rc = ::connect(fd, address, length);
+        if (rc < 0 && errno == EINPROGRESS) {
+            pollfd entry{fd, POLLOUT, 0};
+            do {
+                rc = ::poll(&entry, 1, static_cast<int>(timeout.count()));
+            } while (rc < 0 && errno == EINTR);
+            if (rc == 0) {
+                errno = ETIMEDOUT;
+                rc = -1;
+            } else if (rc > 0) {
+                int error = 0;
+                socklen_t size = sizeof(error);
+                ::getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &size);
+                errno = error;
+                rc = error == 0 ? 0 : -1;
+            }
+        }
+        ::fcntl(fd, F_SETFL, flags);
+        return rc == 0;
+    }
+
+    void applyTimeout() noexcept {
+        if (fd_ < 0) {
+            return;
+        }
+        timeval tv{};
+        tv.tv_sec = static_cast<time_t>(timeout_.count() / 1000);
+        tv.tv_usec = static_cast<suseconds_t>((timeout_.count() % 1000) * 1000);
+        ::setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        ::setsockopt(fd_, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    }
+
+    void fill() {
+        if (inPos_ > 0 && inPos_ == in_.size()) {
+            in_.clear();
+            inPos_ = 0;
+        }
+        char buffer[16384];
+        ssize_t n = 0;
+        do {
+            n = ::recv(fd_, buffer, sizeof(buffer), 0);
+        } while (n < 0 && errno == EINTR);
+        if (n <= 0) {
+            throw std::system_error{
+                n == 0 ? ECONNRESET : errno, std::generic_category(), "recv"
+            };
+        }
+        in_.append(buffer, static_cast<size_t>(n));
+    }
+
+    std::string readLine() {
+        for (;;) {
+            const size_t end = in_.find("\r\n", inPos_);
+            if (end != std::string::npos) {
+                std::string line = in_.substr(inPos_, end - inPos_);
+                inPos_ = end + 2;
+                return line;
+            }
+            fill();
+        }
+    }
+
+    std::string readExact(size_t size) {
+        while (in_.size() - inPos_ < size) {
+            fill();
+        }
+        std::string data = in_.substr(inPos_, size);
+        inPos_ += size;
+        return data;
+    }
+
+    int fd_ = -1;
+    std::chrono::milliseconds timeout_{0};
+    std::string out_;
+    std::string in_;
+    size_t inPos_ = 0;
+};
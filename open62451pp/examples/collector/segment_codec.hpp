@@ -0,0 +1,340 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef COLLECTOR_ENABLE_LZ4
+#include <lz4.h>
+#endif
+#ifdef COLLECTOR_ENABLE_ZSTD
+#include <zdict.h>
+#include <zstd.h>
+#endif
+
+#include "collector_types.hpp"
+
+// 采样块的编码和压缩
+// - 块内采样按列排列：tag、源时间戳差值、服务器时间戳相对源时间戳的偏移、值、状态码
+//   相邻采样的时间戳差值大多相同，按列排列后重复字节集中，压缩率明显高于按行排列
+// - LZ4：速度优先；zstd：压缩率优先，可使用按 tag 分组训练的字典
+// - 编译时定义 COLLECTOR_ENABLE_LZ4 / COLLECTOR_ENABLE_ZSTD 启用对应的压缩库
+
+enum class Codec : uint8_t {
+    None = 0,
+    Lz4 = 1,
+    Zstd = 2,
+};
+
+inline const char* codecName(Codec codec) noexcept {
+    switch (codec) {
+    case Codec::None: return "none";
+    case Codec::Lz4: return "lz4";
+    case Codec::Zstd: return "zstd";
+    }
+    return "unknown";
+}
+
+inline bool codecAvailable(Codec codec) noexcept {
+    switch (codec) {
+    case Codec::None: return true;
+#ifdef COLLECTOR_ENABLE_LZ4
+    case Codec::Lz4: return true;
+#endif
+#ifdef COLLECTOR_ENABLE_ZSTD
+    case Codec::Zstd: return true;
+#endif
+    default: return false;
+    }
+}
+
+namespace segment_detail {
+
+template <typename T>
+void put(std::vector<uint8_t>& out, const T& value) {
+    const auto offset = out.size();
+    out.resize(offset + sizeof(T));
+    std::memcpy(out.data() + offset, &value, sizeof(T));
+}
+
+template <typename T>
+T get(const uint8_t*& in) {
+    T value;
+    std::memcpy(&value, in, sizeof(T));
+    in += sizeof(T);
+    return value;
+}
+
+}  // namespace segment_detail
+
+/// 按列编码一组采样，结果追加到 out
+inline void encodeColumns(opcua::Span<const Sample> samples, std::vector<uint8_t>& out) {
+    using segment_detail::put;
+    out.reserve(out.size() + samples.size() * sizeof(Sample));
+    for (const auto& s : samples) {
+        put(out, s.tag);
+    }
+    int64_t previous = 0;
+    for (const auto& s : samples) {
+        put(out, s.sourceTime - previous);
+        previous = s.sourceTime;
+    }
+    for (const auto& s : samples) {
+        put(out, s.serverTime - s.sourceTime);
+    }
+    for (const auto& s : samples) {
+        put(out, s.value);
+    }
+    for (const auto& s : samples) {
+        put(out, s.status);
+    }
+}
+
+/// encodeColumns 的逆过程，结果追加到 out
+inline void decodeColumns(const uint8_t* data, size_t count, std::vector<Sample>& out) {
+    using segment_detail::get;
+    const size_t first = out.size();
+    out.resize(first + count);
+    Sample* samples = out.data() + first;
+    for (size_t i = 0; i < count; ++i) {
+        samples[i].tag = get<TagHandle>(data);
+    }
+    int64_t previous = 0;
+    for (size_t i = 0; i < count; ++i) {
+        previous += get<int64_t>(data);
+        samples[i].sourceTime = previous;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        samples[i].serverTime = samples[i].sourceTime + get<int64_t>(data);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        samples[i].value = get<double>(data);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        samples[i].status = get<uint32_t>(data);
+    }
+}
+
+inline constexpr size_t encodedSize(size_t count) noexcept {
+    return count * (sizeof(TagHandle) + 2 * sizeof(int64_t) + sizeof(double) + sizeof(uint32_t));
+}
+
+/**
+ * @brief zstd 字典
+ *
+ * 同一组 tag 的采样块结构相似，用前几个块训练的字典压缩后续的小块，压缩率明显提高。
+ * 字典由 ZSTD 字典 ID 标识，记录在每个块的块头中。
+ */
+class ZstdDictionary {
+public:
+    ZstdDictionary(std::vector<uint8_t> bytes, [[maybe_unused]] int level)
+        : bytes_{std::move(bytes)} {
+#ifdef COLLECTOR_ENABLE_ZSTD
+        id_ = ZDICT_getDictID(bytes_.data(), bytes_.size());
+        cdict_ = ZSTD_createCDict(bytes_.data(), bytes_.size(), level);
+        ddict_ = ZSTD_createDDict(bytes_.data(), bytes_.size());
+#endif
+    }
+
+    ~ZstdDictionary() {
+#ifdef COLLECTOR_ENABLE_ZSTD
+        ZSTD_freeCDict(cdict_);
+        ZSTD_freeDDict(ddict_);
+#endif
+    }
+
+    ZstdDictionary(const ZstdDictionary&) = delete;
+    ZstdDictionary& operator=(const ZstdDictionary&) = delete;
+
+    /**
+     * @brief 用一组已编码的块训练字典
+     *
+     * 每个块被切分为 chunkSize 字节的训练样本。
+     * @return 训练失败（样本太少等）时返回 nullptr
+     */
+    static std::unique_ptr<ZstdDictionary> train(
+        [[maybe_unused]] const std::vector<std::vector<uint8_t>>& blocks,
+        [[maybe_unused]] size_t capacity,
+        [[maybe_unused]] int level,
+        [[maybe_unused]] size_t chunkSize = 4096
+    ) {
+#ifdef COLLECTOR_ENABLE_ZSTD
+        std::vector<uint8_t> samples;
+        std::vector<size_t> sizes;
+        for (const auto& block : blocks) {
+            for (size_t offset = 0; offset < block.size(); offset += chunkSize) {
+                const size_t size = std::min(chunkSize, block.size() - offset);
+                samples.insert(samples.end(), block.begin() + offset, block.begin() + offset + size);
+                sizes.push_back(size);
+            }
+        }
+        std::vector<uint8_t> dict(capacity);
+        const size_t size = ZDICT_trainFromBuffer(
+            dict.data(), dict.size(), samples.data(), sizes.data(), static_cast<unsigned>(sizes.size())
+        );
+        if (ZDICT_isError(size)) {
+            return nullptr;
+        }
+        dict.resize(size);
+        return std::make_unique<ZstdDictionary>(std::move(dict), level);
+#else
+        return nullptr;
+#endif
+    }
+
+    uint32_t id() const noexcept {
+        return id_;
+    }
+
+    const std::vector<uint8_t>& bytes() const noexcept {
+        return bytes_;
+    }
+
+#ifdef COLLECTOR_ENABLE_ZSTD
+    const ZSTD_CDict* cdict() const noexcept {
+        return cdict_;
+    }
+
+    const ZSTD_DDict* ddict() const noexcept {
+        return ddict_;
+    }
+#endif
+
+private:
+    std::vector<uint8_t> bytes_;
+    uint32_t id_ = 0;
+#ifdef COLLECTOR_ENABLE_ZSTD
+    ZSTD_CDict* cdict_ = nullptr;
+    ZSTD_DDict* ddict_ = nullptr;
+#endif
+};
+
+/**
+ * @brief 块压缩器
+ *
+ * 持有可复用的压缩上下文，每个线程使用各自的实例。
+ */
+class BlockCompressor {
+public:
+    BlockCompressor() {
+#ifdef COLLECTOR_ENABLE_ZSTD
+        cctx_ = ZSTD_createCCtx();
+        dctx_ = ZSTD_createDCtx();
+#endif
+    }
+
+    ~BlockCompressor() {
+#ifdef COLLECTOR_ENABLE_ZSTD
+        ZSTD_freeCCtx(cctx_);
+        ZSTD_freeDCtx(dctx_);
+#endif
+    }
+
+    BlockCompressor(const BlockCompressor&) = delete;
+    BlockCompressor& operator=(const BlockCompressor&) = delete;
+
+    /// 压缩 raw，结果写入 out（覆盖）
+    void compress(
+        Codec codec,
+        [[maybe_unused]] int level,
+        [[maybe_unused]] const ZstdDictionary* dict,
+        const std::vector<uint8_t>& raw,
+        std::vector<uint8_t>& out
+    ) {
+        switch (codec) {
+        case Codec::None:
+            out = raw;
+            return;
+#ifdef COLLECTOR_ENABLE_LZ4
+        case Codec::Lz4: {
+            out.resize(static_cast<size_t>(LZ4_compressBound(static_cast<int>(raw.size()))));
+            const int size = LZ4_compress_default(
+                reinterpret_cast<const char*>(raw.data()),
+                reinterpret_cast<char*>(out.data()),
+                static_cast<int>(raw.size()),
+                static_cast<int>(out.size())
+            );
+            if (size <= 0) {
+                throw std::runtime_error{"LZ4 compression failed"};
+            }
+            out.resize(static_cast<size_t>(size));
+            return;
+        }
+#endif
+#ifdef COLLECTOR_ENABLE_ZSTD
+        case Codec::Zstd: {
+            out.resize(ZSTD_compressBound(raw.size()));
+            const size_t size = dict != nullptr
+                ? ZSTD_compress_usingCDict(
+                      cctx_, out.data(), out.size(), raw.data(), raw.size(), dict->cdict()
+                  )
+                : ZSTD_compressCCtx(cctx_, out.data(), out.size(), raw.data(), raw.size(), level);
+            if (ZSTD_isError(size)) {
+                throw std::runtime_error{std::string{"zstd: "} + ZSTD_getErrorName(size)};
+            }
+            out.resize(size);
+            return;
+        }
+#endif
+        default:
+            throw std::runtime_error{std::string{"codec not available: "} + codecName(codec)};
+        }
+    }
+
+    /// 解压到 out（覆盖），rawSize 为压缩前的大小
+    void decompress(
+        Codec codec,
+        [[maybe_unused]] const ZstdDictionary* dict,
+        const uint8_t* data,
+        size_t size,
+        size_t rawSize,
+        std::vector<uint8_t>& out
+    ) {
+        out.resize(rawSize);
+        switch (codec) {
+        case Codec::None:
+            if (size != rawSize) {
+                throw std::runtime_error{"stored size does not match raw size"};
+            }
+            std::memcpy(out.data(), data, rawSize);
+            return;
+#ifdef COLLECTOR_ENABLE_LZ4
+        case Codec::Lz4: {
+            const int result = LZ4_decompress_safe(
+                reinterpret_cast<const char*>(data),
+                reinterpret_cast<char*>(out.data()),
+                static_cast<int>(size),
+                static_cast<int>(rawSize)
+            );
+            if (result != static_cast<int>(rawSize)) {
+                throw std::runtime_error{"LZ4 decompression failed"};
+            }
+            return;
+        }
+#endif
+#ifdef COLLECTOR_ENABLE_ZSTD
+        case Codec::Zstd: {
+            const size_t result = dict != nullptr
+                ? ZSTD_decompress_usingDDict(dctx_, out.data(), rawSize, data, size, dict->ddict())
+                : ZSTD_decompressDCtx(dctx_, out.data(), rawSize, data, size);
+            if (ZSTD_isError(result) || result != rawSize) {
+                throw std::runtime_error{"zstd decompression failed"};
+            }
+            return;
+        }
+#endif
+        default:
+            throw std::runtime_error{std::string{"codec not available: "} + codecName(codec)};
+        }
+    }
+
+private:
+#ifdef COLLECTOR_ENABLE_ZSTD
+    ZSTD_CCtx* cctx_ = nullptr;
+    ZSTD_DCtx* dctx_ = nullptr;
+#endif
+};
@@ -0,0 +1,409 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "collector_types.hpp"
+#include "segment_codec.hpp"
+
+// 分段压缩写入参数
+struct SpoolOptions {
+    Codec codec = Codec::None;
+    int level = 3;                        // zstd 压缩级别
+    bool dictionaries = false;            // 是否为每组 tag 训练 zstd 字典
+    size_t blockSamples = 4096;           // 每个块的采样数
+    size_t segmentBytes = 64 << 20;       // 单个段文件的大小上限
+    size_t trainBlocks = 8;               // 训练字典使用的块数
+    size_t dictionaryCapacity = 16 << 10;  // 字典大小上限
+    uint32_t tagsPerGroup = 256;          // 每组 tag 的数量（同组 tag 共用一个字典）
+};
+
+struct SpoolStats {
+    uint64_t samples = 0;
+    uint64_t blocks = 0;
+    uint64_t rawBytes = 0;      // 采样结构体的字节数（逻辑写入量）
+    uint64_t storedBytes = 0;   // 实际写入磁盘的字节数（段头、块头、数据和字典）
+    uint64_t dictionaries = 0;
+    uint64_t failedBlocks = 0;  // 压缩或写入失败而丢弃的块
+    uint64_t lostSamples = 0;   // 失败的块中的采样数
+    double compressSeconds = 0.0;
+
+    /// 写放大：实际写入磁盘的字节数 / 逻辑写入量
+    double writeAmplification() const noexcept {
+        return rawBytes > 0 ? static_cast<double>(storedBytes) / static_cast<double>(rawBytes) : 0.0;
+    }
+};
+
+namespace spool_detail {
+
+inline constexpr uint32_t segmentMagic = 0x31474553;  // "SEG1"
+inline constexpr uint32_t blockMagic = 0x314B4C42;    // "BLK1"
+
+struct SegmentHeader {
+    uint32_t magic;
+    uint8_t codec;  // 段内所有块使用同一种压缩方式
+    uint8_t reserved[3];
+    int32_t level;
+};
+
+struct BlockHeader {
+    uint32_t magic;
+    uint32_t group;
+    uint32_t dictId;  // 0 表示不使用字典
+    uint32_t count;
+    uint32_t rawSize;
+    uint32_t storedSize;
+};
+
+inline std::string segmentName(uint64_t index) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "spool-%08llu.seg", static_cast<unsigned long long>(index));
+    return name;
+}
+
+inline std::string dictionaryName(uint32_t id) {
+    return "dict-" + std::to_string(id) + ".zdict";
+}
+
+}  // namespace spool_detail
+
+/**
+ * @brief 分段压缩的采样写入目标
+ *
+ * - 采样按 tag 分组缓存，每组凑满一个块后交给后台线程
+ * - 后台线程按列编码、压缩并追加到当前段文件，采集线程不等待压缩和磁盘 I/O
+ * - 段文件头记录压缩方式，块头记录所属分组和字典 ID
+ * - 启用字典时，每组的前 trainBlocks 个块用于训练 zstd 字典，字典保存为单独的文件
+ * - replay() 按顺序读取所有段文件并解压
+ * - 后台线程中压缩或写入失败时丢弃该块，计入 stats() 的 failedBlocks，错误信息由 lastError() 返回
+ */
+class SegmentSpool : public HistorySink {
+public:
+    SegmentSpool(std::filesystem::path directory, SpoolOptions options)
+        : directory_{std::move(directory)},
+          options_{options} {
+        if (!codecAvailable(options_.codec)) {
+            throw std::runtime_error{std::string{"codec not available: "} + codecName(options_.codec)};
+        }
+        std::filesystem::create_directories(directory_);
+        // 新的段文件排在已有段文件之后
+        for (const auto& entry : std::filesystem::directory_iterator{directory_}) {
+            const auto stem = entry.path().stem().string();
+            if (entry.path().extension() == ".seg" && stem.rfind("spool-", 0) == 0) {
+                segmentIndex_ = std::max<uint64_t>(segmentIndex_, std::stoull(stem.substr(6)) + 1);
+            }
+        }
+        worker_ = std::thread{[this] { run(); }};
+    }
+
+    ~SegmentSpool() override {
+        flush();
+        {
+            std::lock_guard lock{mutex_};
+            stopping_ = true;
+        }
+        wakeup_.notify_all();
+        worker_.join();
+        closeSegment();
+    }
+
+    SegmentSpool(const SegmentSpool&) = delete;
+    SegmentSpool& operator=(const SegmentSpool&) = delete;
+
+    void write(opcua::Span<const Sample> samples) override {
+        std::lock_guard lock{mutex_};
+        for (const auto& sample : samples) {
+            const uint32_t group = sample.tag / options_.tagsPerGroup;
+            auto& buffer = buffers_[group];
+            buffer.push_back(sample);
+            if (buffer.size() >= options_.blockSamples) {
+                queue_.push_back({group, std::move(buffer)});
+                buffer = {};
+                wakeup_.notify_one();
+            }
+        }
+    }
+
+    /// 把所有未满的块交给后台线程，并等待全部写入磁盘
+    void flush() {
+        std::unique_lock lock{mutex_};
+        for (auto& [group, buffer] : buffers_) {
+            if (!buffer.empty()) {
+                queue_.push_back({group, std::move(buffer)});
+                buffer = {};
+            }
+        }
+        wakeup_.notify_one();
+        drained_.wait(lock, [&] { return queue_.empty() && !busy_; });
+    }
+
+    SpoolStats stats() const {
+        std::lock_guard lock{mutex_};
+        return stats_;
+    }
+
+    /// 后台线程最近一次失败的原因；没有失败时为空
+    std::string lastError() const {
+        std::lock_guard lock{mutex_};
+        return lastError_;
+    }
+
+    /**
+     * @brief 按顺序读取目录中的所有段文件
+     *
+     * @param callback 每个块解压后调用一次
+     * @return 读取的采样数
+     */
+    static uint64_t replay(
+        const std::filesystem::path& directory,
+        const std::function<void(opcua::Span<const Sample>)>& callback
+    ) {
+        using namespace spool_detail;
+        std::vector<std::filesystem::path> segments;
+        for (const auto& entry : std::filesystem::directory_iterator{directory}) {
+            if (entry.path().extension() == ".seg") {
+                segments.push_back(entry.path());
+            }
+        }
+        std::sort(segments.begin(), segments.end());
+
+        BlockCompressor compressor;
+        std::unordered_map<uint32_t, std::unique_ptr<ZstdDictionary>> dictionaries;
+        std::vector<uint8_t> stored;
+        std::vector<uint8_t> raw;
+        std::vector<Sample> samples;
+        uint64_t total = 0;
+        for (const auto& path : segments) {
+            std::FILE* file = std::fopen(path.c_str(), "rb");
+            if (file == nullptr) {
+                continue;
+            }
+            SegmentHeader segment{};
+            if (std::fread(&segment, sizeof(segment), 1, file) != 1 || segment.magic != segmentMagic) {
+                std::fclose(file);
+                continue;
+            }
+            const auto codec = static_cast<Codec>(segment.codec);
+            BlockHeader block{};
+            while (std::fread(&block, sizeof(block), 1, file) == 1 && block.magic == blockMagic) {
+                stored.resize(block.storedSize);
+                if (std::fread(stored.data(), 1, stored.size(), file) != stored.size()) {
+                    break;  // 最后一个块不完整（例如写入时断电）
+                }
+                if (block.rawSize != encodedSize(block.count)) {
+                    break;  // 块头损坏
+                }
+                const ZstdDictionary* dict = nullptr;
+                if (block.dictId != 0) {
+                    auto& loaded = dictionaries[block.dictId];
+                    if (!loaded) {
+                        loaded = loadDictionary(directory / dictionaryName(block.dictId), segment.level);
+                    }
+                    dict = loaded.get();
+                }
+                compressor.decompress(codec, dict, stored.data(), stored.size(), block.rawSize, raw);
+                samples.clear();
+                decodeColumns(raw.data(), block.count, samples);
+                callback(samples);
+                total += block.count;
+            }
+            std::fclose(file);
+        }
+        return total;
+    }
+
+private:
+    struct Block {
+        uint32_t group;
+        std::vector<Sample> samples;
+    };
+
+    struct GroupState {
+        std::vector<std::vector<uint8_t>> training;  // 训练字典用的已编码块
+        std::unique_ptr<ZstdDictionary> dictionary;
+        bool trained = false;
+    };
+
+    static std::unique_ptr<ZstdDictionary> loadDictionary(const std::filesystem::path& path, int level) {
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if (file == nullptr) {
+            throw std::runtime_error{"missing dictionary " + path.string()};
+        }
+        std::vector<uint8_t> bytes(std::filesystem::file_size(path));
+        const size_t n = std::fread(bytes.data(), 1, bytes.size(), file);
+        std::fclose(file);
+        bytes.resize(n);
+        return std::make_unique<ZstdDictionary>(std::move(bytes), level);
+    }
+
+    // 后台线程：编码、压缩、写入
+    void run() {
+        BlockCompressor compressor;
+        std::vector<uint8_t> raw;
+        std::vector<uint8_t> stored;
+        std::unique_lock lock{mutex_};
+        for (;;) {
+            wakeup_.wait(lock, [&] { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;  // stopping_
+            }
+            Block block = std::move(queue_.front());
+            queue_.pop_front();
+            busy_ = true;
+            lock.unlock();
+
+            const auto start = std::chrono::steady_clock::now();
+            std::chrono::duration<double> elapsed{0};
+            uint64_t written = 0;
+            std::string error;
+            try {
+                raw.clear();
+                encodeColumns(block.samples, raw);
+                const ZstdDictionary* dict = dictionaryFor(block.group, raw);
+                compressor.compress(options_.codec, options_.level, dict, raw, stored);
+                elapsed = std::chrono::steady_clock::now() - start;
+                written = append(block, dict, raw.size(), stored);
+            } catch (const std::exception& e) {
+                error = e.what();  // 异常不能离开线程函数，否则 std::terminate
+            }
+
+            lock.lock();
+            if (error.empty()) {
+                stats_.samples += block.samples.size();
+                stats_.blocks += 1;
+                stats_.rawBytes += block.samples.size() * sizeof(Sample);
+                stats_.storedBytes += written;
+                stats_.compressSeconds += elapsed.count();
+            } else {
+                stats_.failedBlocks += 1;
+                stats_.lostSamples += block.samples.size();
+                lastError_ = std::move(error);
+            }
+            stats_.dictionaries = dictionaryCount_;
+            busy_ = false;
+            if (queue_.empty()) {
+                drained_.notify_all();
+            }
+        }
+    }
+
+    // 返回该组当前可用的字典；训练完成前返回 nullptr
+    const ZstdDictionary* dictionaryFor(uint32_t group, const std::vector<uint8_t>& raw) {
+        if (options_.codec != Codec::Zstd || !options_.dictionaries) {
+            return nullptr;
+        }
+        auto& state = groups_[group];
+        if (state.trained) {
+            return state.dictionary.get();
+        }
+        state.training.push_back(raw);
+        if (state.training.size() < options_.trainBlocks) {
+            return nullptr;
+        }
+        state.dictionary = ZstdDictionary::train(
+            state.training, options_.dictionaryCapacity, options_.level
+        );
+        state.training.clear();
+        state.trained = true;
+        if (state.dictionary) {
+            saveDictionary(*state.dictionary);
+        }
+        return state.dictionary.get();
+    }
+
+    void saveDictionary(const ZstdDictionary& dict) {
+        const auto path = directory_ / spool_detail::dictionaryName(dict.id());
+        if (std::FILE* file = std::fopen(path.c_str(), "wb")) {
+            std::fwrite(dict.bytes().data(), 1, dict.bytes().size(), file);
+            std::fclose(file);
+            dictionaryBytes_ += dict.bytes().size();
+            ++dictionaryCount_;
+        }
+    }
+
+    uint64_t append(
+        const Block& block, const ZstdDictionary* dict, size_t rawSize, const std::vector<uint8_t>& stored
+    ) {
+        using namespace spool_detail;
+        uint64_t written = dictionaryBytes_;
+        dictionaryBytes_ = 0;
+        if (segment_ == nullptr || segmentSize_ >= options_.segmentBytes) {
+            closeSegment();
+            const auto path = directory_ / segmentName(segmentIndex_++);
+            segment_ = std::fopen(path.c_str(), "wb");
+            if (segment_ == nullptr) {
+                throw std::runtime_error{"cannot open " + path.string()};
+            }
+            const SegmentHeader header{
+                segmentMagic, static_cast<uint8_t>(options_.codec), {}, options_.level
+            };
+            if (std::fwrite(&header, sizeof(header), 1, segment_) != 1) {
+                closeSegment();
+                throw std::runtime_error{"cannot write " + path.string()};
+            }
+            segmentSize_ = sizeof(header);
+            written += sizeof(header);
+        }
+        const BlockHeader header{
+            blockMagic,
+            block.group,
+            dict != nullptr ? dict->id() : 0,
+            static_cast<uint32_t>(block.samples.size()),
+            static_cast<uint32_t>(rawSize),
+            static_cast<uint32_t>(stored.size()),
+        };
+        const bool ok = std::fwrite(&header, sizeof(header), 1, segment_) == 1 &&
+            std::fwrite(stored.data(), 1, stored.size(), segment_) == stored.size() && std::fflush(segment_) == 0;
+        if (!ok) {
+            // 段尾可能留下不完整的块，replay() 读到这里为止；之后的块写入新的段文件
+            closeSegment();
+            throw std::runtime_error{"cannot write " + segmentName(segmentIndex_ - 1)};
+        }
+        segmentSize_ += sizeof(header) + stored.size();
+        written += sizeof(header) + stored.size();
+        return written;
+    }
+
+    void closeSegment() {
+        if (segment_ != nullptr) {
+            std::fclose(segment_);
+            segment_ = nullptr;
+        }
+    }
+
+    std::filesystem::path directory_;
+    SpoolOptions options_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wakeup_;
+    std::condition_variable drained_;
+    std::map<uint32_t, std::vector<Sample>> buffers_;  // 按分组缓存的未满块
+    std::deque<Block> queue_;
+    bool busy_ = false;
+    bool stopping_ = false;
+    SpoolStats stats_;
+    std::string lastError_;
+
+    // 以下成员只由后台线程访问
+    std::thread worker_;
+    std::unordered_map<uint32_t, GroupState> groups_;
+    std::FILE* segment_ = nullptr;
+    uint64_t segmentIndex_ = 0;
+    size_t segmentSize_ = 0;
+    uint64_t dictionaryBytes_ = 0;  // 尚未计入统计的字典字节数
+    uint64_t dictionaryCount_ = 0;
+};
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "resampler.hpp"
+
+// 共享内存中网格矩阵的头部；之后依次是 rows 个 int64_t 时间和 rows × columns 个 double
+struct SharedGridHeader {
+    static constexpr uint32_t magicValue = 0x44495247;  // "GRID"
+
+    uint32_t magic;
+    uint32_t version;
+    uint64_t columns;
+    uint64_t rows;                  // 环形缓冲的行数
+    int64_t interval;               // 网格间隔（100ns）
+    std::atomic<uint64_t> written;  // 已写入的行数；第 n 行位于 n % rows
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "SharedGridHeader: written must be lock-free");
+
+/**
+ * @brief 把网格行写入 POSIX 共享内存中的环形矩阵
+ *
+ * 分析进程用 shm_open(name) + mmap 只读映射同一块内存，按行号直接访问，不经过任何序列化：
+ * - 读取者先读 written（acquire），行 written - 1 是最新的完整行
+ * - 复制一行，acquire 栅栏，再读一次 written；若 written >= 行号 + rows，写入者在复制期间
+ *   可能已开始覆盖该行（写入第 行号 + rows 行时 written 恰好等于 行号 + rows），应丢弃
+ * - readRow() 是这一协议的实现，读取者可以直接使用
+ *
+ * 列的顺序与 Resampler 的 columns() 相同，列与 tag 的对应关系由调用方另行发布。
+ * 对象析构时解除映射；共享内存对象保留，调用 unlink() 删除。
+ */
+class SharedGridMatrix : public GridSink {
+public:
+    SharedGridMatrix(std::string name, size_t columns, size_t rows, int64_t interval)
+        : name_{std::move(name)},
+          columns_{columns},
+          rows_{rows},
+          size_{sizeof(SharedGridHeader) + rows * sizeof(int64_t) + rows * columns * sizeof(double)} {
+        if (rows_ == 0) {
+            throw std::invalid_argument{"SharedGridMatrix: rows must be positive"};
+        }
+        const int fd = ::shm_open(name_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            throw std::system_error{errno, std::generic_category(), "shm_open " + name_};
+        }
+        if (::ftruncate(fd, static_cast<off_t>(size_)) != 0) {
+            const int error = errno;
+            ::close(fd);
+            throw std::system_error{error, std::generic_category(), "ftruncate " + name_};
+        }
+        void* base = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        const int error = errno;
+        ::close(fd);  // 映射保留到 munmap
+        if (base == MAP_FAILED) {
+            throw std::system_error{error, std::generic_category(), "mmap " + name_};
+        }
+        base_ = static_cast<uint8_t*>(base);
+        header_ = new (base_) SharedGridHeader{SharedGridHeader::magicValue, 1, columns_, rows_, interval, {0}};
+        times_ = reinterpret_cast<int64_t*>(base_ + sizeof(SharedGridHeader));
+        values_ = reinterpret_cast<double*>(times_ + rows_);
+    }
+
+    ~SharedGridMatrix() override {
+        ::munmap(base_, size_);
+    }
+
+    SharedGridMatrix(const SharedGridMatrix&) = delete;
+    SharedGridMatrix& operator=(const SharedGridMatrix&) = delete;
+
+    void writeRow(const GridRow& row) override {
+        const uint64_t n = header_->written.load(std::memory_order_relaxed);
+        // 与 readRow() 中的 acquire 栅栏配对：读取者复制到本次写入的数据时，必然看到 written >= n
+        std::atomic_thread_fence(std::memory_order_release);
+        const size_t slot = n % rows_;
+        times_[slot] = row.time;
+        const size_t count = std::min(columns_, row.values.size());
+        std::memcpy(values_ + slot * columns_, row.values.data(), count * sizeof(double));
+        header_->written.store(n + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief 读取者一侧：从映射的共享内存中复制第 row 行
+     *
+     * @param base   mmap 返回的地址（SharedGridHeader 所在位置）
+     * @param values 至少 columns 个 double
+     * @return 该行已写入且复制期间没有被覆盖时返回 true
+     */
+    static bool readRow(const void* base, uint64_t row, int64_t& time, double* values) {
+        const auto* header = static_cast<const SharedGridHeader*>(base);
+        const uint64_t rows = header->rows;
+        const uint64_t columns = header->columns;
+        const uint64_t before = header->written.load(std::memory_order_acquire);
+        if (row >= before || before >= row + rows) {
+            return false;  // 尚未写入，或已被覆盖
+        }
+        const auto* bytes = static_cast<const uint8_t*>(base);
+        const auto* times = reinterpret_cast<const int64_t*>(bytes + sizeof(SharedGridHeader));
+        const auto* data = reinterpret_cast<const double*>(times + rows);
+        const size_t slot = row % rows;
+        time = times[slot];
+        std::memcpy(values, data + slot * columns, columns * sizeof(double));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return header->written.load(std::memory_order_relaxed) < row + rows;
+    }
+
+    /// 删除共享内存对象；已映射的读取者不受影响
+    void unlink() {
+        ::shm_unlink(name_.c_str());
+    }
+
+    uint64_t written() const noexcept {
+        return header_->written.load(std::memory_order_relaxed);
+    }
+
+    size_t bytes() const noexcept {
+        return size_;
+    }
+
+private:
+    std::string name_;
+    size_t columns_;
+    size_t rows_;
+    size_t size_;
+    uint8_t* base_ = nullptr;
+    SharedGridHeader* header_ = nullptr;
+    int64_t* times_ = nullptr;
+    double* values_ = nullptr;
+};
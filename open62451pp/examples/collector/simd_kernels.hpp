@@ -0,0 +1,174 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// 数值数组的向量化计算
+// - 编译时按 __AVX2__ / __SSE2__ 选择实现（-mavx2 或 -march=native 启用 AVX2）
+// - 每个函数都有标量实现，结果与向量实现只在浮点求和顺序上有差别
+namespace simd {
+
+struct MinMaxSum {
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+    double sum = 0.0;
+};
+
+inline const char* instructionSet() noexcept {
+#if defined(__AVX2__)
+    return "AVX2";
+#elif defined(__SSE2__)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
+
+/// v[0..n) 的最小值、最大值和总和，累加到 result
+inline void minMaxSum(const double* v, size_t n, MinMaxSum& result) noexcept {
+    size_t i = 0;
+#if defined(__AVX2__)
+    if (n >= 8) {
+        // 两组累加器交错，隐藏加法延迟
+        __m256d min0 = _mm256_set1_pd(result.min);
+        __m256d max0 = _mm256_set1_pd(result.max);
+        __m256d min1 = min0;
+        __m256d max1 = max0;
+        __m256d sum0 = _mm256_setzero_pd();
+        __m256d sum1 = _mm256_setzero_pd();
+        for (; i + 8 <= n; i += 8) {
+            const __m256d a = _mm256_loadu_pd(v + i);
+            const __m256d b = _mm256_loadu_pd(v + i + 4);
+            min0 = _mm256_min_pd(min0, a);
+            max0 = _mm256_max_pd(max0, a);
+            sum0 = _mm256_add_pd(sum0, a);
+            min1 = _mm256_min_pd(min1, b);
+            max1 = _mm256_max_pd(max1, b);
+            sum1 = _mm256_add_pd(sum1, b);
+        }
+        alignas(32) double lanes[3][4];
+        _mm256_store_pd(lanes[0], _mm256_min_pd(min0, min1));
+        _mm256_store_pd(lanes[1], _mm256_max_pd(max0, max1));
+        _mm256_store_pd(lanes[2], _mm256_add_pd(sum0, sum1));
+        for (int k = 0; k < 4; ++k) {
+            result.min = std::min(result.min, lanes[0][k]);
+            result.max = std::max(result.max, lanes[1][k]);
+            result.sum += lanes[2][k];
+        }
+    }
+#elif defined(__SSE2__)
+    if (n >= 4) {
+        __m128d min0 = _mm_set1_pd(result.min);
+        __m128d max0 = _mm_set1_pd(result.max);
+        __m128d min1 = min0;
+        __m128d max1 = max0;
+        __m128d sum0 = _mm_setzero_pd();
+        __m128d sum1 = _mm_setzero_pd();
+        for (; i + 4 <= n; i += 4) {
+            const __m128d a = _mm_loadu_pd(v + i);
+            const __m128d b = _mm_loadu_pd(v + i + 2);
+            min0 = _mm_min_pd(min0, a);
+            max0 = _mm_max_pd(max0, a);
+            sum0 = _mm_add_pd(sum0, a);
+            min1 = _mm_min_pd(min1, b);
+            max1 = _mm_max_pd(max1, b);
+            sum1 = _mm_add_pd(sum1, b);
+        }
+        alignas(16) double lanes[3][2];
+        _mm_store_pd(lanes[0], _mm_min_pd(min0, min1));
+        _mm_store_pd(lanes[1], _mm_max_pd(max0, max1));
+        _mm_store_pd(lanes[2], _mm_add_pd(sum0, sum1));
+        for (int k = 0; k < 2; ++k) {
+            result.min = std::min(result.min, lanes[0][k]);
+            result.max = std::max(result.max, lanes[1][k]);
+            result.sum += lanes[2][k];
+        }
+    }
+#endif
+    for (; i < n; ++i) {
+        result.min = std::min(result.min, v[i]);
+        result.max = std::max(result.max, v[i]);
+        result.sum += v[i];
+    }
+}
+
+/// 点积 Σ a[i] * b[i]（时间加权积分：值 × 持续时间）
+inline double dot(const double* a, const double* b, size_t n) noexcept {
+    size_t i = 0;
+    double result = 0.0;
+#if defined(__AVX2__)
+    if (n >= 8) {
+        __m256d acc0 = _mm256_setzero_pd();
+        __m256d acc1 = _mm256_setzero_pd();
+        for (; i + 8 <= n; i += 8) {
+#if defined(__FMA__)
+            acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), acc0);
+            acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4), acc1);
+#else
+            acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+            acc1 = _mm256_add_pd(
+                acc1, _mm256_mul_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4))
+            );
+#endif
+        }
+        alignas(32) double lanes[4];
+        _mm256_store_pd(lanes, _mm256_add_pd(acc0, acc1));
+        result = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    }
+#elif defined(__SSE2__)
+    if (n >= 4) {
+        __m128d acc0 = _mm_setzero_pd();
+        __m128d acc1 = _mm_setzero_pd();
+        for (; i + 4 <= n; i += 4) {
+            acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+            acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+        }
+        alignas(16) double lanes[2];
+        _mm_store_pd(lanes, _mm_add_pd(acc0, acc1));
+        result = lanes[0] + lanes[1];
+    }
+#endif
+    for (; i < n; ++i) {
+        result += a[i] * b[i];
+    }
+    return result;
+}
+
+/// 四个带回差的限值比较，返回位掩码：第 k 位 = 值越过 on[k]，或 active 第 k 位已置位且仍越过 off[k]
+/// 第 0、1 个为上限（value >= 限值），第 2、3 个为下限（value <= 限值）；限值为 NaN 时不置位
+inline unsigned limitMask(double value, const double* on, const double* off, unsigned active) noexcept {
+#if defined(__AVX2__)
+    const __m256d v = _mm256_set1_pd(value);
+    const __m256d onLimits = _mm256_loadu_pd(on);
+    const __m256d offLimits = _mm256_loadu_pd(off);
+    const unsigned above = static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(v, onLimits, _CMP_GE_OQ)));
+    const unsigned below = static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(v, onLimits, _CMP_LE_OQ)));
+    const unsigned stayAbove = static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(v, offLimits, _CMP_GE_OQ)));
+    const unsigned stayBelow = static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(v, offLimits, _CMP_LE_OQ)));
+    const unsigned enter = (above & 0x3U) | (below & 0xCU);
+    const unsigned stay = (stayAbove & 0x3U) | (stayBelow & 0xCU);
+    return enter | (stay & active & 0xFU);
+#elif defined(__SSE2__)
+    const __m128d v = _mm_set1_pd(value);
+    const unsigned enter = static_cast<unsigned>(_mm_movemask_pd(_mm_cmpge_pd(v, _mm_loadu_pd(on))))
+                           | static_cast<unsigned>(_mm_movemask_pd(_mm_cmple_pd(v, _mm_loadu_pd(on + 2)))) << 2;
+    const unsigned stay = static_cast<unsigned>(_mm_movemask_pd(_mm_cmpge_pd(v, _mm_loadu_pd(off))))
+                          | static_cast<unsigned>(_mm_movemask_pd(_mm_cmple_pd(v, _mm_loadu_pd(off + 2)))) << 2;
+    return enter | (stay & active & 0xFU);
+#else
+    unsigned result = 0;
+    for (unsigned k = 0; k < 4; ++k) {
+        const bool enter = k < 2 ? value >= on[k] : value <= on[k];
+        const bool stay = k < 2 ? value >= off[k] : value <= off[k];
+        result |= enter || ((active >> k & 1U) != 0 && stay) ? 1U << k : 0U;
+    }
+    return result;
+#endif
+}
+
+}  // namespace simd
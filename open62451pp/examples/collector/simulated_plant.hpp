@@ -0,0 +1,252 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <open62541/server.h>
+
+#include <open62541pp/node.hpp>
+#include <open62541pp/server.hpp>
+#include <open62541pp/services/nodemanagement.hpp>
+
+// 模拟工厂：在内置服务器中创建与 KEPServerEX 类似的地址空间
+//
+//   Objects
+//   └── Channel1                        (文件夹)
+//       └── Device1                     (对象)
+//           ├── Temperature1            ns=1;s=Channel1.Device1.Temperature1  Double
+//           ├── Running1                ns=1;s=Channel1.Device1.Running1      Boolean
+//           ├── Counter1                ns=1;s=Channel1.Device1.Counter1      Int32
+//           └── ...
+//
+// 用于地址空间浏览、元数据读取和启动流程等示例，节点数可以按参数放大到几十万。
+// 运行中可以增删设备并发出 GeneralModelChangeEvent，模拟修改 KEPServerEX 的配置。
+
+struct PlantOptions {
+    size_t channels = 4;
+    size_t devicesPerChannel = 25;
+    size_t tagsPerDevice = 50;
+    uint16_t namespaceIndex = 1;
+    bool analogProperties = false;  // 为模拟量 tag 添加 EngineeringUnits 和 EURange 属性
+};
+
+enum class PlantTagKind : uint8_t {
+    Temperature,
+    Pressure,
+    Flow,
+    Level,
+    Speed,
+    Running,
+    Alarm,
+    Counter,
+    Status,
+};
+
+struct PlantTag {
+    opcua::NodeId id;
+    PlantTagKind kind;
+};
+
+class SimulatedPlant {
+public:
+    static constexpr size_t kindCount = 9;
+
+    static const char* kindName(PlantTagKind kind) noexcept {
+        static constexpr const char* names[kindCount] = {
+            "Temperature", "Pressure", "Flow", "Level", "Speed", "Running", "Alarm", "Counter", "Status"
+        };
+        return names[static_cast<size_t>(kind)];
+    }
+
+    static opcua::DataTypeId dataType(PlantTagKind kind) noexcept {
+        switch (kind) {
+        case PlantTagKind::Running:
+        case PlantTagKind::Alarm:
+            return opcua::DataTypeId::Boolean;
+        case PlantTagKind::Counter:
+            return opcua::DataTypeId::Int32;
+        case PlantTagKind::Status:
+            return opcua::DataTypeId::String;
+        default:
+            return opcua::DataTypeId::Double;
+        }
+    }
+
+    /// 在 server 的 Objects 文件夹下创建通道、设备和 tag
+    SimulatedPlant(opcua::Server& server, PlantOptions options = {})
+        : server_{server},
+          options_{options} {
+        opcua::Node objects{server, opcua::ObjectId::ObjectsFolder};
+        tags_.reserve(options_.channels * options_.devicesPerChannel * options_.tagsPerDevice);
+        for (size_t c = 1; c <= options_.channels; ++c) {
+            const std::string channelName = "Channel" + std::to_string(c);
+            objects.addFolder({options_.namespaceIndex, channelName}, channelName);
+            for (size_t d = 1; d <= options_.devicesPerChannel; ++d) {
+                addDevice(c, d, options_.tagsPerDevice);
+            }
+        }
+    }
+
+    /// 在通道 channel 下添加设备 Device<device>，返回设备的 NodeId
+    opcua::NodeId addDevice(size_t channel, size_t device, size_t tagCount) {
+        const uint16_t ns = options_.namespaceIndex;
+        const std::string channelName = "Channel" + std::to_string(channel);
+        const std::string deviceName = "Device" + std::to_string(device);
+        const std::string devicePath = channelName + "." + deviceName;
+        opcua::Node channelNode{server_, opcua::NodeId{ns, channelName}};
+        auto deviceNode = channelNode.addObject({ns, devicePath}, deviceName);
+        for (size_t t = 0; t < tagCount; ++t) {
+            const auto kind = static_cast<PlantTagKind>(t % kindCount);
+            const std::string tagName = kindName(kind) + std::to_string(t / kindCount + 1);
+            auto tagNode = deviceNode.addVariable(
+                {ns, devicePath + "." + tagName},
+                tagName,
+                opcua::VariableAttributes{}
+                    .setDisplayName({"", tagName})
+                    .setDataType(dataType(kind))
+                    .setAccessLevel(UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE)
+                    .setValue(initialValue(kind))
+            );
+            if (options_.analogProperties && isAnalog(kind)) {
+                addAnalogProperties(tagNode, devicePath + "." + tagName, kind);
+            }
+            tags_.push_back({tagNode.id(), kind});
+        }
+        return deviceNode.id();
+    }
+
+    /// 删除设备及其 tag，返回设备的 NodeId
+    opcua::NodeId removeDevice(size_t channel, size_t device) {
+        const std::string devicePath = "Channel" + std::to_string(channel) + ".Device" + std::to_string(device);
+        const opcua::NodeId id{options_.namespaceIndex, devicePath};
+        const std::string prefix = "s=" + devicePath + ".";
+        opcua::Node deviceNode{server_, id};
+        for (const auto& child : deviceNode.browseChildren()) {
+            opcua::services::deleteNode(server_, child.id(), true);
+        }
+        opcua::services::deleteNode(server_, id, true);
+        tags_.erase(
+            std::remove_if(
+                tags_.begin(),
+                tags_.end(),
+                [&](const PlantTag& tag) {
+                    const auto name = opcua::toString(tag.id);
+                    return name.find(prefix) != std::string::npos;
+                }
+            ),
+            tags_.end()
+        );
+        return id;
+    }
+
+    /**
+     * @brief 在 Server 对象上发出 GeneralModelChangeEvent
+     *
+     * @param changes 受影响的节点和 verb（1 NodeAdded、2 NodeDeleted、4 ReferenceAdded、8 ReferenceDeleted）
+     */
+    void emitModelChange(const std::vector<std::pair<opcua::NodeId, uint8_t>>& changes) {
+        UA_Server* server = server_.handle();
+        UA_NodeId eventId;
+        if (UA_Server_createEvent(server, UA_NODEID_NUMERIC(0, UA_NS0ID_GENERALMODELCHANGEEVENTTYPE), &eventId) !=
+            UA_STATUSCODE_GOOD) {
+            return;
+        }
+        std::vector<UA_ModelChangeStructureDataType> items(changes.size());
+        for (size_t i = 0; i < changes.size(); ++i) {
+            UA_ModelChangeStructureDataType_init(&items[i]);
+            items[i].affected = *changes[i].first.handle();  // 浅拷贝，写入属性时复制
+            items[i].verb = changes[i].second;
+        }
+        UA_Variant value;
+        UA_Variant_setArray(
+            &value, items.data(), items.size(), &UA_TYPES[UA_TYPES_MODELCHANGESTRUCTUREDATATYPE]
+        );
+        const opcua::QualifiedName changesName{0, "Changes"};
+        const opcua::QualifiedName timeName{0, "Time"};
+        UA_Server_writeObjectProperty(server, eventId, *changesName.handle(), value);
+        UA_DateTime now = UA_DateTime_now();
+        UA_Server_writeObjectProperty_scalar(server, eventId, *timeName.handle(), &now, &UA_TYPES[UA_TYPES_DATETIME]);
+        UA_Server_triggerEvent(server, eventId, UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER), nullptr, true);
+    }
+
+    const PlantOptions& options() const noexcept {
+        return options_;
+    }
+
+    /// 当前的所有 tag
+    const std::vector<PlantTag>& tags() const noexcept {
+        return tags_;
+    }
+
+    /// 初始创建的对象节点（文件夹和设备）与 tag 的总数，不含属性节点
+    size_t nodeCount() const noexcept {
+        return options_.channels * (1 + options_.devicesPerChannel) +
+            options_.channels * options_.devicesPerChannel * options_.tagsPerDevice;
+    }
+
+    static bool isAnalog(PlantTagKind kind) noexcept {
+        return kind <= PlantTagKind::Speed;
+    }
+
+private:
+    // 与 OPC UA AnalogItemType 相同的两个属性，单位使用 UNECE 代码
+    void addAnalogProperties(opcua::Node<opcua::Server>& tag, const std::string& path, PlantTagKind kind) {
+        struct Analog {
+            const char* symbol;
+            int32_t unitId;
+            double high;
+        };
+        static constexpr Analog analogs[] = {
+            {"°C", 4408652, 150.0},      // CEL
+            {"kPa", 4935745, 1000.0},    // KPA
+            {"m³/h", 5067080, 500.0},    // MQH
+            {"m", 5067858, 20.0},        // MTR
+            {"r/min", 5394509, 3000.0},  // RPM
+        };
+        const Analog& analog = analogs[static_cast<size_t>(kind)];
+        const uint16_t ns = options_.namespaceIndex;
+
+        UA_EUInformation eu;
+        UA_EUInformation_init(&eu);
+        eu.namespaceUri = UA_STRING(const_cast<char*>("http://www.opcfoundation.org/UA/units/un/cefact"));
+        eu.unitId = analog.unitId;
+        eu.displayName = UA_LOCALIZEDTEXT(const_cast<char*>(""), const_cast<char*>(analog.symbol));
+        opcua::Variant units;
+        UA_Variant_setScalarCopy(units.handle(), &eu, &UA_TYPES[UA_TYPES_EUINFORMATION]);
+        tag.addProperty(
+            {ns, path + ".EngineeringUnits"},
+            "EngineeringUnits",
+            opcua::VariableAttributes{}.setDataType(opcua::DataTypeId::EUInformation).setValue(units)
+        );
+
+        UA_Range range{0.0, analog.high};
+        opcua::Variant rangeValue;
+        UA_Variant_setScalarCopy(rangeValue.handle(), &range, &UA_TYPES[UA_TYPES_RANGE]);
+        tag.addProperty(
+            {ns, path + ".EURange"},
+            "EURange",
+            opcua::VariableAttributes{}.setDataType(opcua::DataTypeId::Range).setValue(rangeValue)
+        );
+    }
+
+    static opcua::Variant initialValue(PlantTagKind kind) {
+        switch (kind) {
+        case PlantTagKind::Running:
+        case PlantTagKind::Alarm:
+            return opcua::Variant{false};
+        case PlantTagKind::Counter:
+            return opcua::Variant{int32_t{0}};
+        case PlantTagKind::Status:
+            return opcua::Variant{std::string{"Idle"}};
+        default:
+            return opcua::Variant{0.0};
+        }
+    }
+
+    opcua::Server& server_;
+    PlantOptions options_;
+    std::vector<PlantTag> tags_;
+};
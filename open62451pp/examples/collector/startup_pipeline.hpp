@@ -0,0 +1,492 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <open62541/client.h>
+
+#include <open62541pp/client.hpp>
+
+#include "collector_types.hpp"
+#include "request_profiles.hpp"
+#include "subscription_engine.hpp"
+
+// 启动流程参数
+struct StartupOptions {
+    size_t batchSize = 1000;     // 每批 tag 数：一个 TranslateBrowsePaths、一个 Read、一次 addTags
+    size_t maxInFlight = 4;      // 解析和元数据阶段各自同时未完成的请求数
+    bool overlap = true;         // false 时按阶段依次执行（原来的冷启动方式），用于对照
+    bool sampleableOnly = true;  // 只订阅写入目标能保存的 tag（数值、布尔、枚举的标量）
+};
+
+// 一个阶段的计时；时间为相对 start() 的秒数
+struct StartupPhase {
+    size_t requests = 0;
+    size_t items = 0;
+    double busySeconds = 0.0;  // 各请求从发送到收到响应的时间之和
+    double firstStart = -1.0;
+    double lastEnd = -1.0;
+};
+
+struct StartupStats {
+    StartupPhase resolve;
+    StartupPhase metadata;
+    StartupPhase subscribe;
+    size_t tagsRequested = 0;
+    size_t tagsResolved = 0;
+    size_t tagsFailed = 0;     // 路径无法解析或元数据读取失败
+    size_t tagsDuplicate = 0;  // 与前面的路径解析到同一节点（只订阅一次）
+    size_t tagsSkipped = 0;    // 不可读、数组或非数值类型
+    size_t tagsSubscribed = 0;
+    size_t tagsCovered = 0;      // 已收到至少一个采样的监控项
+    double firstSample = -1.0;   // 首个采样到达的时间
+    double fullCoverage = -1.0;  // 所有监控项都收到过采样的时间
+};
+
+// 启动时读取的元数据：用于决定是否订阅
+struct StartupTagMetadata {
+    opcua::NodeId dataType;
+    int32_t valueRank = -1;
+    uint8_t accessLevel = 0;
+};
+
+/**
+ * @brief 分批流水线式冷启动
+ *
+ * 原来的冷启动按阶段依次执行：解析全部 tag 路径 → 读取全部元数据 → 创建全部监控项，
+ * 10 万个 tag 时第一个采样要等几分钟。流水线把 tag 分批：
+ * - 解析：TranslateBrowsePathsToNodeIds 异步请求，同时最多 maxInFlight 个
+ * - 元数据：一批解析完成后立即发送该批的 Read（DataType、ValueRank、AccessLevel）
+ * - 订阅：一批元数据到达后立即调用 SubscriptionEngine::addTags()
+ * 第一批 tag 开始产生采样时，后面的批次仍在解析。
+ *
+ * 流水线同时是一个写入目标，用于统计首个采样和全部覆盖的时间：
+ *   engine.addSink("startup", pipeline);
+ *
+ * step() 与 client.runIterate()、engine.publish() 在同一线程调用。
+ */
+class StartupPipeline : public HistorySink {
+public:
+    StartupPipeline(
+        opcua::Client& client, TagTable& tags, SubscriptionEngine& engine, StartupOptions options = {}
+    )
+        : client_{client},
+          tags_{tags},
+          engine_{engine},
+          options_{options} {}
+
+    ~StartupPipeline() override {
+        alive_.reset();  // 尚未返回的请求的回调不再访问流水线
+    }
+
+    StartupPipeline(const StartupPipeline&) = delete;
+    StartupPipeline& operator=(const StartupPipeline&) = delete;
+
+    /**
+     * @brief 开始启动流程
+     *
+     * @param paths 从 Objects 开始的浏览路径，元素用 '/' 分隔，可带命名空间前缀，
+     *              例如 "1:Channel1/1:Device1/1:Temperature1"
+     */
+    void start(std::vector<std::string> paths) {
+        paths_ = std::move(paths);
+        nextPath_ = 0;
+        stats_ = {};
+        stats_.tagsRequested = paths_.size();
+        metadataQueue_.clear();
+        subscribeQueue_.clear();
+        metadata_.clear();
+        coverage_.clear();
+        queued_.clear();
+        alive_ = std::make_shared<StartupPipeline*>(this);
+        resolveInFlight_ = 0;
+        metadataInFlight_ = 0;
+        start_ = std::chrono::steady_clock::now();
+    }
+
+    /// 推进流水线：先处理下游阶段，再发送新的请求
+    void step() {
+        subscribeReady();
+        while (!metadataQueue_.empty() && metadataInFlight_ < options_.maxInFlight &&
+               (options_.overlap || resolveFinished())) {
+            if (!sendMetadata()) {
+                break;
+            }
+        }
+        while (nextPath_ < paths_.size() && resolveInFlight_ < options_.maxInFlight) {
+            if (!sendResolve()) {
+                break;
+            }
+        }
+        checkCoverage();
+    }
+
+    /// 所有批次都已解析、读取元数据并创建监控项
+    bool done() const noexcept {
+        return metadataFinished() && subscribeQueue_.empty();
+    }
+
+    /// 所有监控项都已收到采样
+    bool covered() const noexcept {
+        return stats_.fullCoverage >= 0.0;
+    }
+
+    const StartupStats& stats() const noexcept {
+        return stats_;
+    }
+
+    /// 启动时读取的元数据；handle 未经过元数据阶段时返回 nullptr
+    const StartupTagMetadata* metadata(TagHandle handle) const noexcept {
+        return handle < metadata_.size() && metadata_[handle].dataType != opcua::NodeId{} ? &metadata_[handle]
+                                                                                          : nullptr;
+    }
+
+    void write(opcua::Span<const Sample> samples) override {
+        for (const auto& sample : samples) {
+            if (sample.tag < coverage_.size() && coverage_[sample.tag] == waiting) {
+                coverage_[sample.tag] = seen;
+                ++stats_.tagsCovered;
+            }
+        }
+        if (stats_.firstSample < 0.0 && !samples.empty()) {
+            stats_.firstSample = elapsed();
+        }
+        checkCoverage();
+    }
+
+private:
+    struct RequestContext {
+        std::weak_ptr<StartupPipeline*> owner;
+        size_t first = 0;  // 解析：paths_ 中的起始下标
+        size_t count = 0;
+        std::vector<TagHandle> handles;  // 元数据：本批的 tag
+        std::chrono::steady_clock::time_point sent;
+    };
+
+    static constexpr uint8_t waiting = 1;
+    static constexpr uint8_t seen = 2;
+
+    double elapsed() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+    }
+
+    bool resolveFinished() const noexcept {
+        return nextPath_ == paths_.size() && resolveInFlight_ == 0;
+    }
+
+    bool metadataFinished() const noexcept {
+        return resolveFinished() && metadataQueue_.empty() && metadataInFlight_ == 0;
+    }
+
+    static void begin(StartupPhase& phase, double now, size_t items) {
+        ++phase.requests;
+        phase.items += items;
+        if (phase.firstStart < 0.0) {
+            phase.firstStart = now;
+        }
+    }
+
+    void end(StartupPhase& phase, std::chrono::steady_clock::time_point sent) {
+        phase.busySeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - sent).count();
+        phase.lastEnd = elapsed();
+    }
+
+    // 解析 "1:Channel1/1:Device1/Tag" 这样的路径元素；没有前缀时命名空间为 0
+    static std::vector<std::pair<uint16_t, std::string_view>> splitPath(std::string_view path) {
+        std::vector<std::pair<uint16_t, std::string_view>> elements;
+        while (!path.empty()) {
+            const size_t slash = path.find('/');
+            std::string_view element = path.substr(0, slash);
+            path = slash == std::string_view::npos ? std::string_view{} : path.substr(slash + 1);
+            uint16_t ns = 0;
+            const size_t colon = element.find(':');
+            if (colon != std::string_view::npos && colon > 0 &&
+                std::all_of(element.begin(), element.begin() + colon, [](char c) { return c >= '0' && c <= '9'; })) {
+                ns = static_cast<uint16_t>(std::stoul(std::string{element.substr(0, colon)}));
+                element = element.substr(colon + 1);
+            }
+            if (!element.empty()) {
+                elements.emplace_back(ns, element);
+            }
+        }
+        return elements;
+    }
+
+    bool sendResolve() {
+        auto context = std::make_unique<RequestContext>();
+        context->owner = alive_;
+        context->first = nextPath_;
+        context->count = std::min(options_.batchSize, paths_.size() - nextPath_);
+
+        // 请求中的字符串指向 paths_，发送时立即编码
+        std::vector<std::vector<UA_RelativePathElement>> elements(context->count);
+        std::vector<UA_BrowsePath> browsePaths(context->count);
+        for (size_t i = 0; i < context->count; ++i) {
+            for (const auto& [ns, name] : splitPath(paths_[context->first + i])) {
+                UA_RelativePathElement element;
+                UA_RelativePathElement_init(&element);
+                element.referenceTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_HIERARCHICALREFERENCES);
+                element.includeSubtypes = true;
+                element.targetName.namespaceIndex = ns;
+                element.targetName.name = {name.size(), reinterpret_cast<UA_Byte*>(const_cast<char*>(name.data()))};
+                elements[i].push_back(element);
+            }
+            UA_BrowsePath_init(&browsePaths[i]);
+            browsePaths[i].startingNode = UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER);
+            browsePaths[i].relativePath.elements = elements[i].data();
+            browsePaths[i].relativePath.elementsSize = elements[i].size();
+        }
+        UA_TranslateBrowsePathsToNodeIdsRequest request;
+        UA_TranslateBrowsePathsToNodeIdsRequest_init(&request);
+        request.browsePaths = browsePaths.data();
+        request.browsePathsSize = browsePaths.size();
+
+        context->sent = std::chrono::steady_clock::now();
+        const UA_StatusCode status = __UA_Client_AsyncService(
+            client_.handle(),
+            &request,
+            &UA_TYPES[UA_TYPES_TRANSLATEBROWSEPATHSTONODEIDSREQUEST],
+            onResolveResponse,
+            &UA_TYPES[UA_TYPES_TRANSLATEBROWSEPATHSTONODEIDSRESPONSE],
+            context.get(),
+            nullptr
+        );
+        if (status != UA_STATUSCODE_GOOD) {
+            return false;  // 例如连接已断开，下次 step() 重试
+        }
+        begin(stats_.resolve, elapsed(), context->count);
+        nextPath_ += context->count;
+        context.release();  // 所有权交给回调
+        ++resolveInFlight_;
+        return true;
+    }
+
+    // 客户端保证每个异步请求的回调都会被调用（断开连接时带错误状态码）
+    static void onResolveResponse(UA_Client*, void* userdata, UA_UInt32, void* response) {
+        std::unique_ptr<RequestContext> context{static_cast<RequestContext*>(userdata)};
+        const auto owner = context->owner.lock();
+        if (owner == nullptr) {
+            return;
+        }
+        (*owner)->handleResolve(*context, *static_cast<UA_TranslateBrowsePathsToNodeIdsResponse*>(response));
+    }
+
+    void handleResolve(const RequestContext& context, const UA_TranslateBrowsePathsToNodeIdsResponse& response) {
+        --resolveInFlight_;
+        end(stats_.resolve, context.sent);
+        std::vector<TagHandle> handles;
+        size_t duplicates = 0;
+        if (response.responseHeader.serviceResult == UA_STATUSCODE_GOOD && response.resultsSize == context.count) {
+            for (size_t i = 0; i < context.count; ++i) {
+                const auto& result = response.results[i];
+                if (result.statusCode != UA_STATUSCODE_GOOD || result.targetsSize == 0 ||
+                    result.targets[0].remainingPathIndex != UA_UINT32_MAX) {
+                    continue;
+                }
+                // 多条路径指向同一节点时 TagTable 返回同一个 handle；重复订阅会使监控项数多于可覆盖的 tag 数
+                const TagHandle handle = tags_.add(opcua::NodeId{result.targets[0].targetId.nodeId});
+                if (queued_.size() <= handle) {
+                    queued_.resize(handle + 1, false);
+                }
+                if (queued_[handle]) {
+                    ++duplicates;
+                    continue;
+                }
+                queued_[handle] = true;
+                handles.push_back(handle);
+            }
+        }
+        stats_.tagsResolved += handles.size();
+        stats_.tagsDuplicate += duplicates;
+        stats_.tagsFailed += context.count - handles.size() - duplicates;
+        if (!handles.empty()) {
+            metadataQueue_.push_back(std::move(handles));
+        }
+    }
+
+    bool sendMetadata() {
+        static constexpr UA_UInt32 attributes[] = {
+            UA_ATTRIBUTEID_DATATYPE,
+            UA_ATTRIBUTEID_VALUERANK,
+            UA_ATTRIBUTEID_ACCESSLEVEL,
+        };
+        constexpr size_t perTag = 3;
+
+        auto context = std::make_unique<RequestContext>();
+        context->owner = alive_;
+        context->handles = std::move(metadataQueue_.front());
+        metadataQueue_.pop_front();
+        context->count = context->handles.size();
+
+        std::vector<UA_ReadValueId> items(context->count * perTag);
+        for (size_t i = 0; i < context->count; ++i) {
+            for (size_t a = 0; a < perTag; ++a) {
+                auto& item = items[i * perTag + a];
+                UA_ReadValueId_init(&item);
+                item.nodeId = *tags_.nodeId(context->handles[i]).handle();  // 浅拷贝
+                item.attributeId = attributes[a];
+            }
+        }
+        UA_ReadRequest request;
+        UA_ReadRequest_init(&request);
+        request.nodesToRead = items.data();
+        request.nodesToReadSize = items.size();
+        apply(request_profiles::metadata, request);
+
+        context->sent = std::chrono::steady_clock::now();
+        const UA_StatusCode status = __UA_Client_AsyncService(
+            client_.handle(),
+            &request,
+            &UA_TYPES[UA_TYPES_READREQUEST],
+            onMetadataResponse,
+            &UA_TYPES[UA_TYPES_READRESPONSE],
+            context.get(),
+            nullptr
+        );
+        if (status != UA_STATUSCODE_GOOD) {
+            metadataQueue_.push_front(std::move(context->handles));
+            return false;
+        }
+        begin(stats_.metadata, elapsed(), context->count);
+        context.release();
+        ++metadataInFlight_;
+        return true;
+    }
+
+    static void onMetadataResponse(UA_Client*, void* userdata, UA_UInt32, void* response) {
+        std::unique_ptr<RequestContext> context{static_cast<RequestContext*>(userdata)};
+        const auto owner = context->owner.lock();
+        if (owner == nullptr) {
+            return;
+        }
+        (*owner)->handleMetadata(*context, *static_cast<UA_ReadResponse*>(response));
+    }
+
+    void handleMetadata(const RequestContext& context, const UA_ReadResponse& response) {
+        --metadataInFlight_;
+        end(stats_.metadata, context.sent);
+        if (response.responseHeader.serviceResult != UA_STATUSCODE_GOOD ||
+            response.resultsSize != context.count * 3) {
+            stats_.tagsFailed += context.count;
+            return;
+        }
+        const UA_DataTypeArray* customTypes = UA_Client_getConfig(client_.handle())->customDataTypes;
+        std::vector<TagHandle> subscribe;
+        for (size_t i = 0; i < context.count; ++i) {
+            const TagHandle handle = context.handles[i];
+            const UA_DataValue* dv = &response.results[i * 3];
+            if (metadata_.size() <= handle) {
+                metadata_.resize(handle + 1);
+            }
+            auto& meta = metadata_[handle];
+            if (dv[0].hasValue && UA_Variant_hasScalarType(&dv[0].value, &UA_TYPES[UA_TYPES_NODEID])) {
+                meta.dataType = opcua::NodeId{*static_cast<const UA_NodeId*>(dv[0].value.data)};
+            }
+            if (dv[1].hasValue && UA_Variant_hasScalarType(&dv[1].value, &UA_TYPES[UA_TYPES_INT32])) {
+                meta.valueRank = *static_cast<const UA_Int32*>(dv[1].value.data);
+            }
+            if (dv[2].hasValue && UA_Variant_hasScalarType(&dv[2].value, &UA_TYPES[UA_TYPES_BYTE])) {
+                meta.accessLevel = *static_cast<const UA_Byte*>(dv[2].value.data);
+            }
+            if ((meta.accessLevel & UA_ACCESSLEVELMASK_READ) == 0 ||
+                (options_.sampleableOnly && !sampleable(meta, customTypes))) {
+                ++stats_.tagsSkipped;
+                continue;
+            }
+            subscribe.push_back(handle);
+        }
+        if (!subscribe.empty()) {
+            subscribeQueue_.push_back(std::move(subscribe));
+        }
+    }
+
+    /**
+     * toSample() 能转换的值：标量，且 DataType 是数值、布尔或枚举（包括它们的子类型，如 Duration、Counter）。
+     *
+     * 已知类型（命名空间 0 和客户端配置中注册的自定义类型）按 UA_DataType::typeKind 判断，
+     * 字符串、时间、ByteString 的子类型和结构体都不订阅；未注册的自定义类型无法判断，也不订阅。
+     */
+    static bool sampleable(const StartupTagMetadata& meta, const UA_DataTypeArray* customTypes) {
+        if (meta.valueRank >= 0) {
+            return false;  // 数组
+        }
+        const UA_NodeId& id = *meta.dataType.handle();
+        if (id.namespaceIndex == 0 && id.identifierType == UA_NODEIDTYPE_NUMERIC) {
+            switch (id.identifier.numeric) {
+            case UA_NS0ID_NUMBER:
+            case UA_NS0ID_INTEGER:
+            case UA_NS0ID_UINTEGER:
+            case UA_NS0ID_ENUMERATION:
+                return true;  // 抽象类型，值的实际类型仍是数值或 Int32
+            default:
+                break;
+            }
+        }
+        const UA_DataType* type = UA_findDataTypeWithCustom(&id, customTypes);
+        if (type == nullptr) {
+            return false;
+        }
+        return type->typeKind <= UA_DATATYPEKIND_DOUBLE || type->typeKind == UA_DATATYPEKIND_ENUM;
+    }
+
+    // 创建监控项（同步请求）；等待期间到达的其他批次的响应照常处理
+    void subscribeReady() {
+        if (subscribeQueue_.empty() || (!options_.overlap && !metadataFinished())) {
+            return;
+        }
+        std::vector<TagHandle> batch = std::move(subscribeQueue_.front());
+        subscribeQueue_.pop_front();
+        if (!options_.overlap) {
+            // 原来的方式：所有 tag 一次创建
+            while (!subscribeQueue_.empty()) {
+                batch.insert(batch.end(), subscribeQueue_.front().begin(), subscribeQueue_.front().end());
+                subscribeQueue_.pop_front();
+            }
+        }
+        for (const TagHandle handle : batch) {
+            if (coverage_.size() <= handle) {
+                coverage_.resize(handle + 1, 0);
+            }
+            coverage_[handle] = waiting;
+        }
+        const auto sent = std::chrono::steady_clock::now();
+        begin(stats_.subscribe, elapsed(), batch.size());
+        const size_t before = engine_.itemCount();
+        engine_.addTags(batch);
+        stats_.tagsSubscribed += engine_.itemCount() - before;
+        end(stats_.subscribe, sent);
+    }
+
+    void checkCoverage() {
+        if (stats_.fullCoverage < 0.0 && done() && stats_.tagsSubscribed > 0 &&
+            stats_.tagsCovered >= stats_.tagsSubscribed) {
+            stats_.fullCoverage = elapsed();
+        }
+    }
+
+    opcua::Client& client_;
+    TagTable& tags_;
+    SubscriptionEngine& engine_;
+    StartupOptions options_;
+
+    std::vector<std::string> paths_;
+    size_t nextPath_ = 0;
+    std::deque<std::vector<TagHandle>> metadataQueue_;   // 已解析、等待读取元数据的批次
+    std::deque<std::vector<TagHandle>> subscribeQueue_;  // 已读取元数据、等待创建监控项的批次
+    std::vector<StartupTagMetadata> metadata_;           // 按 TagHandle
+    std::vector<uint8_t> coverage_;                      // 按 TagHandle：0 未订阅，waiting，seen
+    std::vector<bool> queued_;                           // 按 TagHandle：已进入元数据阶段
+    size_t resolveInFlight_ = 0;
+    size_t metadataInFlight_ = 0;
+    std::chrono::steady_clock::time_point start_ = std::chrono::steady_clock::now();
+
+    std::shared_ptr<StartupPipeline*> alive_ = std::make_shared<StartupPipeline*>(this);
+    StartupStats stats_;
+};
@@ -0,0 +1,711 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <open62541/client.h>
+
+#include <open62541pp/client.hpp>
+
+#include "checkpoint.hpp"
+#include "collector_types.hpp"
+#include "decode_pool.hpp"
+
+// 订阅引擎参数
+struct SubscriptionEngineOptions {
+    double publishingInterval = 1000.0;  // 发布间隔（毫秒）
+    double samplingInterval = 500.0;     // 采样间隔（毫秒）
+    uint32_t queueSize = 10;             // 监控项队列长度
+    uint32_t lifetimeCount = 600;        // 没有 Publish 请求时订阅的存活周期数，需覆盖重启时间
+    uint32_t maxKeepAliveCount = 10;
+    size_t itemsPerSubscription = 1000;  // 每个订阅的监控项数
+    size_t itemsPerRequest = 1000;       // 每个 CreateMonitoredItems 请求的监控项数
+    size_t publishRequests = 0;          // 同时未完成的 Publish 请求数，0 表示订阅数 + 1
+    // 监控项返回的时间戳；写入目标只使用一种时间戳时可以改为 SOURCE 或 SERVER，每个采样少 8 字节
+    UA_TimestampsToReturn timestampsToReturn = UA_TIMESTAMPSTORETURN_BOTH;
+};
+
+struct SubscriptionEngineStats {
+    size_t subscriptionsCreated = 0;
+    size_t subscriptionsTransferred = 0;
+    size_t republished = 0;      // 通过 Republish 取回的通知消息数
+    size_t republishFailed = 0;  // Republish 失败的通知消息数；这些消息不确认，服务器继续保留
+    size_t publishErrors = 0;    // serviceResult 为 Bad 的 Publish 响应数
+    size_t notifications = 0;
+    size_t samples = 0;
+    size_t frames = 0;  // 交给 FrameSink 的帧数
+};
+
+/**
+ * @brief 由采集器直接管理的订阅
+ *
+ * 与 opcua::Subscription 不同，订阅和监控项通过原始服务请求创建，客户端内部不登记这些订阅：
+ * - 监控项的 clientHandle 就是 TagHandle，通知直接映射到 tag
+ * - Publish 请求由引擎发送，引擎掌握每个订阅的序号和确认状态
+ * - 订阅布局可以写入检查点，新进程通过 TransferSubscriptions 接管原有订阅
+ * - 每个 Publish 响应可以作为一帧（PublishFrame）整体交给 FrameSink
+ *
+ * 使用 DecodePool 时，大的 Publish 响应由工作线程转换，采样在 publish() 中按顺序写入写入目标，
+ * 写入后才确认对应的通知消息。
+ *
+ * 所有方法和 client.runIterate() 在同一线程中调用。
+ */
+class SubscriptionEngine {
+public:
+    SubscriptionEngine(
+        opcua::Client& client, const TagTable& tags, SubscriptionEngineOptions options = {}
+    )
+        : client_{client},
+          tags_{tags},
+          options_{options} {}
+
+    ~SubscriptionEngine() {
+        alive_.reset();  // 尚未返回的 Publish 请求的回调不再访问引擎
+    }
+
+    SubscriptionEngine(const SubscriptionEngine&) = delete;
+    SubscriptionEngine& operator=(const SubscriptionEngine&) = delete;
+
+    /// 添加写入目标；offset 为该目标已接收的采样数（从检查点恢复时继续计数）
+    void addSink(std::string name, HistorySink& sink, uint64_t offset = 0) {
+        sinks_.push_back({std::move(name), &sink, offset});
+    }
+
+    /**
+     * @brief 添加按帧接收的写入目标
+     *
+     * 每个 Publish 响应（包括通过 Republish 取回的）作为一帧交付，带订阅 ID、序号和发布时间。
+     * 只有 FrameSink 时不再转换 Sample。已添加的 sink 再次添加时忽略，每帧只交付一次。
+     */
+    void addFrameSink(FrameSink& sink) {
+        if (std::find(frameSinks_.begin(), frameSinks_.end(), &sink) == frameSinks_.end()) {
+            frameSinks_.push_back(&sink);
+        }
+    }
+
+    /// 使用线程池转换 Publish 响应；线程池可以与其他引擎共用，生命周期需长于引擎
+    void useDecodePool(DecodePool& pool) {
+        decodePool_ = &pool;
+    }
+
+    /**
+     * @brief 为所有 tag 创建订阅和监控项（冷启动）
+     */
+    void create() {
+        std::vector<TagHandle> all;
+        all.reserve(tags_.size());
+        for (TagHandle tag = 0; tag < tags_.size(); ++tag) {
+            if (tags_.active(tag)) {
+                all.push_back(tag);
+            }
+        }
+        createFor(all);
+    }
+
+    /**
+     * @brief 为新增的 tag 创建监控项
+     *
+     * 先填满已有订阅中的空位（每个订阅最多 itemsPerSubscription 个），剩余的创建新订阅。
+     */
+    void addTags(const std::vector<TagHandle>& tags) {
+        size_t next = 0;
+        for (auto& sub : subscriptions_) {
+            while (next < tags.size() && sub.items.size() < options_.itemsPerSubscription) {
+                const size_t count = std::min(
+                    {tags.size() - next, options_.itemsPerSubscription - sub.items.size(), options_.itemsPerRequest}
+                );
+                createMonitoredItems(sub, {tags.data() + next, count});
+                next += count;
+            }
+        }
+        if (next < tags.size()) {
+            createFor({tags.begin() + static_cast<std::ptrdiff_t>(next), tags.end()});
+        }
+    }
+
+    /**
+     * @brief 删除 tag 的监控项（节点已从服务器删除）
+     *
+     * 按订阅分组，每个订阅一个 DeleteMonitoredItems 请求。
+     * @return 删除的监控项数
+     */
+    size_t removeTags(const std::vector<TagHandle>& tags) {
+        const std::unordered_set<TagHandle> removing{tags.begin(), tags.end()};
+        size_t removed = 0;
+        for (auto& sub : subscriptions_) {
+            std::vector<UA_UInt32> ids;
+            for (const auto& item : sub.items) {
+                if (removing.count(item.tag) > 0) {
+                    ids.push_back(item.monitoredItemId);
+                }
+            }
+            if (ids.empty()) {
+                continue;
+            }
+            UA_DeleteMonitoredItemsRequest request;
+            UA_DeleteMonitoredItemsRequest_init(&request);
+            request.subscriptionId = sub.subscriptionId;
+            request.monitoredItemIds = ids.data();
+            request.monitoredItemIdsSize = ids.size();
+            UA_DeleteMonitoredItemsResponse response;
+            service(
+                request,
+                UA_TYPES[UA_TYPES_DELETEMONITOREDITEMSREQUEST],
+                response,
+                UA_TYPES[UA_TYPES_DELETEMONITOREDITEMSRESPONSE]
+            );
+            const UA_StatusCode status = response.responseHeader.serviceResult;
+            UA_DeleteMonitoredItemsResponse_clear(&response);
+            if (status != UA_STATUSCODE_GOOD) {
+                continue;  // 保留在布局中，调用方可以稍后再次删除
+            }
+            // 服务器上已不存在的监控项（BadMonitoredItemIdInvalid）同样从布局中移除
+            const auto end = std::remove_if(sub.items.begin(), sub.items.end(), [&](const auto& item) {
+                return removing.count(item.tag) > 0;
+            });
+            removed += static_cast<size_t>(sub.items.end() - end);
+            sub.items.erase(end, sub.items.end());
+        }
+        return removed;
+    }
+
+    /**
+     * @brief 从检查点接管订阅（热启动）
+     *
+     * 1. TransferSubscriptions 把订阅转移到当前会话（sendInitialValues = true）
+     * 2. 对检查点之后尚未处理的通知消息调用 Republish
+     * 3. 转移失败的订阅（例如已经超过存活时间）中的 tag 重新创建
+     *
+     * @return 成功转移的订阅数
+     */
+    size_t restore(const std::vector<SubscriptionCheckpoint>& checkpoints) {
+        if (checkpoints.empty()) {
+            return 0;
+        }
+        std::vector<UA_UInt32> ids;
+        ids.reserve(checkpoints.size());
+        for (const auto& cp : checkpoints) {
+            ids.push_back(cp.subscriptionId);
+        }
+        UA_TransferSubscriptionsRequest request;
+        UA_TransferSubscriptionsRequest_init(&request);
+        request.subscriptionIds = ids.data();
+        request.subscriptionIdsSize = ids.size();
+        request.sendInitialValues = true;
+        UA_TransferSubscriptionsResponse response;
+        service(
+            request,
+            UA_TYPES[UA_TYPES_TRANSFERSUBSCRIPTIONSREQUEST],
+            response,
+            UA_TYPES[UA_TYPES_TRANSFERSUBSCRIPTIONSRESPONSE]
+        );
+
+        size_t transferred = 0;
+        std::vector<TagHandle> orphaned;
+        const bool serviceOk = response.responseHeader.serviceResult == UA_STATUSCODE_GOOD &&
+            response.resultsSize == checkpoints.size();
+        for (size_t i = 0; i < checkpoints.size(); ++i) {
+            const auto& cp = checkpoints[i];
+            if (!serviceOk || response.results[i].statusCode != UA_STATUSCODE_GOOD) {
+                for (const auto& item : cp.items) {
+                    orphaned.push_back(item.tag);
+                }
+                continue;
+            }
+            subscriptions_.push_back(cp);
+            index_[cp.subscriptionId] = subscriptions_.size() - 1;
+            ++transferred;
+            const auto& result = response.results[i];
+            republish(
+                subscriptions_.back(),
+                {result.availableSequenceNumbers, result.availableSequenceNumbersSize}
+            );
+        }
+        UA_TransferSubscriptionsResponse_clear(&response);
+        stats_.subscriptionsTransferred += transferred;
+
+        if (!orphaned.empty()) {
+            createFor(orphaned);
+        }
+        return transferred;
+    }
+
+    /**
+     * @brief 保持足够的 Publish 请求（在主循环中调用）
+     *
+     * 服务器返回 BadTooManyPublishRequests 时，同时未完成的请求数降到服务器已接受的数量；
+     * 其他 Bad 响应之后暂停发送，等待时间从 100 毫秒起加倍，最长一个发布间隔（不少于 100 毫秒）。
+     */
+    void publish() {
+        if (decodePool_ != nullptr) {
+            decodePool_->drain();
+        }
+        if (subscriptions_.empty() || !sessionActivated()) {
+            return;
+        }
+        if (publishRetryAt_ != 0 && UA_DateTime_nowMonotonic() < publishRetryAt_) {
+            return;
+        }
+        const size_t target = std::min(
+            options_.publishRequests > 0 ? options_.publishRequests : subscriptions_.size() + 1,
+            publishLimit_
+        );
+        while (publishInFlight_ < target) {
+            if (!sendPublish()) {
+                break;
+            }
+        }
+    }
+
+    /// 把订阅布局和写入目标偏移量写入检查点；先交付线程池中已提交的响应，使序号与偏移量一致
+    void checkpoint(CollectorCheckpoint& cp) {
+        flushDecodes();
+        cp.subscriptions = subscriptions_;
+        cp.sinkOffsets.clear();
+        for (const auto& sink : sinks_) {
+            cp.sinkOffsets.emplace_back(sink.name, sink.offset);
+        }
+    }
+
+    /**
+     * @brief 只关闭安全通道，保留会话和订阅
+     *
+     * client.disconnect() 会以 deleteSubscriptions = true 关闭会话，服务器随即删除订阅。
+     * 计划重启时改用本方法，订阅在 lifetimeCount 个发布周期内等待新进程接管。
+     */
+    void detach() {
+        flushDecodes();
+        UA_Client_disconnectSecureChannel(client_.handle());
+        clear();
+    }
+
+    /**
+     * @brief 重新连接后恢复当前的订阅
+     *
+     * 客户端可能在新的安全通道上重新激活了原会话，也可能创建了新会话；
+     * 两种情况都通过 TransferSubscriptions 处理，无法转移的订阅重新创建。
+     */
+    size_t resume() {
+        flushDecodes();  // 交付后 lastSequenceNumber 才包含这些消息，Republish 不会重复取回
+        std::vector<SubscriptionCheckpoint> current;
+        current.swap(subscriptions_);
+        clear();
+        return restore(current);
+    }
+
+    size_t subscriptionCount() const noexcept {
+        return subscriptions_.size();
+    }
+
+    size_t itemCount() const noexcept {
+        size_t count = 0;
+        for (const auto& sub : subscriptions_) {
+            count += sub.items.size();
+        }
+        return count;
+    }
+
+    const SubscriptionEngineStats& stats() const noexcept {
+        return stats_;
+    }
+
+private:
+    struct SinkEntry {
+        std::string name;
+        HistorySink* sink;
+        uint64_t offset;
+    };
+
+    // 线程池中的响应只在交付时推进 lastSequenceNumber，丢弃它们会使 Republish 误认为已处理
+    void flushDecodes() {
+        if (decodePool_ != nullptr) {
+            decodePool_->flush();
+        }
+    }
+
+    void clear() {
+        flushDecodes();
+        subscriptions_.clear();
+        index_.clear();
+        pendingAcks_.clear();
+        alive_ = std::make_shared<SubscriptionEngine*>(this);  // 丢弃尚未返回的 Publish 请求
+        publishInFlight_ = 0;
+        publishLimit_ = std::numeric_limits<size_t>::max();  // 新会话的限制重新探测
+        publishRetryAt_ = 0;
+        publishBackoff_ = 0;
+    }
+
+    bool sessionActivated() {
+        UA_SecureChannelState channelState{};
+        UA_SessionState sessionState{};
+        UA_StatusCode connectStatus{};
+        UA_Client_getState(client_.handle(), &channelState, &sessionState, &connectStatus);
+        return sessionState == UA_SESSIONSTATE_ACTIVATED;
+    }
+
+    template <typename Request, typename Response>
+    void service(
+        const Request& request,
+        const UA_DataType& requestType,
+        Response& response,
+        const UA_DataType& responseType
+    ) {
+        __UA_Client_Service(client_.handle(), &request, &requestType, &response, &responseType);
+    }
+
+    void createFor(const std::vector<TagHandle>& tags) {
+        for (size_t first = 0; first < tags.size(); first += options_.itemsPerSubscription) {
+            const size_t last = std::min(tags.size(), first + options_.itemsPerSubscription);
+
+            UA_CreateSubscriptionRequest request;
+            UA_CreateSubscriptionRequest_init(&request);
+            request.requestedPublishingInterval = options_.publishingInterval;
+            request.requestedLifetimeCount = options_.lifetimeCount;
+            request.requestedMaxKeepAliveCount = options_.maxKeepAliveCount;
+            request.publishingEnabled = true;
+            UA_CreateSubscriptionResponse response;
+            service(
+                request,
+                UA_TYPES[UA_TYPES_CREATESUBSCRIPTIONREQUEST],
+                response,
+                UA_TYPES[UA_TYPES_CREATESUBSCRIPTIONRESPONSE]
+            );
+            const UA_StatusCode status = response.responseHeader.serviceResult;
+            SubscriptionCheckpoint sub{};
+            sub.subscriptionId = response.subscriptionId;
+            sub.revisedPublishingInterval = response.revisedPublishingInterval;
+            sub.revisedLifetimeCount = response.revisedLifetimeCount;
+            sub.revisedMaxKeepAliveCount = response.revisedMaxKeepAliveCount;
+            UA_CreateSubscriptionResponse_clear(&response);
+            if (status != UA_STATUSCODE_GOOD) {
+                throw opcua::BadStatus{status};
+            }
+
+            for (size_t begin = first; begin < last; begin += options_.itemsPerRequest) {
+                const size_t end = std::min(last, begin + options_.itemsPerRequest);
+                createMonitoredItems(sub, {tags.data() + begin, end - begin});
+            }
+            subscriptions_.push_back(std::move(sub));
+            index_[subscriptions_.back().subscriptionId] = subscriptions_.size() - 1;
+            ++stats_.subscriptionsCreated;
+        }
+    }
+
+    void createMonitoredItems(SubscriptionCheckpoint& sub, opcua::Span<const TagHandle> tags) {
+        std::vector<UA_MonitoredItemCreateRequest> items(tags.size());
+        for (size_t i = 0; i < tags.size(); ++i) {
+            auto& item = items[i];
+            UA_MonitoredItemCreateRequest_init(&item);
+            item.itemToMonitor.nodeId = *tags_.nodeId(tags[i]).handle();  // 浅拷贝
+            item.itemToMonitor.attributeId = UA_ATTRIBUTEID_VALUE;
+            item.monitoringMode = UA_MONITORINGMODE_REPORTING;
+            item.requestedParameters.clientHandle = tags[i];
+            item.requestedParameters.samplingInterval = options_.samplingInterval;
+            item.requestedParameters.queueSize = options_.queueSize;
+            item.requestedParameters.discardOldest = true;
+        }
+        UA_CreateMonitoredItemsRequest request;
+        UA_CreateMonitoredItemsRequest_init(&request);
+        request.subscriptionId = sub.subscriptionId;
+        request.timestampsToReturn = options_.timestampsToReturn;
+        request.itemsToCreate = items.data();
+        request.itemsToCreateSize = items.size();
+        UA_CreateMonitoredItemsResponse response;
+        service(
+            request,
+            UA_TYPES[UA_TYPES_CREATEMONITOREDITEMSREQUEST],
+            response,
+            UA_TYPES[UA_TYPES_CREATEMONITOREDITEMSRESPONSE]
+        );
+        if (response.responseHeader.serviceResult == UA_STATUSCODE_GOOD &&
+            response.resultsSize == tags.size()) {
+            for (size_t i = 0; i < tags.size(); ++i) {
+                const auto& result = response.results[i];
+                if (result.statusCode == UA_STATUSCODE_GOOD) {
+                    sub.items.push_back(
+                        {tags[i],
+                         result.monitoredItemId,
+                         result.revisedSamplingInterval,
+                         result.revisedQueueSize}
+                    );
+                }
+            }
+        }
+        const UA_StatusCode status = response.responseHeader.serviceResult;
+        UA_CreateMonitoredItemsResponse_clear(&response);
+        if (status != UA_STATUSCODE_GOOD) {
+            throw opcua::BadStatus{status};
+        }
+    }
+
+    // 取回检查点之后服务器仍保留的通知消息
+    void republish(SubscriptionCheckpoint& sub, opcua::Span<const UA_UInt32> available) {
+        std::vector<UA_UInt32> sequenceNumbers(available.begin(), available.end());
+        std::sort(sequenceNumbers.begin(), sequenceNumbers.end());
+        for (const auto seq : sequenceNumbers) {
+            if (seq > sub.lastSequenceNumber) {
+                UA_RepublishRequest request;
+                UA_RepublishRequest_init(&request);
+                request.subscriptionId = sub.subscriptionId;
+                request.retransmitSequenceNumber = seq;
+                UA_RepublishResponse response;
+                service(
+                    request,
+                    UA_TYPES[UA_TYPES_REPUBLISHREQUEST],
+                    response,
+                    UA_TYPES[UA_TYPES_REPUBLISHRESPONSE]
+                );
+                const bool ok = response.responseHeader.serviceResult == UA_STATUSCODE_GOOD;
+                if (ok) {
+                    dispatch(sub, response.notificationMessage);
+                    ++stats_.republished;
+                }
+                UA_RepublishResponse_clear(&response);
+                if (!ok) {
+                    // 未交付的消息不能确认，否则服务器会丢弃它；保留在服务器上，下次接管时再取
+                    ++stats_.republishFailed;
+                    continue;
+                }
+            }
+            // 已交付的消息，以及旧进程已处理但尚未确认的消息
+            pendingAcks_.push_back({sub.subscriptionId, seq});
+        }
+    }
+
+    bool sendPublish() {
+        std::vector<UA_SubscriptionAcknowledgement> acks;
+        acks.swap(pendingAcks_);
+        UA_PublishRequest request;
+        UA_PublishRequest_init(&request);
+        request.subscriptionAcknowledgements = acks.data();
+        request.subscriptionAcknowledgementsSize = acks.size();
+        auto owner = std::make_unique<std::weak_ptr<SubscriptionEngine*>>(alive_);
+        const UA_StatusCode status = __UA_Client_AsyncService(
+            client_.handle(),
+            &request,
+            &UA_TYPES[UA_TYPES_PUBLISHREQUEST],
+            onPublishResponse,
+            &UA_TYPES[UA_TYPES_PUBLISHRESPONSE],
+            owner.get(),
+            nullptr
+        );
+        if (status != UA_STATUSCODE_GOOD) {
+            pendingAcks_.insert(pendingAcks_.end(), acks.begin(), acks.end());
+            return false;
+        }
+        owner.release();  // 所有权交给回调
+        ++publishInFlight_;
+        return true;
+    }
+
+    static void onPublishResponse(UA_Client*, void* userdata, UA_UInt32, void* response) {
+        std::unique_ptr<std::weak_ptr<SubscriptionEngine*>> owner{
+            static_cast<std::weak_ptr<SubscriptionEngine*>*>(userdata)
+        };
+        const auto engine = owner->lock();
+        if (engine == nullptr) {
+            return;
+        }
+        (*engine)->handlePublishResponse(*static_cast<UA_PublishResponse*>(response));
+    }
+
+    void handlePublishResponse(UA_PublishResponse& response) {
+        --publishInFlight_;
+        const UA_StatusCode status = response.responseHeader.serviceResult;
+        if (status != UA_STATUSCODE_GOOD) {
+            // 超时、会话断开等情况下由 publish() 重新发送；立即重发只会得到同样的错误
+            ++stats_.publishErrors;
+            if (status == UA_STATUSCODE_BADTOOMANYPUBLISHREQUESTS) {
+                // 仍未完成的请求就是服务器接受的数量
+                publishLimit_ = std::max<size_t>(publishInFlight_, 1);
+            } else {
+                constexpr int64_t minBackoff = 100 * UA_DATETIME_MSEC;
+                const auto maxBackoff = static_cast<int64_t>(options_.publishingInterval * UA_DATETIME_MSEC);
+                publishBackoff_ = std::max(minBackoff, std::min(publishBackoff_ * 2, maxBackoff));
+                publishRetryAt_ = UA_DateTime_nowMonotonic() + publishBackoff_;
+            }
+            return;
+        }
+        publishRetryAt_ = 0;
+        publishBackoff_ = 0;
+        const auto it = index_.find(response.subscriptionId);
+        if (it == index_.end()) {
+            return;
+        }
+        auto& sub = subscriptions_[it->second];
+        const auto& message = response.notificationMessage;
+        if (message.notificationDataSize == 0) {
+            return;  // 保活消息，不需要确认
+        }
+        if (decodePool_ != nullptr) {
+            dispatchAsync(sub, response);
+            return;
+        }
+        dispatch(sub, message);
+        pendingAcks_.push_back({sub.subscriptionId, message.sequenceNumber});
+    }
+
+    void dispatch(SubscriptionCheckpoint& sub, const UA_NotificationMessage& message) {
+        ++stats_.notifications;
+        batch_.clear();
+        frameItems_.clear();
+        for (size_t i = 0; i < message.notificationDataSize; ++i) {
+            const UA_ExtensionObject& data = message.notificationData[i];
+            if (data.encoding < UA_EXTENSIONOBJECT_DECODED ||
+                data.content.decoded.type != &UA_TYPES[UA_TYPES_DATACHANGENOTIFICATION]) {
+                continue;
+            }
+            const auto* notification =
+                static_cast<const UA_DataChangeNotification*>(data.content.decoded.data);
+            for (size_t j = 0; j < notification->monitoredItemsSize; ++j) {
+                const auto& item = notification->monitoredItems[j];
+                if (!frameSinks_.empty()) {
+                    frameItems_.push_back({item.clientHandle, &item.value});
+                }
+                Sample sample{};
+                if (!sinks_.empty() && toSample(item.value, item.clientHandle, sample)) {
+                    batch_.push_back(sample);
+                }
+            }
+        }
+        sub.lastSequenceNumber = std::max(sub.lastSequenceNumber, message.sequenceNumber);
+        deliverFrame({sub.subscriptionId, message.sequenceNumber, message.publishTime, frameItems_});
+        deliver(batch_);
+    }
+
+    // 接管响应，交给线程池转换；客户端在回调返回后清理的是已置空的响应
+    void dispatchAsync(SubscriptionCheckpoint& sub, UA_PublishResponse& response) {
+        ++stats_.notifications;
+        std::shared_ptr<UA_PublishResponse> owned{
+            new UA_PublishResponse{response},
+            [](UA_PublishResponse* r) {
+                UA_PublishResponse_clear(r);
+                delete r;
+            }
+        };
+        UA_PublishResponse_init(&response);
+
+        // 把各 DataChangeNotification 的监控项看作一个连续数组
+        const auto& message = owned->notificationMessage;
+        std::vector<const UA_DataChangeNotification*> blocks;
+        std::vector<size_t> starts;
+        size_t count = 0;
+        for (size_t i = 0; i < message.notificationDataSize; ++i) {
+            const UA_ExtensionObject& data = message.notificationData[i];
+            if (data.encoding < UA_EXTENSIONOBJECT_DECODED ||
+                data.content.decoded.type != &UA_TYPES[UA_TYPES_DATACHANGENOTIFICATION]) {
+                continue;
+            }
+            const auto* notification =
+                static_cast<const UA_DataChangeNotification*>(data.content.decoded.data);
+            blocks.push_back(notification);
+            starts.push_back(count);
+            count += notification->monitoredItemsSize;
+        }
+
+        // 帧引用响应中的 DataValue，响应保留到交付之后，在本线程中释放
+        std::vector<FrameItem> frameItems;
+        if (!frameSinks_.empty()) {
+            frameItems.reserve(count);
+            for (const auto* block : blocks) {
+                for (size_t j = 0; j < block->monitoredItemsSize; ++j) {
+                    frameItems.push_back({block->monitoredItems[j].clientHandle, &block->monitoredItems[j].value});
+                }
+            }
+        }
+        const UA_SubscriptionAcknowledgement ack{sub.subscriptionId, message.sequenceNumber};
+        decodePool_->submit(
+            sinks_.empty() ? 0 : count,  // 只有 FrameSink 时不转换 Sample
+            [owned, blocks = std::move(blocks), starts = std::move(starts)](
+                size_t begin, size_t end, std::vector<Sample>& out
+            ) {
+                // begin 所在的 DataChangeNotification
+                size_t b = static_cast<size_t>(
+                    std::upper_bound(starts.begin(), starts.end(), begin) - starts.begin() - 1
+                );
+                for (size_t i = begin; i < end; ++i) {
+                    while (b + 1 < starts.size() && i >= starts[b + 1]) {
+                        ++b;
+                    }
+                    const auto& item = blocks[b]->monitoredItems[i - starts[b]];
+                    Sample sample{};
+                    if (toSample(item.value, item.clientHandle, sample)) {
+                        out.push_back(sample);
+                    }
+                }
+            },
+            [owner = std::weak_ptr<SubscriptionEngine*>{alive_},
+             ack,
+             publishTime = message.publishTime,
+             frameItems = std::move(frameItems),
+             keep = frameSinks_.empty() ? nullptr : owned](std::vector<Sample>& samples) {
+                const auto engine = owner.lock();
+                if (engine == nullptr) {
+                    return;  // 引擎已销毁；clear() 之前总是先交付，会话重建不会走到这里
+                }
+                (*engine)->deliverFrame({ack.subscriptionId, ack.sequenceNumber, publishTime, frameItems});
+                (*engine)->deliver(samples);
+                (*engine)->delivered(ack);
+            }
+        );
+        decodePool_->drain();
+    }
+
+    // 消息交付给写入目标之后才推进序号并确认；订阅按编号查找（交付前 subscriptions_ 可能已扩容）
+    void delivered(const UA_SubscriptionAcknowledgement& ack) {
+        const auto it = index_.find(ack.subscriptionId);
+        if (it != index_.end()) {
+            auto& sub = subscriptions_[it->second];
+            sub.lastSequenceNumber = std::max(sub.lastSequenceNumber, ack.sequenceNumber);
+        }
+        pendingAcks_.push_back(ack);
+    }
+
+    void deliverFrame(const PublishFrame& frame) {
+        if (frameSinks_.empty() || frame.items.size() == 0) {
+            return;
+        }
+        for (auto* sink : frameSinks_) {
+            sink->writeFrame(frame);
+        }
+        ++stats_.frames;
+    }
+
+    void deliver(const std::vector<Sample>& samples) {
+        if (samples.empty()) {
+            return;
+        }
+        for (auto& sink : sinks_) {
+            sink.sink->write(samples);
+            sink.offset += samples.size();
+        }
+        stats_.samples += samples.size();
+    }
+
+    opcua::Client& client_;
+    const TagTable& tags_;
+    SubscriptionEngineOptions options_;
+
+    std::vector<SubscriptionCheckpoint> subscriptions_;
+    std::unordered_map<uint32_t, size_t> index_;  // subscriptionId -> subscriptions_ 下标
+    std::vector<SinkEntry> sinks_;
+    std::vector<FrameSink*> frameSinks_;
+    std::vector<FrameItem> frameItems_;
+    std::vector<UA_SubscriptionAcknowledgement> pendingAcks_;
+    std::vector<Sample> batch_;
+    size_t publishInFlight_ = 0;
+    size_t publishLimit_ = std::numeric_limits<size_t>::max();  // 服务器每个会话接受的 Publish 请求数
+    int64_t publishRetryAt_ = 0;                                 // 单调时钟；0 表示不等待
+    int64_t publishBackoff_ = 0;
+    DecodePool* decodePool_ = nullptr;
+
+    std::shared_ptr<SubscriptionEngine*> alive_ = std::make_shared<SubscriptionEngine*>(this);
+    SubscriptionEngineStats stats_;
+};
@@ -0,0 +1,347 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+#include "collector_types.hpp"
+#include "segment_codec.hpp"
+#include "simd_kernels.hpp"
+
+// 块摘要：封块时计算，完全落在查询区间内的块直接使用摘要，不解压
+struct BlockSummary {
+    int64_t firstTime = 0;
+    int64_t lastTime = 0;
+    uint32_t count = 0;
+    double min = 0.0;
+    double max = 0.0;
+    double sum = 0.0;
+    double integral = 0.0;  // Σ v[i] × (t[i+1] − t[i])，块内相邻采样之间（单位 100ns）
+    double firstValue = 0.0;
+    double lastValue = 0.0;
+};
+
+// 聚合结果
+struct Aggregate {
+    uint64_t count = 0;
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+    double sum = 0.0;
+    double integral = 0.0;  // 保持采样（sample-and-hold）下的值 × 时间
+    int64_t duration = 0;   // 积分覆盖的时间（100ns）
+    uint32_t summaryBlocks = 0;  // 直接使用摘要的块数
+    uint32_t decodedBlocks = 0;  // 解压的块数
+
+    double avg() const noexcept {
+        return count > 0 ? sum / static_cast<double>(count) : 0.0;
+    }
+
+    /// 时间加权平均值
+    double timeWeightedAvg() const noexcept {
+        return duration > 0 ? integral / static_cast<double>(duration) : avg();
+    }
+};
+
+struct TagBlockStoreOptions {
+    Codec codec = Codec::None;
+    int level = 1;               // zstd 压缩级别
+    size_t blockSamples = 1024;  // 每块的采样数：解压后的时间和值约 16 KiB，可留在 L1/L2 缓存中
+};
+
+/**
+ * @brief 按 tag 分块压缩的时序存储，支持区间聚合查询
+ *
+ * - 每个 tag 的采样按时间追加，凑满 blockSamples 个后封块：计算摘要、按列编码并压缩
+ * - 查询 [from, to) 时，完全落在区间内的块只读摘要；跨越区间边界的块解压到线程局部的
+ *   小缓冲区，用 simd_kernels.hpp 的向量化函数计算
+ * - 只保存状态为 Good 的采样；早于该 tag 最新时间戳的采样被丢弃（乱序数据请使用 LocalHistoryStore）
+ * - 时间加权平均按保持采样计算：每个值一直有效到下一个采样，最后一个采样之后不计入
+ */
+class TagBlockStore : public HistorySink {
+public:
+    explicit TagBlockStore(TagBlockStoreOptions options = {})
+        : options_{options} {
+        if (!codecAvailable(options_.codec)) {
+            throw std::runtime_error{std::string{"codec not available: "} + codecName(options_.codec)};
+        }
+    }
+
+    void write(opcua::Span<const Sample> samples) override {
+        std::unique_lock lock{mutex_};
+        for (const auto& sample : samples) {
+            if ((sample.status & 0xC0000000) != 0) {
+                ++skipped_;
+                continue;
+            }
+            if (sample.tag >= series_.size()) {
+                series_.resize(static_cast<size_t>(sample.tag) + 1);
+            }
+            auto& series = series_[sample.tag];
+            const int64_t time = sampleTime(sample);
+            if (series.hasData && time <= series.lastTime) {
+                ++skipped_;
+                continue;
+            }
+            series.hasData = true;
+            series.lastTime = time;
+            series.openTimes.push_back(time);
+            series.openValues.push_back(sample.value);
+            if (series.openTimes.size() >= options_.blockSamples) {
+                seal(series);
+            }
+        }
+    }
+
+    /// 一个 tag 在 [from, to) 内的聚合值
+    Aggregate aggregate(TagHandle tag, int64_t from, int64_t to) const {
+        std::shared_lock lock{mutex_};
+        Aggregate result;
+        if (tag < series_.size() && from < to) {
+            query(series_[tag], from, to, result);
+        }
+        return result;
+    }
+
+    /// 多个 tag 的聚合值，结果顺序与 tags 相同
+    std::vector<Aggregate> aggregate(opcua::Span<const TagHandle> tags, int64_t from, int64_t to) const {
+        std::shared_lock lock{mutex_};
+        std::vector<Aggregate> results(tags.size());
+        for (size_t i = 0; i < tags.size(); ++i) {
+            if (tags[i] < series_.size() && from < to) {
+                query(series_[tags[i]], from, to, results[i]);
+            }
+        }
+        return results;
+    }
+
+    uint64_t sampleCount() const {
+        std::shared_lock lock{mutex_};
+        uint64_t count = 0;
+        for (const auto& series : series_) {
+            for (const auto& summary : series.summaries) {
+                count += summary.count;
+            }
+            count += series.openTimes.size();
+        }
+        return count;
+    }
+
+    /// 压缩块的字节数（不含未封块的缓冲区）
+    uint64_t compressedBytes() const {
+        std::shared_lock lock{mutex_};
+        uint64_t bytes = 0;
+        for (const auto& series : series_) {
+            for (const auto& block : series.blocks) {
+                bytes += block.size();
+            }
+        }
+        return bytes;
+    }
+
+    /// 被丢弃的非 Good 或乱序采样数
+    uint64_t skippedSamples() const {
+        std::shared_lock lock{mutex_};
+        return skipped_;
+    }
+
+private:
+    struct Series {
+        std::vector<BlockSummary> summaries;        // 与 blocks 一一对应，按时间排序
+        std::vector<std::vector<uint8_t>> blocks;  // 压缩后的块：时间差值列 + 值列
+        std::vector<int64_t> openTimes;             // 未封块的采样
+        std::vector<double> openValues;
+        int64_t lastTime = 0;
+        bool hasData = false;
+    };
+
+    // 解压缓冲区，每个查询线程一份
+    struct Scratch {
+        BlockCompressor compressor;
+        std::vector<uint8_t> raw;
+        std::vector<int64_t> times;
+        std::vector<double> values;
+        std::vector<double> durations;  // durations[i] = times[i + 1] − times[i]
+    };
+
+    static Scratch& scratch() {
+        thread_local Scratch instance;
+        return instance;
+    }
+
+    // 保持采样的积分状态：value 从 start 起有效
+    struct Hold {
+        bool active = false;
+        double value = 0.0;
+        int64_t start = 0;
+
+        // 到 time 为止的一段
+        void advance(int64_t time, Aggregate& result) noexcept {
+            if (active && time > start) {
+                result.integral += value * static_cast<double>(time - start);
+                result.duration += time - start;
+            }
+        }
+    };
+
+    void seal(Series& series) {
+        const size_t n = series.openTimes.size();
+        auto& s = scratch();
+        s.durations.resize(n);
+        for (size_t i = 0; i + 1 < n; ++i) {
+            s.durations[i] = static_cast<double>(series.openTimes[i + 1] - series.openTimes[i]);
+        }
+
+        BlockSummary summary;
+        simd::MinMaxSum mms;
+        simd::minMaxSum(series.openValues.data(), n, mms);
+        summary.firstTime = series.openTimes.front();
+        summary.lastTime = series.openTimes.back();
+        summary.count = static_cast<uint32_t>(n);
+        summary.min = mms.min;
+        summary.max = mms.max;
+        summary.sum = mms.sum;
+        summary.integral = simd::dot(series.openValues.data(), s.durations.data(), n - 1);
+        summary.firstValue = series.openValues.front();
+        summary.lastValue = series.openValues.back();
+
+        s.raw.clear();
+        int64_t previous = 0;
+        for (const int64_t time : series.openTimes) {
+            segment_detail::put(s.raw, time - previous);
+            previous = time;
+        }
+        const auto offset = s.raw.size();
+        s.raw.resize(offset + n * sizeof(double));
+        std::memcpy(s.raw.data() + offset, series.openValues.data(), n * sizeof(double));
+
+        std::vector<uint8_t> block;
+        s.compressor.compress(options_.codec, options_.level, nullptr, s.raw, block);
+        block.shrink_to_fit();
+        series.summaries.push_back(summary);
+        series.blocks.push_back(std::move(block));
+        series.openTimes.clear();
+        series.openValues.clear();
+    }
+
+    void decode(const Series& series, size_t index, Scratch& s) const {
+        const size_t n = series.summaries[index].count;
+        const auto& block = series.blocks[index];
+        s.compressor.decompress(
+            options_.codec, nullptr, block.data(), block.size(), n * (sizeof(int64_t) + sizeof(double)), s.raw
+        );
+        s.times.resize(n);
+        s.values.resize(n);
+        s.durations.resize(n);
+        const uint8_t* data = s.raw.data();
+        int64_t time = 0;
+        for (size_t i = 0; i < n; ++i) {
+            const auto delta = segment_detail::get<int64_t>(data);
+            time += delta;
+            s.times[i] = time;
+            if (i > 0) {
+                s.durations[i - 1] = static_cast<double>(delta);
+            }
+        }
+        std::memcpy(s.values.data(), data, n * sizeof(double));
+    }
+
+    /**
+     * @brief 处理一段已解压的采样
+     *
+     * @return true 表示已遇到 to 之后的采样，查询结束
+     */
+    static bool scan(
+        const int64_t* times,
+        const double* values,
+        const double* durations,
+        size_t n,
+        int64_t from,
+        int64_t to,
+        Hold& hold,
+        Aggregate& result
+    ) {
+        const size_t first = static_cast<size_t>(std::lower_bound(times, times + n, from) - times);
+        const size_t last = static_cast<size_t>(std::lower_bound(times + first, times + n, to) - times);
+        if (first > 0) {
+            hold = {true, values[first - 1], from};  // 区间起点之前的最后一个采样
+        }
+        if (last > first) {
+            hold.advance(times[first], result);
+            simd::MinMaxSum mms{result.min, result.max, 0.0};
+            simd::minMaxSum(values + first, last - first, mms);
+            result.count += last - first;
+            result.min = mms.min;
+            result.max = mms.max;
+            result.sum += mms.sum;
+            result.integral += simd::dot(values + first, durations + first, last - first - 1);
+            result.duration += times[last - 1] - times[first];
+            hold = {true, values[last - 1], times[last - 1]};
+        }
+        if (last < n) {
+            hold.advance(to, result);
+            return true;
+        }
+        return false;
+    }
+
+    void query(const Series& series, int64_t from, int64_t to, Aggregate& result) const {
+        const auto& summaries = series.summaries;
+        // 第一个 lastTime >= from 的块
+        size_t index = static_cast<size_t>(
+            std::lower_bound(
+                summaries.begin(),
+                summaries.end(),
+                from,
+                [](const BlockSummary& summary, int64_t time) { return summary.lastTime < time; }
+            ) -
+            summaries.begin()
+        );
+        Hold hold;
+        if (index > 0) {
+            hold = {true, summaries[index - 1].lastValue, from};
+        }
+
+        auto& s = scratch();
+        for (; index < summaries.size(); ++index) {
+            const auto& summary = summaries[index];
+            if (summary.firstTime >= to) {
+                hold.advance(to, result);
+                return;
+            }
+            if (summary.firstTime >= from && summary.lastTime < to) {
+                hold.advance(summary.firstTime, result);
+                result.count += summary.count;
+                result.min = std::min(result.min, summary.min);
+                result.max = std::max(result.max, summary.max);
+                result.sum += summary.sum;
+                result.integral += summary.integral;
+                result.duration += summary.lastTime - summary.firstTime;
+                hold = {true, summary.lastValue, summary.lastTime};
+                ++result.summaryBlocks;
+                continue;
+            }
+            decode(series, index, s);
+            ++result.decodedBlocks;
+            if (scan(s.times.data(), s.values.data(), s.durations.data(), s.times.size(), from, to, hold, result)) {
+                return;
+            }
+        }
+
+        // 未封块的采样
+        const size_t n = series.openTimes.size();
+        s.durations.resize(n);
+        for (size_t i = 0; i + 1 < n; ++i) {
+            s.durations[i] = static_cast<double>(series.openTimes[i + 1] - series.openTimes[i]);
+        }
+        scan(series.openTimes.data(), series.openValues.data(), s.durations.data(), n, from, to, hold, result);
+    }
+
+    TagBlockStoreOptions options_;
+    mutable std::shared_mutex mutex_;
+    std::vector<Series> series_;  // 按 TagHandle 索引
+    uint64_t skipped_ = 0;
+};
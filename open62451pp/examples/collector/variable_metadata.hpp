@@ -0,0 +1,285 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "address_space.hpp"
+#include "checkpoint.hpp"
+
+// 变量元数据缓存
+// - 与 AddressSpaceSnapshot 使用同一套 NodeIndex，各属性按列保存
+// - EngineeringUnits 和枚举定义使用去重后的小表，变量只保存表中的下标
+// - 数组维度放在一个共享的数组中，变量保存起点和个数
+
+struct EngineeringUnit {
+    std::string namespaceUri;
+    int32_t unitId = 0;  // UNECE 单位代码，例如 4408652（°C）
+    std::string displayName;
+    std::string description;
+};
+
+struct EnumEntry {
+    int64_t value;
+    std::string name;
+};
+
+class VariableMetadataCache {
+public:
+    static constexpr uint32_t none = UINT32_MAX;
+
+    /// 扩展到 n 个节点，新节点为未采集状态
+    void resize(size_t n) {
+        flags_.resize(n, 0);
+        valueRanks_.resize(n, -1);
+        accessLevels_.resize(n, 0);
+        dimOffsets_.resize(n, 0);
+        dimCounts_.resize(n, 0);
+        units_.resize(n, none);
+        euLow_.resize(n, std::numeric_limits<double>::quiet_NaN());
+        euHigh_.resize(n, std::numeric_limits<double>::quiet_NaN());
+        enumerations_.resize(n, none);
+    }
+
+    size_t size() const noexcept {
+        return flags_.size();
+    }
+
+    /// 是否已读取过该节点的属性；快照同步后新增的节点在重新采集前返回 false
+    bool harvested(NodeIndex node) const noexcept {
+        return node < flags_.size() && (flags_[node] & harvestedFlag) != 0;
+    }
+
+    int32_t valueRank(NodeIndex node) const {
+        return valueRanks_[node];
+    }
+
+    opcua::Span<const uint32_t> arrayDimensions(NodeIndex node) const {
+        return {dims_.data() + dimOffsets_[node], dimCounts_[node]};
+    }
+
+    /// UA_ACCESSLEVELMASK_* 的组合
+    uint8_t accessLevel(NodeIndex node) const {
+        return accessLevels_[node];
+    }
+
+    /// 没有 EngineeringUnits 属性时返回 nullptr
+    const EngineeringUnit* engineeringUnits(NodeIndex node) const {
+        return units_[node] != none ? &unitTable_[units_[node]] : nullptr;
+    }
+
+    /// EURange 属性 (low, high)
+    std::optional<std::pair<double, double>> euRange(NodeIndex node) const {
+        if ((flags_[node] & rangeFlag) == 0) {
+            return std::nullopt;
+        }
+        return std::make_pair(euLow_[node], euHigh_[node]);
+    }
+
+    /// 枚举定义的下标；变量自身的 EnumStrings 优先，其次是其 DataType 的 EnumStrings/EnumValues
+    uint32_t enumerationOf(NodeIndex node) const {
+        return enumerations_[node];
+    }
+
+    std::vector<EnumEntry> enumeration(uint32_t index) const {
+        std::vector<EnumEntry> entries;
+        for (uint32_t i = enumOffsets_[index]; i < enumOffsets_[index + 1]; ++i) {
+            entries.push_back({enumValues_[i], enumNames_[i]});
+        }
+        return entries;
+    }
+
+    /// 枚举值对应的名称；不是枚举或没有该值时返回 nullptr
+    const std::string* enumName(NodeIndex node, int64_t value) const {
+        const uint32_t index = enumerations_[node];
+        if (index == none) {
+            return nullptr;
+        }
+        for (uint32_t i = enumOffsets_[index]; i < enumOffsets_[index + 1]; ++i) {
+            if (enumValues_[i] == value) {
+                return &enumNames_[i];
+            }
+        }
+        return nullptr;
+    }
+
+    size_t unitCount() const noexcept {
+        return unitTable_.size();
+    }
+
+    size_t enumerationCount() const noexcept {
+        return enumOffsets_.empty() ? 0 : enumOffsets_.size() - 1;
+    }
+
+    void setAttributes(
+        NodeIndex node, int32_t valueRank, opcua::Span<const uint32_t> dimensions, uint8_t accessLevel
+    ) {
+        flags_[node] |= harvestedFlag;
+        valueRanks_[node] = valueRank;
+        accessLevels_[node] = accessLevel;
+        if (dimensions.size() != dimCounts_[node]) {
+            dimOffsets_[node] = static_cast<uint32_t>(dims_.size());
+            dimCounts_[node] = static_cast<uint32_t>(dimensions.size());
+            dims_.insert(dims_.end(), dimensions.begin(), dimensions.end());
+        } else {
+            std::copy(dimensions.begin(), dimensions.end(), dims_.begin() + dimOffsets_[node]);
+        }
+    }
+
+    void setEngineeringUnits(NodeIndex node, const EngineeringUnit& unit) {
+        const std::string key = unitKey(unit);
+        auto it = unitIndex_.find(key);
+        if (it == unitIndex_.end()) {
+            it = unitIndex_.emplace(key, static_cast<uint32_t>(unitTable_.size())).first;
+            unitTable_.push_back(unit);
+        }
+        units_[node] = it->second;
+    }
+
+    void setRange(NodeIndex node, double low, double high) {
+        flags_[node] |= rangeFlag;
+        euLow_[node] = low;
+        euHigh_[node] = high;
+    }
+
+    /// 登记一个枚举定义，相同的定义只保存一次
+    uint32_t addEnumeration(const std::vector<EnumEntry>& entries) {
+        std::string key;
+        for (const auto& entry : entries) {
+            appendEnumKey(key, entry.value, entry.name);
+        }
+        const auto it = enumIndex_.find(key);
+        if (it != enumIndex_.end()) {
+            return it->second;
+        }
+        if (enumOffsets_.empty()) {
+            enumOffsets_.push_back(0);
+        }
+        for (const auto& entry : entries) {
+            enumValues_.push_back(entry.value);
+            enumNames_.push_back(entry.name);
+        }
+        enumOffsets_.push_back(static_cast<uint32_t>(enumValues_.size()));
+        const auto index = static_cast<uint32_t>(enumOffsets_.size() - 2);
+        enumIndex_.emplace(std::move(key), index);
+        return index;
+    }
+
+    void setEnumeration(NodeIndex node, uint32_t index) {
+        enumerations_[node] = index;
+    }
+
+    void save(checkpoint_detail::Writer& writer) const {
+        writer.pods(flags_);
+        writer.pods(valueRanks_);
+        writer.pods(accessLevels_);
+        writer.pods(dimOffsets_);
+        writer.pods(dimCounts_);
+        writer.pods(dims_);
+        writer.pods(units_);
+        writer.pods(euLow_);
+        writer.pods(euHigh_);
+        writer.pods(enumerations_);
+        writer.pod(static_cast<uint32_t>(unitTable_.size()));
+        for (const auto& unit : unitTable_) {
+            writer.string(unit.namespaceUri);
+            writer.pod(unit.unitId);
+            writer.string(unit.displayName);
+            writer.string(unit.description);
+        }
+        writer.pods(enumOffsets_);
+        writer.pods(enumValues_);
+        writer.pod(static_cast<uint32_t>(enumNames_.size()));
+        for (const auto& name : enumNames_) {
+            writer.string(name);
+        }
+    }
+
+    /// 读取 save() 写出的内容；各列长度不一致时返回 false，缓存保持为空
+    bool load(checkpoint_detail::Reader& reader) {
+        VariableMetadataCache loaded;
+        loaded.flags_ = reader.pods<uint8_t>();
+        loaded.valueRanks_ = reader.pods<int32_t>();
+        loaded.accessLevels_ = reader.pods<uint8_t>();
+        loaded.dimOffsets_ = reader.pods<uint32_t>();
+        loaded.dimCounts_ = reader.pods<uint32_t>();
+        loaded.dims_ = reader.pods<uint32_t>();
+        loaded.units_ = reader.pods<uint32_t>();
+        loaded.euLow_ = reader.pods<double>();
+        loaded.euHigh_ = reader.pods<double>();
+        loaded.enumerations_ = reader.pods<uint32_t>();
+        loaded.unitTable_.resize(reader.pod<uint32_t>());
+        for (auto& unit : loaded.unitTable_) {
+            unit.namespaceUri = reader.string();
+            unit.unitId = reader.pod<int32_t>();
+            unit.displayName = reader.string();
+            unit.description = reader.string();
+        }
+        loaded.enumOffsets_ = reader.pods<uint32_t>();
+        loaded.enumValues_ = reader.pods<int64_t>();
+        loaded.enumNames_.resize(reader.pod<uint32_t>());
+        for (auto& name : loaded.enumNames_) {
+            name = reader.string();
+        }
+        const size_t n = loaded.flags_.size();
+        if (!reader.ok() || loaded.valueRanks_.size() != n || loaded.accessLevels_.size() != n ||
+            loaded.dimOffsets_.size() != n || loaded.dimCounts_.size() != n || loaded.units_.size() != n ||
+            loaded.euLow_.size() != n || loaded.euHigh_.size() != n || loaded.enumerations_.size() != n ||
+            loaded.enumNames_.size() != loaded.enumValues_.size()) {
+            *this = {};
+            return false;
+        }
+        // 去重表不保存，加载时重建
+        for (uint32_t i = 0; i < loaded.unitTable_.size(); ++i) {
+            loaded.unitIndex_.emplace(unitKey(loaded.unitTable_[i]), i);
+        }
+        for (uint32_t e = 0; e + 1 < loaded.enumOffsets_.size(); ++e) {
+            std::string key;
+            for (uint32_t i = loaded.enumOffsets_[e]; i < loaded.enumOffsets_[e + 1]; ++i) {
+                appendEnumKey(key, loaded.enumValues_[i], loaded.enumNames_[i]);
+            }
+            loaded.enumIndex_.emplace(std::move(key), e);
+        }
+        *this = std::move(loaded);
+        return true;
+    }
+
+private:
+    static constexpr uint8_t harvestedFlag = 1;
+    static constexpr uint8_t rangeFlag = 2;
+
+    static std::string unitKey(const EngineeringUnit& unit) {
+        return unit.namespaceUri + '\n' + std::to_string(unit.unitId) + '\n' + unit.displayName + '\n' +
+            unit.description;
+    }
+
+    static void appendEnumKey(std::string& key, int64_t value, const std::string& name) {
+        key += std::to_string(value);
+        key += '=';
+        key += name;
+        key += '\n';
+    }
+
+    std::vector<uint8_t> flags_;
+    std::vector<int32_t> valueRanks_;
+    std::vector<uint8_t> accessLevels_;
+    std::vector<uint32_t> dimOffsets_;  // 节点的数组维度为 dims_[dimOffsets_[i], dimOffsets_[i] + dimCounts_[i])
+    std::vector<uint32_t> dimCounts_;
+    std::vector<uint32_t> dims_;
+    std::vector<uint32_t> units_;  // unitTable_ 的下标
+    std::vector<double> euLow_;
+    std::vector<double> euHigh_;
+    std::vector<uint32_t> enumerations_;  // 枚举定义的下标
+
+    std::vector<EngineeringUnit> unitTable_;
+    std::unordered_map<std::string, uint32_t> unitIndex_;
+    std::vector<uint32_t> enumOffsets_;  // 定义 e 为 [enumOffsets_[e], enumOffsets_[e + 1])
+    std::vector<int64_t> enumValues_;
+    std::vector<std::string> enumNames_;
+    std::unordered_map<std::string, uint32_t> enumIndex_;
+};
@@ -0,0 +1,667 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <open62541/types.h>
+#include <open62541/types_generated_handling.h>
+
+#include <open62541pp/types.hpp>
+
+// 编译后的事件过滤器
+// - ContentFilter 只编译一次，生成后缀形式的扁平指令序列
+// - SimpleAttributeOperand 在编译期解析为事件字段槽位（FieldSlot）
+// - OfType 在编译期展开为类型及其全部子类型的集合
+// - 按批求值：每条指令一次处理整批事件
+// - 内容相同的过滤器共享同一个编译结果
+
+namespace compiled_filter {
+
+using FieldSlot = uint32_t;
+
+// 事件字段的标量值（求值时使用）
+struct Scalar {
+    enum class Kind : uint8_t { Null, Bool, Number, Text, Node };
+
+    Kind kind = Kind::Null;
+    double number = 0.0;
+    std::string_view text;
+    const UA_NodeId* node = nullptr;
+
+    static Scalar fromBool(bool value) noexcept {
+        Scalar s;
+        s.kind = Kind::Bool;
+        s.number = value ? 1.0 : 0.0;
+        return s;
+    }
+
+    bool isTrue() const noexcept {
+        return kind == Kind::Bool && number != 0.0;
+    }
+};
+
+// 从 Variant 提取标量值；字符串和 NodeId 引用 Variant 内部的内存
+inline Scalar toScalar(const UA_Variant& var) noexcept {
+    Scalar s;
+    if (var.type == nullptr || var.data == nullptr || !UA_Variant_isScalar(&var)) {
+        return s;
+    }
+    const void* data = var.data;
+    switch (var.type->typeKind) {
+    case UA_DATATYPEKIND_BOOLEAN:
+        return Scalar::fromBool(*static_cast<const UA_Boolean*>(data));
+    case UA_DATATYPEKIND_SBYTE: s.number = *static_cast<const UA_SByte*>(data); break;
+    case UA_DATATYPEKIND_BYTE: s.number = *static_cast<const UA_Byte*>(data); break;
+    case UA_DATATYPEKIND_INT16: s.number = *static_cast<const UA_Int16*>(data); break;
+    case UA_DATATYPEKIND_UINT16: s.number = *static_cast<const UA_UInt16*>(data); break;
+    case UA_DATATYPEKIND_INT32: s.number = *static_cast<const UA_Int32*>(data); break;
+    case UA_DATATYPEKIND_UINT32: s.number = *static_cast<const UA_UInt32*>(data); break;
+    case UA_DATATYPEKIND_INT64:
+        s.number = static_cast<double>(*static_cast<const UA_Int64*>(data));
+        break;
+    case UA_DATATYPEKIND_UINT64:
+        s.number = static_cast<double>(*static_cast<const UA_UInt64*>(data));
+        break;
+    case UA_DATATYPEKIND_FLOAT: s.number = *static_cast<const UA_Float*>(data); break;
+    case UA_DATATYPEKIND_DOUBLE: s.number = *static_cast<const UA_Double*>(data); break;
+    case UA_DATATYPEKIND_DATETIME:
+        s.number = static_cast<double>(*static_cast<const UA_DateTime*>(data));
+        break;
+    case UA_DATATYPEKIND_STRING: {
+        const auto* str = static_cast<const UA_String*>(data);
+        s.kind = Scalar::Kind::Text;
+        s.text = {reinterpret_cast<const char*>(str->data), str->length};
+        return s;
+    }
+    case UA_DATATYPEKIND_LOCALIZEDTEXT: {
+        const auto* lt = static_cast<const UA_LocalizedText*>(data);
+        s.kind = Scalar::Kind::Text;
+        s.text = {reinterpret_cast<const char*>(lt->text.data), lt->text.length};
+        return s;
+    }
+    case UA_DATATYPEKIND_NODEID:
+        s.kind = Scalar::Kind::Node;
+        s.node = static_cast<const UA_NodeId*>(data);
+        return s;
+    default:
+        return s;
+    }
+    s.kind = Scalar::Kind::Number;
+    return s;
+}
+
+// 比较两个标量：返回 -1/0/1，类型不可比较时返回 2
+inline int compare(const Scalar& a, const Scalar& b) noexcept {
+    if (a.kind == Scalar::Kind::Null || b.kind == Scalar::Kind::Null) {
+        return 2;
+    }
+    const bool aNum = a.kind == Scalar::Kind::Number || a.kind == Scalar::Kind::Bool;
+    const bool bNum = b.kind == Scalar::Kind::Number || b.kind == Scalar::Kind::Bool;
+    if (aNum && bNum) {
+        return a.number < b.number ? -1 : (a.number > b.number ? 1 : 0);
+    }
+    if (a.kind == Scalar::Kind::Text && b.kind == Scalar::Kind::Text) {
+        const int r = a.text.compare(b.text);
+        return r < 0 ? -1 : (r > 0 ? 1 : 0);
+    }
+    if (a.kind == Scalar::Kind::Node && b.kind == Scalar::Kind::Node) {
+        return UA_NodeId_equal(a.node, b.node) ? 0 : 2;
+    }
+    return 2;
+}
+
+/**
+ * @brief 事件字段注册表
+ *
+ * 把 SimpleAttributeOperand 的浏览路径和属性ID映射为固定的槽位编号。
+ * 事件生产者按槽位填充字段，过滤器编译时把操作数解析为槽位。
+ * 槽位 0 固定为 EventType。
+ */
+class FieldRegistry {
+public:
+    static constexpr FieldSlot eventTypeSlot = 0;
+
+    FieldRegistry() {
+        slot("0:EventType");
+    }
+
+    /// 按路径键（如 "0:Severity"）获取或分配槽位
+    FieldSlot slot(const std::string& key) {
+        std::lock_guard lock{mutex_};
+        const auto [it, inserted] = slots_.emplace(key, static_cast<FieldSlot>(slots_.size()));
+        return it->second;
+    }
+
+    /// 由 SimpleAttributeOperand 计算路径键
+    static std::string key(const UA_SimpleAttributeOperand& operand) {
+        std::string result;
+        for (size_t i = 0; i < operand.browsePathSize; ++i) {
+            const auto& qn = operand.browsePath[i];
+            if (i > 0) {
+                result += '/';
+            }
+            result += std::to_string(qn.namespaceIndex);
+            result += ':';
+            result.append(reinterpret_cast<const char*>(qn.name.data), qn.name.length);
+        }
+        if (operand.attributeId != UA_ATTRIBUTEID_VALUE) {
+            result += '#';
+            result += std::to_string(operand.attributeId);
+        }
+        return result;
+    }
+
+    size_t size() const {
+        std::lock_guard lock{mutex_};
+        return slots_.size();
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, FieldSlot> slots_;
+};
+
+/**
+ * @brief 一批事件（列式存储）
+ *
+ * 每个字段槽位一列，列中按事件顺序保存 Variant。
+ * 求值前每个被引用的列只转换一次为 Scalar 列，供所有过滤器共享。
+ */
+class EventBatch {
+public:
+    explicit EventBatch(const FieldRegistry& registry)
+        : registry_{registry} {}
+
+    /// 追加一个事件，返回行号
+    size_t addEvent(const opcua::NodeId& eventType) {
+        const size_t row = rows_++;
+        set(row, FieldRegistry::eventTypeSlot, opcua::Variant{eventType});
+        return row;
+    }
+
+    void set(size_t row, FieldSlot slot, opcua::Variant value) {
+        if (slot >= columns_.size()) {
+            columns_.resize(std::max<size_t>(slot + 1, registry_.size()));
+        }
+        auto& column = columns_[slot];
+        if (column.size() < rows_) {
+            column.resize(rows_);
+        }
+        column[row] = std::move(value);
+        if (slot < scalars_.size()) {
+            scalars_[slot].clear();  // 标记标量列需要重新生成
+        }
+    }
+
+    const opcua::Variant* get(size_t row, FieldSlot slot) const {
+        if (slot >= columns_.size() || row >= columns_[slot].size()) {
+            return nullptr;
+        }
+        return &columns_[slot][row];
+    }
+
+    size_t size() const noexcept {
+        return rows_;
+    }
+
+    /// 获取标量列（按需生成，批内只转换一次）
+    const std::vector<Scalar>& scalars(FieldSlot slot) const {
+        if (slot >= scalars_.size()) {
+            scalars_.resize(slot + 1);
+        }
+        auto& column = scalars_[slot];
+        if (column.size() != rows_) {
+            column.assign(rows_, Scalar{});
+            if (slot < columns_.size()) {
+                const auto& values = columns_[slot];
+                for (size_t i = 0; i < values.size(); ++i) {
+                    column[i] = toScalar(*values[i].handle());
+                }
+            }
+        }
+        return column;
+    }
+
+    void clear() {
+        rows_ = 0;
+        columns_.clear();
+        scalars_.clear();
+    }
+
+private:
+    const FieldRegistry& registry_;
+    size_t rows_ = 0;
+    std::vector<std::vector<opcua::Variant>> columns_;
+    mutable std::vector<std::vector<Scalar>> scalars_;
+};
+
+// 返回类型本身及其所有子类型（用于展开 OfType）
+using SubtypeResolver = std::function<std::vector<opcua::NodeId>(const opcua::NodeId& type)>;
+
+/**
+ * @brief 编译后的过滤器程序
+ */
+class CompiledFilter {
+public:
+    enum class Op : uint8_t {
+        PushField,    // arg: 字段槽位
+        PushLiteral,  // arg: 常量索引
+        PushResult,   // arg: 已求值元素的结果列（被多个 ElementOperand 引用的元素只求值一次）
+        Equals,
+        GreaterThan,
+        LessThan,
+        GreaterThanOrEqual,
+        LessThanOrEqual,
+        IsNull,
+        Not,
+        And,
+        Or,
+        Between,
+        InList,  // arg: 列表元素数量
+        OfType,  // arg: 类型集合索引
+    };
+
+    struct Instruction {
+        Op op;
+        uint32_t arg;
+    };
+
+    /// 编译 EventFilter（where 子句编译为指令，select 子句解析为槽位）
+    static CompiledFilter compile(
+        const UA_EventFilter& filter, FieldRegistry& registry, const SubtypeResolver& resolver
+    ) {
+        CompiledFilter program;
+        for (size_t i = 0; i < filter.selectClausesSize; ++i) {
+            program.selectSlots_.push_back(registry.slot(FieldRegistry::key(filter.selectClauses[i])));
+        }
+        if (filter.whereClause.elementsSize > 0) {
+            Compiler compiler{filter.whereClause, registry, resolver, program, 0};
+            compiler.results.assign(filter.whereClause.elementsSize, Compiler::noResult);
+            compiler.element(0, 0);
+        }
+        return program;
+    }
+
+    /// 对整批事件求值，matches[i] 表示第 i 个事件是否满足过滤条件
+    void evaluate(const EventBatch& batch, std::vector<uint8_t>& matches) const {
+        const size_t n = batch.size();
+        matches.assign(n, 1);
+        if (code_.empty() || n == 0) {
+            return;
+        }
+
+        // 栈中的每一项是一列：字段列直接引用批中的标量列，常量列广播单个值
+        struct Column {
+            const Scalar* data;
+            bool broadcast;
+            Scalar at(size_t i) const noexcept {
+                return broadcast ? data[0] : data[i];
+            }
+        };
+        std::vector<Column> stack;
+        stack.reserve(maxDepth_);
+        std::vector<std::vector<Scalar>> scratch(resultColumns_);
+        size_t scratchUsed = 0;
+
+        auto result = [&]() -> std::vector<Scalar>& {
+            auto& column = scratch[scratchUsed++];
+            column.resize(n);
+            return column;
+        };
+        auto pop = [&] {
+            const Column c = stack.back();
+            stack.pop_back();
+            return c;
+        };
+
+        for (const auto& ins : code_) {
+            switch (ins.op) {
+            case Op::PushField:
+                stack.push_back({batch.scalars(ins.arg).data(), false});
+                break;
+            case Op::PushLiteral:
+                stack.push_back({&literalScalars_[ins.arg], true});
+                break;
+            case Op::PushResult:
+                stack.push_back({scratch[ins.arg].data(), false});  // scratch 不再扩容，data() 保持有效
+                break;
+            case Op::Equals:
+            case Op::GreaterThan:
+            case Op::LessThan:
+            case Op::GreaterThanOrEqual:
+            case Op::LessThanOrEqual: {
+                const Column b = pop();
+                const Column a = pop();
+                auto& out = result();
+                for (size_t i = 0; i < n; ++i) {
+                    const int c = compare(a.at(i), b.at(i));
+                    bool r = false;
+                    switch (ins.op) {
+                    case Op::Equals: r = c == 0; break;
+                    case Op::GreaterThan: r = c == 1; break;
+                    case Op::LessThan: r = c == -1; break;
+                    case Op::GreaterThanOrEqual: r = c == 0 || c == 1; break;
+                    default: r = c == 0 || c == -1; break;
+                    }
+                    out[i] = Scalar::fromBool(r);
+                }
+                stack.push_back({out.data(), false});
+                break;
+            }
+            case Op::IsNull:
+            case Op::Not: {
+                const Column a = pop();
+                auto& out = result();
+                for (size_t i = 0; i < n; ++i) {
+                    const Scalar v = a.at(i);
+                    out[i] = Scalar::fromBool(
+                        ins.op == Op::IsNull ? v.kind == Scalar::Kind::Null : !v.isTrue()
+                    );
+                }
+                stack.push_back({out.data(), false});
+                break;
+            }
+            case Op::And:
+            case Op::Or: {
+                const Column b = pop();
+                const Column a = pop();
+                auto& out = result();
+                for (size_t i = 0; i < n; ++i) {
+                    out[i] = Scalar::fromBool(
+                        ins.op == Op::And ? (a.at(i).isTrue() && b.at(i).isTrue())
+                                          : (a.at(i).isTrue() || b.at(i).isTrue())
+                    );
+                }
+                stack.push_back({out.data(), false});
+                break;
+            }
+            case Op::Between: {
+                const Column high = pop();
+                const Column low = pop();
+                const Column value = pop();
+                auto& out = result();
+                for (size_t i = 0; i < n; ++i) {
+                    const int lo = compare(value.at(i), low.at(i));
+                    const int hi = compare(value.at(i), high.at(i));
+                    out[i] = Scalar::fromBool((lo == 0 || lo == 1) && (hi == 0 || hi == -1));
+                }
+                stack.push_back({out.data(), false});
+                break;
+            }
+            case Op::InList: {
+                const size_t count = ins.arg;
+                const size_t base = stack.size() - count;
+                const Column value = stack[base - 1];
+                auto& out = result();
+                for (size_t i = 0; i < n; ++i) {
+                    bool found = false;
+                    for (size_t k = 0; k < count && !found; ++k) {
+                        found = compare(value.at(i), stack[base + k].at(i)) == 0;
+                    }
+                    out[i] = Scalar::fromBool(found);
+                }
+                stack.resize(base - 1);
+                stack.push_back({out.data(), false});
+                break;
+            }
+            case Op::OfType: {
+                const auto& types = typeSets_[ins.arg];
+                const auto& eventTypes = batch.scalars(FieldRegistry::eventTypeSlot);
+                auto& out = result();
+                for (size_t i = 0; i < n; ++i) {
+                    bool found = false;
+                    if (eventTypes[i].kind == Scalar::Kind::Node) {
+                        for (const auto& type : types) {
+                            if (UA_NodeId_equal(eventTypes[i].node, type.handle())) {
+                                found = true;
+                                break;
+                            }
+                        }
+                    }
+                    out[i] = Scalar::fromBool(found);
+                }
+                stack.push_back({out.data(), false});
+                break;
+            }
+            }
+        }
+
+        const Column top = stack.back();
+        for (size_t i = 0; i < n; ++i) {
+            matches[i] = top.at(i).isTrue() ? 1 : 0;
+        }
+    }
+
+    /// select 子句对应的字段槽位
+    const std::vector<FieldSlot>& selectSlots() const noexcept {
+        return selectSlots_;
+    }
+
+    size_t instructionCount() const noexcept {
+        return code_.size();
+    }
+
+private:
+    // 把 ContentFilter 树（元素 0 为根）后序展开为指令序列
+    struct Compiler {
+        static constexpr uint32_t noResult = UINT32_MAX;
+
+        const UA_ContentFilter& filter;
+        FieldRegistry& registry;
+        const SubtypeResolver& resolver;
+        CompiledFilter& program;
+        size_t depth = 0;
+        // 每个元素的结果列；元素可以被多个 ElementOperand 共用，重复展开会使指令数随共用层数指数增长
+        std::vector<uint32_t> results{};
+
+        // 压栈指令
+        void push(Op op, uint32_t arg) {
+            program.code_.push_back({op, arg});
+            ++depth;
+            program.maxDepth_ = std::max(program.maxDepth_, depth);
+        }
+
+        // 运算指令：弹出 popCount 列，压入一列结果
+        void reduce(Op op, uint32_t arg, size_t popCount) {
+            program.code_.push_back({op, arg});
+            depth = depth - popCount + 1;
+            ++program.resultColumns_;
+        }
+
+        void operand(const UA_ExtensionObject& eo, size_t nesting) {
+            const UA_DataType* type = eo.content.decoded.type;
+            const void* data = eo.content.decoded.data;
+            if (eo.encoding < UA_EXTENSIONOBJECT_DECODED || type == nullptr) {
+                throw opcua::BadStatus{UA_STATUSCODE_BADFILTEROPERANDINVALID};
+            }
+            if (type == &UA_TYPES[UA_TYPES_ELEMENTOPERAND]) {
+                element(static_cast<const UA_ElementOperand*>(data)->index, nesting + 1);
+            } else if (type == &UA_TYPES[UA_TYPES_LITERALOPERAND]) {
+                const auto& value = static_cast<const UA_LiteralOperand*>(data)->value;
+                program.literals_.emplace_back(value);
+                program.literalScalars_.push_back(toScalar(*program.literals_.back().handle()));
+                push(Op::PushLiteral, static_cast<uint32_t>(program.literals_.size() - 1));
+            } else if (type == &UA_TYPES[UA_TYPES_SIMPLEATTRIBUTEOPERAND]) {
+                const auto& sao = *static_cast<const UA_SimpleAttributeOperand*>(data);
+                push(Op::PushField, registry.slot(FieldRegistry::key(sao)));
+            } else {
+                // AttributeOperand 需要完整的 RelativePath，暂不支持
+                throw opcua::BadStatus{UA_STATUSCODE_BADFILTEROPERANDINVALID};
+            }
+        }
+
+        void element(size_t index, size_t nesting) {
+            if (index >= filter.elementsSize || nesting > filter.elementsSize) {
+                throw opcua::BadStatus{UA_STATUSCODE_BADFILTERELEMENTINVALID};  // 越界或循环引用
+            }
+            if (results[index] != noResult) {
+                push(Op::PushResult, results[index]);
+                return;
+            }
+            expand(index, nesting);
+            // 每条运算指令恰好占用一个结果列，元素的结果是最后分配的一列
+            results[index] = static_cast<uint32_t>(program.resultColumns_ - 1);
+        }
+
+        void expand(size_t index, size_t nesting) {
+            const auto& el = filter.elements[index];
+            auto binary = [&](Op op, size_t count) {
+                if (el.filterOperandsSize != count) {
+                    throw opcua::BadStatus{UA_STATUSCODE_BADFILTEROPERANDCOUNTMISMATCH};
+                }
+                for (size_t i = 0; i < count; ++i) {
+                    operand(el.filterOperands[i], nesting);
+                }
+                reduce(op, 0, count);
+            };
+
+            switch (el.filterOperator) {
+            case UA_FILTEROPERATOR_EQUALS: binary(Op::Equals, 2); break;
+            case UA_FILTEROPERATOR_GREATERTHAN: binary(Op::GreaterThan, 2); break;
+            case UA_FILTEROPERATOR_LESSTHAN: binary(Op::LessThan, 2); break;
+            case UA_FILTEROPERATOR_GREATERTHANOREQUAL: binary(Op::GreaterThanOrEqual, 2); break;
+            case UA_FILTEROPERATOR_LESSTHANOREQUAL: binary(Op::LessThanOrEqual, 2); break;
+            case UA_FILTEROPERATOR_ISNULL: binary(Op::IsNull, 1); break;
+            case UA_FILTEROPERATOR_NOT: binary(Op::Not, 1); break;
+            case UA_FILTEROPERATOR_AND: binary(Op::And, 2); break;
+            case UA_FILTEROPERATOR_OR: binary(Op::Or, 2); break;
+            case UA_FILTEROPERATOR_BETWEEN: binary(Op::Between, 3); break;
+            case UA_FILTEROPERATOR_INLIST: {
+                if (el.filterOperandsSize < 2) {
+                    throw opcua::BadStatus{UA_STATUSCODE_BADFILTEROPERANDCOUNTMISMATCH};
+                }
+                for (size_t i = 0; i < el.filterOperandsSize; ++i) {
+                    operand(el.filterOperands[i], nesting);
+                }
+                const auto listSize = static_cast<uint32_t>(el.filterOperandsSize - 1);
+                reduce(Op::InList, listSize, el.filterOperandsSize);
+                break;
+            }
+            case UA_FILTEROPERATOR_OFTYPE: {
+                // OfType 的操作数必须是 NodeId 字面量，编译期展开子类型
+                if (el.filterOperandsSize != 1 ||
+                    el.filterOperands[0].content.decoded.type != &UA_TYPES[UA_TYPES_LITERALOPERAND]) {
+                    throw opcua::BadStatus{UA_STATUSCODE_BADFILTEROPERANDINVALID};
+                }
+                const auto& value = static_cast<const UA_LiteralOperand*>(
+                                        el.filterOperands[0].content.decoded.data
+                )->value;
+                if (!UA_Variant_hasScalarType(&value, &UA_TYPES[UA_TYPES_NODEID])) {
+                    throw opcua::BadStatus{UA_STATUSCODE_BADFILTEROPERANDINVALID};
+                }
+                const opcua::NodeId type{*static_cast<const UA_NodeId*>(value.data)};
+                program.typeSets_.push_back(resolver ? resolver(type) : std::vector{type});
+                ++depth;  // OfType 不弹出操作数，只压入结果
+                program.maxDepth_ = std::max(program.maxDepth_, depth);
+                reduce(Op::OfType, static_cast<uint32_t>(program.typeSets_.size() - 1), 1);
+                break;
+            }
+            default:
+                // Like、Cast、BitwiseAnd/Or、RelatedTo、InView 暂不支持
+                throw opcua::BadStatus{UA_STATUSCODE_BADFILTEROPERATORUNSUPPORTED};
+            }
+        }
+    };
+
+    std::vector<Instruction> code_;
+    std::vector<opcua::Variant> literals_;
+    std::vector<Scalar> literalScalars_;
+    std::vector<std::vector<opcua::NodeId>> typeSets_;
+    std::vector<FieldSlot> selectSlots_;
+    size_t maxDepth_ = 1;
+    size_t resultColumns_ = 0;
+};
+
+/**
+ * @brief 过滤器缓存
+ *
+ * 以 EventFilter 的二进制编码为键，内容相同的过滤器共享同一个编译结果。
+ * 缓存只持有弱引用，最后一个使用者释放后编译结果随之释放。
+ * 键最多保留 capacity 个，超出时淘汰最久未使用的一个；被淘汰的编译结果仍由使用者持有，
+ * 只是之后相同的过滤器会重新编译。
+ */
+class FilterCache {
+public:
+    FilterCache(FieldRegistry& registry, SubtypeResolver resolver, size_t capacity = 1024)
+        : registry_{registry},
+          resolver_{std::move(resolver)},
+          capacity_{std::max<size_t>(capacity, 1)} {}
+
+    std::shared_ptr<const CompiledFilter> get(const UA_EventFilter& filter) {
+        std::string key = encode(filter);
+        std::lock_guard lock{mutex_};
+        auto it = cache_.find(key);
+        if (it != cache_.end()) {
+            order_.splice(order_.begin(), order_, it->second.order);
+            if (auto existing = it->second.compiled.lock()) {
+                hits_.fetch_add(1, std::memory_order_relaxed);
+                return existing;
+            }
+        } else {
+            if (cache_.size() >= capacity_) {
+                cache_.erase(order_.back());
+                order_.pop_back();
+            }
+            order_.push_front(key);
+            it = cache_.emplace(std::move(key), Entry{{}, order_.begin()}).first;
+        }
+        auto compiled = std::make_shared<const CompiledFilter>(
+            CompiledFilter::compile(filter, registry_, resolver_)
+        );
+        it->second.compiled = compiled;
+        compilations_.fetch_add(1, std::memory_order_relaxed);
+        return compiled;
+    }
+
+    size_t hits() const noexcept {
+        return hits_.load(std::memory_order_relaxed);
+    }
+
+    size_t compilations() const noexcept {
+        return compilations_.load(std::memory_order_relaxed);
+    }
+
+    size_t size() const {
+        std::lock_guard lock{mutex_};
+        return cache_.size();
+    }
+
+private:
+    static std::string encode(const UA_EventFilter& filter) {
+        UA_ByteString encoded = UA_BYTESTRING_NULL;
+        const UA_StatusCode status =
+            UA_encodeBinary(&filter, &UA_TYPES[UA_TYPES_EVENTFILTER], &encoded);
+        if (status != UA_STATUSCODE_GOOD) {
+            throw opcua::BadStatus{status};
+        }
+        std::string key{reinterpret_cast<const char*>(encoded.data), encoded.length};
+        UA_ByteString_clear(&encoded);
+        return key;
+    }
+
+    struct Entry {
+        std::weak_ptr<const CompiledFilter> compiled;
+        std::list<std::string>::iterator order;
+    };
+
+    FieldRegistry& registry_;
+    SubtypeResolver resolver_;
+    size_t capacity_;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, Entry> cache_;
+    std::list<std::string> order_;  // 最近使用的在前
+    std::atomic<size_t> hits_{0};
+    std::atomic<size_t> compilations_{0};
+};
+
+}  // namespace compiled_filter
@@ -0,0 +1,309 @@
+/**
+ * @file server_eventfilter_compiled_annotated.cpp
+ * @brief OPC UA 网关事件过滤示例 - 演示如何预编译 EventFilter 并按批求值
+ *
+ * 本示例展示了 compiled_filter.hpp 中编译型事件过滤器的使用方法，包括：
+ * 1. 注册事件字段槽位（FieldRegistry）
+ * 2. 把 EventFilter 编译为扁平指令序列（CompiledFilter）
+ * 3. 内容相同的过滤器共享同一个编译结果（FilterCache）
+ * 4. 对一批事件按列求值，并分发给每个订阅者
+ * 5. 与逐个事件遍历过滤器树的方式进行性能对比
+ *
+ * 功能说明：
+ * - 网关把上游设备的事件转发给大量下游订阅者，每个订阅者带有自己的 EventFilter
+ * - 逐个事件遍历过滤器树时，每个操作数都要重新解析浏览路径
+ * - 编译后，操作数在编译期解析为字段槽位，求值时直接按槽位取列
+ * - 多个订阅者使用相同过滤器时（例如同一 HMI 的多个实例），整批只求值一次
+ *
+ * 注意：open62541 服务器内部对事件监控项的过滤由 C 库完成，无法从 C++ 层替换；
+ * 本示例的过滤器用于网关自己的事件路由（转发、事件 sink 等）
+ */
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+// 包含必要的头文件
+#include <open62541pp/callback.hpp>       // 回调功能
+#include <open62541pp/server.hpp>         // 服务器核心功能
+#include <open62541pp/services/view.hpp>  // 视图服务（浏览子类型）
+
+#include "compiled_filter.hpp"  // 编译型事件过滤器
+
+using namespace compiled_filter;
+
+/**
+ * @brief 浏览服务器地址空间，返回类型及其所有子类型
+ *
+ * 用于在编译期展开 OfType 操作符。
+ */
+static std::vector<opcua::NodeId> resolveSubtypes(opcua::Server& server, const opcua::NodeId& type) {
+    std::vector<opcua::NodeId> result{type};
+    for (size_t i = 0; i < result.size(); ++i) {
+        const opcua::BrowseDescription bd{
+            result[i],                           // 从当前类型开始
+            opcua::BrowseDirection::Forward,     // 向前浏览
+            opcua::ReferenceTypeId::HasSubtype,  // 只查找子类型引用
+        };
+        const auto browseResult = opcua::services::browse(server, bd, 0);
+        for (const auto& reference : browseResult.references()) {
+            result.push_back(reference.nodeId().nodeId());
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief 逐个事件遍历过滤器树的求值方式（对比基准）
+ *
+ * 每个事件、每个操作数都重新计算浏览路径键并查找字段。
+ */
+static bool evaluateNaive(
+    const UA_ContentFilter& filter,
+    size_t index,
+    const EventBatch& batch,
+    size_t row,
+    FieldRegistry& registry,
+    const std::map<opcua::NodeId, std::vector<opcua::NodeId>>& subtypes
+) {
+    const auto& el = filter.elements[index];
+    auto value = [&](const UA_ExtensionObject& eo) -> Scalar {
+        const UA_DataType* type = eo.content.decoded.type;
+        const void* data = eo.content.decoded.data;
+        if (type == &UA_TYPES[UA_TYPES_ELEMENTOPERAND]) {
+            const auto child = static_cast<const UA_ElementOperand*>(data)->index;
+            return Scalar::fromBool(evaluateNaive(filter, child, batch, row, registry, subtypes));
+        }
+        if (type == &UA_TYPES[UA_TYPES_LITERALOPERAND]) {
+            return toScalar(static_cast<const UA_LiteralOperand*>(data)->value);
+        }
+        const auto& sao = *static_cast<const UA_SimpleAttributeOperand*>(data);
+        const auto* field = batch.get(row, registry.slot(FieldRegistry::key(sao)));
+        return field != nullptr ? toScalar(*field->handle()) : Scalar{};
+    };
+
+    switch (el.filterOperator) {
+    case UA_FILTEROPERATOR_LESSTHAN:
+        return compare(value(el.filterOperands[0]), value(el.filterOperands[1])) == -1;
+    case UA_FILTEROPERATOR_GREATERTHANOREQUAL: {
+        const int c = compare(value(el.filterOperands[0]), value(el.filterOperands[1]));
+        return c == 0 || c == 1;
+    }
+    case UA_FILTEROPERATOR_NOT:
+        return !value(el.filterOperands[0]).isTrue();
+    case UA_FILTEROPERATOR_AND:
+        return value(el.filterOperands[0]).isTrue() && value(el.filterOperands[1]).isTrue();
+    case UA_FILTEROPERATOR_OFTYPE: {
+        const auto& literal = *static_cast<const UA_LiteralOperand*>(
+            el.filterOperands[0].content.decoded.data
+        );
+        const opcua::NodeId type{*static_cast<const UA_NodeId*>(literal.value.data)};
+        const auto* eventType = batch.get(row, FieldRegistry::eventTypeSlot);
+        for (const auto& subtype : subtypes.at(type)) {
+            if (eventType != nullptr && eventType->scalar<opcua::NodeId>() == subtype) {
+                return true;
+            }
+        }
+        return false;
+    }
+    default:
+        return false;
+    }
+}
+
+int main() {
+    std::cout << "=== OPC UA 网关事件过滤示例 ===" << std::endl;
+
+    // 创建 OPC UA 服务器实例
+    opcua::Server server;
+
+    // 字段注册表：所有过滤器和事件生产者共享
+    FieldRegistry registry;
+    const FieldSlot slotTime = registry.slot("0:Time");
+    const FieldSlot slotSeverity = registry.slot("0:Severity");
+    const FieldSlot slotMessage = registry.slot("0:Message");
+
+    // 过滤器缓存：OfType 通过浏览服务器的类型层次结构展开
+    FilterCache cache{registry, [&](const opcua::NodeId& type) {
+                          return resolveSubtypes(server, type);
+                      }};
+
+    std::cout << "正在创建过滤器..." << std::endl;
+
+    // 过滤器 1：与 client_eventfilter_annotated.cpp 相同
+    // BaseEventType 且严重性 >= 200
+    const opcua::ContentFilterElement filterBaseEventType{
+        opcua::FilterOperator::OfType,
+        {opcua::LiteralOperand{opcua::NodeId{opcua::ObjectTypeId::BaseEventType}}},
+    };
+    const opcua::ContentFilterElement filterLowSeverity{
+        opcua::FilterOperator::LessThan,
+        {
+            opcua::SimpleAttributeOperand(
+                opcua::ObjectTypeId::BaseEventType, {{0, "Severity"}}, opcua::AttributeId::Value
+            ),
+            opcua::LiteralOperand{200},
+        },
+    };
+    // 过滤器 2：只接受审计事件
+    const opcua::ContentFilterElement filterAudit{
+        opcua::FilterOperator::OfType,
+        {opcua::LiteralOperand{opcua::NodeId{opcua::ObjectTypeId::AuditEventType}}},
+    };
+
+    // 选择子句：时间、严重性、消息
+    const std::vector<opcua::SimpleAttributeOperand> selectClauses{
+        {opcua::ObjectTypeId::BaseEventType, {{0, "Time"}}, opcua::AttributeId::Value},
+        {opcua::ObjectTypeId::BaseEventType, {{0, "Severity"}}, opcua::AttributeId::Value},
+        {opcua::ObjectTypeId::BaseEventType, {{0, "Message"}}, opcua::AttributeId::Value},
+    };
+    const std::vector<opcua::EventFilter> distinctFilters{
+        {selectClauses, filterBaseEventType && !filterLowSeverity},
+        {selectClauses, filterAudit},
+    };
+
+    // 模拟 1000 个下游订阅者，大部分使用相同的过滤器
+    // 每个订阅者从缓存获取编译结果，相同过滤器共享同一个程序
+    struct Subscriber {
+        std::shared_ptr<const CompiledFilter> program;
+        const opcua::EventFilter* filter;
+        size_t delivered = 0;
+    };
+    std::vector<Subscriber> subscribers;
+    for (size_t i = 0; i < 1000; ++i) {
+        const auto& filter = distinctFilters[i % 10 == 0 ? 1 : 0];
+        subscribers.push_back({cache.get(*filter.handle()), &filter});
+    }
+    std::cout << "✓ 订阅者: " << subscribers.size() << "，编译次数: " << cache.compilations()
+              << "，缓存命中: " << cache.hits() << std::endl;
+
+    // 对比基准需要的子类型表
+    std::map<opcua::NodeId, std::vector<opcua::NodeId>> subtypes;
+    for (const auto& type : {opcua::ObjectTypeId::BaseEventType, opcua::ObjectTypeId::AuditEventType}) {
+        subtypes.emplace(opcua::NodeId{type}, resolveSubtypes(server, type));
+    }
+
+    // 模拟一批上游事件
+    const std::vector<opcua::NodeId> eventTypes{
+        opcua::ObjectTypeId::BaseEventType,
+        opcua::ObjectTypeId::SystemEventType,
+        opcua::ObjectTypeId::AuditEventType,
+        opcua::ObjectTypeId::AuditSessionEventType,
+    };
+    std::mt19937 rng{1};
+    auto makeBatch = [&](size_t count) {
+        EventBatch batch{registry};
+        for (size_t i = 0; i < count; ++i) {
+            const size_t row = batch.addEvent(eventTypes[rng() % eventTypes.size()]);
+            batch.set(row, slotTime, opcua::Variant{opcua::DateTime::now()});
+            batch.set(row, slotSeverity, opcua::Variant{static_cast<uint16_t>(rng() % 1000)});
+            batch.set(row, slotMessage, opcua::Variant{opcua::LocalizedText{"", "simulated event"}});
+        }
+        return batch;
+    };
+
+    // 每秒处理一批事件，输出两种求值方式的耗时
+    const opcua::CallbackId id = opcua::addRepeatedCallback(
+        server,
+        [&] {
+            const EventBatch batch = makeBatch(5000);
+            using Clock = std::chrono::steady_clock;
+
+            // 编译型：每个不同的程序对整批求值一次，然后分发给使用该程序的订阅者
+            auto start = Clock::now();
+            std::map<const CompiledFilter*, std::vector<uint8_t>> results;
+            for (const auto& sub : subscribers) {
+                auto [it, inserted] = results.try_emplace(sub.program.get());
+                if (inserted) {
+                    sub.program->evaluate(batch, it->second);
+                }
+            }
+            size_t compiledMatches = 0;
+            for (auto& sub : subscribers) {
+                const auto& matches = results[sub.program.get()];
+                for (size_t row = 0; row < batch.size(); ++row) {
+                    if (matches[row] != 0) {
+                        ++sub.delivered;
+                        ++compiledMatches;
+                    }
+                }
+            }
+            const std::chrono::duration<double, std::milli> compiledMs = Clock::now() - start;
+
+            // 对比基准：每个订阅者、每个事件遍历过滤器树
+            start = Clock::now();
+            size_t naiveMatches = 0;
+            for (const auto& sub : subscribers) {
+                const UA_ContentFilter& where = sub.filter->handle()->whereClause;
+                for (size_t row = 0; row < batch.size(); ++row) {
+                    if (evaluateNaive(where, 0, batch, row, registry, subtypes)) {
+                        ++naiveMatches;
+                    }
+                }
+            }
+            const std::chrono::duration<double, std::milli> naiveMs = Clock::now() - start;
+
+            std::cout << "批次 " << batch.size() << " 个事件 x " << subscribers.size()
+                      << " 个订阅者: 编译型 " << compiledMs.count() << " ms（匹配 "
+                      << compiledMatches << "），逐个遍历 " << naiveMs.count() << " ms（匹配 "
+                      << naiveMatches << "）" << std::endl;
+        },
+        1000
+    );
+
+    std::cout << "\n正在启动服务器..." << std::endl;
+    std::cout << "服务器地址: opc.tcp://localhost:4840" << std::endl;
+    std::cout << "按 Ctrl+C 停止服务器" << std::endl;
+
+    // 启动服务器
+    server.run();
+
+    opcua::removeCallback(server, id);
+    return 0;
+}
+
+/**
+ * 使用说明：
+ *
+ * 1. 编译并运行此程序
+ * 2. 程序每秒生成一批 5000 个模拟事件，分发给 1000 个订阅者
+ * 3. 控制台输出两种求值方式的耗时和匹配数量（两者的匹配数量应当一致）
+ *
+ * 编译过程：
+ *
+ * 1. 操作数解析：
+ *    - SimpleAttributeOperand 的浏览路径（如 0:Severity）解析为字段槽位
+ *    - LiteralOperand 预先转换为标量常量
+ *    - ElementOperand 展开为子元素的指令；同一元素被多次引用时只展开一次，之后引用它的结果列（PushResult）
+ *
+ * 2. 指令生成：
+ *    - 从元素 0 开始后序遍历，生成基于栈的指令序列
+ *    - 例如 OfType(BaseEventType) && !(Severity < 200) 编译为：
+ *      OfType[0]; PushField[Severity]; PushLiteral[200]; LessThan; Not; And
+ *
+ * 3. OfType 展开：
+ *    - 编译期浏览 HasSubtype 引用，得到类型及其所有子类型
+ *    - 求值时只需比较事件类型是否在集合中
+ *
+ * 按批求值：
+ *
+ * 1. 事件以列的形式存储，每个字段槽位一列
+ * 2. 被引用的列在每批中只转换一次为标量列，由所有程序共享
+ * 3. 每条指令一次处理整批事件，循环体简单、分支可预测
+ * 4. 相同的程序只求值一次，结果分发给所有使用它的订阅者
+ *
+ * 过滤器共享：
+ *
+ * - 缓存以 EventFilter 的二进制编码为键
+ * - 缓存只保存弱引用，所有订阅者释放后编译结果随之释放
+ *
+ * 注意事项：
+ *
+ * - 不支持的操作符（Like、Cast、RelatedTo 等）在编译时抛出 BadFilterOperatorUnsupported
+ * - 与 NULL 的比较结果为 false（规范中为三值逻辑）
+ * - EventBatch 的标量列缓存不是线程安全的，同一批事件应在一个线程中求值
+ */
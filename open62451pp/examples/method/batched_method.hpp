@@ -0,0 +1,221 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <open62541/server.h>
+
+#include <open62541pp/server.hpp>
+#include <open62541pp/services/nodemanagement.hpp>
+
+// 一次方法调用（批量处理器中的一个元素）
+struct MethodCall {
+    opcua::NodeId objectId;                   // 调用所在的对象
+    opcua::Span<const opcua::Variant> input;  // 输入参数（已由服务器按 Argument 定义校验）
+    std::vector<opcua::Variant> output;       // 输出参数，大小与输出 Argument 数量一致
+    opcua::StatusCode status;                 // 单个调用的结果状态，默认 Good
+};
+
+// 批量方法处理器：一次接收同一方法的所有待处理调用
+using BatchedMethodHandler = std::function<void(opcua::Span<MethodCall> calls)>;
+
+// 批量方法分发器
+// 方法节点被设置为异步执行，服务器把 Call 请求中的每个方法调用放入异步队列；
+// 工作线程一次取空队列，按 MethodId 分组，每组只调用一次批量处理器
+class BatchedMethodDispatcher {
+public:
+    explicit BatchedMethodDispatcher(
+        opcua::Server& server,
+        std::chrono::microseconds gatherWindow = std::chrono::microseconds{500}
+    )
+        : server_{server},
+          gatherWindow_{gatherWindow} {}
+
+    ~BatchedMethodDispatcher() {
+        stop();
+    }
+
+    BatchedMethodDispatcher(const BatchedMethodDispatcher&) = delete;
+    BatchedMethodDispatcher& operator=(const BatchedMethodDispatcher&) = delete;
+
+    /// 添加批量方法节点
+    opcua::NodeId addBatchedMethod(
+        const opcua::NodeId& parentId,
+        const opcua::NodeId& id,
+        std::string_view browseName,
+        BatchedMethodHandler handler,
+        opcua::Span<const opcua::Argument> inputArguments,
+        opcua::Span<const opcua::Argument> outputArguments
+    ) {
+        // 方法节点本身的回调不会被执行：异步模式下调用由分发器处理
+        const auto result = opcua::services::addMethod(
+            server_,
+            parentId,
+            id,
+            browseName,
+            [](opcua::Span<const opcua::Variant>, opcua::Span<opcua::Variant>) {},
+            inputArguments,
+            outputArguments,
+            opcua::MethodAttributes{},
+            opcua::ReferenceTypeId::HasComponent
+        );
+        result.code().throwIfBad();
+        opcua::useAsyncOperation(server_, result.value(), true);
+
+        std::lock_guard lock{mutex_};
+        methods_.emplace(result.value(), Method{std::move(handler), outputArguments.size()});
+        return result.value();
+    }
+
+    /// 启动工作线程
+    void start() {
+        running_ = true;
+        worker_ = std::thread{[this] {
+            while (running_) {
+                if (processPending() == 0) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds{1});
+                }
+            }
+        }};
+    }
+
+    /// 停止工作线程
+    void stop() {
+        running_ = false;
+        if (worker_.joinable()) {
+            worker_.join();
+        }
+    }
+
+    /// 取空异步队列并按方法批量执行，返回处理的调用数量
+    size_t processPending() {
+        std::vector<Pending> pending;
+        const auto deadline = std::chrono::steady_clock::now() + gatherWindow_;
+        while (true) {
+            UA_AsyncOperationType type{};
+            const UA_AsyncOperationRequest* request = nullptr;
+            void* context = nullptr;
+            UA_DateTime timeout = 0;
+            if (UA_Server_getAsyncOperationNonBlocking(
+                    server_.handle(), &type, &request, &context, &timeout
+                )) {
+                pending.push_back({request, context});
+                continue;
+            }
+            // 队列已空：同一 Call 请求中的调用可能仍在入队，在收集窗口内继续等待
+            if (pending.empty() || std::chrono::steady_clock::now() >= deadline) {
+                break;
+            }
+            std::this_thread::yield();
+        }
+        if (pending.empty()) {
+            return 0;
+        }
+
+        // 按 MethodId 分组，组内保持到达顺序
+        std::map<opcua::NodeId, std::vector<size_t>> groups;
+        for (size_t i = 0; i < pending.size(); ++i) {
+            const auto& methodId = pending[i].request->callMethodRequest.methodId;
+            groups[opcua::NodeId{methodId}].push_back(i);
+        }
+
+        for (const auto& [methodId, indices] : groups) {
+            dispatch(methodId, pending, indices);
+        }
+        return pending.size();
+    }
+
+private:
+    struct Method {
+        BatchedMethodHandler handler;
+        size_t outputCount;
+    };
+
+    struct Pending {
+        const UA_AsyncOperationRequest* request;
+        void* context;
+    };
+
+    void dispatch(
+        const opcua::NodeId& methodId,
+        const std::vector<Pending>& pending,
+        const std::vector<size_t>& indices
+    ) {
+        const Method* method = nullptr;
+        {
+            std::lock_guard lock{mutex_};
+            const auto it = methods_.find(methodId);
+            if (it != methods_.end()) {
+                method = &it->second;
+            }
+        }
+
+        std::vector<MethodCall> calls;
+        calls.reserve(indices.size());
+        for (const size_t i : indices) {
+            const UA_CallMethodRequest& req = pending[i].request->callMethodRequest;
+            calls.push_back(MethodCall{
+                opcua::NodeId{req.objectId},
+                // opcua::Variant 与 UA_Variant 内存布局相同
+                {reinterpret_cast<const opcua::Variant*>(req.inputArguments),
+                 req.inputArgumentsSize},
+                std::vector<opcua::Variant>(method != nullptr ? method->outputCount : 0),
+                method != nullptr ? UA_STATUSCODE_GOOD : UA_STATUSCODE_BADMETHODINVALID,
+            });
+        }
+
+        if (method != nullptr) {
+            try {
+                method->handler(calls);
+            } catch (const opcua::BadStatus& e) {
+                for (auto& call : calls) {
+                    call.status = e.code();
+                }
+            } catch (const std::exception&) {
+                for (auto& call : calls) {
+                    call.status = UA_STATUSCODE_BADINTERNALERROR;
+                }
+            }
+        }
+
+        for (size_t k = 0; k < indices.size(); ++k) {
+            setResult(calls[k], pending[indices[k]].context);
+        }
+    }
+
+    void setResult(MethodCall& call, void* context) {
+        UA_AsyncOperationResponse response;
+        UA_CallMethodResult& result = response.callMethodResult;
+        UA_CallMethodResult_init(&result);
+        result.statusCode = call.status;
+        if (call.status.isGood() && !call.output.empty()) {
+            result.outputArguments = static_cast<UA_Variant*>(
+                UA_Array_new(call.output.size(), &UA_TYPES[UA_TYPES_VARIANT])
+            );
+            result.outputArgumentsSize = call.output.size();
+            for (size_t i = 0; i < call.output.size(); ++i) {
+                // 转移所有权，避免深拷贝输出值
+                result.outputArguments[i] = *call.output[i].handle();
+                UA_Variant_init(call.output[i].handle());
+            }
+        }
+        // 服务器会复制结果，之后释放本地副本
+        UA_Server_setAsyncOperationResult(server_.handle(), &response, context);
+        UA_CallMethodResult_clear(&result);
+    }
+
+    opcua::Server& server_;
+    std::chrono::microseconds gatherWindow_;
+    std::mutex mutex_;
+    std::map<opcua::NodeId, Method> methods_;
+    std::atomic<bool> running_{false};
+    std::thread worker_;
+};
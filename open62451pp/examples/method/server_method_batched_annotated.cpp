@@ -0,0 +1,187 @@
+/**
+ * @file server_method_batched_annotated.cpp
+ * @brief OPC UA 服务器批量方法示例 - 演示如何把同一 Call 请求中的大量方法调用合并处理
+ *
+ * 本示例展示了 batched_method.hpp 中 BatchedMethodDispatcher 的使用方法，包括：
+ * 1. 注册批量方法节点
+ * 2. 在一个处理器中接收同一方法的所有待处理调用
+ * 3. 用一次"PLC 事务"完成整批调用
+ * 4. 为每个调用单独设置输出参数和状态码
+ *
+ * 功能说明：
+ * - server_method_annotated.cpp 中每个方法调用都会执行一次 lambda
+ * - 客户端在一个 Call 请求中调用数百次方法时，每次调用都单独访问设备
+ * - 批量方法把这些调用合并为一批，只访问一次设备或数据库
+ *
+ * 工作原理：
+ * - 方法节点启用异步执行（useAsyncOperation）
+ * - 服务器把 Call 请求中的每个方法调用放入异步队列
+ * - 分发器的工作线程取空队列，按 MethodId 分组后调用批量处理器
+ */
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// 包含必要的头文件
+#include <open62541pp/server.hpp>  // 服务器核心功能
+
+#include "batched_method.hpp"  // BatchedMethodDispatcher - 批量方法分发器
+
+/**
+ * @brief 模拟的 PLC 连接
+ *
+ * 每次事务都有固定的往返开销（这里用 5 毫秒模拟），
+ * 一次事务可以读取任意数量的寄存器。
+ */
+class SimulatedPlc {
+public:
+    std::vector<double> readRegisters(const std::vector<uint32_t>& addresses) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{5});  // 一次往返
+        ++transactions_;
+        std::vector<double> values;
+        values.reserve(addresses.size());
+        for (const auto address : addresses) {
+            values.push_back(static_cast<double>(address) * 0.1);
+        }
+        return values;
+    }
+
+    size_t transactions() const noexcept {
+        return transactions_;
+    }
+
+private:
+    size_t transactions_ = 0;
+};
+
+int main() {
+    std::cout << "=== OPC UA 服务器批量方法示例 ===" << std::endl;
+
+    // 创建 OPC UA 服务器实例
+    opcua::Server server;
+    SimulatedPlc plc;
+
+    // 创建批量方法分发器
+    // 收集窗口 500 微秒：队列取空后再等待一小段时间，
+    // 让同一 Call 请求中仍在入队的调用进入同一批
+    BatchedMethodDispatcher dispatcher{server, std::chrono::microseconds{500}};
+
+    std::cout << "正在创建批量方法 ReadRegister..." << std::endl;
+
+    // 添加批量方法：读取一个寄存器地址的值
+    // 处理器的参数是同一方法的所有待处理调用
+    dispatcher.addBatchedMethod(
+        opcua::ObjectId::ObjectsFolder,  // 父节点
+        {1, 2000},                       // 方法节点ID
+        "ReadRegister",                  // 方法名称
+        [&](opcua::Span<MethodCall> calls) {
+            // 1. 收集所有调用的寄存器地址
+            //    输入参数已经由服务器按 Argument 定义校验过类型
+            std::vector<uint32_t> addresses;
+            addresses.reserve(calls.size());
+            for (const auto& call : calls) {
+                addresses.push_back(call.input[0].scalar<uint32_t>());
+            }
+
+            // 2. 一次 PLC 事务读取全部寄存器
+            const auto values = plc.readRegisters(addresses);
+
+            // 3. 把结果写回每个调用的输出参数
+            for (size_t i = 0; i < calls.size(); ++i) {
+                calls[i].output[0] = values[i];
+            }
+
+            std::cout << "批量处理 " << calls.size() << " 个 ReadRegister 调用，PLC 事务累计 "
+                      << plc.transactions() << " 次" << std::endl;
+        },
+        // 输入参数定义
+        {{"address", {"en-US", "register address"}, opcua::DataTypeId::UInt32, opcua::ValueRank::Scalar}},
+        // 输出参数定义
+        {{"value", {"en-US", "register value"}, opcua::DataTypeId::Double, opcua::ValueRank::Scalar}}
+    );
+
+    // 添加第二个批量方法：写入寄存器
+    // 单个调用的错误通过 call.status 返回，不影响同一批中的其他调用
+    dispatcher.addBatchedMethod(
+        opcua::ObjectId::ObjectsFolder,
+        {1, 2001},
+        "WriteRegister",
+        [&](opcua::Span<MethodCall> calls) {
+            for (auto& call : calls) {
+                const auto address = call.input[0].scalar<uint32_t>();
+                if (address >= 10000) {
+                    call.status = UA_STATUSCODE_BADOUTOFRANGE;  // 地址越界
+                }
+            }
+            std::cout << "批量处理 " << calls.size() << " 个 WriteRegister 调用" << std::endl;
+        },
+        {
+            {"address", {"en-US", "register address"}, opcua::DataTypeId::UInt32, opcua::ValueRank::Scalar},
+            {"value", {"en-US", "register value"}, opcua::DataTypeId::Double, opcua::ValueRank::Scalar},
+        },
+        {}
+    );
+
+    std::cout << "✓ 批量方法创建完成" << std::endl;
+
+    // 启动分发器工作线程
+    dispatcher.start();
+
+    std::cout << "\n正在启动服务器..." << std::endl;
+    std::cout << "服务器地址: opc.tcp://localhost:4840" << std::endl;
+    std::cout << "按 Ctrl+C 停止服务器" << std::endl;
+
+    // 启动服务器
+    server.run();
+
+    dispatcher.stop();
+    return 0;
+}
+
+/**
+ * 使用说明：
+ *
+ * 1. 编译并运行此程序
+ * 2. 客户端在一个 Call 请求中调用多次 ReadRegister，例如：
+ *
+ *    std::vector<opcua::CallMethodRequest> items;
+ *    for (uint32_t address = 0; address < 500; ++address) {
+ *        items.emplace_back(
+ *            opcua::ObjectId::ObjectsFolder,
+ *            opcua::NodeId{1, 2000},
+ *            opcua::Span<const opcua::Variant>{opcua::Variant{address}}
+ *        );
+ *    }
+ *    opcua::services::call(client, opcua::CallRequest{{}, items});
+ *
+ * 3. 服务器控制台只输出少量"批量处理 N 个调用"，PLC 事务次数远小于调用次数
+ *
+ * 批量方法工作原理：
+ *
+ * 1. 入队：
+ *    - 方法节点启用异步执行后，服务器不会直接执行方法回调
+ *    - 服务器先按 Argument 定义校验输入参数，再把调用放入异步队列
+ *    - 一个 Call 请求中的所有调用在同一次服务器迭代中入队
+ *
+ * 2. 收集：
+ *    - 工作线程取空队列
+ *    - 队列空后在收集窗口内继续等待，避免一个请求被拆成多批
+ *
+ * 3. 分组和执行：
+ *    - 按 MethodId 分组，组内保持到达顺序
+ *    - 每组调用一次批量处理器
+ *    - 处理器抛出异常时，整批调用返回对应的错误状态码
+ *
+ * 4. 返回结果：
+ *    - 每个调用单独设置输出参数和状态码
+ *    - 服务器收集完同一请求的所有结果后再发送响应
+ *
+ * 注意事项：
+ *
+ * - 批量处理器在工作线程中执行，访问共享数据时需要同步
+ * - 收集窗口越大，批次越完整，但单次调用的延迟也越大
+ * - 异步操作有超时时间（ServerConfig 中的 asyncOperationTimeout），批量处理应在超时前完成
+ * - 未通过分发器注册的异步方法会返回 BadMethodInvalid
+ */
@@ -0,0 +1,174 @@
+/**
+ * @file server_method_typed_annotated.cpp
+ * @brief OPC UA 服务器类型化方法示例 - 演示如何由 C++ 函数签名自动生成方法参数定义
+ *
+ * 本示例展示了 typed_method.hpp 中类型化 addMethod 的使用方法，包括：
+ * 1. 用普通 C++ 参数类型声明方法（std::string_view、uint16_t 等）
+ * 2. 在编译期推导输入/输出 Argument 定义
+ * 3. 用 std::tuple 返回多个输出参数
+ * 4. 用 Span<const T> 接收数组参数
+ * 5. 改写 server_events_annotated.cpp 中的 GenerateEvent 方法
+ *
+ * 功能说明：
+ * - server_method_annotated.cpp 中需要手动编写 Argument 描述
+ * - 方法体中通过 input.at(0).scalar<T>() 取值，每次调用都要做类型检查
+ * - 类型化绑定由函数签名生成 Argument 定义和解包代码，二者不会不一致
+ * - 解包直接读取 Variant 的数据指针，字符串参数以 std::string_view 引用原始缓冲区
+ */
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+// 包含必要的头文件
+#include <open62541pp/event.hpp>   // 事件系统功能
+#include <open62541pp/node.hpp>    // 节点操作
+#include <open62541pp/server.hpp>  // 服务器核心功能
+
+#include "typed_method.hpp"  // 类型化 addMethod
+
+int main() {
+    std::cout << "=== OPC UA 服务器类型化方法示例 ===" << std::endl;
+
+    // 创建 OPC UA 服务器实例
+    opcua::Server server;
+
+    // 获取 Objects 文件夹节点作为父节点
+    opcua::Node objectsNode{server, opcua::ObjectId::ObjectsFolder};
+
+    std::cout << "1. 创建问候方法 (Greet)..." << std::endl;
+
+    // 输入参数：String name（由 std::string_view 推导）
+    // 输出参数：String greeting（由返回类型 std::string 推导）
+    // name 直接指向请求中的字符串缓冲区，没有临时拷贝
+    addMethod(
+        objectsNode,
+        {1, 1000},
+        "Greet",
+        [](std::string_view name) -> std::string {
+            return std::string{"Hello "}.append(name);
+        },
+        {"name"},     // 输入参数名称
+        {"greeting"}  // 输出参数名称
+    );
+
+    std::cout << "2. 创建数组增量方法 (IncInt32ArrayValues)..." << std::endl;
+
+    // 输入参数：Int32[] values、Int32 delta
+    // 输出参数：Int32[]（由 std::vector<int32_t> 推导）
+    addMethod(
+        objectsNode,
+        {1, 1001},
+        "IncInt32ArrayValues",
+        [](opcua::Span<const int32_t> values, int32_t delta) {
+            std::vector<int32_t> incremented;
+            incremented.reserve(values.size());
+            for (const auto v : values) {
+                incremented.push_back(v + delta);
+            }
+            return incremented;
+        },
+        {"values", "delta"},
+        {"incremented"}
+    );
+
+    std::cout << "3. 创建多输出方法 (DivMod)..." << std::endl;
+
+    // 返回 std::tuple 时每个元素对应一个输出参数
+    addMethod(
+        objectsNode,
+        {1, 1002},
+        "DivMod",
+        [](int32_t dividend, int32_t divisor) -> std::tuple<int32_t, int32_t> {
+            if (divisor == 0) {
+                // 抛出 BadStatus，状态码会作为方法调用结果返回给客户端
+                throw opcua::BadStatus{UA_STATUSCODE_BADINVALIDARGUMENT};
+            }
+            return {dividend / divisor, dividend % divisor};
+        },
+        {"dividend", "divisor"},
+        {"quotient", "remainder"}
+    );
+
+    std::cout << "4. 创建事件生成方法 (GenerateEvent)..." << std::endl;
+
+    // 与 server_events_annotated.cpp 中的 GenerateEvent 相同，
+    // 但参数直接声明为 uint16_t 和 std::string_view
+    objectsNode.writeEventNotifier(opcua::EventNotifier::SubscribeToEvents);
+    opcua::Event event{server};
+    addMethod(
+        objectsNode,
+        {1, 1003},
+        "GenerateEvent",
+        [&](uint16_t severity, std::string_view message) {
+            event.writeTime(opcua::DateTime::now());
+            event.writeSeverity(severity);
+            event.writeMessage({"", message});
+            event.trigger();
+        },
+        {"severity", "message"}
+    );
+
+    std::cout << "✓ 类型化方法创建完成" << std::endl;
+
+    std::cout << "\n=== 推导出的参数定义 ===" << std::endl;
+    std::cout << "Greet:               (String name) -> String greeting" << std::endl;
+    std::cout << "IncInt32ArrayValues: (Int32[] values, Int32 delta) -> Int32[] incremented" << std::endl;
+    std::cout << "DivMod:              (Int32 dividend, Int32 divisor) -> (Int32 quotient, Int32 remainder)" << std::endl;
+    std::cout << "GenerateEvent:       (UInt16 severity, String message) -> ()" << std::endl;
+
+    std::cout << "\n正在启动服务器..." << std::endl;
+    std::cout << "服务器地址: opc.tcp://localhost:4840" << std::endl;
+    std::cout << "按 Ctrl+C 停止服务器" << std::endl;
+
+    // 启动服务器
+    server.run();
+
+    return 0;
+}
+
+/**
+ * 使用说明：
+ *
+ * 1. 编译并运行此程序
+ * 2. 使用 UaExpert 浏览 Objects 文件夹，查看各方法的 InputArguments/OutputArguments 属性
+ * 3. 调用方法并观察返回值
+ *
+ * 类型化绑定工作原理：
+ *
+ * 1. 签名推导：
+ *    - FunctionTraits 从 lambda 的 operator() 提取参数类型和返回类型
+ *    - ArgTraits<T> 为每种 C++ 类型提供 OPC UA 数据类型索引和 ValueRank
+ *    - 这些信息都是编译期常量
+ *
+ * 2. 参数定义：
+ *    - 注册方法时按参数类型生成 InputArguments
+ *    - 返回类型生成 OutputArguments：void 无输出，std::tuple 多个输出
+ *
+ * 3. 解包：
+ *    - 通过 std::index_sequence 为每个参数生成一次 ArgTraits<T>::unpack 调用
+ *    - 服务器在调用方法前已经按 Argument 定义校验了参数数量和类型
+ *    - 因此解包直接读取 Variant 的数据指针，不再逐个检查类型
+ *
+ * 类型映射：
+ *
+ * | C++ 类型                | OPC UA 数据类型 | ValueRank |
+ * |-------------------------|-----------------|-----------|
+ * | bool                    | Boolean         | Scalar    |
+ * | int8_t ... uint64_t     | SByte ... UInt64| Scalar    |
+ * | float / double          | Float / Double  | Scalar    |
+ * | std::string_view        | String（输入）  | Scalar    |
+ * | std::string             | String（输出）  | Scalar    |
+ * | opcua::String 等包装类型 | 对应类型        | Scalar    |
+ * | opcua::Span<const T>    | T（输入）       | 一维数组  |
+ * | std::vector<T>          | T（输出）       | 一维数组  |
+ *
+ * 注意事项：
+ *
+ * - std::string_view 和 Span 参数只在方法执行期间有效，不要保存引用
+ * - 不在映射表中的类型会导致编译错误，需要为其添加 ArgTraits 特化
+ * - 方法中抛出的 BadStatus 会作为方法调用的状态码返回
+ */
@@ -0,0 +1,234 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <open62541/types.h>
+
+#include <open62541pp/node.hpp>
+#include <open62541pp/server.hpp>
+
+// 类型化方法绑定
+// 根据 C++ 函数签名在编译期推导方法的输入/输出 Argument 定义，
+// 并生成直接从 Variant 数据指针取值的解包代码。
+//
+// 服务器在调用方法前已经按 Argument 定义校验了参数数量、数据类型和 ValueRank，
+// 因此解包时不再做运行时类型检查。
+
+namespace typed_method {
+
+// 参数类型特征：数据类型索引、ValueRank 和解包方式
+template <typename T, typename = void>
+struct ArgTraits;
+
+template <typename T, int TypeIndex>
+struct ScalarTraits {
+    static constexpr int typeIndex = TypeIndex;
+    static constexpr opcua::ValueRank valueRank = opcua::ValueRank::Scalar;
+
+    static const T& unpack(const opcua::Variant& var) noexcept {
+        return *static_cast<const T*>(var.data());
+    }
+};
+
+template <> struct ArgTraits<bool> : ScalarTraits<bool, UA_TYPES_BOOLEAN> {};
+template <> struct ArgTraits<int8_t> : ScalarTraits<int8_t, UA_TYPES_SBYTE> {};
+template <> struct ArgTraits<uint8_t> : ScalarTraits<uint8_t, UA_TYPES_BYTE> {};
+template <> struct ArgTraits<int16_t> : ScalarTraits<int16_t, UA_TYPES_INT16> {};
+template <> struct ArgTraits<uint16_t> : ScalarTraits<uint16_t, UA_TYPES_UINT16> {};
+template <> struct ArgTraits<int32_t> : ScalarTraits<int32_t, UA_TYPES_INT32> {};
+template <> struct ArgTraits<uint32_t> : ScalarTraits<uint32_t, UA_TYPES_UINT32> {};
+template <> struct ArgTraits<int64_t> : ScalarTraits<int64_t, UA_TYPES_INT64> {};
+template <> struct ArgTraits<uint64_t> : ScalarTraits<uint64_t, UA_TYPES_UINT64> {};
+template <> struct ArgTraits<float> : ScalarTraits<float, UA_TYPES_FLOAT> {};
+template <> struct ArgTraits<double> : ScalarTraits<double, UA_TYPES_DOUBLE> {};
+template <> struct ArgTraits<opcua::String> : ScalarTraits<opcua::String, UA_TYPES_STRING> {};
+template <> struct ArgTraits<opcua::DateTime> : ScalarTraits<opcua::DateTime, UA_TYPES_DATETIME> {};
+template <> struct ArgTraits<opcua::NodeId> : ScalarTraits<opcua::NodeId, UA_TYPES_NODEID> {};
+template <> struct ArgTraits<opcua::LocalizedText>
+    : ScalarTraits<opcua::LocalizedText, UA_TYPES_LOCALIZEDTEXT> {};
+
+// std::string_view 直接指向 UA_String 的缓冲区，不产生临时字符串
+template <>
+struct ArgTraits<std::string_view> {
+    static constexpr int typeIndex = UA_TYPES_STRING;
+    static constexpr opcua::ValueRank valueRank = opcua::ValueRank::Scalar;
+
+    static std::string_view unpack(const opcua::Variant& var) noexcept {
+        const auto* str = static_cast<const UA_String*>(var.data());
+        return {reinterpret_cast<const char*>(str->data), str->length};
+    }
+};
+
+// std::string 作为输出类型时映射为 String
+template <>
+struct ArgTraits<std::string> {
+    static constexpr int typeIndex = UA_TYPES_STRING;
+    static constexpr opcua::ValueRank valueRank = opcua::ValueRank::Scalar;
+};
+
+// 一维数组：Span<const T> 直接引用 Variant 中的数组数据
+template <typename T>
+struct ArgTraits<opcua::Span<const T>> {
+    static constexpr int typeIndex = ArgTraits<T>::typeIndex;
+    static constexpr opcua::ValueRank valueRank = opcua::ValueRank::OneDimension;
+
+    static opcua::Span<const T> unpack(const opcua::Variant& var) noexcept {
+        return {static_cast<const T*>(var.data()), var.arrayLength()};
+    }
+};
+
+// 数组输出：std::vector<T>
+template <typename T>
+struct ArgTraits<std::vector<T>> {
+    static constexpr int typeIndex = ArgTraits<T>::typeIndex;
+    static constexpr opcua::ValueRank valueRank = opcua::ValueRank::OneDimension;
+};
+
+template <typename T>
+using Decay = std::remove_cv_t<std::remove_reference_t<T>>;
+
+// 函数签名特征：支持 lambda、函数对象和函数指针
+template <typename F>
+struct FunctionTraits : FunctionTraits<decltype(&Decay<F>::operator())> {};
+
+template <typename R, typename... Args>
+struct FunctionTraits<R(Args...)> {
+    using Result = R;
+    using Inputs = std::tuple<Decay<Args>...>;
+};
+
+template <typename R, typename... Args>
+struct FunctionTraits<R (*)(Args...)> : FunctionTraits<R(Args...)> {};
+
+template <typename C, typename R, typename... Args>
+struct FunctionTraits<R (C::*)(Args...)> : FunctionTraits<R(Args...)> {};
+
+template <typename C, typename R, typename... Args>
+struct FunctionTraits<R (C::*)(Args...) const> : FunctionTraits<R(Args...)> {};
+
+// 返回值到输出参数的映射：void 无输出，std::tuple 多个输出，其他类型一个输出
+template <typename R>
+struct OutputTraits {
+    using Outputs = std::tuple<R>;
+
+    static void pack(R&& result, opcua::Span<opcua::Variant> output) {
+        output[0] = std::move(result);
+    }
+};
+
+template <>
+struct OutputTraits<void> {
+    using Outputs = std::tuple<>;
+};
+
+template <typename... Ts>
+struct OutputTraits<std::tuple<Ts...>> {
+    using Outputs = std::tuple<Ts...>;
+
+    static void pack(std::tuple<Ts...>&& result, opcua::Span<opcua::Variant> output) {
+        packImpl(std::move(result), output, std::index_sequence_for<Ts...>{});
+    }
+
+private:
+    template <size_t... I>
+    static void packImpl(
+        std::tuple<Ts...>&& result, opcua::Span<opcua::Variant> output, std::index_sequence<I...>
+    ) {
+        ((output[I] = std::move(std::get<I>(result))), ...);
+    }
+};
+
+// 由类型列表生成 Argument 定义；名称缺省时使用 "arg0", "arg1", ...
+template <typename Tuple, size_t... I>
+std::vector<opcua::Argument> makeArguments(
+    [[maybe_unused]] std::initializer_list<std::string_view> names, std::index_sequence<I...>
+) {
+    std::vector<opcua::Argument> arguments;
+    arguments.reserve(sizeof...(I));
+    (
+        [&] {
+            using T = std::tuple_element_t<I, Tuple>;
+            const std::string name = I < names.size() ? std::string{names.begin()[I]}
+                                                      : "arg" + std::to_string(I);
+            arguments.emplace_back(
+                name,
+                opcua::LocalizedText{"", name},
+                opcua::NodeId{UA_TYPES[ArgTraits<T>::typeIndex].typeId},
+                ArgTraits<T>::valueRank
+            );
+        }(),
+        ...
+    );
+    return arguments;
+}
+
+template <typename F, typename Inputs, size_t... I>
+decltype(auto) invoke(F& method, opcua::Span<const opcua::Variant> input, std::index_sequence<I...>) {
+    return method(ArgTraits<std::tuple_element_t<I, Inputs>>::unpack(input[I])...);
+}
+
+}  // namespace typed_method
+
+/**
+ * @brief 添加类型化方法节点
+ *
+ * 输入/输出参数定义由 method 的函数签名推导，例如：
+ *   addMethod(parent, {1, 1000}, "Greet", [](std::string_view name) -> std::string {...}, {"name"});
+ *
+ * @param parent 父节点
+ * @param id 方法节点ID
+ * @param browseName 浏览名称
+ * @param method 方法实现（lambda、函数对象或函数指针）
+ * @param inputNames 输入参数名称（可选）
+ * @param outputNames 输出参数名称（可选）
+ */
+template <typename F>
+opcua::Node<opcua::Server> addMethod(
+    opcua::Node<opcua::Server>& parent,
+    const opcua::NodeId& id,
+    std::string_view browseName,
+    F&& method,
+    std::initializer_list<std::string_view> inputNames = {},
+    std::initializer_list<std::string_view> outputNames = {}
+) {
+    using Traits = typed_method::FunctionTraits<typed_method::Decay<F>>;
+    using Inputs = typename Traits::Inputs;
+    using Result = typename Traits::Result;
+    using Outputs = typename typed_method::OutputTraits<Result>::Outputs;
+    constexpr size_t inputCount = std::tuple_size_v<Inputs>;
+    constexpr size_t outputCount = std::tuple_size_v<Outputs>;
+
+    const auto inputArguments = typed_method::makeArguments<Inputs>(
+        inputNames, std::make_index_sequence<inputCount>{}
+    );
+    const auto outputArguments = typed_method::makeArguments<Outputs>(
+        outputNames, std::make_index_sequence<outputCount>{}
+    );
+
+    return parent.addMethod(
+        id,
+        browseName,
+        [fn = std::forward<F>(method)](
+            opcua::Span<const opcua::Variant> input, opcua::Span<opcua::Variant> output
+        ) mutable {
+            constexpr auto indices = std::make_index_sequence<inputCount>{};
+            if constexpr (std::is_void_v<Result>) {
+                typed_method::invoke<decltype(fn), Inputs>(fn, input, indices);
+            } else {
+                typed_method::OutputTraits<Result>::pack(
+                    typed_method::invoke<decltype(fn), Inputs>(fn, input, indices), output
+                );
+            }
+        },
+        inputArguments,
+        outputArguments
+    );
+}
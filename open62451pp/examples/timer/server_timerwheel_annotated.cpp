@@ -0,0 +1,190 @@
+/**
+ * @file server_timerwheel_annotated.cpp
+ * @brief OPC UA 服务器时间轮示例 - 演示如何用分层时间轮调度大量重复回调
+ *
+ * 本示例展示了如何在 open62541pp 服务器中使用 timer_wheel.hpp 提供的分层时间轮，包括：
+ * 1. 用一个内置重复回调驱动整个时间轮
+ * 2. 为每个模拟设备注册一个刷新定时器（数量可达数万）
+ * 3. 使用批量回调一次处理同一 tick 内到期的所有设备
+ * 4. 运行时修改定时器间隔、取消定时器
+ *
+ * 功能说明：
+ * - server_callback_annotated.cpp 中每个定时器都是一个 addRepeatedCallback
+ * - 定时器数量很大时，服务器事件循环每次迭代都要处理庞大的内置定时器集合
+ * - 时间轮把所有设备定时器合并为一个内置回调，插入/取消/修改间隔均为 O(1)
+ *
+ * 与内置回调的性能对比见 timerwheel_benchmark.cpp
+ */
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// 包含必要的头文件
+#include <open62541pp/callback.hpp>  // 回调功能
+#include <open62541pp/node.hpp>      // 节点操作
+#include <open62541pp/server.hpp>    // 服务器核心功能
+
+#include "../helper.hpp"   // CliParser - 命令行参数解析器
+#include "timer_wheel.hpp"  // TimerWheel - 分层时间轮
+
+int main(int argc, char* argv[]) {
+    std::cout << "=== OPC UA 服务器时间轮示例 ===" << std::endl;
+
+    // 解析命令行参数：--devices <数量>，默认 20000 个模拟设备
+    const CliParser parser{argc, argv};
+    const size_t deviceCount = std::stoul(std::string{parser.value("--devices").value_or("20000")});
+
+    // 创建 OPC UA 服务器实例
+    opcua::Server server;
+
+    // 创建设备文件夹和每个设备的数值变量
+    opcua::Node objectsNode{server, opcua::ObjectId::ObjectsFolder};
+    auto devicesNode = objectsNode.addFolder({1, "Devices"}, "Devices");
+
+    std::cout << "正在创建 " << deviceCount << " 个模拟设备变量..." << std::endl;
+    std::vector<opcua::NodeId> deviceNodes;
+    deviceNodes.reserve(deviceCount);
+    for (size_t i = 0; i < deviceCount; ++i) {
+        const std::string name = "Device" + std::to_string(i);
+        deviceNodes.push_back(
+            devicesNode
+                .addVariable(
+                    {1, name},
+                    name,
+                    opcua::VariableAttributes{}
+                        .setDataType<double>()
+                        .setValue(opcua::Variant{0.0})
+                )
+                .id()
+        );
+    }
+
+    // 创建时间轮
+    // tick 为 10 毫秒：同一个 10 毫秒内到期的定时器会被合并为一批
+    TimerWheel wheel{10.0};
+
+    // 设置批量回调
+    // 参数是本 tick 到期的所有设备编号（注册时传入的 userData）
+    // 实际网关中可以在这里发起一次批量读取，而不是每个设备单独处理
+    std::vector<double> deviceValues(deviceCount, 0.0);
+    size_t refreshCount = 0;
+    wheel.setBatchCallback([&](const std::vector<uint64_t>& devices) {
+        for (const auto device : devices) {
+            deviceValues[device] += 1.0;
+            opcua::Node{server, deviceNodes[device]}.writeValue(opcua::Variant{deviceValues[device]});
+        }
+        refreshCount += devices.size();
+    });
+
+    // 为每个设备注册一个重复定时器
+    // 间隔在 500ms ~ 5000ms 之间分布，模拟不同的设备刷新周期
+    std::cout << "正在注册设备刷新定时器..." << std::endl;
+    std::vector<TimerWheel::TimerId> deviceTimers;
+    deviceTimers.reserve(deviceCount);
+    for (size_t i = 0; i < deviceCount; ++i) {
+        const double interval = 500.0 + static_cast<double>(i % 10) * 500.0;
+        deviceTimers.push_back(wheel.addRepeatedTimer(i, interval));
+    }
+    std::cout << "✓ 已注册 " << wheel.size() << " 个设备定时器" << std::endl;
+
+    // 普通回调同样可以注册到时间轮上：每 5 秒输出一次统计信息
+    wheel.addRepeatedCallback(
+        [&] {
+            std::cout << "统计: 时间轮定时器 " << wheel.size() << " 个，累计刷新 " << refreshCount
+                      << " 次" << std::endl;
+        },
+        5000.0
+    );
+
+    // 10 秒后演示修改间隔和取消定时器（都是 O(1) 操作）
+    wheel.addTimedCallback(
+        [&] {
+            std::cout << "定时回调执行: 修改设备 0 的刷新间隔为 100ms，取消最后一个设备的定时器"
+                      << std::endl;
+            wheel.changeInterval(deviceTimers.front(), 100.0);
+            wheel.remove(deviceTimers.back());
+        },
+        10000.0
+    );
+
+    // 使用一个内置重复回调驱动时间轮
+    // 每次执行时根据实际经过的时间推进时间轮，避免事件循环抖动造成累计误差
+    auto last = std::chrono::steady_clock::now();
+    const opcua::CallbackId driverId = opcua::addRepeatedCallback(
+        server,
+        [&] {
+            const auto now = std::chrono::steady_clock::now();
+            const std::chrono::duration<double, std::milli> elapsed = now - last;
+            last = now;
+            wheel.advanceByMs(elapsed.count());
+        },
+        wheel.tickMs()
+    );
+
+    std::cout << "✓ 时间轮驱动回调已创建，回调ID: " << driverId << std::endl;
+    std::cout << "\n正在启动服务器..." << std::endl;
+    std::cout << "服务器地址: opc.tcp://localhost:4840" << std::endl;
+    std::cout << "按 Ctrl+C 停止服务器" << std::endl;
+
+    // 启动服务器
+    server.run();
+
+    opcua::removeCallback(server, driverId);
+    return 0;
+}
+
+/**
+ * 使用说明：
+ *
+ * 1. 编译并运行此程序：./server_timerwheel_annotated --devices 20000
+ * 2. 服务器在 Objects/Devices 下创建指定数量的设备变量
+ * 3. 每个设备按自己的周期刷新数值
+ * 4. 使用 UaExpert 订阅任意设备变量可以观察刷新效果
+ *
+ * 分层时间轮工作原理：
+ *
+ * 1. 层次结构：
+ *    - 第 0 层：256 个槽，每槽一个 tick（10ms），覆盖 2.56 秒
+ *    - 第 1 层：256 个槽，每槽 256 个 tick，覆盖约 11 分钟
+ *    - 第 2、3 层依次再扩大 256 倍
+ *    - 定时器按剩余时间放入合适的层
+ *
+ * 2. 推进过程：
+ *    - 每推进一个 tick，执行第 0 层当前槽中的所有定时器
+ *    - 第 0 层转满一圈时，把第 1 层对应槽中的定时器"降级"到第 0 层
+ *    - 高层以此类推
+ *
+ * 3. 复杂度：
+ *    - 插入：根据剩余时间直接计算层和槽，O(1)
+ *    - 取消：从双向链表中摘除，O(1)
+ *    - 修改间隔：摘除后重新插入，O(1)
+ *    - 推进：只处理到期的槽，空槽开销为常数
+ *
+ * 4. 批量执行：
+ *    - 同一个 tick 内到期的定时器一次性摘下
+ *    - 带回调函数的定时器依次执行
+ *    - 只带 userData 的定时器合并为一次批量回调
+ *
+ * 与内置回调的区别：
+ *
+ * 1. 精度：
+ *    - 时间轮的精度是一个 tick，到期时间按 tick 取整
+ *    - 内置回调精度更高，但每个回调都是服务器定时器中的一项
+ *
+ * 2. 执行线程：
+ *    - 时间轮回调在驱动回调中执行，与服务器事件循环在同一线程
+ *    - 可以直接访问服务器节点，无需额外同步
+ *
+ * 3. 适用场景：
+ *    - 定时器数量很大（数千到数十万）
+ *    - 间隔相对较长（远大于 tick）
+ *    - 需要频繁修改间隔或取消
+ *
+ * 注意事项：
+ *
+ * - 批量回调中的工作量与到期设备数量成正比，应尽量保持轻量
+ * - 事件循环被长时间阻塞后，时间轮会连续推进多个 tick 以追赶时间
+ * - 时间轮不是线程安全的，只能在服务器事件循环线程中使用
+ */
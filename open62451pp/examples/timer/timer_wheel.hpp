@@ -0,0 +1,326 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+// 分层时间轮（hierarchical timing wheel）
+// - 4 层 x 256 槽，每层覆盖前一层的 256 倍时间跨度
+// - 定时器保存在连续数组中，槽内使用侵入式双向链表
+// - 插入、取消、修改间隔均为 O(1)
+// - 同一个 tick 内到期的定时器被收集成一批统一执行
+class TimerWheel {
+public:
+    using TimerId = uint64_t;
+    using Callback = std::function<void()>;
+    // 批量回调：一次接收同一 tick 内到期的所有 userData
+    using BatchCallback = std::function<void(const std::vector<uint64_t>& userData)>;
+
+    static constexpr TimerId invalidId = 0;
+
+    explicit TimerWheel(double tickMs = 10.0)
+        : tickMs_{tickMs} {
+        for (auto& level : slots_) {
+            level.fill(npos);
+        }
+    }
+
+    double tickMs() const noexcept {
+        return tickMs_;
+    }
+
+    size_t size() const noexcept {
+        return activeCount_;
+    }
+
+    uint64_t currentTick() const noexcept {
+        return current_;
+    }
+
+    /// 设置批量回调，用于处理没有单独回调函数的定时器
+    void setBatchCallback(BatchCallback callback) {
+        batchCallback_ = std::move(callback);
+    }
+
+    /// 添加重复执行的回调函数（与 opcua::addRepeatedCallback 语义相同）
+    TimerId addRepeatedCallback(Callback callback, double intervalMs) {
+        return add(std::move(callback), 0, intervalMs, true);
+    }
+
+    /// 添加一次性回调函数，在 delayMs 之后执行
+    TimerId addTimedCallback(Callback callback, double delayMs) {
+        return add(std::move(callback), 0, delayMs, false);
+    }
+
+    /// 添加重复定时器，到期时 userData 会交给批量回调处理
+    TimerId addRepeatedTimer(uint64_t userData, double intervalMs) {
+        return add({}, userData, intervalMs, true);
+    }
+
+    /// 修改重复定时器的执行间隔，下一次执行从当前 tick 重新计时
+    bool changeInterval(TimerId id, double intervalMs) {
+        Entry* entry = find(id);
+        if (entry == nullptr) {
+            return false;
+        }
+        const uint32_t index = indexOf(id);
+        unlink(index);
+        entry->intervalTicks = toTicks(intervalMs);
+        entry->expires = current_ + entry->intervalTicks;
+        entry->pendingFire = false;
+        link(index);
+        return true;
+    }
+
+    /// 取消定时器
+    bool remove(TimerId id) {
+        Entry* entry = find(id);
+        if (entry == nullptr) {
+            return false;
+        }
+        const uint32_t index = indexOf(id);
+        unlink(index);
+        release(index);
+        return true;
+    }
+
+    /// 推进时间轮到 nowTick，执行所有到期的定时器
+    /// 返回执行的定时器数量
+    size_t advanceTo(uint64_t nowTick) {
+        size_t fired = 0;
+        while (current_ < nowTick) {
+            ++current_;
+            cascade();
+            fired += fireSlot(static_cast<uint32_t>(current_ & slotMask));
+        }
+        return fired;
+    }
+
+    /// 按经过的毫秒数推进时间轮
+    size_t advanceByMs(double elapsedMs) {
+        remainderMs_ += elapsedMs;
+        const auto ticks = static_cast<uint64_t>(remainderMs_ / tickMs_);
+        remainderMs_ -= static_cast<double>(ticks) * tickMs_;
+        return advanceTo(current_ + ticks);
+    }
+
+private:
+    static constexpr uint32_t npos = UINT32_MAX;
+    static constexpr size_t levels = 4;
+    static constexpr uint32_t slotBits = 8;
+    static constexpr uint32_t slotCount = 1U << slotBits;
+    static constexpr uint64_t slotMask = slotCount - 1;
+    static constexpr uint64_t maxDelta = (uint64_t{1} << (slotBits * levels)) - 1;
+
+    struct Entry {
+        Callback callback;
+        uint64_t userData = 0;
+        uint64_t expires = 0;
+        uint64_t intervalTicks = 0;
+        uint32_t prev = npos;
+        uint32_t next = npos;
+        uint32_t generation = 1;
+        uint8_t level = 0;
+        uint16_t slot = 0;
+        bool active = false;
+        bool linked = false;
+        bool repeated = false;
+        bool pendingFire = false;
+    };
+
+    static uint32_t indexOf(TimerId id) noexcept {
+        return static_cast<uint32_t>(id & 0xFFFFFFFFU);
+    }
+
+    static TimerId makeId(uint32_t index, uint32_t generation) noexcept {
+        return (static_cast<uint64_t>(generation) << 32) | index;
+    }
+
+    uint64_t toTicks(double ms) const noexcept {
+        const auto ticks = static_cast<uint64_t>(ms / tickMs_ + 0.5);
+        return ticks == 0 ? 1 : ticks;
+    }
+
+    Entry* find(TimerId id) noexcept {
+        const uint32_t index = indexOf(id);
+        if (index >= entries_.size()) {
+            return nullptr;
+        }
+        Entry& entry = entries_[index];
+        if (!entry.active || entry.generation != static_cast<uint32_t>(id >> 32)) {
+            return nullptr;
+        }
+        return &entry;
+    }
+
+    TimerId add(Callback callback, uint64_t userData, double intervalMs, bool repeated) {
+        uint32_t index = 0;
+        if (!freeList_.empty()) {
+            index = freeList_.back();
+            freeList_.pop_back();
+        } else {
+            index = static_cast<uint32_t>(entries_.size());
+            entries_.emplace_back();
+        }
+        Entry& entry = entries_[index];
+        entry.callback = std::move(callback);
+        entry.userData = userData;
+        entry.intervalTicks = toTicks(intervalMs);
+        entry.expires = current_ + entry.intervalTicks;
+        entry.repeated = repeated;
+        entry.active = true;
+        entry.pendingFire = false;
+        link(index);
+        ++activeCount_;
+        return makeId(index, entry.generation);
+    }
+
+    void release(uint32_t index) {
+        Entry& entry = entries_[index];
+        entry.callback = nullptr;
+        entry.active = false;
+        entry.pendingFire = false;
+        ++entry.generation;
+        if (entry.generation == 0) {
+            entry.generation = 1;  // 0 保留给 invalidId
+        }
+        freeList_.push_back(index);
+        --activeCount_;
+    }
+
+    void link(uint32_t index) {
+        Entry& entry = entries_[index];
+        uint64_t delta = entry.expires - current_;
+        if (delta > maxDelta) {
+            delta = maxDelta;
+            entry.expires = current_ + delta;
+        }
+        size_t level = 0;
+        while (level + 1 < levels && delta >= (uint64_t{1} << (slotBits * (level + 1)))) {
+            ++level;
+        }
+        const auto slot = static_cast<uint16_t>((entry.expires >> (slotBits * level)) & slotMask);
+        uint32_t& head = slots_[level][slot];
+        entry.level = static_cast<uint8_t>(level);
+        entry.slot = slot;
+        entry.prev = npos;
+        entry.next = head;
+        if (head != npos) {
+            entries_[head].prev = index;
+        }
+        head = index;
+        entry.linked = true;
+    }
+
+    void unlink(uint32_t index) {
+        Entry& entry = entries_[index];
+        if (!entry.linked) {
+            return;
+        }
+        if (entry.prev != npos) {
+            entries_[entry.prev].next = entry.next;
+        } else {
+            slots_[entry.level][entry.slot] = entry.next;
+        }
+        if (entry.next != npos) {
+            entries_[entry.next].prev = entry.prev;
+        }
+        entry.prev = npos;
+        entry.next = npos;
+        entry.linked = false;
+    }
+
+    // 低层转满一圈时，把高层对应槽中的定时器重新分配到更低的层
+    void cascade() {
+        for (size_t level = 1; level < levels; ++level) {
+            if (((current_ >> (slotBits * (level - 1))) & slotMask) != 0) {
+                break;
+            }
+            const auto slot = static_cast<uint16_t>((current_ >> (slotBits * level)) & slotMask);
+            uint32_t index = slots_[level][slot];
+            slots_[level][slot] = npos;
+            while (index != npos) {
+                const uint32_t next = entries_[index].next;
+                entries_[index].linked = false;
+                link(index);
+                index = next;
+            }
+        }
+    }
+
+    size_t fireSlot(uint32_t slot) {
+        // 先把整个槽摘下来，回调中对定时器的修改不会影响本次遍历
+        batch_.clear();
+        uint32_t index = slots_[0][slot];
+        slots_[0][slot] = npos;
+        while (index != npos) {
+            Entry& entry = entries_[index];
+            const uint32_t next = entry.next;
+            entry.linked = false;
+            entry.prev = npos;
+            entry.next = npos;
+            entry.pendingFire = true;
+            batch_.push_back(index);
+            index = next;
+        }
+        if (batch_.empty()) {
+            return 0;
+        }
+
+        batchUserData_.clear();
+        size_t fired = 0;
+        for (const uint32_t i : batch_) {
+            Entry& entry = entries_[i];
+            if (!entry.active || !entry.pendingFire) {
+                continue;  // 已在本批次中被取消或修改
+            }
+            entry.pendingFire = false;
+            ++fired;
+            if (entry.callback) {
+                // 回调中可能增删定时器（entries_ 可能重新分配），先把回调移出再执行
+                const TimerId id = makeId(i, entry.generation);
+                Callback callback = std::move(entry.callback);
+                callback();
+                if (Entry* alive = find(id)) {
+                    alive->callback = std::move(callback);
+                }
+                reschedule(id);
+            } else {
+                batchUserData_.push_back(entry.userData);
+                reschedule(makeId(i, entry.generation));
+            }
+        }
+        if (!batchUserData_.empty() && batchCallback_) {
+            batchCallback_(batchUserData_);
+        }
+        return fired;
+    }
+
+    void reschedule(TimerId id) {
+        Entry* entry = find(id);
+        if (entry == nullptr || entry->linked) {
+            return;  // 已取消，或回调中已经修改过间隔
+        }
+        const uint32_t index = indexOf(id);
+        if (!entry->repeated) {
+            release(index);
+            return;
+        }
+        entry->expires = current_ + entry->intervalTicks;
+        link(index);
+    }
+
+    double tickMs_;
+    double remainderMs_ = 0.0;
+    uint64_t current_ = 0;
+    size_t activeCount_ = 0;
+    std::vector<Entry> entries_;
+    std::vector<uint32_t> freeList_;
+    std::array<std::array<uint32_t, slotCount>, levels> slots_{};
+    std::vector<uint32_t> batch_;
+    std::vector<uint64_t> batchUserData_;
+    BatchCallback batchCallback_;
+};
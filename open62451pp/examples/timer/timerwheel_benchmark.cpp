@@ -0,0 +1,176 @@
+/**
+ * @file timerwheel_benchmark.cpp
+ * @brief 时间轮性能测试 - 比较内置重复回调与 TimerWheel
+ *
+ * 本程序分别用 1000、10000、100000 个定时器测试：
+ * 1. 每次插入、修改间隔、取消的耗时
+ * 2. 每秒墙钟时间内服务器事件循环占用的 CPU 时间
+ * 3. 测试期间触发的回调总数
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <open62541/server.h>
+
+#include <open62541pp/callback.hpp>
+#include <open62541pp/server.hpp>
+
+#include "timer_wheel.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+struct Result {
+    double insertNs;
+    double changeNs;
+    double cancelNs;
+    double loopCpuMsPerSec;
+    uint64_t fired;
+};
+
+static double nsPerOp(Clock::time_point start, size_t ops) {
+    const std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+    return elapsed.count() / static_cast<double>(ops);
+}
+
+static std::vector<double> makeIntervals(size_t count) {
+    std::mt19937 rng{42};
+    std::uniform_real_distribution<double> dist{100.0, 1000.0};
+    std::vector<double> intervals(count);
+    for (auto& interval : intervals) {
+        interval = dist(rng);
+    }
+    return intervals;
+}
+
+// 非阻塞地运行服务器事件循环，统计 run_iterate 占用的时间（毫秒/秒）
+static double runLoop(opcua::Server& server, std::chrono::milliseconds duration) {
+    std::chrono::duration<double, std::milli> busy{0};
+    const auto end = Clock::now() + duration;
+    while (Clock::now() < end) {
+        const auto start = Clock::now();
+        UA_Server_run_iterate(server.handle(), false);
+        busy += Clock::now() - start;
+    }
+    return busy.count() / std::chrono::duration<double>(duration).count();
+}
+
+static Result benchBuiltin(const std::vector<double>& intervals, std::chrono::milliseconds duration) {
+    opcua::Server server;
+    UA_Server_run_startup(server.handle());
+    uint64_t fired = 0;
+    Result result{};
+
+    // 每个定时器一个 addRepeatedCallback
+    std::vector<opcua::CallbackId> ids;
+    ids.reserve(intervals.size());
+    auto start = Clock::now();
+    for (const double interval : intervals) {
+        ids.push_back(opcua::addRepeatedCallback(server, [&] { ++fired; }, interval));
+    }
+    result.insertNs = nsPerOp(start, intervals.size());
+
+    start = Clock::now();
+    for (size_t i = 0; i < ids.size(); ++i) {
+        opcua::changeRepeatedCallbackInterval(server, ids[i], intervals[ids.size() - 1 - i]);
+    }
+    result.changeNs = nsPerOp(start, ids.size());
+
+    result.loopCpuMsPerSec = runLoop(server, duration);
+    result.fired = fired;
+
+    start = Clock::now();
+    for (const auto id : ids) {
+        opcua::removeCallback(server, id);
+    }
+    result.cancelNs = nsPerOp(start, ids.size());
+
+    UA_Server_run_shutdown(server.handle());
+    return result;
+}
+
+static Result benchWheel(const std::vector<double>& intervals, std::chrono::milliseconds duration) {
+    opcua::Server server;
+    UA_Server_run_startup(server.handle());
+    uint64_t fired = 0;
+    Result result{};
+
+    // 所有定时器放入时间轮，由一个 10 毫秒的内置回调驱动
+    TimerWheel wheel{10.0};
+    wheel.setBatchCallback([&](const std::vector<uint64_t>& due) { fired += due.size(); });
+
+    std::vector<TimerWheel::TimerId> ids;
+    ids.reserve(intervals.size());
+    auto start = Clock::now();
+    for (size_t i = 0; i < intervals.size(); ++i) {
+        ids.push_back(wheel.addRepeatedTimer(i, intervals[i]));
+    }
+    result.insertNs = nsPerOp(start, intervals.size());
+
+    start = Clock::now();
+    for (size_t i = 0; i < ids.size(); ++i) {
+        wheel.changeInterval(ids[i], intervals[ids.size() - 1 - i]);
+    }
+    result.changeNs = nsPerOp(start, ids.size());
+
+    auto last = Clock::now();
+    const auto driverId = opcua::addRepeatedCallback(
+        server,
+        [&] {
+            const auto now = Clock::now();
+            wheel.advanceByMs(std::chrono::duration<double, std::milli>(now - last).count());
+            last = now;
+        },
+        wheel.tickMs()
+    );
+    result.loopCpuMsPerSec = runLoop(server, duration);
+    result.fired = fired;
+    opcua::removeCallback(server, driverId);
+
+    start = Clock::now();
+    for (const auto id : ids) {
+        wheel.remove(id);
+    }
+    result.cancelNs = nsPerOp(start, ids.size());
+
+    UA_Server_run_shutdown(server.handle());
+    return result;
+}
+
+static void print(const char* name, size_t count, const Result& r) {
+    std::cout << std::left << std::setw(10) << name << std::right << std::setw(8) << count
+              << std::fixed << std::setprecision(1) << std::setw(12) << r.insertNs
+              << std::setw(12) << r.changeNs << std::setw(12) << r.cancelNs << std::setw(14)
+              << r.loopCpuMsPerSec << std::setw(12) << r.fired << std::endl;
+}
+
+int main() {
+    const std::chrono::milliseconds duration{3000};
+    std::cout << "=== 时间轮性能测试 ===" << std::endl;
+    // 列：调度方式、定时器数、插入/修改间隔/取消（纳秒/次）、事件循环 CPU（毫秒/秒）、触发次数
+    std::cout << std::left << std::setw(10) << "scheduler" << std::right << std::setw(8)
+              << "timers" << std::setw(12) << "insert ns" << std::setw(12) << "change ns"
+              << std::setw(12) << "cancel ns" << std::setw(14) << "loop ms/s" << std::setw(12)
+              << "fired" << std::endl;
+    for (const size_t count : {1000, 10000, 100000}) {
+        const auto intervals = makeIntervals(count);
+        print("builtin", count, benchBuiltin(intervals, duration));
+        print("wheel", count, benchWheel(intervals, duration));
+    }
+}
+
+/**
+ * 使用说明：
+ *
+ * 1. 运行：./timerwheel_benchmark
+ * 2. 每组定时器数量各运行 3 秒事件循环，间隔在 100~1000 毫秒之间随机分布
+ *
+ * 注意事项：
+ *
+ * - 修改间隔时把第 i 个定时器改为倒数第 i 个的间隔，保证每个定时器都被实际移动
+ * - loop ms/s 接近 1000 表示事件循环已经跟不上
+ */